@@ -31,18 +31,108 @@
 #include "array.h"
 
 #include <algorithm>
-#include <vector>
 
 #include "core/hashfuncs.h"
 #include "core/object.h"
 #include "core/variant.h"
 
+// Arrays up to this size keep their elements inside ArrayPrivate, so creating
+// and filling one only costs a single allocation.
+#define ARRAY_INLINE_CAPACITY 4
+
 class ArrayPrivate {
 public:
 	SafeRefCount refcount;
 
-	// need_update : obliterate this class :o ! Learn diff between array and vector !
-	std::vector<Variant> array;
+	// Elements are relocated with memcpy/memmove, like CowData does.
+	Variant *data;
+	int size;
+	int capacity;
+	alignas(Variant) uint8_t inline_data[sizeof(Variant) * ARRAY_INLINE_CAPACITY];
+
+	_FORCE_INLINE_ bool is_inline() const { return data == (const Variant *)inline_data; }
+
+	bool reserve(int p_capacity) {
+
+		if (p_capacity <= capacity) {
+			return true;
+		}
+
+		Variant *new_data = (Variant *)memalloc(sizeof(Variant) * p_capacity);
+		ERR_FAIL_COND_V(!new_data, false);
+		memcpy(new_data, data, sizeof(Variant) * size);
+		if (!is_inline()) {
+			memfree(data);
+		}
+		data = new_data;
+		capacity = p_capacity;
+		return true;
+	}
+
+	bool resize(int p_size) {
+
+		ERR_FAIL_COND_V(p_size < 0, false);
+
+		if (p_size > capacity && !reserve(p_size)) {
+			return false;
+		}
+		for (int i = size; i < p_size; i++) {
+			memnew_placement(&data[i], Variant);
+		}
+		for (int i = p_size; i < size; i++) {
+			data[i].~Variant();
+		}
+		size = p_size;
+		return true;
+	}
+
+	void insert(int p_pos, const Variant &p_value) {
+
+		if (p_pos == size && size < capacity) {
+			memnew_placement(&data[size], Variant(p_value));
+			size++;
+			return;
+		}
+
+		// p_value may live in this array, copy it before anything moves.
+		Variant value = p_value;
+		if (size == capacity && !reserve(capacity * 2)) {
+			return;
+		}
+		memmove(&data[p_pos + 1], &data[p_pos], sizeof(Variant) * (size - p_pos));
+		memnew_placement(&data[p_pos], Variant(value));
+		size++;
+	}
+
+	void remove(int p_pos) {
+
+		data[p_pos].~Variant();
+		memmove(&data[p_pos], &data[p_pos + 1], sizeof(Variant) * (size - p_pos - 1));
+		size--;
+	}
+
+	void clear() {
+
+		for (int i = 0; i < size; i++) {
+			data[i].~Variant();
+		}
+		size = 0;
+		if (!is_inline()) {
+			memfree(data);
+			data = (Variant *)inline_data;
+			capacity = ARRAY_INLINE_CAPACITY;
+		}
+	}
+
+	ArrayPrivate() {
+		data = (Variant *)inline_data;
+		size = 0;
+		capacity = ARRAY_INLINE_CAPACITY;
+	}
+
+	~ArrayPrivate() {
+		clear();
+	}
 };
 
 void Array::_ref(const Array &p_from) const {
@@ -74,25 +164,25 @@ void Array::_unref() const {
 
 Variant &Array::operator[](int p_idx) {
 
-	return _p->array[p_idx];
+	return _p->data[p_idx];
 }
 
 const Variant &Array::operator[](int p_idx) const {
 
-	return _p->array[p_idx];
+	return _p->data[p_idx];
 }
 
 int Array::size() const {
 
-	return _p->array.size();
+	return _p->size;
 }
 bool Array::empty() const {
 
-	return _p->array.empty();
+	return _p->size == 0;
 }
 void Array::clear() {
 
-	_p->array.clear();
+	_p->clear();
 }
 
 bool Array::operator==(const Array &p_array) const {
@@ -104,9 +194,9 @@ uint32_t Array::hash() const {
 
 	uint32_t h = hash_djb2_one_32(0);
 
-	for (int i = 0; i < _p->array.size(); i++) {
+	for (int i = 0; i < _p->size; i++) {
 
-		h = hash_djb2_one_32(_p->array[i].hash(), h);
+		h = hash_djb2_one_32(_p->data[i].hash(), h);
 	}
 	return h;
 }
@@ -116,46 +206,46 @@ void Array::operator=(const Array &p_array) {
 }
 void Array::push_back(const Variant &p_value) {
 
-	_p->array.push_back(p_value);
+	_p->insert(_p->size, p_value);
 }
 
 Error Array::resize(int p_new_size) {
-	try {
-		_p->array.resize(p_new_size);
-	} catch (...) {
-		ERR_FAIL_COND_V_MSG(0, ERR_CANT_CREATE, "Can't resize.");
-	}
+
+	ERR_FAIL_COND_V_MSG(!_p->resize(p_new_size), ERR_CANT_CREATE, "Can't resize.");
 
 	return OK;
 }
 
 void Array::insert(int p_pos, const Variant &p_value) {
-	_p->array.insert(_p->array.begin() + p_pos, p_value);
+	ERR_FAIL_INDEX(p_pos, _p->size + 1);
+	_p->insert(p_pos, p_value);
 }
 
 void Array::erase(const Variant &p_value) {
-	auto it_find = std::find(_p->array.begin(), _p->array.end(), p_value);
+	const Variant *end = _p->data + _p->size;
+	const Variant *it_find = std::find((const Variant *)_p->data, end, p_value);
 
-	if (it_find != _p->array.end()) {
-		_p->array.erase(it_find);
+	if (it_find != end) {
+		_p->remove(it_find - _p->data);
 	}
 }
 
 Variant Array::front() const {
-	ERR_FAIL_COND_V_MSG(_p->array.size() == 0, Variant(), "Can't take value from empty array.");
+	ERR_FAIL_COND_V_MSG(_p->size == 0, Variant(), "Can't take value from empty array.");
 	return operator[](0);
 }
 
 Variant Array::back() const {
-	ERR_FAIL_COND_V_MSG(_p->array.size() == 0, Variant(), "Can't take value from empty array.");
-	return operator[](_p->array.size() - 1);
+	ERR_FAIL_COND_V_MSG(_p->size == 0, Variant(), "Can't take value from empty array.");
+	return operator[](_p->size - 1);
 }
 
 int Array::find(const Variant &p_value, int p_from) const {
-	auto it_find = std::find(_p->array.begin() + p_from, _p->array.end(), p_value);
+	const Variant *end = _p->data + _p->size;
+	const Variant *it_find = std::find((const Variant *)_p->data + p_from, end, p_value);
 
-	if (it_find != _p->array.end()) {
-		return std::distance(_p->array.begin(), it_find);
+	if (it_find != end) {
+		return it_find - _p->data;
 	}
 
 	return -1;
@@ -163,21 +253,21 @@ int Array::find(const Variant &p_value, int p_from) const {
 
 int Array::rfind(const Variant &p_value, int p_from) const {
 
-	if (_p->array.size() == 0)
+	if (_p->size == 0)
 		return -1;
 
 	if (p_from < 0) {
 		// Relative offset from the end
-		p_from = _p->array.size() + p_from;
+		p_from = _p->size + p_from;
 	}
-	if (p_from < 0 || p_from >= _p->array.size()) {
+	if (p_from < 0 || p_from >= _p->size) {
 		// Limit to array boundaries
-		p_from = _p->array.size() - 1;
+		p_from = _p->size - 1;
 	}
 
 	for (int i = p_from; i >= 0; i--) {
 
-		if (_p->array[i] == p_value) {
+		if (_p->data[i] == p_value) {
 			return i;
 		}
 	}
@@ -192,13 +282,13 @@ int Array::find_last(const Variant &p_value) const {
 
 int Array::count(const Variant &p_value) const {
 
-	if (_p->array.size() == 0)
+	if (_p->size == 0)
 		return 0;
 
 	int amount = 0;
-	for (int i = 0; i < _p->array.size(); i++) {
+	for (int i = 0; i < _p->size; i++) {
 
-		if (_p->array[i] == p_value) {
+		if (_p->data[i] == p_value) {
 			amount++;
 		}
 	}
@@ -211,7 +301,8 @@ bool Array::has(const Variant &p_value) const {
 }
 
 void Array::remove(int p_pos) {
-	_p->array.erase(_p->array.begin() + p_pos);
+	ERR_FAIL_INDEX(p_pos, _p->size);
+	_p->remove(p_pos);
 }
 
 void Array::set(int p_idx, const Variant &p_value) {
@@ -308,7 +399,7 @@ struct _ArrayVariantSort {
 };
 
 Array &Array::sort() {
-	std::sort(_p->array.begin(), _p->array.end());
+	std::sort(_p->data, _p->data + _p->size);
 
 	return *this;
 }
@@ -335,16 +426,16 @@ Array &Array::sort_custom(Object *p_obj, const StringName &p_function) {
 	SortArray<Variant, _ArrayVariantSortCustom, true> avs;
 	avs.compare.obj = p_obj;
 	avs.compare.func = p_function;
-	avs.sort(_p->array.data(), _p->array.size());
+	avs.sort(_p->data, _p->size);
 	return *this;
 }
 
 void Array::shuffle() {
 
-	const int n = _p->array.size();
+	const int n = _p->size;
 	if (n < 2)
 		return;
-	Variant *data = _p->array.data();
+	Variant *data = _p->data;
 	for (int i = n - 1; i >= 1; i--) {
 		const int j = Math::rand() % (i + 1);
 		const Variant tmp = data[j];
@@ -354,14 +445,15 @@ void Array::shuffle() {
 }
 
 template <typename Less>
-_FORCE_INLINE_ int bisect(const std::vector<Variant> &p_array, const Variant &p_value, bool p_before, const Less &p_less) {
+_FORCE_INLINE_ int bisect(const ArrayPrivate *p_array, const Variant &p_value, bool p_before, const Less &p_less) {
 
+	const Variant *data = p_array->data;
 	int lo = 0;
-	int hi = p_array.size();
+	int hi = p_array->size;
 	if (p_before) {
 		while (lo < hi) {
 			const int mid = (lo + hi) / 2;
-			if (p_less(p_array[mid], p_value)) {
+			if (p_less(data[mid], p_value)) {
 				lo = mid + 1;
 			} else {
 				hi = mid;
@@ -370,7 +462,7 @@ _FORCE_INLINE_ int bisect(const std::vector<Variant> &p_array, const Variant &p_
 	} else {
 		while (lo < hi) {
 			const int mid = (lo + hi) / 2;
-			if (p_less(p_value, p_array[mid])) {
+			if (p_less(p_value, data[mid])) {
 				hi = mid;
 			} else {
 				lo = mid + 1;
@@ -381,7 +473,7 @@ _FORCE_INLINE_ int bisect(const std::vector<Variant> &p_array, const Variant &p_
 }
 
 int Array::bsearch(const Variant &p_value, bool p_before) {
-	return bisect(_p->array, p_value, p_before, _ArrayVariantSort());
+	return bisect(_p, p_value, p_before, _ArrayVariantSort());
 }
 
 int Array::bsearch_custom(const Variant &p_value, Object *p_obj, const StringName &p_function, bool p_before) {
@@ -392,24 +484,24 @@ int Array::bsearch_custom(const Variant &p_value, Object *p_obj, const StringNam
 	less.obj = p_obj;
 	less.func = p_function;
 
-	return bisect(_p->array, p_value, p_before, less);
+	return bisect(_p, p_value, p_before, less);
 }
 
 Array &Array::invert() {
-	std::reverse(_p->array.begin(), _p->array.end());
+	std::reverse(_p->data, _p->data + _p->size);
 
 	return *this;
 }
 
 void Array::push_front(const Variant &p_value) {
-	_p->array.insert(_p->array.begin(), p_value);
+	_p->insert(0, p_value);
 }
 
 Variant Array::pop_back() {
-	if (!_p->array.empty()) {
-		Variant ret = _p->array.back();
+	if (_p->size) {
+		Variant ret = _p->data[_p->size - 1];
 
-		_p->array.pop_back();
+		_p->remove(_p->size - 1);
 
 		return ret;
 	}
@@ -418,10 +510,10 @@ Variant Array::pop_back() {
 }
 
 Variant Array::pop_front() {
-	if (!_p->array.empty()) {
-		Variant ret = _p->array[0];
+	if (_p->size) {
+		Variant ret = _p->data[0];
 
-		_p->array.erase(_p->array.begin());
+		_p->remove(0);
 
 		return ret;
 	}
@@ -475,7 +567,7 @@ Variant Array::max() const {
 }
 
 const void *Array::id() const {
-	return _p->array.data();
+	return _p;
 }
 
 Array::Array(const Array &p_from) {
@@ -1087,6 +1087,27 @@ bool ClassDB::get_property(Object *p_object, const StringName &p_property, Varia
 	return false;
 }
 
+// Resolves a property the way get_property() (p_for_get) or set_property() would, for callers
+// that cache the result. Returns NULL if the property isn't found or a constant shadows it.
+const ClassDB::PropertySetGet *ClassDB::get_property_setget(const StringName &p_class, const StringName &p_property, bool p_for_get) {
+
+	ClassInfo *check = classes.getptr(p_class);
+	while (check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg) {
+			return psg;
+		}
+
+		if (p_for_get && check->constant_map.has(p_property)) {
+			return NULL;
+		}
+
+		check = check->inherits_ptr;
+	}
+
+	return NULL;
+}
+
 int ClassDB::get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid) {
 
 	ClassInfo *type = classes.getptr(p_class);
@@ -271,6 +271,56 @@
 		ss->in_use = false;                                                           \
 	}
 
+#define BATCH_PARAM(N) const P##N *p##N
+#define BATCH_ARG(N) items[i].p##N
+#define BATCH_ASSIGN_PARAM(N) cmd->items[i].p##N = p##N[from + i]
+
+// A batch command calls the same method once per item, items are stored right after the command.
+#define DECL_CMD_BATCH(N)                                              \
+	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)> \
+	struct CommandBatch##N : public CommandBase {                      \
+		struct Item {                                                  \
+			SEMIC_SEP_LIST(PARAM_DECL, N);                             \
+		};                                                             \
+		T *instance;                                                   \
+		M method;                                                      \
+		Item *items;                                                   \
+		int count;                                                     \
+		virtual void call() {                                          \
+			for (int i = 0; i < count; i++) {                          \
+				(instance->*method)(COMMA_SEP_LIST(BATCH_ARG, N));     \
+			}                                                          \
+		}                                                              \
+		virtual ~CommandBatch##N() {                                   \
+			for (int i = 0; i < count; i++) {                          \
+				items[i].~Item();                                      \
+			}                                                          \
+		}                                                              \
+	};
+
+#define CMD_BATCH_TYPE(N) CommandBatch##N<T, M COMMA(N) COMMA_SEP_LIST(TYPE_ARG, N)>
+
+#define DECL_PUSH_BATCH(N)                                                                            \
+	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>                                \
+	void push_batch(T *p_instance, M p_method, int p_count COMMA(N) COMMA_SEP_LIST(BATCH_PARAM, N)) { \
+		typedef typename CMD_BATCH_TYPE(N)::Item Item;                                                \
+		const int chunk_size = MAX(1, BATCH_MAX_SIZE / (int)sizeof(Item));                            \
+		for (int from = 0; from < p_count; from += chunk_size) {                                      \
+			int count = MIN(chunk_size, p_count - from);                                              \
+			CMD_BATCH_TYPE(N) *cmd = allocate_and_lock<CMD_BATCH_TYPE(N)>(sizeof(Item) * count);      \
+			cmd->instance = p_instance;                                                               \
+			cmd->method = p_method;                                                                   \
+			cmd->items = reinterpret_cast<Item *>(cmd + 1);                                           \
+			cmd->count = count;                                                                       \
+			for (int i = 0; i < count; i++) {                                                         \
+				memnew_placement(&cmd->items[i], Item);                                               \
+				SEMIC_SEP_LIST(BATCH_ASSIGN_PARAM, N);                                                \
+			}                                                                                         \
+			unlock();                                                                                 \
+			if (sync) sync->post();                                                                   \
+		}                                                                                             \
+	}
+
 #define MAX_CMD_PARAMS 13
 
 class CommandQueueMT {
@@ -308,11 +358,15 @@ class CommandQueueMT {
 	DECL_CMD_SYNC(0)
 	SPACE_SEP_LIST(DECL_CMD_SYNC, 13)
 
+	/* commands that call a method for each item of an array */
+	SPACE_SEP_LIST(DECL_CMD_BATCH, 3)
+
 	/***** BASE *******/
 
 	enum {
 		COMMAND_MEM_SIZE_KB = 256,
 		COMMAND_MEM_SIZE = COMMAND_MEM_SIZE_KB * 1024,
+		BATCH_MAX_SIZE = COMMAND_MEM_SIZE / 16,
 		SYNC_SEMAPHORES = 8
 	};
 
@@ -325,10 +379,10 @@ class CommandQueueMT {
 	Semaphore *sync;
 
 	template <class T>
-	T *allocate() {
+	T *allocate(uint32_t p_extra = 0) {
 
-		// alloc size is size+T+safeguard
-		uint32_t alloc_size = ((sizeof(T) + 8 - 1) & ~(8 - 1)) + 8;
+		// alloc size is size+T+extra+safeguard
+		uint32_t alloc_size = ((sizeof(T) + p_extra + 8 - 1) & ~(8 - 1)) + 8;
 
 	tryagain:
 
@@ -370,7 +424,7 @@ class CommandQueueMT {
 		// Allocate the size and the 'in use' bit.
 		// First bit used to mark if command is still in use (1)
 		// or if it has been destroyed and can be deallocated (0).
-		uint32_t size = (sizeof(T) + 8 - 1) & ~(8 - 1);
+		uint32_t size = (sizeof(T) + p_extra + 8 - 1) & ~(8 - 1);
 		uint32_t *p = (uint32_t *)&command_mem[write_ptr];
 		*p = (size << 1) | 1;
 		write_ptr += 8;
@@ -381,12 +435,12 @@ class CommandQueueMT {
 	}
 
 	template <class T>
-	T *allocate_and_lock() {
+	T *allocate_and_lock(uint32_t p_extra = 0) {
 
 		lock();
 		T *ret;
 
-		while ((ret = allocate<T>()) == NULL) {
+		while ((ret = allocate<T>(p_extra)) == NULL) {
 
 			unlock();
 			// sleep a little until fetch happened and some room is made
@@ -453,6 +507,9 @@ public:
 	DECL_PUSH_AND_SYNC(0)
 	SPACE_SEP_LIST(DECL_PUSH_AND_SYNC, 13)
 
+	/* BATCH PUSH COMMANDS, p_method is called once per item of the arrays */
+	SPACE_SEP_LIST(DECL_PUSH_BATCH, 3)
+
 	void wait_and_flush_one() {
 		ERR_FAIL_COND(!sync);
 		sync->wait();
@@ -487,5 +544,11 @@ public:
 #undef DECL_PUSH_AND_RET
 #undef CMD_SYNC_TYPE
 #undef DECL_CMD_SYNC
+#undef BATCH_PARAM
+#undef BATCH_ARG
+#undef BATCH_ASSIGN_PARAM
+#undef DECL_CMD_BATCH
+#undef CMD_BATCH_TYPE
+#undef DECL_PUSH_BATCH
 
 #endif
@@ -34,18 +34,123 @@
 #include "core/safe_refcount.h"
 #include "core/variant.h"
 
+// The first pairs of a Dictionary, up to this many, are kept inside DictionaryPrivate
+// and searched linearly. Later pairs go to variant_map and come after them in
+// insertion order. Pairs never move once inserted, so references returned by
+// operator[] and getptr() stay valid until the pair is erased, as they did when
+// everything was in the OrderedHashMap. Erasing an inline pair leaves a tombstone,
+// trailing ones are reused. New pairs only go inline while variant_map is empty,
+// so that they stay after the inline ones.
+#define DICTIONARY_INLINE_CAPACITY 4
+
+typedef OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> DictionaryMap;
+
 struct DictionaryPrivate {
 
 	SafeRefCount refcount;
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> variant_map;
+	int inline_size; // slots used, tombstones included
+	int inline_count; // live pairs among them
+	uint32_t inline_tombstones; // bit per erased slot
+	Variant inline_keys[DICTIONARY_INLINE_CAPACITY];
+	Variant inline_values[DICTIONARY_INLINE_CAPACITY];
+	DictionaryMap variant_map;
+
+	_FORCE_INLINE_ bool is_tombstone(int p_index) const { return inline_tombstones & (1 << p_index); }
+
+	_FORCE_INLINE_ int find_inline(const Variant &p_key) const {
+
+		for (int i = 0; i < inline_size; i++) {
+			if (!is_tombstone(i) && VariantComparator::compare(inline_keys[i], p_key)) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	// First live inline slot from p_index, or inline_size.
+	_FORCE_INLINE_ int next_inline(int p_index) const {
+
+		while (p_index < inline_size && is_tombstone(p_index)) {
+			p_index++;
+		}
+		return p_index;
+	}
+
+	const Variant *getptr(const Variant &p_key) const {
+
+		int idx = find_inline(p_key);
+		if (idx >= 0) {
+			return &inline_values[idx];
+		}
+		if (variant_map.empty()) {
+			return NULL;
+		}
+
+		DictionaryMap::ConstElement E = ((const DictionaryMap *)&variant_map)->find(p_key);
+		return E ? &E.get() : NULL;
+	}
+
+	Variant &get_or_insert(const Variant &p_key) {
+
+		int idx = find_inline(p_key);
+		if (idx >= 0) {
+			return inline_values[idx];
+		}
+
+		if (variant_map.empty() && inline_size < DICTIONARY_INLINE_CAPACITY) {
+			inline_keys[inline_size] = p_key;
+			inline_count++;
+			return inline_values[inline_size++];
+		}
+
+		return variant_map[p_key];
+	}
+
+	bool erase(const Variant &p_key) {
+
+		int idx = find_inline(p_key);
+		if (idx < 0) {
+			return !variant_map.empty() && variant_map.erase(p_key);
+		}
+
+		inline_keys[idx] = Variant();
+		inline_values[idx] = Variant();
+		inline_tombstones |= 1 << idx;
+		inline_count--;
+
+		while (inline_size > 0 && is_tombstone(inline_size - 1)) {
+			inline_size--;
+			inline_tombstones &= ~(1 << inline_size);
+		}
+		return true;
+	}
+
+	void clear() {
+
+		for (int i = 0; i < inline_size; i++) {
+			inline_keys[i] = Variant();
+			inline_values[i] = Variant();
+		}
+		inline_size = 0;
+		inline_count = 0;
+		inline_tombstones = 0;
+		variant_map.clear();
+	}
+
+	DictionaryPrivate() {
+		inline_size = 0;
+		inline_count = 0;
+		inline_tombstones = 0;
+	}
 };
 
 void Dictionary::get_key_list(List<Variant> *p_keys) const {
 
-	if (_p->variant_map.empty())
-		return;
+	for (int i = _p->next_inline(0); i < _p->inline_size; i = _p->next_inline(i + 1)) {
+		p_keys->push_back(_p->inline_keys[i]);
+	}
 
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (DictionaryMap::Element E = _p->variant_map.front(); E; E = E.next()) {
 		p_keys->push_back(E.key());
 	}
 }
@@ -53,7 +158,14 @@ void Dictionary::get_key_list(List<Variant> *p_keys) const {
 Variant Dictionary::get_key_at_index(int p_index) const {
 
 	int index = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (int i = _p->next_inline(0); i < _p->inline_size; i = _p->next_inline(i + 1)) {
+		if (index == p_index) {
+			return _p->inline_keys[i];
+		}
+		index++;
+	}
+
+	for (DictionaryMap::Element E = _p->variant_map.front(); E; E = E.next()) {
 		if (index == p_index) {
 			return E.key();
 		}
@@ -66,7 +178,14 @@ Variant Dictionary::get_key_at_index(int p_index) const {
 Variant Dictionary::get_value_at_index(int p_index) const {
 
 	int index = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (int i = _p->next_inline(0); i < _p->inline_size; i = _p->next_inline(i + 1)) {
+		if (index == p_index) {
+			return _p->inline_values[i];
+		}
+		index++;
+	}
+
+	for (DictionaryMap::Element E = _p->variant_map.front(); E; E = E.next()) {
 		if (index == p_index) {
 			return E.value();
 		}
@@ -78,38 +197,32 @@ Variant Dictionary::get_value_at_index(int p_index) const {
 
 Variant &Dictionary::operator[](const Variant &p_key) {
 
-	return _p->variant_map[p_key];
+	return _p->get_or_insert(p_key);
 }
 
 const Variant &Dictionary::operator[](const Variant &p_key) const {
 
-	return _p->variant_map[p_key];
+	const Variant *value = _p->getptr(p_key);
+	CRASH_COND(!value);
+	return *value;
 }
 const Variant *Dictionary::getptr(const Variant &p_key) const {
 
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
-
-	if (!E)
-		return NULL;
-	return &E.get();
+	return _p->getptr(p_key);
 }
 
 Variant *Dictionary::getptr(const Variant &p_key) {
 
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.find(p_key);
-
-	if (!E)
-		return NULL;
-	return &E.get();
+	return const_cast<Variant *>(_p->getptr(p_key));
 }
 
 Variant Dictionary::get_valid(const Variant &p_key) const {
 
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
+	const Variant *value = _p->getptr(p_key);
 
-	if (!E)
+	if (!value)
 		return Variant();
-	return E.get();
+	return *value;
 }
 
 Variant Dictionary::get(const Variant &p_key, const Variant &p_default) const {
@@ -123,16 +236,16 @@ Variant Dictionary::get(const Variant &p_key, const Variant &p_default) const {
 
 int Dictionary::size() const {
 
-	return _p->variant_map.size();
+	return _p->inline_count + _p->variant_map.size();
 }
 bool Dictionary::empty() const {
 
-	return !_p->variant_map.size();
+	return size() == 0;
 }
 
 bool Dictionary::has(const Variant &p_key) const {
 
-	return _p->variant_map.has(p_key);
+	return _p->getptr(p_key) != NULL;
 }
 
 bool Dictionary::has_all(const Array &p_keys) const {
@@ -146,7 +259,7 @@ bool Dictionary::has_all(const Array &p_keys) const {
 
 bool Dictionary::erase(const Variant &p_key) {
 
-	return _p->variant_map.erase(p_key);
+	return _p->erase(p_key);
 }
 
 bool Dictionary::operator==(const Dictionary &p_dictionary) const {
@@ -177,7 +290,7 @@ void Dictionary::_ref(const Dictionary &p_from) const {
 
 void Dictionary::clear() {
 
-	_p->variant_map.clear();
+	_p->clear();
 }
 
 void Dictionary::_unref() const {
@@ -208,11 +321,13 @@ Array Dictionary::keys() const {
 
 	Array varr;
 	varr.resize(size());
-	if (_p->variant_map.empty())
-		return varr;
-
 	int i = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (int j = _p->next_inline(0); j < _p->inline_size; j = _p->next_inline(j + 1)) {
+		varr[i] = _p->inline_keys[j];
+		i++;
+	}
+
+	for (DictionaryMap::Element E = _p->variant_map.front(); E; E = E.next()) {
 		varr[i] = E.key();
 		i++;
 	}
@@ -224,11 +339,13 @@ Array Dictionary::values() const {
 
 	Array varr;
 	varr.resize(size());
-	if (_p->variant_map.empty())
-		return varr;
-
 	int i = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (int j = _p->next_inline(0); j < _p->inline_size; j = _p->next_inline(j + 1)) {
+		varr[i] = _p->inline_values[j];
+		i++;
+	}
+
+	for (DictionaryMap::Element E = _p->variant_map.front(); E; E = E.next()) {
 		varr[i] = E.get();
 		i++;
 	}
@@ -238,13 +355,34 @@ Array Dictionary::values() const {
 
 const Variant *Dictionary::next(const Variant *p_key) const {
 
+	// Inline pairs come first, then the ones in variant_map.
+	int idx;
 	if (p_key == NULL) {
-		// caller wants to get the first element
+		idx = 0;
+	} else if (p_key >= _p->inline_keys && p_key < _p->inline_keys + DICTIONARY_INLINE_CAPACITY) {
+		idx = p_key - _p->inline_keys + 1;
+	} else {
+		idx = _p->find_inline(*p_key);
+		if (idx >= 0) {
+			idx++;
+		}
+	}
+
+	if (idx >= 0) {
+		idx = _p->next_inline(idx);
+		if (idx < _p->inline_size) {
+			return &_p->inline_keys[idx];
+		}
+		// caller wants the first element of variant_map
 		if (_p->variant_map.front())
 			return &_p->variant_map.front().key();
 		return NULL;
 	}
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.find(*p_key);
+
+	if (_p->variant_map.empty()) {
+		return NULL;
+	}
+	DictionaryMap::Element E = _p->variant_map.find(*p_key);
 
 	if (E && E.next())
 		return &E.next().key();
@@ -271,7 +409,7 @@ void Dictionary::operator=(const Dictionary &p_dictionary) {
 }
 
 const void *Dictionary::id() const {
-	return _p->variant_map.id();
+	return _p;
 }
 
 Dictionary::Dictionary(const Dictionary &p_from) {
@@ -339,6 +339,8 @@ void ResourceLoader::_remove_from_loading_map_and_thread(const String &p_path, T
 
 RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p_no_cache, Error *r_error) {
 
+	MemoryTagScope tag_scope(Memory::TAG_LOADER);
+
 	if (r_error)
 		*r_error = ERR_CANT_OPEN;
 
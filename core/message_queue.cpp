@@ -30,32 +30,205 @@
 
 #include "message_queue.h"
 
+#include "core/os/thread.h"
 #include "core/project_settings.h"
 #include "core/script_language.h"
 
 MessageQueue *MessageQueue::singleton = NULL;
+thread_local MessageQueue::ProducerBinding MessageQueue::producer_binding;
+uint32_t MessageQueue::last_generation = 0;
 
 MessageQueue *MessageQueue::get_singleton() {
 
 	return singleton;
 }
 
-Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
+MessageQueue::ProducerBinding::~ProducerBinding() {
+
+	// The thread is exiting, let another thread adopt its producer (and any message still pending in it).
+	if (producer && queue && queue == singleton && queue_generation == queue->generation) {
+		producer->orphaned.store(true, std::memory_order_release);
+	}
+}
+
+MessageQueue::Segment *MessageQueue::_alloc_segment(uint32_t p_size, bool p_new_producer) {
+
+	_THREAD_SAFE_METHOD_
+
+	if (p_new_producer) {
+		producer_count++;
+	} else if (buffer_used + p_size > buffer_size + uint64_t(producer_count) * SEGMENT_SIZE) {
+		return NULL;
+	}
+
+	Segment *segment;
+	if (p_size == SEGMENT_SIZE && free_segments) {
+		segment = free_segments;
+		free_segments = segment->next.load(std::memory_order_relaxed);
+		free_segment_count--;
+	} else {
+		segment = memnew_placement(memalloc(sizeof(Segment) + p_size), Segment);
+		segment->size = p_size;
+	}
+
+	segment->next.store(NULL, std::memory_order_relaxed);
+	segment->end.store(0, std::memory_order_relaxed);
+
+	buffer_used += p_size;
+	if (buffer_used > buffer_max_used) {
+		buffer_max_used = buffer_used;
+	}
+
+	return segment;
+}
+
+void MessageQueue::_free_segment(Segment *p_segment) {
 
 	_THREAD_SAFE_METHOD_
 
-	int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+	buffer_used -= p_segment->size;
+
+	// Keep one per producer at least, so every thread can move to a new segment without allocating.
+	if (p_segment->size == SEGMENT_SIZE && free_segment_count < MAX((uint32_t)MAX_FREE_SEGMENTS, producer_count)) {
+		p_segment->next.store(free_segments, std::memory_order_relaxed);
+		free_segments = p_segment;
+		free_segment_count++;
+	} else {
+		p_segment->~Segment();
+		memfree(p_segment);
+	}
+}
+
+MessageQueue::Producer *MessageQueue::_get_producer() {
+
+	ProducerBinding &binding = producer_binding;
+	if (likely(binding.queue == this && binding.queue_generation == generation)) {
+		return binding.producer;
+	}
+
+	Producer *producer = NULL;
+
+	// Adopt the producer of a thread that exited, so there are never more producers than threads alive.
+	for (Producer *p = producers.load(std::memory_order_acquire); p; p = p->next) {
+		bool orphaned = true;
+		if (p->orphaned.load(std::memory_order_relaxed) && p->orphaned.compare_exchange_strong(orphaned, false, std::memory_order_acquire)) {
+			producer = p;
+			break;
+		}
+	}
+
+	if (!producer) {
+		producer = memnew(Producer);
+		producer->orphaned.store(false, std::memory_order_relaxed);
+		producer->write_segment = _alloc_segment(SEGMENT_SIZE, true);
+		producer->read_segment = producer->write_segment;
+		producer->read_pos = 0;
+
+		producer->next = producers.load(std::memory_order_relaxed);
+		while (!producers.compare_exchange_weak(producer->next, producer, std::memory_order_release, std::memory_order_relaxed)) {
+		}
+	}
+
+	binding.queue = this;
+	binding.queue_generation = generation;
+	binding.producer = producer;
+
+	return producer;
+}
+
+uint8_t *MessageQueue::_reserve(Producer *p_producer, uint32_t p_room) {
+
+	Segment *segment = p_producer->write_segment;
+	uint32_t end = segment->end.load(std::memory_order_relaxed);
+	if (likely(segment->size - end >= p_room)) {
+		return segment->get_data() + end;
+	}
+
+	Segment *next = _alloc_segment(MAX(p_room, (uint32_t)SEGMENT_SIZE));
+	if (!next) {
+		return NULL;
+	}
+
+	// Everything in the current segment is published already, linking the next one tells the flushing thread it's done.
+	segment->next.store(next, std::memory_order_release);
+	p_producer->write_segment = next;
+
+	return next->get_data();
+}
+
+void MessageQueue::_commit(Producer *p_producer, uint32_t p_room) {
+
+	Segment *segment = p_producer->write_segment;
+	uint32_t end = segment->end.load(std::memory_order_relaxed);
+
+	Message *msg = (Message *)(segment->get_data() + end);
+	msg->order = atomic_increment(&next_order);
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	segment->end.store(end + p_room, std::memory_order_release);
+}
+
+MessageQueue::Message *MessageQueue::_peek(Producer *p_producer) {
+
+	Segment *segment = p_producer->read_segment;
+
+	while (true) {
+
+		// Load next before end: once next is set, end is final.
+		Segment *next = segment->next.load(std::memory_order_acquire);
+		if (p_producer->read_pos < segment->end.load(std::memory_order_acquire)) {
+			return (Message *)(segment->get_data() + p_producer->read_pos);
+		}
+
+		if (!next) {
+			return NULL;
+		}
+
+		p_producer->read_segment = next;
+		p_producer->read_pos = 0;
+		_free_segment(segment);
+		segment = next;
+	}
+}
+
+uint32_t MessageQueue::_get_message_size(const Message *p_message) {
+
+	uint32_t size = sizeof(Message);
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION)
+		size += sizeof(Variant) * p_message->args;
+
+	return size;
+}
+
+void MessageQueue::_destroy_message(Message *p_message) {
+
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		Variant *args = (Variant *)(p_message + 1);
+		for (int i = 0; i < p_message->args; i++) {
+			args[i].~Variant();
+		}
+	}
+
+	p_message->~Message();
+}
+
+Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
+
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+
+	Producer *producer = _get_producer();
+	uint8_t *room = _reserve(producer, room_needed);
+
+	if (!room) {
 		String type;
 		if (ObjectDB::get_instance(p_id))
 			type = ObjectDB::get_instance(p_id)->get_class();
 		print_line("Failed method: " + type + ":" + p_method + " target ID: " + itos(p_id));
-		statistics();
+		if (Thread::get_caller_id() == Thread::get_main_id())
+			statistics();
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'message_queue_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(room, Message);
 	msg->args = p_argcount;
 	msg->instance_id = p_id;
 	msg->target = p_method;
@@ -63,15 +236,14 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const V
 	if (p_show_error)
 		msg->type |= FLAG_SHOW_ERROR;
 
-	buffer_end += sizeof(Message);
-
+	Variant *args = (Variant *)(msg + 1);
 	for (int i = 0; i < p_argcount; i++) {
 
-		Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-		buffer_end += sizeof(Variant);
-		*v = *p_args[i];
+		memnew_placement(&args[i], Variant(*p_args[i]));
 	}
 
+	_commit(producer, room_needed);
+
 	return OK;
 }
 
@@ -92,59 +264,61 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, VARIANT
 
 Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
 
-	_THREAD_SAFE_METHOD_
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant);
 
-	uint8_t room_needed = sizeof(Message) + sizeof(Variant);
+	Producer *producer = _get_producer();
+	uint8_t *room = _reserve(producer, room_needed);
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	if (!room) {
 		String type;
 		if (ObjectDB::get_instance(p_id))
 			type = ObjectDB::get_instance(p_id)->get_class();
 		print_line("Failed set: " + type + ":" + p_prop + " target ID: " + itos(p_id));
-		statistics();
+		if (Thread::get_caller_id() == Thread::get_main_id())
+			statistics();
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'message_queue_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(room, Message);
 	msg->args = 1;
 	msg->instance_id = p_id;
 	msg->target = p_prop;
 	msg->type = TYPE_SET;
 
-	buffer_end += sizeof(Message);
+	memnew_placement(msg + 1, Variant(p_value));
 
-	Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-	buffer_end += sizeof(Variant);
-	*v = p_value;
+	_commit(producer, room_needed);
 
 	return OK;
 }
 
 Error MessageQueue::push_notification(ObjectID p_id, int p_notification) {
 
-	_THREAD_SAFE_METHOD_
-
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
 
-	uint8_t room_needed = sizeof(Message);
+	uint32_t room_needed = sizeof(Message);
+
+	Producer *producer = _get_producer();
+	uint8_t *room = _reserve(producer, room_needed);
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	if (!room) {
 		String type;
 		if (ObjectDB::get_instance(p_id))
 			type = ObjectDB::get_instance(p_id)->get_class();
 		print_line("Failed notification: " + itos(p_notification) + " target ID: " + itos(p_id));
-		statistics();
+		if (Thread::get_caller_id() == Thread::get_main_id())
+			statistics();
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'message_queue_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(room, Message);
 
 	msg->type = TYPE_NOTIFICATION;
 	msg->instance_id = p_id;
 	//msg->target;
 	msg->notification = p_notification;
 
-	buffer_end += sizeof(Message);
+	_commit(producer, room_needed);
 
 	return OK;
 }
@@ -170,55 +344,65 @@ void MessageQueue::statistics() {
 	Map<StringName, int> call_count;
 	int null_count = 0;
 
-	uint32_t read_pos = 0;
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
+	for (Producer *producer = producers.load(std::memory_order_acquire); producer; producer = producer->next) {
 
-		Object *target = ObjectDB::get_instance(message->instance_id);
+		Segment *segment = producer->read_segment;
+		uint32_t read_pos = producer->read_pos;
 
-		if (target != NULL) {
+		while (segment) {
 
-			switch (message->type & FLAG_MASK) {
+			if (read_pos >= segment->end.load(std::memory_order_acquire)) {
+				segment = segment->next.load(std::memory_order_acquire);
+				read_pos = 0;
+				continue;
+			}
 
-				case TYPE_CALL: {
+			Message *message = (Message *)(segment->get_data() + read_pos);
 
-					if (!call_count.has(message->target))
-						call_count[message->target] = 0;
+			Object *target = ObjectDB::get_instance(message->instance_id);
 
-					call_count[message->target]++;
+			if (target != NULL) {
 
-				} break;
-				case TYPE_NOTIFICATION: {
+				switch (message->type & FLAG_MASK) {
 
-					if (!notify_count.has(message->notification))
-						notify_count[message->notification] = 0;
+					case TYPE_CALL: {
 
-					notify_count[message->notification]++;
+						if (!call_count.has(message->target))
+							call_count[message->target] = 0;
 
-				} break;
-				case TYPE_SET: {
+						call_count[message->target]++;
 
-					if (!set_count.has(message->target))
-						set_count[message->target] = 0;
+					} break;
+					case TYPE_NOTIFICATION: {
 
-					set_count[message->target]++;
+						if (!notify_count.has(message->notification))
+							notify_count[message->notification] = 0;
 
-				} break;
-			}
+						notify_count[message->notification]++;
 
-		} else {
-			//object was deleted
-			print_line("Object was deleted while awaiting a callback");
+					} break;
+					case TYPE_SET: {
 
-			null_count++;
-		}
+						if (!set_count.has(message->target))
+							set_count[message->target] = 0;
+
+						set_count[message->target]++;
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			read_pos += sizeof(Variant) * message->args;
+					} break;
+				}
+
+			} else {
+				//object was deleted
+				print_line("Object was deleted while awaiting a callback");
+
+				null_count++;
+			}
+
+			read_pos += _get_message_size(message);
+		}
 	}
 
-	print_line("TOTAL BYTES: " + itos(buffer_end));
+	print_line("TOTAL BYTES: " + itos(buffer_used));
 	print_line("NULL count: " + itos(null_count));
 
 	for (Map<StringName, int>::Element *E = set_count.front(); E; E = E->next()) {
@@ -259,78 +443,82 @@ void MessageQueue::_call_function(Object *p_target, const StringName &p_func, co
 
 void MessageQueue::flush() {
 
-	if (buffer_end > buffer_max_used) {
-		buffer_max_used = buffer_end;
-	}
-
-	uint32_t read_pos = 0;
-
-	//using reverse locking strategy
-	_THREAD_SAFE_LOCK_
-
 	ERR_FAIL_COND(flushing); //already flushing, you did something odd
 	flushing = true;
 
-	while (read_pos < buffer_end) {
+	while (true) {
 
-		//lock on each iteration, so a call can re-add itself to the message queue
+		// Find the producer holding the oldest message, and the order of the oldest message held by any other producer.
+		// Producers and messages added by the calls below are picked up by the next pass.
+		Producer *producer = NULL;
+		Message *message = NULL;
+		uint64_t limit = UINT64_MAX;
 
-		Message *message = (Message *)&buffer[read_pos];
+		for (Producer *p = producers.load(std::memory_order_acquire); p; p = p->next) {
 
-		uint32_t advance = sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			advance += sizeof(Variant) * message->args;
+			Message *m = _peek(p);
+			if (!m) {
+				continue;
+			}
 
-		//pre-advance so this function is reentrant
-		read_pos += advance;
+			if (!message || m->order < message->order) {
+				if (message) {
+					limit = message->order;
+				}
+				producer = p;
+				message = m;
+			} else if (m->order < limit) {
+				limit = m->order;
+			}
+		}
 
-		_THREAD_SAFE_UNLOCK_
+		if (!message) {
+			break;
+		}
 
-		Object *target = ObjectDB::get_instance(message->instance_id);
+		// Run this producer's messages until another producer has an older one.
+		do {
 
-		if (target != NULL) {
+			//pre-advance so this function is reentrant
+			producer->read_pos += _get_message_size(message);
 
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
+			Object *target = ObjectDB::get_instance(message->instance_id);
 
-					Variant *args = (Variant *)(message + 1);
+			if (target != NULL) {
 
-					// messages don't expect a return value
+				switch (message->type & FLAG_MASK) {
+					case TYPE_CALL: {
 
-					_call_function(target, message->target, args, message->args, message->type & FLAG_SHOW_ERROR);
+						Variant *args = (Variant *)(message + 1);
 
-				} break;
-				case TYPE_NOTIFICATION: {
+						// messages don't expect a return value
 
-					// messages don't expect a return value
-					target->notification(message->notification);
+						_call_function(target, message->target, args, message->args, message->type & FLAG_SHOW_ERROR);
 
-				} break;
-				case TYPE_SET: {
+					} break;
+					case TYPE_NOTIFICATION: {
 
-					Variant *arg = (Variant *)(message + 1);
-					// messages don't expect a return value
-					target->set(message->target, *arg);
+						// messages don't expect a return value
+						target->notification(message->notification);
 
-				} break;
-			}
-		}
+					} break;
+					case TYPE_SET: {
+
+						Variant *arg = (Variant *)(message + 1);
+						// messages don't expect a return value
+						target->set(message->target, *arg);
 
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			Variant *args = (Variant *)(message + 1);
-			for (int i = 0; i < message->args; i++) {
-				args[i].~Variant();
+					} break;
+				}
 			}
-		}
 
-		message->~Message();
+			_destroy_message(message);
 
-		_THREAD_SAFE_LOCK_
+			message = _peek(producer);
+		} while (message && message->order < limit);
 	}
 
-	buffer_end = 0; // reset buffer
 	flushing = false;
-	_THREAD_SAFE_UNLOCK_
 }
 
 bool MessageQueue::is_flushing() const {
@@ -343,35 +531,46 @@ MessageQueue::MessageQueue() {
 	ERR_FAIL_COND_MSG(singleton != NULL, "MessageQueue singleton already exist.");
 	singleton = this;
 	flushing = false;
+	generation = ++last_generation;
 
-	buffer_end = 0;
+	producers.store(NULL);
+	producer_count = 0;
+	free_segments = NULL;
+	free_segment_count = 0;
+
+	next_order = 0;
+	buffer_used = 0;
 	buffer_max_used = 0;
 	buffer_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/max_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/max_size_kb", PROPERTY_HINT_RANGE, "0,2048,1,or_greater"));
 	buffer_size *= 1024;
-	buffer = memnew_arr(uint8_t, buffer_size);
 }
 
 MessageQueue::~MessageQueue() {
 
-	uint32_t read_pos = 0;
+	Producer *producer = producers.load(std::memory_order_acquire);
 
-	while (read_pos < buffer_end) {
+	while (producer) {
 
-		Message *message = (Message *)&buffer[read_pos];
-		Variant *args = (Variant *)(message + 1);
-		int argc = message->args;
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			for (int i = 0; i < argc; i++)
-				args[i].~Variant();
+		Message *message = _peek(producer);
+		while (message) {
+			producer->read_pos += _get_message_size(message);
+			_destroy_message(message);
+			message = _peek(producer);
 		}
-		message->~Message();
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			read_pos += sizeof(Variant) * message->args;
+		Producer *next = producer->next;
+		_free_segment(producer->read_segment);
+		memdelete(producer);
+		producer = next;
+	}
+
+	while (free_segments) {
+		Segment *segment = free_segments;
+		free_segments = segment->next.load(std::memory_order_relaxed);
+		segment->~Segment();
+		memfree(segment);
 	}
 
 	singleton = NULL;
-	memdelete_arr(buffer);
 }
@@ -34,13 +34,23 @@
 #include "core/object.h"
 #include "core/os/thread_safe.h"
 
+#include <atomic>
+
+// Every thread pushing messages gets its own producer, a chain of segments
+// only that thread writes to, so pushing takes no lock. Messages carry a global
+// order and flush() merges the producers back into submission order. Segments
+// are allocated on demand and recycled once flushed; the lock only guards the
+// segment pool. Each producer always holds a write segment, those don't count
+// against the size limit, or enough threads would use it up on their own.
 class MessageQueue {
 
 	_THREAD_SAFE_CLASS_
 
 	enum {
 
-		DEFAULT_QUEUE_SIZE_KB = 1024
+		DEFAULT_QUEUE_SIZE_KB = 1024,
+		SEGMENT_SIZE = 64 * 1024,
+		MAX_FREE_SEGMENTS = 16
 	};
 
 	enum {
@@ -56,6 +66,7 @@ class MessageQueue {
 
 		ObjectID instance_id;
 		StringName target;
+		uint64_t order;
 		int16_t type;
 		union {
 			int16_t notification;
@@ -63,10 +74,60 @@ class MessageQueue {
 		};
 	};
 
-	uint8_t *buffer;
-	uint32_t buffer_end;
-	uint32_t buffer_max_used;
-	uint32_t buffer_size;
+	struct Segment {
+
+		std::atomic<Segment *> next;
+		std::atomic<uint32_t> end;
+		uint32_t size;
+
+		_FORCE_INLINE_ uint8_t *get_data() { return (uint8_t *)(this + 1); }
+	};
+
+	struct Producer {
+
+		Producer *next;
+		std::atomic<bool> orphaned;
+
+		// Written by the producing thread only.
+		Segment *write_segment;
+
+		// Read by the flushing thread only.
+		Segment *read_segment;
+		uint32_t read_pos;
+	};
+
+	struct ProducerBinding {
+
+		MessageQueue *queue;
+		uint32_t queue_generation;
+		Producer *producer;
+
+		~ProducerBinding();
+	};
+
+	static thread_local ProducerBinding producer_binding;
+	static uint32_t last_generation;
+
+	uint32_t generation;
+	std::atomic<Producer *> producers;
+	uint32_t producer_count;
+	Segment *free_segments;
+	uint32_t free_segment_count;
+
+	uint64_t next_order;
+	uint64_t buffer_used;
+	uint64_t buffer_max_used;
+	uint64_t buffer_size;
+
+	Segment *_alloc_segment(uint32_t p_size, bool p_new_producer = false);
+	void _free_segment(Segment *p_segment);
+
+	Producer *_get_producer();
+	uint8_t *_reserve(Producer *p_producer, uint32_t p_room);
+	void _commit(Producer *p_producer, uint32_t p_room);
+	Message *_peek(Producer *p_producer);
+	static uint32_t _get_message_size(const Message *p_message);
+	static void _destroy_message(Message *p_message);
 
 	void _call_function(Object *p_target, const StringName &p_func, const Variant *p_args, int p_argcount, bool p_show_error);
 
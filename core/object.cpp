@@ -41,19 +41,6 @@
 
 #ifdef DEBUG_ENABLED
 
-struct _ObjectDebugLock {
-
-	Object *obj;
-
-	_ObjectDebugLock(Object *p_obj) {
-		obj = p_obj;
-		obj->_lock_index.ref();
-	}
-	~_ObjectDebugLock() {
-		obj->_lock_index.unref();
-	}
-};
-
 #define OBJ_DEBUG_LOCK _ObjectDebugLock _debug_lock(this);
 
 #else
@@ -1171,25 +1158,31 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 	List<_ObjectSignalDisconnectData> disconnect_data;
 
 	//copy on write will ensure that disconnecting the signal or even deleting the object will not affect the signal calling.
-	//this happens automatically and will not change the performance of calling.
-	//awesome, isn't it?
-	VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map;
+	//holding a reference only costs a refcount increment, the slots are copied by whoever changes them during the emission.
+	//they must only be read through a const reference though, any non-const access would make the copy right here.
+	const VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map;
+	const VMap<Signal::Target, Signal::Slot>::Pair *slots = slot_map.get_array();
 
 	int ssize = slot_map.size();
 
 	OBJ_DEBUG_LOCK
 
+	// Arguments followed by the binds, kept on the stack unless there are a lot of them.
+	enum {
+		BIND_STACK_SIZE = 16
+	};
+	const Variant *bind_stack[BIND_STACK_SIZE];
 	std::vector<const Variant *> bind_mem;
 
 	Error err = OK;
 
 	for (int i = 0; i < ssize; i++) {
 
-		const Connection &c = slot_map.getv(i).conn;
+		const Connection &c = slots[i].value.conn;
 
 		Object *target;
 #ifdef DEBUG_ENABLED
-		target = ObjectDB::get_instance(slot_map.getk(i)._id);
+		target = ObjectDB::get_instance(slots[i].key._id);
 		ERR_CONTINUE(!target);
 #else
 		target = c.target;
@@ -1200,17 +1193,22 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 
 		if (c.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount + c.binds.size());
+			argc = p_argcount + c.binds.size();
+
+			const Variant **bind_args = bind_stack;
+			if (argc > BIND_STACK_SIZE) {
+				bind_mem.resize(argc);
+				bind_args = bind_mem.data();
+			}
 
 			for (int j = 0; j < p_argcount; j++) {
-				bind_mem[j] = p_args[j];
+				bind_args[j] = p_args[j];
 			}
 			for (int j = 0; j < c.binds.size(); j++) {
-				bind_mem[p_argcount + j] = &c.binds[j];
+				bind_args[p_argcount + j] = &c.binds[j];
 			}
 
-			args = (const Variant **)bind_mem.data();
-			argc = bind_mem.size();
+			args = bind_args;
 		}
 
 		if (c.flags & CONNECT_DEFERRED) {
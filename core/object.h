@@ -756,6 +756,25 @@ public:
 	virtual ~Object();
 };
 
+#ifdef DEBUG_ENABLED
+
+// Keeps an object from being freed while one of its methods runs. Object::call() holds one,
+// callers invoking resolved MethodBinds directly should do the same.
+struct _ObjectDebugLock {
+
+	Object *obj;
+
+	_ObjectDebugLock(Object *p_obj) {
+		obj = p_obj;
+		obj->_lock_index.ref();
+	}
+	~_ObjectDebugLock() {
+		obj->_lock_index.unref();
+	}
+};
+
+#endif
+
 bool predelete_handler(Object *p_object);
 void postinitialize_handler(Object *p_object);
 
@@ -34,6 +34,10 @@
 #include "core/os/copymem.h"
 #include "core/safe_refcount.h"
 
+#ifdef SLAB_ALLOCATOR_ENABLED
+#include "core/os/slab_allocator.h"
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -68,26 +72,98 @@ void operator delete(void *p_mem, void *p_pointer, size_t check, const char *p_d
 #endif
 
 #ifdef DEBUG_ENABLED
-uint64_t Memory::mem_usage = 0;
-uint64_t Memory::max_usage = 0;
-#endif
+// Usage is accounted in per-thread shards instead of one global counter, so
+// threads allocating at the same time don't fight over a cache line. Shards
+// are only summed when the usage is read. A thread may free memory another
+// one allocated, so a single shard can go "negative" (it wraps around, the
+// sum is still right).
+//
+// For the same reason a per-shard peak means nothing, so each shard also
+// keeps its net change since it last added it to a global total, and adds
+// it once it reaches MEMORY_SHARD_FLUSH bytes either way. The peak of that
+// total is tracked on allocation, it's off by at most MEMORY_SHARD_FLUSH
+// bytes per shard.
+
+namespace {
+
+enum {
+	MEMORY_SHARD_COUNT = 64,
+	MEMORY_SHARD_FLUSH = 16 * 1024,
+};
+
+struct alignas(64) MemoryShard {
+	uint64_t usage[Memory::TAG_MAX];
+	uint64_t alloc_count;
+	uint64_t unflushed; // Net change not added to memory_flushed_usage yet, signed.
+};
+
+MemoryShard memory_shards[MEMORY_SHARD_COUNT];
+uint32_t memory_next_shard = 0;
+uint64_t memory_flushed_usage = 0; // Signed, like MemoryShard::unflushed.
+uint64_t memory_max_usage = 0;
+
+thread_local MemoryShard *memory_thread_shard = NULL;
+thread_local Memory::Tag memory_thread_tag = Memory::TAG_GENERAL;
+
+_FORCE_INLINE_ MemoryShard &memory_get_shard() {
+
+	if (unlikely(!memory_thread_shard)) {
+		memory_thread_shard = &memory_shards[atomic_increment(&memory_next_shard) % MEMORY_SHARD_COUNT];
+	}
+	return *memory_thread_shard;
+}
+
+_FORCE_INLINE_ void memory_account(MemoryShard &p_shard, uint32_t p_tag, int64_t p_bytes) {
+
+	atomic_add(&p_shard.usage[p_tag], (uint64_t)p_bytes);
+
+	int64_t unflushed = (int64_t)atomic_add(&p_shard.unflushed, (uint64_t)p_bytes);
+	if (unlikely(unflushed >= MEMORY_SHARD_FLUSH || unflushed <= -MEMORY_SHARD_FLUSH)) {
+		// Another thread of this shard may flush too, each one moves what it saw, so the sum stays right.
+		atomic_sub(&p_shard.unflushed, (uint64_t)unflushed);
+		int64_t usage = (int64_t)atomic_add(&memory_flushed_usage, (uint64_t)unflushed);
+		if (unflushed > 0 && usage > 0) {
+			atomic_exchange_if_greater(&memory_max_usage, (uint64_t)usage);
+		}
+	}
+}
+
+// The tag is stored in the allocation header after the size, so a free is credited to the tag that allocated.
+_FORCE_INLINE_ uint32_t &memory_header_tag(void *p_header) {
 
-uint64_t Memory::alloc_count = 0;
+	return ((uint32_t *)p_header)[2];
+}
+
+} // namespace
+
+void Memory::set_thread_tag(Tag p_tag) {
+
+	memory_thread_tag = p_tag;
+}
+
+Memory::Tag Memory::get_thread_tag() {
+
+	return memory_thread_tag;
+}
+#endif
 
 void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SLAB_ALLOCATOR_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
 #endif
 
+#ifdef SLAB_ALLOCATOR_ENABLED
+	// The size header is always there, free_static() needs it to find the size class.
+	void *mem = SlabAllocator::alloc(p_bytes + PAD_ALIGN);
+#else
 	void *mem = malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
+#endif
 
 	ERR_FAIL_COND_V(!mem, NULL);
 
-	atomic_increment(&alloc_count);
-
 	if (prepad) {
 		uint64_t *s = (uint64_t *)mem;
 		*s = p_bytes;
@@ -95,8 +171,11 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 		uint8_t *s8 = (uint8_t *)mem;
 
 #ifdef DEBUG_ENABLED
-		atomic_add(&mem_usage, p_bytes);
-		atomic_exchange_if_greater(&max_usage, mem_usage);
+		MemoryShard &shard = memory_get_shard();
+		Tag tag = memory_thread_tag;
+		memory_header_tag(mem) = tag;
+		memory_account(shard, tag, p_bytes);
+		atomic_increment(&shard.alloc_count);
 #endif
 		return s8 + PAD_ALIGN;
 	} else {
@@ -112,7 +191,7 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 
 	uint8_t *mem = (uint8_t *)p_memory;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SLAB_ALLOCATOR_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
@@ -123,21 +202,28 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 		uint64_t *s = (uint64_t *)mem;
 
 #ifdef DEBUG_ENABLED
-		if (p_bytes > *s) {
-			atomic_add(&mem_usage, p_bytes - *s);
-			atomic_exchange_if_greater(&max_usage, mem_usage);
-		} else {
-			atomic_sub(&mem_usage, *s - p_bytes);
+		MemoryShard &shard = memory_get_shard();
+		memory_account(shard, memory_header_tag(mem), (int64_t)p_bytes - (int64_t)*s);
+		if (p_bytes == 0) {
+			atomic_decrement(&shard.alloc_count);
 		}
 #endif
 
 		if (p_bytes == 0) {
+#ifdef SLAB_ALLOCATOR_ENABLED
+			SlabAllocator::free(mem, *s + PAD_ALIGN);
+#else
 			free(mem);
+#endif
 			return NULL;
 		} else {
+#ifdef SLAB_ALLOCATOR_ENABLED
+			mem = (uint8_t *)SlabAllocator::realloc(mem, *s + PAD_ALIGN, p_bytes + PAD_ALIGN);
+#else
 			*s = p_bytes;
 
 			mem = (uint8_t *)realloc(mem, p_bytes + PAD_ALIGN);
+#endif
 			ERR_FAIL_COND_V(!mem, NULL);
 
 			s = (uint64_t *)mem;
@@ -162,23 +248,29 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 
 	uint8_t *mem = (uint8_t *)p_ptr;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SLAB_ALLOCATOR_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
 #endif
 
-	atomic_decrement(&alloc_count);
-
 	if (prepad) {
 		mem -= PAD_ALIGN;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SLAB_ALLOCATOR_ENABLED)
 		uint64_t *s = (uint64_t *)mem;
-		atomic_sub(&mem_usage, *s);
+#endif
+#ifdef DEBUG_ENABLED
+		MemoryShard &shard = memory_get_shard();
+		memory_account(shard, memory_header_tag(mem), -(int64_t)*s);
+		atomic_decrement(&shard.alloc_count);
 #endif
 
+#ifdef SLAB_ALLOCATOR_ENABLED
+		SlabAllocator::free(mem, *s + PAD_ALIGN);
+#else
 		free(mem);
+#endif
 	} else {
 
 		free(mem);
@@ -192,7 +284,16 @@ uint64_t Memory::get_mem_available() {
 
 uint64_t Memory::get_mem_usage() {
 #ifdef DEBUG_ENABLED
-	return mem_usage;
+	uint64_t usage = 0;
+	for (int i = 0; i < MEMORY_SHARD_COUNT; i++) {
+		for (int j = 0; j < TAG_MAX; j++) {
+			usage += memory_shards[i].usage[j];
+		}
+	}
+
+	// Exact here, unlike the total memory_account() watches.
+	atomic_exchange_if_greater(&memory_max_usage, usage);
+	return usage;
 #else
 	return 0;
 #endif
@@ -200,12 +301,55 @@ uint64_t Memory::get_mem_usage() {
 
 uint64_t Memory::get_mem_max_usage() {
 #ifdef DEBUG_ENABLED
-	return max_usage;
+	get_mem_usage();
+	return memory_max_usage;
+#else
+	return 0;
+#endif
+}
+
+uint64_t Memory::get_mem_usage_by_tag(Tag p_tag) {
+#ifdef DEBUG_ENABLED
+	ERR_FAIL_INDEX_V(p_tag, TAG_MAX, 0);
+
+	uint64_t usage = 0;
+	for (int i = 0; i < MEMORY_SHARD_COUNT; i++) {
+		usage += memory_shards[i].usage[p_tag];
+	}
+	return usage;
 #else
 	return 0;
 #endif
 }
 
+uint64_t Memory::get_alloc_count() {
+#ifdef DEBUG_ENABLED
+	uint64_t count = 0;
+	for (int i = 0; i < MEMORY_SHARD_COUNT; i++) {
+		count += memory_shards[i].alloc_count;
+	}
+	return count;
+#else
+	return 0;
+#endif
+}
+
+const char *Memory::get_tag_name(Tag p_tag) {
+
+	static const char *names[TAG_MAX] = {
+		"general",
+		"scene",
+		"rendering",
+		"physics_3d",
+		"physics_2d",
+		"audio",
+		"loader",
+	};
+
+	ERR_FAIL_INDEX_V(p_tag, TAG_MAX, "");
+	return names[p_tag];
+}
+
 _GlobalNil::_GlobalNil() {
 
 	color = 1;
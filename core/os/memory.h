@@ -43,14 +43,20 @@
 class Memory {
 
 	Memory();
-#ifdef DEBUG_ENABLED
-	static uint64_t mem_usage;
-	static uint64_t max_usage;
-#endif
-
-	static uint64_t alloc_count;
 
 public:
+	// Subsystem a thread (or a scope, see MemoryTagScope) is allocating for, debug builds only.
+	enum Tag {
+		TAG_GENERAL,
+		TAG_SCENE,
+		TAG_RENDERING,
+		TAG_PHYSICS,
+		TAG_PHYSICS_2D,
+		TAG_AUDIO,
+		TAG_LOADER,
+		TAG_MAX
+	};
+
 	static void *alloc_static(size_t p_bytes, bool p_pad_align = false);
 	static void *realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align = false);
 	static void free_static(void *p_ptr, bool p_pad_align = false);
@@ -58,6 +64,31 @@ public:
 	static uint64_t get_mem_available();
 	static uint64_t get_mem_usage();
 	static uint64_t get_mem_max_usage();
+	static uint64_t get_mem_usage_by_tag(Tag p_tag);
+	static uint64_t get_alloc_count();
+
+#ifdef DEBUG_ENABLED
+	static void set_thread_tag(Tag p_tag);
+	static Tag get_thread_tag();
+#else
+	_FORCE_INLINE_ static void set_thread_tag(Tag p_tag) {}
+	_FORCE_INLINE_ static Tag get_thread_tag() { return TAG_GENERAL; }
+#endif
+	static const char *get_tag_name(Tag p_tag);
+};
+
+class MemoryTagScope {
+
+	Memory::Tag prev_tag;
+
+public:
+	_FORCE_INLINE_ MemoryTagScope(Memory::Tag p_tag) {
+		prev_tag = Memory::get_thread_tag();
+		Memory::set_thread_tag(p_tag);
+	}
+	_FORCE_INLINE_ ~MemoryTagScope() {
+		Memory::set_thread_tag(prev_tag);
+	}
 };
 
 class DefaultAllocator {
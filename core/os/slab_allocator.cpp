@@ -0,0 +1,302 @@
+/*************************************************************************/
+/*  slab_allocator.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "slab_allocator.h"
+
+#include "core/error_macros.h"
+#include "core/os/copymem.h"
+
+#include <atomic>
+#include <stdlib.h>
+
+namespace {
+
+struct FreeBlock {
+	FreeBlock *next;
+};
+
+const uint32_t block_sizes[SlabAllocator::SIZE_CLASS_COUNT] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256,
+	320, 384, 448, 512,
+	640, 768, 896, 1024
+};
+
+_FORCE_INLINE_ int size_class(size_t p_bytes) {
+
+	if (p_bytes <= 128)
+		return p_bytes ? (p_bytes - 1) >> 4 : 0;
+	if (p_bytes <= 256)
+		return 8 + ((p_bytes - 129) >> 5);
+	if (p_bytes <= 512)
+		return 12 + ((p_bytes - 257) >> 6);
+	return 16 + ((p_bytes - 513) >> 7);
+}
+
+// Blocks moved between a thread cache and the depot at once, a cache holds up to twice this.
+_FORCE_INLINE_ uint32_t batch_size(int p_class) {
+
+	return CLAMP(4096 / block_sizes[p_class], 4, 64);
+}
+
+// Memory may be allocated before any engine Mutex backend exists (static init),
+// so the depots use a plain spin lock.
+struct Depot {
+	std::atomic_flag lock = ATOMIC_FLAG_INIT;
+	FreeBlock *list = NULL;
+	uint64_t count = 0;
+
+	uint64_t allocs = 0;
+	uint64_t frees = 0;
+	uint64_t spans = 0;
+
+	_FORCE_INLINE_ void acquire() {
+		while (lock.test_and_set(std::memory_order_acquire)) {
+		}
+	}
+	_FORCE_INLINE_ void release() {
+		lock.clear(std::memory_order_release);
+	}
+};
+
+Depot depots[SlabAllocator::SIZE_CLASS_COUNT];
+
+struct ThreadCache {
+	FreeBlock *lists[SlabAllocator::SIZE_CLASS_COUNT];
+	uint32_t counts[SlabAllocator::SIZE_CLASS_COUNT];
+	uint32_t allocs[SlabAllocator::SIZE_CLASS_COUNT];
+	uint32_t frees[SlabAllocator::SIZE_CLASS_COUNT];
+
+	~ThreadCache();
+};
+
+thread_local ThreadCache thread_cache;
+thread_local bool thread_cache_destroyed = false;
+
+// Takes up to p_max blocks from the depot (carving a new span if needed), caller holds the lock.
+FreeBlock *depot_take(Depot &p_depot, int p_class, uint32_t p_max, uint32_t &r_taken) {
+
+	if (!p_depot.list) {
+
+		uint8_t *span = (uint8_t *)malloc(SlabAllocator::SPAN_SIZE);
+		if (!span) {
+			r_taken = 0;
+			return NULL;
+		}
+		p_depot.spans++;
+
+		uint32_t bs = block_sizes[p_class];
+		uint32_t blocks = SlabAllocator::SPAN_SIZE / bs;
+		for (uint32_t i = 0; i < blocks; i++) {
+			FreeBlock *b = (FreeBlock *)(span + i * bs);
+			b->next = p_depot.list;
+			p_depot.list = b;
+		}
+		p_depot.count += blocks;
+	}
+
+	FreeBlock *first = p_depot.list;
+	FreeBlock *last = first;
+	uint32_t taken = 1;
+	while (taken < p_max && last->next) {
+		last = last->next;
+		taken++;
+	}
+
+	p_depot.list = last->next;
+	p_depot.count -= taken;
+	last->next = NULL;
+
+	r_taken = taken;
+	return first;
+}
+
+void depot_give(Depot &p_depot, FreeBlock *p_first, FreeBlock *p_last, uint32_t p_count) {
+
+	p_last->next = p_depot.list;
+	p_depot.list = p_first;
+	p_depot.count += p_count;
+}
+
+void flush_stats(Depot &p_depot, ThreadCache &p_cache, int p_class) {
+
+	p_depot.allocs += p_cache.allocs[p_class];
+	p_depot.frees += p_cache.frees[p_class];
+	p_cache.allocs[p_class] = 0;
+	p_cache.frees[p_class] = 0;
+}
+
+ThreadCache::~ThreadCache() {
+
+	// Blocks allocated by this thread may still be in use elsewhere, only cached ones go back.
+	for (int i = 0; i < SlabAllocator::SIZE_CLASS_COUNT; i++) {
+
+		Depot &depot = depots[i];
+		depot.acquire();
+		if (lists[i]) {
+			FreeBlock *last = lists[i];
+			while (last->next)
+				last = last->next;
+			depot_give(depot, lists[i], last, counts[i]);
+			lists[i] = NULL;
+			counts[i] = 0;
+		}
+		flush_stats(depot, *this, i);
+		depot.release();
+	}
+
+	thread_cache_destroyed = true;
+}
+
+} // namespace
+
+void *SlabAllocator::alloc(size_t p_bytes) {
+
+	if (p_bytes > MAX_BLOCK_SIZE)
+		return malloc(p_bytes);
+
+	int c = size_class(p_bytes);
+
+	if (unlikely(thread_cache_destroyed)) {
+		// Thread is exiting, go through the depot.
+		Depot &depot = depots[c];
+		uint32_t taken;
+		depot.acquire();
+		FreeBlock *b = depot_take(depot, c, 1, taken);
+		if (b)
+			depot.allocs++;
+		depot.release();
+		return b;
+	}
+
+	ThreadCache &cache = thread_cache;
+	FreeBlock *b = cache.lists[c];
+
+	if (unlikely(!b)) {
+		Depot &depot = depots[c];
+		uint32_t taken;
+		depot.acquire();
+		b = depot_take(depot, c, batch_size(c), taken);
+		flush_stats(depot, cache, c);
+		depot.release();
+
+		if (!b)
+			return NULL;
+		cache.counts[c] = taken;
+	}
+
+	cache.lists[c] = b->next;
+	cache.counts[c]--;
+	cache.allocs[c]++;
+
+	return b;
+}
+
+void SlabAllocator::free(void *p_ptr, size_t p_bytes) {
+
+	if (p_bytes > MAX_BLOCK_SIZE) {
+		::free(p_ptr);
+		return;
+	}
+
+	int c = size_class(p_bytes);
+	FreeBlock *b = (FreeBlock *)p_ptr;
+
+	if (unlikely(thread_cache_destroyed)) {
+		Depot &depot = depots[c];
+		depot.acquire();
+		depot_give(depot, b, b, 1);
+		depot.frees++;
+		depot.release();
+		return;
+	}
+
+	ThreadCache &cache = thread_cache;
+	b->next = cache.lists[c];
+	cache.lists[c] = b;
+	cache.counts[c]++;
+	cache.frees[c]++;
+
+	uint32_t batch = batch_size(c);
+	if (unlikely(cache.counts[c] > batch * 2)) {
+
+		// Give the oldest half back, keep the most recently freed (cache hot) blocks.
+		FreeBlock *keep_last = cache.lists[c];
+		for (uint32_t i = 1; i < batch; i++)
+			keep_last = keep_last->next;
+
+		FreeBlock *first = keep_last->next;
+		FreeBlock *last = first;
+		uint32_t given = 1;
+		while (last->next) {
+			last = last->next;
+			given++;
+		}
+		keep_last->next = NULL;
+		cache.counts[c] -= given;
+
+		Depot &depot = depots[c];
+		depot.acquire();
+		depot_give(depot, first, last, given);
+		flush_stats(depot, cache, c);
+		depot.release();
+	}
+}
+
+void *SlabAllocator::realloc(void *p_ptr, size_t p_old_bytes, size_t p_bytes) {
+
+	if (p_old_bytes > MAX_BLOCK_SIZE && p_bytes > MAX_BLOCK_SIZE)
+		return ::realloc(p_ptr, p_bytes);
+
+	if (p_old_bytes <= MAX_BLOCK_SIZE && p_bytes <= MAX_BLOCK_SIZE && size_class(p_old_bytes) == size_class(p_bytes))
+		return p_ptr; // still fits the same block
+
+	void *mem = alloc(p_bytes);
+	if (!mem)
+		return NULL;
+
+	copymem(mem, p_ptr, MIN(p_old_bytes, p_bytes));
+	free(p_ptr, p_old_bytes);
+	return mem;
+}
+
+void SlabAllocator::get_size_class_stats(int p_class, SizeClassStats *r_stats) {
+
+	ERR_FAIL_INDEX(p_class, SIZE_CLASS_COUNT);
+
+	Depot &depot = depots[p_class];
+	depot.acquire();
+	r_stats->block_size = block_sizes[p_class];
+	r_stats->allocs = depot.allocs;
+	r_stats->frees = depot.frees;
+	r_stats->spans = depot.spans;
+	r_stats->depot_blocks = depot.count;
+	depot.release();
+}
@@ -0,0 +1,75 @@
+/*************************************************************************/
+/*  slab_allocator.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include "core/typedefs.h"
+
+/**
+ * Size-class slab allocator used by Memory::alloc_static() when the engine
+ * is built with slab_allocator=yes (SLAB_ALLOCATOR_ENABLED).
+ *
+ * Blocks up to MAX_BLOCK_SIZE bytes are carved from SPAN_SIZE spans, one set
+ * of spans per size class. Each thread keeps a small cache of free blocks per
+ * class, so the common alloc/free pair touches no shared state; caches
+ * exchange batches of blocks with a per-class depot when they run empty or
+ * overflow. Spans are never returned to the system.
+ * Larger requests are forwarded to malloc/realloc/free.
+ *
+ * The caller must pass the same size to free() it requested from alloc(),
+ * Memory keeps it in the allocation header.
+ */
+
+class SlabAllocator {
+public:
+	enum {
+		MAX_BLOCK_SIZE = 1024,
+		SIZE_CLASS_COUNT = 20,
+		SPAN_SIZE = 64 * 1024,
+	};
+
+	struct SizeClassStats {
+		uint32_t block_size;
+		uint64_t allocs; // flushed from the thread caches when they exchange batches
+		uint64_t frees;
+		uint64_t spans;
+		uint64_t depot_blocks; // free blocks not cached by any thread
+	};
+
+	static void *alloc(size_t p_bytes);
+	static void *realloc(void *p_ptr, size_t p_old_bytes, size_t p_bytes);
+	static void free(void *p_ptr, size_t p_bytes);
+
+	static int get_size_class_count() { return SIZE_CLASS_COUNT; }
+	static void get_size_class_stats(int p_class, SizeClassStats *r_stats);
+};
+
+#endif // SLAB_ALLOCATOR_H
@@ -0,0 +1,308 @@
+/*************************************************************************/
+/*  thread_pool.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "thread_pool.h"
+
+#include "core/os/os.h"
+
+ThreadPool *ThreadPool::singleton = NULL;
+
+void ThreadPool::TaskGroup::run() {
+
+	ThreadPool *pool = ThreadPool::get_singleton();
+	if (!pool) {
+		for (uint32_t i = 0; i < tasks.size(); i++) {
+			process(i);
+		}
+		return;
+	}
+
+	pool->submit(this, tasks.size());
+	pool->wait(this);
+}
+
+void ThreadPool::_worker_thread(void *p_worker) {
+
+	Worker *worker = (Worker *)p_worker;
+	ThreadPool *pool = worker->pool;
+
+	while (true) {
+
+		pool->work_available->wait();
+		if (pool->exit_threads)
+			break;
+
+		Work *work = pool->_pop_work(worker->index);
+		if (!work)
+			continue; // already taken by the thread waiting for it
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		pool->_process_work(work);
+		atomic_add(&worker->busy_usec, OS::get_singleton()->get_ticks_usec() - from);
+
+		// Don't touch the work after this unless we are the last one, the waiting thread may free it.
+		if (atomic_decrement(&work->pending) == 0) {
+			work->done->post();
+		}
+	}
+}
+
+void ThreadPool::_process_work(Work *p_work) {
+
+	while (true) {
+		uint32_t index = atomic_increment(&p_work->index) - 1;
+		if (index >= p_work->elements)
+			break;
+		p_work->process(index);
+	}
+}
+
+ThreadPool::Work *ThreadPool::_pop_work(uint32_t p_worker) {
+
+	// Own queue first (most recent), then steal the oldest work of the others.
+	for (uint32_t i = 0; i < workers.size(); i++) {
+
+		Worker *w = workers[(p_worker + i) % workers.size()];
+		Work *work = NULL;
+
+		w->mutex->lock();
+		if (!w->queue.empty()) {
+			if (i == 0) {
+				work = w->queue.back();
+				w->queue.pop_back();
+			} else {
+				work = w->queue.front();
+				w->queue.erase(w->queue.begin());
+			}
+		}
+		w->mutex->unlock();
+
+		if (work) {
+			atomic_decrement(&queued);
+			return work;
+		}
+	}
+
+	return NULL;
+}
+
+uint32_t ThreadPool::_remove_work(Work *p_work) {
+
+	uint32_t removed = 0;
+
+	for (uint32_t i = 0; i < workers.size(); i++) {
+
+		Worker *w = workers[i];
+		w->mutex->lock();
+		for (uint32_t j = 0; j < w->queue.size();) {
+			if (w->queue[j] == p_work) {
+				w->queue.erase(w->queue.begin() + j);
+				removed++;
+			} else {
+				j++;
+			}
+		}
+		w->mutex->unlock();
+	}
+
+	if (removed) {
+		atomic_sub(&queued, removed);
+	}
+
+	return removed;
+}
+
+void ThreadPool::submit(Work *p_work, uint32_t p_elements) {
+
+	p_work->elements = p_elements;
+	p_work->index = 0;
+
+	// The thread calling wait() processes as well, so one element less needs help.
+	uint32_t helpers = p_elements > 1 ? MIN((uint32_t)workers.size(), p_elements - 1) : 0;
+	p_work->pending = helpers + 1;
+
+	if (helpers == 0)
+		return;
+
+	semaphore_mutex->lock();
+	if (free_semaphores.empty()) {
+		p_work->done = Semaphore::create();
+	} else {
+		p_work->done = free_semaphores.back();
+		free_semaphores.pop_back();
+	}
+	semaphore_mutex->unlock();
+
+	for (uint32_t i = 0; i < helpers; i++) {
+
+		Worker *w = workers[atomic_increment(&next_worker) % workers.size()];
+		w->mutex->lock();
+		w->queue.push_back(p_work);
+		w->mutex->unlock();
+
+		atomic_increment(&queued);
+		work_available->post();
+	}
+}
+
+void ThreadPool::wait(Work *p_work) {
+
+	_process_work(p_work);
+
+	if (!p_work->done)
+		return; // processed entirely by this thread
+
+	// Every element is taken by now, entries still queued are of no use.
+	uint32_t removed = _remove_work(p_work);
+	if (atomic_sub(&p_work->pending, removed + 1) != 0) {
+		p_work->done->wait();
+	}
+
+	semaphore_mutex->lock();
+	free_semaphores.push_back(p_work->done);
+	semaphore_mutex->unlock();
+	p_work->done = NULL;
+}
+
+float ThreadPool::get_utilization() const {
+
+	if (workers.empty())
+		return 0;
+
+	MutexLock lock(stats_mutex);
+
+	uint64_t busy = 0;
+	for (uint32_t i = 0; i < workers.size(); i++) {
+		busy += workers[i]->busy_usec;
+	}
+
+	uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+	uint64_t elapsed = ticks - last_stats_ticks;
+	if (elapsed < 1000)
+		return last_utilization; // too short to be meaningful, e.g. several monitors read in a row
+
+	last_utilization = float(busy - last_stats_busy) / float(elapsed * workers.size());
+	last_stats_busy = busy;
+	last_stats_ticks = ticks;
+
+	return last_utilization;
+}
+
+void ThreadPool::init(int p_threads) {
+
+	ERR_FAIL_COND(!workers.empty());
+
+	semaphore_mutex = Mutex::create();
+	stats_mutex = Mutex::create();
+	last_stats_ticks = OS::get_singleton()->get_ticks_usec();
+
+#ifndef NO_THREADS
+	if (p_threads < 0) {
+		// The thread waiting for a work helps as well, so leave it a core.
+		p_threads = MAX(1, OS::get_singleton()->get_processor_count() - 1);
+	}
+
+	if (p_threads == 0)
+		return;
+
+	exit_threads = false;
+	work_available = Semaphore::create();
+
+	workers.resize(p_threads);
+	for (int i = 0; i < p_threads; i++) {
+		Worker *w = memnew(Worker);
+		w->pool = this;
+		w->mutex = Mutex::create();
+		w->index = i;
+		w->busy_usec = 0;
+		workers[i] = w;
+	}
+
+	for (int i = 0; i < p_threads; i++) {
+		workers[i]->thread = Thread::create(_worker_thread, workers[i]);
+	}
+#endif
+}
+
+void ThreadPool::finish() {
+
+	if (!workers.empty()) {
+
+		exit_threads = true;
+		for (uint32_t i = 0; i < workers.size(); i++) {
+			work_available->post();
+		}
+
+		for (uint32_t i = 0; i < workers.size(); i++) {
+			Thread::wait_to_finish(workers[i]->thread);
+			memdelete(workers[i]->thread);
+			memdelete(workers[i]->mutex);
+			memdelete(workers[i]);
+		}
+		workers.clear();
+
+		memdelete(work_available);
+		work_available = NULL;
+	}
+
+	for (uint32_t i = 0; i < free_semaphores.size(); i++) {
+		memdelete(free_semaphores[i]);
+	}
+	free_semaphores.clear();
+
+	if (semaphore_mutex) {
+		memdelete(semaphore_mutex);
+		semaphore_mutex = NULL;
+	}
+	if (stats_mutex) {
+		memdelete(stats_mutex);
+		stats_mutex = NULL;
+	}
+}
+
+ThreadPool::ThreadPool() {
+
+	singleton = this;
+	work_available = NULL;
+	exit_threads = false;
+	next_worker = 0;
+	queued = 0;
+	semaphore_mutex = NULL;
+	stats_mutex = NULL;
+	last_stats_ticks = 0;
+	last_stats_busy = 0;
+	last_utilization = 0;
+}
+
+ThreadPool::~ThreadPool() {
+
+	finish();
+	singleton = NULL;
+}
@@ -0,0 +1,183 @@
+/*************************************************************************/
+/*  thread_pool.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+
+/**
+ * Engine-wide pool of worker threads, started once from register_core_types().
+ *
+ * Work is submitted as a ThreadPool::Work, a range of indices [0, elements)
+ * that any number of threads pull from. Submitting a work pushes one entry
+ * into the queue of each worker that may help (round robin), workers pop
+ * their own queue first and steal from the others when it is empty.
+ * The thread waiting for a work always helps processing it, so waiting
+ * from inside a worker (nested parallel loops) can't dead-lock.
+ */
+
+class ThreadPool {
+public:
+	class Work {
+
+		friend class ThreadPool;
+
+		uint32_t elements;
+		uint32_t index;
+		uint32_t pending;
+		Semaphore *done;
+
+	protected:
+		virtual void process(uint32_t p_index) = 0;
+
+	public:
+		uint32_t get_elements() const { return elements; }
+
+		Work() {
+			elements = 0;
+			index = 0;
+			pending = 0;
+			done = NULL;
+		}
+		virtual ~Work() {}
+	};
+
+	template <class C, class M, class U>
+	class MethodWork : public Work {
+	public:
+		C *instance;
+		M method;
+		U userdata;
+
+		virtual void process(uint32_t p_index) {
+			(instance->*method)(p_index, userdata);
+		}
+	};
+
+	typedef void (*TaskFunc)(void *p_userdata);
+
+	// Heterogeneous tasks that run in parallel and are waited for together.
+	class TaskGroup : public Work {
+
+		struct Task {
+			TaskFunc func;
+			void *userdata;
+		};
+
+		std::vector<Task> tasks;
+
+	protected:
+		virtual void process(uint32_t p_index) {
+			tasks[p_index].func(tasks[p_index].userdata);
+		}
+
+	public:
+		void add_task(TaskFunc p_func, void *p_userdata) {
+			Task t;
+			t.func = p_func;
+			t.userdata = p_userdata;
+			tasks.push_back(t);
+		}
+
+		int get_task_count() const { return tasks.size(); }
+		void clear() { tasks.clear(); }
+
+		void run(); // submits and waits
+	};
+
+private:
+	struct Worker {
+		ThreadPool *pool;
+		Thread *thread;
+		Mutex *mutex;
+		std::vector<Work *> queue;
+		uint32_t index;
+		uint64_t busy_usec;
+	};
+
+	static ThreadPool *singleton;
+
+	std::vector<Worker *> workers;
+	Semaphore *work_available;
+	bool exit_threads;
+	uint32_t next_worker;
+	uint32_t queued;
+
+	Mutex *semaphore_mutex;
+	std::vector<Semaphore *> free_semaphores;
+
+	mutable Mutex *stats_mutex;
+	mutable uint64_t last_stats_ticks;
+	mutable uint64_t last_stats_busy;
+	mutable float last_utilization;
+
+	static void _worker_thread(void *p_worker);
+
+	void _process_work(Work *p_work);
+	Work *_pop_work(uint32_t p_worker);
+	uint32_t _remove_work(Work *p_work);
+
+public:
+	static ThreadPool *get_singleton() { return singleton; }
+
+	void init(int p_threads = -1);
+	void finish();
+
+	// Queue a work and return immediately, call wait() before the work goes away.
+	void submit(Work *p_work, uint32_t p_elements);
+	// Help processing the work from the calling thread and block until it's done.
+	void wait(Work *p_work);
+
+	template <class C, class M, class U>
+	void parallel_for(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+
+		MethodWork<C, M, U> work;
+		work.instance = p_instance;
+		work.method = p_method;
+		work.userdata = p_userdata;
+		submit(&work, p_elements);
+		wait(&work);
+	}
+
+	int get_thread_count() const { return workers.size(); }
+	uint32_t get_queue_depth() const { return queued; }
+	float get_utilization() const; // ratio of busy worker time since last call
+
+	ThreadPool();
+	~ThreadPool();
+};
+
+#endif // THREAD_POOL_H
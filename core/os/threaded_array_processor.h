@@ -31,78 +31,20 @@
 #ifndef THREADED_ARRAY_PROCESSOR_H
 #define THREADED_ARRAY_PROCESSOR_H
 
-#include "core/os/mutex.h"
-#include "core/os/os.h"
-#include "core/os/thread.h"
-#include "core/os/thread_safe.h"
-#include "core/safe_refcount.h"
-
-template <class C, class U>
-struct ThreadArrayProcessData {
-	uint32_t elements;
-	uint32_t index;
-	C *instance;
-	U userdata;
-	void (C::*method)(uint32_t, U);
-
-	void process(uint32_t p_index) {
-		(instance->*method)(p_index, userdata);
-	}
-};
-
-#ifndef NO_THREADS
-
-template <class T>
-void process_array_thread(void *ud) {
-
-	T &data = *(T *)ud;
-	while (true) {
-		uint32_t index = atomic_increment(&data.index);
-		if (index >= data.elements)
-			break;
-		data.process(index);
-	}
-}
+#include "core/os/thread_pool.h"
 
 template <class C, class M, class U>
 void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
 
-	ThreadArrayProcessData<C, U> data;
-	data.method = p_method;
-	data.instance = p_instance;
-	data.userdata = p_userdata;
-	data.index = 0;
-	data.elements = p_elements;
-	data.process(data.index); //process first, let threads increment for next
-
-	std::vector<Thread *> threads(OS::get_singleton()->get_processor_count());
-
-	for (auto &&thread : threads) {
-		thread = Thread::create(process_array_thread<ThreadArrayProcessData<C, U> >, &data);
-	}
-
-	for (auto &&thread : threads) {
-		Thread::wait_to_finish(thread);
-		memdelete(thread);
+	ThreadPool *pool = ThreadPool::get_singleton();
+	if (pool) {
+		pool->parallel_for(p_elements, p_instance, p_method, p_userdata);
+		return;
 	}
-}
-
-#else
 
-template <class C, class M, class U>
-void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-
-	ThreadArrayProcessData<C, U> data;
-	data.method = p_method;
-	data.instance = p_instance;
-	data.userdata = p_userdata;
-	data.index = 0;
-	data.elements = p_elements;
 	for (uint32_t i = 0; i < p_elements; i++) {
-		data.process(i);
+		(p_instance->*p_method)(i, p_userdata);
 	}
 }
 
-#endif
-
 #endif // THREADED_ARRAY_PROCESSOR_H
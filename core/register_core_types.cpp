@@ -61,6 +61,7 @@
 #include "core/math/triangle_mesh.h"
 #include "core/os/input.h"
 #include "core/os/main_loop.h"
+#include "core/os/thread_pool.h"
 #include "core/packed_data_container.h"
 #include "core/path_remap.h"
 #include "core/project_settings.h"
@@ -85,6 +86,8 @@ static _JSON *_json = NULL;
 
 static IP *ip = NULL;
 
+static ThreadPool *thread_pool = NULL;
+
 static _Geometry *_geometry = NULL;
 
 extern Mutex *_global_mutex;
@@ -93,6 +96,7 @@ extern void register_global_constants();
 extern void unregister_global_constants();
 extern void register_variant_methods();
 extern void unregister_variant_methods();
+extern void register_variant_operators();
 
 void register_core_types() {
 
@@ -102,11 +106,15 @@ void register_core_types() {
 
 	_global_mutex = Mutex::create();
 
+	thread_pool = memnew(ThreadPool);
+	thread_pool->init();
+
 	StringName::setup();
 	ResourceLoader::initialize();
 
 	register_global_constants();
 	register_variant_methods();
+	register_variant_operators();
 
 	CoreStringNames::create();
 
@@ -312,6 +320,11 @@ void unregister_core_types() {
 	CoreStringNames::free();
 	StringName::cleanup();
 
+	if (thread_pool) {
+		memdelete(thread_pool);
+		thread_pool = NULL;
+	}
+
 	if (_global_mutex) {
 		memdelete(_global_mutex);
 		_global_mutex = NULL; //still needed at a few places
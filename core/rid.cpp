@@ -33,9 +33,9 @@
 RID_Data::~RID_Data() {
 }
 
-SafeRefCount RID_OwnerBase::refcount;
+uint32_t RID_OwnerBase::last_validator = 0;
 
 void RID_OwnerBase::init_rid() {
 
-	refcount.init();
+	last_validator = 0;
 }
@@ -37,15 +37,14 @@
 #include "core/set.h"
 #include "core/typedefs.h"
 
+#include <atomic>
+
 class RID_OwnerBase;
 
 class RID_Data {
 
 	friend class RID_OwnerBase;
 
-#ifndef DEBUG_ENABLED
-	RID_OwnerBase *_owner;
-#endif
 	uint32_t _id;
 
 public:
@@ -54,67 +53,73 @@ public:
 	virtual ~RID_Data();
 };
 
+// A RID is a handle into the slot table of the RID_Owner that made it: the low
+// 32 bits are the slot index, the high 32 bits are the validator the slot had
+// when the RID was made. Validators are unique across all owners, so a stale
+// RID, or one belonging to another owner, never matches a live slot.
 class RID {
 	friend class RID_OwnerBase;
 
-	mutable RID_Data *_data;
+	uint64_t _id;
 
 public:
-	_FORCE_INLINE_ RID_Data *get_data() const { return _data; }
-
 	_FORCE_INLINE_ bool operator==(const RID &p_rid) const {
 
-		return _data == p_rid._data;
+		return _id == p_rid._id;
 	}
 	_FORCE_INLINE_ bool operator<(const RID &p_rid) const {
 
-		return _data < p_rid._data;
+		return _id < p_rid._id;
 	}
 	_FORCE_INLINE_ bool operator<=(const RID &p_rid) const {
 
-		return _data <= p_rid._data;
+		return _id <= p_rid._id;
 	}
 	_FORCE_INLINE_ bool operator>(const RID &p_rid) const {
 
-		return _data > p_rid._data;
+		return _id > p_rid._id;
 	}
 	_FORCE_INLINE_ bool operator!=(const RID &p_rid) const {
 
-		return _data != p_rid._data;
+		return _id != p_rid._id;
 	}
-	_FORCE_INLINE_ bool is_valid() const { return _data != NULL; }
+	_FORCE_INLINE_ bool is_valid() const { return _id != 0; }
 
-	_FORCE_INLINE_ uint32_t get_id() const { return _data ? _data->get_id() : 0; }
+	_FORCE_INLINE_ uint32_t get_id() const { return uint32_t(_id >> 32); }
 
 	_FORCE_INLINE_ RID() {
-		_data = NULL;
+		_id = 0;
 	}
 };
 
 class RID_OwnerBase {
 protected:
-	static SafeRefCount refcount;
-	_FORCE_INLINE_ void _set_data(RID &p_rid, RID_Data *p_data) {
-		p_rid._data = p_data;
-		refcount.ref();
-		p_data->_id = refcount.get();
-#ifndef DEBUG_ENABLED
-		p_data->_owner = this;
-#endif
+	static uint32_t last_validator;
+
+	_FORCE_INLINE_ static uint32_t _gen_validator() {
+
+		uint32_t validator = atomic_increment(&last_validator);
+		while (unlikely(validator == 0)) { // 0 marks free slots and invalid RIDs, skip it on wraparound.
+			validator = atomic_increment(&last_validator);
+		}
+		return validator;
 	}
 
-#ifndef DEBUG_ENABLED
+	_FORCE_INLINE_ static void _set_data(RID &p_rid, RID_Data *p_data, uint32_t p_index, uint32_t p_validator) {
+
+		p_rid._id = (uint64_t(p_validator) << 32) | p_index;
+		p_data->_id = p_validator;
+	}
 
-	_FORCE_INLINE_ bool _is_owner(const RID &p_rid) const {
+	_FORCE_INLINE_ static uint32_t _get_index(const RID &p_rid) {
 
-		return this == p_rid._data->_owner;
+		return uint32_t(p_rid._id & 0xFFFFFFFF);
 	}
 
-	_FORCE_INLINE_ void _remove_owner(RID &p_rid) {
+	_FORCE_INLINE_ static uint32_t _get_validator(const RID &p_rid) {
 
-		p_rid._data->_owner = NULL;
+		return uint32_t(p_rid._id >> 32);
 	}
-#endif
 
 public:
 	virtual void get_owned_list(List<RID> *p_owned) = 0;
@@ -123,81 +128,195 @@ public:
 	virtual ~RID_OwnerBase() {}
 };
 
+// Slots live in fixed size chunks which never move once allocated, so a pointer
+// resolves with two array lookups and a validator compare. Freed slots are
+// recycled through a free list. Like the rest of the servers, an owner is not
+// thread safe: it must only be modified by the thread that uses it. Lookups
+// from other threads may run while it grows though, so the table of chunks is
+// never reallocated in place: a larger copy is published and the old one is
+// kept until the owner is destroyed.
 template <class T>
 class RID_Owner : public RID_OwnerBase {
-public:
-#ifdef DEBUG_ENABLED
-	mutable Set<RID_Data *> id_map;
-#endif
+
+	enum {
+		CHUNK_SHIFT = 8,
+		CHUNK_SIZE = 1 << CHUNK_SHIFT,
+		CHUNK_MASK = CHUNK_SIZE - 1,
+		INVALID_SLOT = 0xFFFFFFFF
+	};
+
+	struct Slot {
+		T *data;
+		uint32_t validator;
+		uint32_t next_free;
+	};
+
+	// The table is published before the count, so a reader seeing a chunk in the count sees it in the table.
+	std::atomic<Slot **> chunks;
+	std::atomic<uint32_t> chunk_count;
+	uint32_t chunk_capacity;
+	List<Slot **> retired_chunks;
+	uint32_t free_head;
+	uint32_t rid_count;
+
+	_FORCE_INLINE_ Slot &_get_slot(uint32_t p_index) const {
+
+		return chunks.load(std::memory_order_acquire)[p_index >> CHUNK_SHIFT][p_index & CHUNK_MASK];
+	}
+
+	_FORCE_INLINE_ Slot *_find_slot(const RID &p_rid) const {
+
+		uint32_t index = _get_index(p_rid);
+		uint32_t validator = _get_validator(p_rid);
+		if (unlikely(validator == 0 || index >= (chunk_count.load(std::memory_order_acquire) << CHUNK_SHIFT))) {
+			return NULL;
+		}
+
+		Slot &slot = _get_slot(index);
+		return slot.validator == validator ? &slot : NULL;
+	}
+
+	void _grow() {
+
+		uint32_t count = chunk_count.load(std::memory_order_relaxed);
+		ERR_FAIL_COND(count >= (0xFFFFFFFF >> CHUNK_SHIFT));
+
+		Slot **table = chunks.load(std::memory_order_relaxed);
+		if (count == chunk_capacity) {
+			// Lookups on other threads may still read the old table. The capacity doubles, so the retired
+			// tables never take more memory than the current one.
+			chunk_capacity = MAX(chunk_capacity * 2, 8u);
+			Slot **new_table = (Slot **)memalloc(sizeof(Slot *) * chunk_capacity);
+			if (table) {
+				memcpy(new_table, table, sizeof(Slot *) * count);
+				retired_chunks.push_back(table);
+			}
+			table = new_table;
+			chunks.store(table, std::memory_order_release);
+		}
+
+		Slot *chunk = (Slot *)memalloc(sizeof(Slot) * CHUNK_SIZE);
+
+		uint32_t base = count << CHUNK_SHIFT;
+		for (uint32_t i = 0; i < CHUNK_SIZE; i++) {
+			chunk[i].data = NULL;
+			chunk[i].validator = 0;
+			chunk[i].next_free = i + 1 < CHUNK_SIZE ? base + i + 1 : free_head;
+		}
+
+		table[count] = chunk;
+		chunk_count.store(count + 1, std::memory_order_release);
+		free_head = base;
+	}
+
 public:
 	_FORCE_INLINE_ RID make_rid(T *p_data) {
 
 		RID rid;
-		_set_data(rid, p_data);
+		ERR_FAIL_COND_V(!p_data, rid);
 
-#ifdef DEBUG_ENABLED
-		id_map.insert(p_data);
-#endif
+		if (unlikely(free_head == INVALID_SLOT)) {
+			_grow();
+			ERR_FAIL_COND_V(free_head == INVALID_SLOT, rid);
+		}
+
+		uint32_t index = free_head;
+		Slot &slot = _get_slot(index);
+		free_head = slot.next_free;
+
+		slot.data = p_data;
+		slot.validator = _gen_validator();
+		slot.next_free = INVALID_SLOT;
+		rid_count++;
 
+		_set_data(rid, p_data, index, slot.validator);
 		return rid;
 	}
 
 	_FORCE_INLINE_ T *get(const RID &p_rid) {
 
+		Slot *slot = _find_slot(p_rid);
 #ifdef DEBUG_ENABLED
 
 		ERR_FAIL_COND_V(!p_rid.is_valid(), NULL);
-		ERR_FAIL_COND_V(!id_map.has(p_rid.get_data()), NULL);
+		ERR_FAIL_COND_V(!slot, NULL);
 #endif
-		return static_cast<T *>(p_rid.get_data());
+		return slot ? slot->data : NULL;
 	}
 
 	_FORCE_INLINE_ T *getornull(const RID &p_rid) {
 
+		Slot *slot = _find_slot(p_rid);
 #ifdef DEBUG_ENABLED
 
-		if (p_rid.get_data()) {
-			ERR_FAIL_COND_V(!id_map.has(p_rid.get_data()), NULL);
+		if (p_rid.is_valid()) {
+			ERR_FAIL_COND_V(!slot, NULL);
 		}
 #endif
-		return static_cast<T *>(p_rid.get_data());
+		return slot ? slot->data : NULL;
 	}
 
 	_FORCE_INLINE_ T *getptr(const RID &p_rid) {
 
-		return static_cast<T *>(p_rid.get_data());
+		Slot *slot = _find_slot(p_rid);
+		return slot ? slot->data : NULL;
 	}
 
 	_FORCE_INLINE_ bool owns(const RID &p_rid) const {
 
-		if (p_rid.get_data() == NULL)
-			return false;
-#ifdef DEBUG_ENABLED
-		return id_map.has(p_rid.get_data());
-#else
-		return _is_owner(p_rid);
-#endif
+		return _find_slot(p_rid) != NULL;
 	}
 
 	void free(RID p_rid) {
 
-#ifdef DEBUG_ENABLED
-		id_map.erase(p_rid.get_data());
-#else
-		_remove_owner(p_rid);
-#endif
+		Slot *slot = _find_slot(p_rid);
+		ERR_FAIL_COND(!slot);
+
+		slot->data = NULL;
+		slot->validator = 0;
+		slot->next_free = free_head;
+		free_head = _get_index(p_rid);
+		rid_count--;
 	}
 
+	_FORCE_INLINE_ uint32_t get_rid_count() const { return rid_count; }
+
 	void get_owned_list(List<RID> *p_owned) {
 
-#ifdef DEBUG_ENABLED
+		Slot **table = chunks.load(std::memory_order_acquire);
+		uint32_t count = chunk_count.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < count; i++) {
+			const Slot *chunk = table[i];
+			for (uint32_t j = 0; j < CHUNK_SIZE; j++) {
+				if (chunk[j].validator) {
+					RID r;
+					_set_data(r, chunk[j].data, (i << CHUNK_SHIFT) | j, chunk[j].validator);
+					p_owned->push_back(r);
+				}
+			}
+		}
+	}
 
-		for (typename Set<RID_Data *>::Element *E = id_map.front(); E; E = E->next()) {
-			RID r;
-			_set_data(r, static_cast<T *>(E->get()));
-			p_owned->push_back(r);
+	RID_Owner() {
+		chunks = NULL;
+		chunk_count = 0;
+		chunk_capacity = 0;
+		free_head = INVALID_SLOT;
+		rid_count = 0;
+	}
+
+	~RID_Owner() {
+		Slot **table = chunks.load();
+		uint32_t count = chunk_count.load();
+		for (uint32_t i = 0; i < count; i++) {
+			memfree(table[i]);
+		}
+		if (table) {
+			memfree(table);
+		}
+		for (typename List<Slot **>::Element *E = retired_chunks.front(); E; E = E->next()) {
+			memfree(E->get());
 		}
-#endif
 	}
 };
 
@@ -303,6 +303,15 @@ struct _ScriptDebuggerLocalProfileInfoSort {
 	}
 };
 
+static String _profile_cache_hits(const ScriptLanguage::ProfilingInfo &p_info) {
+
+	uint64_t lookups = p_info.cache_hits + p_info.cache_misses;
+	if (lookups == 0)
+		return String();
+
+	return "\tcache hits: " + itos(p_info.cache_hits * 100 / lookups) + " %";
+}
+
 void ScriptDebuggerLocal::profiling_set_frame_times(float p_frame_time, float p_idle_time, float p_physics_time, float p_physics_frame_time) {
 
 	frame_time = p_frame_time;
@@ -353,7 +362,7 @@ void ScriptDebuggerLocal::idle_poll() {
 		print_line(itos(i) + ":" + pinfo[i].signature);
 		float tt = USEC_TO_SEC(pinfo[i].total_time);
 		float st = USEC_TO_SEC(pinfo[i].self_time);
-		print_line("\ttotal: " + rtos(tt) + "/" + itos(tt * 100 / total_time) + " % \tself: " + rtos(st) + "/" + itos(st * 100 / total_time) + " % tcalls: " + itos(pinfo[i].call_count));
+		print_line("\ttotal: " + rtos(tt) + "/" + itos(tt * 100 / total_time) + " % \tself: " + rtos(st) + "/" + itos(st * 100 / total_time) + " % tcalls: " + itos(pinfo[i].call_count) + _profile_cache_hits(pinfo[i]));
 	}
 }
 
@@ -395,7 +404,7 @@ void ScriptDebuggerLocal::profiling_end() {
 		print_line(itos(i) + ":" + pinfo[i].signature);
 		float tt = USEC_TO_SEC(pinfo[i].total_time);
 		float st = USEC_TO_SEC(pinfo[i].self_time);
-		print_line("\ttotal_ms: " + rtos(tt) + "\tself_ms: " + rtos(st) + "total%: " + itos(tt * 100 / total_time) + "\tself%: " + itos(st * 100 / total_time) + "\tcalls: " + itos(pinfo[i].call_count));
+		print_line("\ttotal_ms: " + rtos(tt) + "\tself_ms: " + rtos(st) + "total%: " + itos(tt * 100 / total_time) + "\tself%: " + itos(st * 100 / total_time) + "\tcalls: " + itos(pinfo[i].call_count) + _profile_cache_hits(pinfo[i]));
 	}
 
 	for (int i = 0; i < ScriptServer::get_language_count(); i++) {
@@ -338,6 +338,9 @@ public:
 
 	virtual void reload_all_scripts() = 0;
 	virtual void reload_tool_script(const Ref<Script> &p_script, bool p_soft_reload) = 0;
+	// Load the scripts p_paths depend on ahead of time, e.g. on worker threads. They stay loaded at
+	// least until the next frame.
+	virtual void preload_scripts(const std::vector<String> &p_paths) {}
 	/* LOADER FUNCTIONS */
 
 	virtual void get_recognized_extensions(List<String> *p_extensions) const = 0;
@@ -349,6 +352,8 @@ public:
 		uint64_t call_count;
 		uint64_t total_time;
 		uint64_t self_time;
+		uint64_t cache_hits; // lookups served by call site caches, if the language has them
+		uint64_t cache_misses;
 	};
 
 	virtual void profiling_start() = 0;
@@ -33,14 +33,16 @@
 #include "core/os/os.h"
 #include "core/print_string.h"
 
+#include <string.h>
+#include <atomic>
+#include <vector>
+
 StaticCString StaticCString::create(const char *p_ptr) {
 	StaticCString scs;
 	scs.ptr = p_ptr;
 	return scs;
 }
 
-StringName::_Data *StringName::_table[STRING_TABLE_LEN];
-
 StringName _scs_create(const char *p_chr) {
 
 	return (p_chr[0] ? StringName(StaticCString::create(p_chr)) : StringName());
@@ -49,15 +51,413 @@ StringName _scs_create(const char *p_chr) {
 bool StringName::configured = false;
 Mutex *StringName::lock = NULL;
 
+// Open addressed intern table. Lookups take no lock: they probe the slots and
+// take a reference on the matching name. Inserting, removing and growing are
+// serialized by StringName::lock. Removed names and replaced tables are retired
+// with the current epoch and freed later, outside of the lock, once every thread
+// that was in a lookup back then has moved on. Nothing ever waits for readers.
+struct StringNameTable {
+
+	typedef StringName::_Data Data;
+
+	enum {
+		DEFAULT_TABLE_SIZE = 1 << 14,
+		MIN_RECLAIM_THRESHOLD = 64
+	};
+
+	struct Slot {
+		std::atomic<Data *> data;
+		std::atomic<uint32_t> hash;
+	};
+
+	struct Table {
+		uint32_t size;
+		uint32_t mask;
+		Slot *slots;
+	};
+
+	// One per thread, reused once the thread exits. Never freed before StringName::cleanup().
+	struct Reader {
+		// Global epoch seen when the current lookup started, 0 outside of lookups.
+		std::atomic<uint64_t> epoch;
+		std::atomic<bool> in_use;
+		Reader *next;
+		// Statistics, updated without read-modify-write so they stay cheap, losing a count now and then is fine.
+		std::atomic<uint64_t> lookups;
+		std::atomic<uint64_t> probes;
+		std::atomic<uint64_t> contention;
+		// Keeps the epochs of different threads off the same cache line.
+		uint8_t padding[64];
+
+		Reader() :
+				epoch(0),
+				in_use(true),
+				next(NULL),
+				lookups(0),
+				probes(0),
+				contention(0) {}
+	};
+
+	struct ReaderHandle {
+		Reader *reader;
+
+		ReaderHandle() :
+				reader(NULL) {}
+		~ReaderHandle() {
+			// The main thread exits after StringName::cleanup() freed the readers.
+			if (reader && table.load(std::memory_order_relaxed)) {
+				reader->in_use.store(false, std::memory_order_release);
+			}
+		}
+	};
+
+	struct ReadScope {
+		Reader &reader;
+
+		ReadScope(Reader &p_reader) :
+				reader(p_reader) {
+			reader.epoch.store(global_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+			// Pairs with the fence in reclaim(): either the reclaimer sees this epoch, or this lookup sees everything retired before the scan unlinked.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+		~ReadScope() {
+			reader.epoch.store(0, std::memory_order_release);
+		}
+	};
+
+	struct Retired {
+		Data *data;
+		Table *table;
+		uint64_t epoch;
+	};
+
+	static Data tombstone;
+	static std::atomic<Table *> table;
+	static uint32_t count;
+	static uint32_t tombstones;
+	static std::atomic<uint64_t> global_epoch;
+	static std::vector<Retired> retired;
+	static uint32_t reclaim_threshold;
+
+	static std::atomic<Reader *> readers;
+	static thread_local ReaderHandle reader_handle;
+
+	static _FORCE_INLINE_ void _count(std::atomic<uint64_t> &p_stat, uint64_t p_amount = 1) {
+		p_stat.store(p_stat.load(std::memory_order_relaxed) + p_amount, std::memory_order_relaxed);
+	}
+
+	static Reader *acquire_reader() {
+
+		for (Reader *r = readers.load(std::memory_order_acquire); r; r = r->next) {
+			bool expected = false;
+			if (!r->in_use.load(std::memory_order_relaxed) && r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+				return r;
+			}
+		}
+
+		Reader *r = memnew(Reader);
+		r->next = readers.load(std::memory_order_relaxed);
+		while (!readers.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+		}
+		return r;
+	}
+
+	static _FORCE_INLINE_ Reader &get_reader() {
+
+		if (unlikely(!reader_handle.reader)) {
+			reader_handle.reader = acquire_reader();
+		}
+		return *reader_handle.reader;
+	}
+
+	static _FORCE_INLINE_ bool name_equals(const Data *p_data, const char *p_name) {
+		return p_data->cname ? strcmp(p_data->cname, p_name) == 0 : p_data->name == p_name;
+	}
+
+	static _FORCE_INLINE_ bool name_equals(const Data *p_data, const CharType *p_name) {
+		return p_data->cname ? String(p_data->cname) == p_name : p_data->name == p_name;
+	}
+
+	static _FORCE_INLINE_ bool name_equals(const Data *p_data, const String &p_name) {
+		return p_data->cname ? p_name == p_data->cname : p_data->name == p_name;
+	}
+
+	static Table *create_table(uint32_t p_size) {
+
+		Table *t = memnew(Table);
+		t->size = p_size;
+		t->mask = p_size - 1;
+		t->slots = (Slot *)memalloc(sizeof(Slot) * p_size);
+		for (uint32_t i = 0; i < p_size; i++) {
+			memnew_placement(&t->slots[i], Slot);
+			t->slots[i].data.store(NULL, std::memory_order_relaxed);
+			t->slots[i].hash.store(0, std::memory_order_relaxed);
+		}
+		return t;
+	}
+
+	static void free_table(Table *p_table) {
+
+		for (uint32_t i = 0; i < p_table->size; i++) {
+			p_table->slots[i].~Slot();
+		}
+		memfree(p_table->slots);
+		memdelete(p_table);
+	}
+
+	static void free_retired(const Retired &p_retired) {
+
+		if (p_retired.data) {
+			memdelete(p_retired.data);
+		} else {
+			free_table(p_retired.table);
+		}
+	}
+
+	// Must be called with the lock held, after unlinking p_data or p_table so new lookups can't reach it.
+	static void retire(Data *p_data, Table *p_table) {
+
+		Retired r;
+		r.data = p_data;
+		r.table = p_table;
+		// Lookups starting after the increment see the epoch past this one, and can't reach what was unlinked.
+		r.epoch = global_epoch.fetch_add(1, std::memory_order_seq_cst);
+		retired.push_back(r);
+	}
+
+	// Must be called with the lock held, tells whether reclaim() is worth calling once the lock is released.
+	static bool should_reclaim() {
+
+		return retired.size() >= reclaim_threshold;
+	}
+
+	// Frees whatever no lookup can still see. Must be called without the lock held and outside of a ReadScope.
+	static void reclaim() {
+
+		// Anything retired after this load has an epoch of at least safe and is kept.
+		uint64_t safe = global_epoch.load(std::memory_order_seq_cst);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		for (Reader *r = readers.load(std::memory_order_acquire); r; r = r->next) {
+			uint64_t e = r->epoch.load(std::memory_order_acquire);
+			if (e && e < safe) {
+				safe = e;
+			}
+		}
+
+		std::vector<Retired> to_free;
+
+		lock();
+		uint32_t kept = 0;
+		for (uint32_t i = 0; i < retired.size(); i++) {
+			if (retired[i].epoch < safe) {
+				to_free.push_back(retired[i]);
+			} else {
+				retired[kept++] = retired[i];
+			}
+		}
+		retired.resize(kept);
+		// A thread stuck in a lookup holds everything back, don't rescan on every retire meanwhile.
+		reclaim_threshold = MAX((uint32_t)MIN_RECLAIM_THRESHOLD, kept * 2);
+		unlock();
+
+		for (uint32_t i = 0; i < to_free.size(); i++) {
+			free_retired(to_free[i]);
+		}
+	}
+
+	// Returns the name with a reference taken, or NULL if not found.
+	template <class N>
+	static Data *lookup(uint32_t p_hash, const N &p_name) {
+
+		Reader &reader = get_reader();
+		ReadScope scope(reader);
+
+		Table *t = table.load(std::memory_order_acquire);
+		uint32_t idx = p_hash & t->mask;
+		uint32_t probes = 1;
+
+		while (true) {
+
+			Slot &slot = t->slots[idx];
+			Data *d = slot.data.load(std::memory_order_acquire);
+			if (!d) {
+				break;
+			}
+
+			// A name whose last reference is being dropped fails ref(), keep probing as if it wasn't there.
+			if (d != &tombstone && slot.hash.load(std::memory_order_relaxed) == p_hash && name_equals(d, p_name) && d->refcount.ref()) {
+				_count(reader.lookups);
+				_count(reader.probes, probes);
+				return d;
+			}
+
+			idx = (idx + 1) & t->mask;
+			probes++;
+		}
+
+		_count(reader.lookups);
+		_count(reader.probes, probes);
+		return NULL;
+	}
+
+	static void lock() {
+
+		if (StringName::lock->try_lock() != OK) {
+			_count(get_reader().contention);
+			StringName::lock->lock();
+		}
+	}
+
+	static void unlock() {
+
+		StringName::lock->unlock();
+	}
+
+	static void rehash(uint32_t p_size) {
+
+		Table *old = table.load(std::memory_order_relaxed);
+		Table *t = create_table(p_size);
+
+		for (uint32_t i = 0; i < old->size; i++) {
+
+			Data *d = old->slots[i].data.load(std::memory_order_relaxed);
+			if (!d || d == &tombstone) {
+				continue;
+			}
+
+			uint32_t idx = d->hash & t->mask;
+			while (t->slots[idx].data.load(std::memory_order_relaxed)) {
+				idx = (idx + 1) & t->mask;
+			}
+			t->slots[idx].hash.store(d->hash, std::memory_order_relaxed);
+			t->slots[idx].data.store(d, std::memory_order_relaxed);
+			d->idx = idx;
+		}
+
+		tombstones = 0;
+		table.store(t, std::memory_order_release);
+
+		retire(NULL, old);
+	}
+
+	// Must be called with the lock held.
+	static void insert(Data *p_data) {
+
+		Table *t = table.load(std::memory_order_relaxed);
+
+		// Keep at most half of the slots used, tombstones included, so probe sequences stay short.
+		if ((count + tombstones + 1) * 2 > t->size) {
+			uint32_t size = t->size;
+			while ((count + 1) * 4 > size) {
+				size <<= 1;
+			}
+			rehash(size);
+			t = table.load(std::memory_order_relaxed);
+		}
+
+		uint32_t idx = p_data->hash & t->mask;
+		while (true) {
+			Data *d = t->slots[idx].data.load(std::memory_order_relaxed);
+			if (!d) {
+				break;
+			}
+			if (d == &tombstone) {
+				tombstones--;
+				break;
+			}
+			idx = (idx + 1) & t->mask;
+		}
+
+		t->slots[idx].hash.store(p_data->hash, std::memory_order_relaxed);
+		t->slots[idx].data.store(p_data, std::memory_order_release);
+		p_data->idx = idx;
+		count++;
+	}
+
+	// Must be called with the lock held, p_data is freed by reclaim() once no lookup can see it.
+	static void remove(Data *p_data) {
+
+		Table *t = table.load(std::memory_order_relaxed);
+		Slot &slot = t->slots[p_data->idx];
+		if (slot.data.load(std::memory_order_relaxed) != p_data) {
+			ERR_PRINT("BUG!");
+			return;
+		}
+
+		slot.data.store(&tombstone, std::memory_order_release);
+		count--;
+		tombstones++;
+
+		retire(p_data, NULL);
+	}
+
+	template <class N>
+	static Data *intern(uint32_t p_hash, const N &p_name, const char *p_static_name) {
+
+		Data *d = lookup(p_hash, p_name);
+		if (d) {
+			return d;
+		}
+
+		lock();
+
+		// Another thread may have added it meanwhile.
+		d = lookup(p_hash, p_name);
+		if (!d) {
+			d = memnew(Data);
+			if (p_static_name) {
+				d->cname = p_static_name;
+			} else {
+				d->name = p_name;
+			}
+			d->refcount.init();
+			d->hash = p_hash;
+			insert(d);
+		}
+
+		bool needs_reclaim = should_reclaim();
+		unlock();
+
+		if (needs_reclaim) {
+			reclaim();
+		}
+
+		return d;
+	}
+
+	template <class N>
+	static Data *search(uint32_t p_hash, const N &p_name) {
+
+		Data *d = lookup(p_hash, p_name);
+		if (d) {
+			return d;
+		}
+
+		// Not found by the lock-free lookup, but it may have been added while the table was growing.
+		lock();
+		d = lookup(p_hash, p_name);
+		unlock();
+
+		return d;
+	}
+};
+
+StringNameTable::Data StringNameTable::tombstone;
+std::atomic<StringNameTable::Table *> StringNameTable::table(NULL);
+uint32_t StringNameTable::count = 0;
+uint32_t StringNameTable::tombstones = 0;
+std::atomic<uint64_t> StringNameTable::global_epoch(1);
+std::vector<StringNameTable::Retired> StringNameTable::retired;
+uint32_t StringNameTable::reclaim_threshold = StringNameTable::MIN_RECLAIM_THRESHOLD;
+std::atomic<StringNameTable::Reader *> StringNameTable::readers(NULL);
+thread_local StringNameTable::ReaderHandle StringNameTable::reader_handle;
+
 void StringName::setup() {
 
 	lock = Mutex::create();
 
 	ERR_FAIL_COND(configured);
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
-
-		_table[i] = NULL;
-	}
+	StringNameTable::table.store(StringNameTable::create_table(StringNameTable::DEFAULT_TABLE_SIZE));
 	configured = true;
 }
 
@@ -65,55 +465,115 @@ void StringName::cleanup() {
 
 	lock->lock();
 
+	// No lookups run anymore, everything retired can go.
+	for (uint32_t i = 0; i < StringNameTable::retired.size(); i++) {
+		StringNameTable::free_retired(StringNameTable::retired[i]);
+	}
+	StringNameTable::retired.clear();
+
+	StringNameTable::Table *t = StringNameTable::table.load();
+
 	int lost_strings = 0;
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
-
-		while (_table[i]) {
-
-			_Data *d = _table[i];
-			lost_strings++;
-			if (OS::get_singleton()->is_stdout_verbose()) {
-				if (d->cname) {
-					print_line("Orphan StringName: " + String(d->cname));
-				} else {
-					print_line("Orphan StringName: " + String(d->name));
-				}
-			}
+	for (uint32_t i = 0; i < t->size; i++) {
 
-			_table[i] = _table[i]->next;
-			memdelete(d);
+		_Data *d = t->slots[i].data.load();
+		if (!d || d == &StringNameTable::tombstone) {
+			continue;
 		}
+
+		lost_strings++;
+		if (OS::get_singleton()->is_stdout_verbose()) {
+			if (d->cname) {
+				print_line("Orphan StringName: " + String(d->cname));
+			} else {
+				print_line("Orphan StringName: " + String(d->name));
+			}
+		}
+
+		memdelete(d);
 	}
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
+
+	StringNameTable::table.store(NULL);
+	StringNameTable::free_table(t);
+	StringNameTable::count = 0;
+	StringNameTable::tombstones = 0;
+
+	StringNameTable::Reader *r = StringNameTable::readers.exchange(NULL);
+	while (r) {
+		StringNameTable::Reader *next = r->next;
+		memdelete(r);
+		r = next;
+	}
+	StringNameTable::reader_handle.reader = NULL;
 	lock->unlock();
 
 	memdelete(lock);
 }
 
+void StringName::reserve(uint32_t p_table_size) {
+
+	ERR_FAIL_COND(!configured);
+
+	StringNameTable::lock();
+
+	uint32_t size = next_power_of_2(p_table_size);
+	StringNameTable::Table *t = StringNameTable::table.load();
+	if (size > t->size) {
+		StringNameTable::rehash(size);
+	}
+
+	bool needs_reclaim = StringNameTable::should_reclaim();
+	StringNameTable::unlock();
+
+	if (needs_reclaim) {
+		StringNameTable::reclaim();
+	}
+}
+
+uint32_t StringName::get_interned_count() {
+
+	return StringNameTable::count;
+}
+
+float StringName::get_average_probe_length() {
+
+	uint64_t lookups = 0;
+	uint64_t probes = 0;
+	for (StringNameTable::Reader *r = StringNameTable::readers.load(std::memory_order_acquire); r; r = r->next) {
+		lookups += r->lookups.load(std::memory_order_relaxed);
+		probes += r->probes.load(std::memory_order_relaxed);
+	}
+
+	return lookups ? float(double(probes) / lookups) : 0;
+}
+
+uint64_t StringName::get_lock_contention_count() {
+
+	uint64_t contention = 0;
+	for (StringNameTable::Reader *r = StringNameTable::readers.load(std::memory_order_acquire); r; r = r->next) {
+		contention += r->contention.load(std::memory_order_relaxed);
+	}
+
+	return contention;
+}
+
 void StringName::unref() {
 
 	ERR_FAIL_COND(!configured);
 
 	if (_data && _data->refcount.unref()) {
 
-		lock->lock();
+		StringNameTable::lock();
+		StringNameTable::remove(_data);
+		bool needs_reclaim = StringNameTable::should_reclaim();
+		StringNameTable::unlock();
 
-		if (_data->prev) {
-			_data->prev->next = _data->next;
-		} else {
-			if (_table[_data->idx] != _data) {
-				ERR_PRINT("BUG!");
-			}
-			_table[_data->idx] = _data->next;
+		if (needs_reclaim) {
+			StringNameTable::reclaim();
 		}
-
-		if (_data->next) {
-			_data->next->prev = _data->prev;
-		}
-		memdelete(_data);
-		lock->unlock();
 	}
 
 	_data = NULL;
@@ -184,43 +644,7 @@ StringName::StringName(const char *p_name) {
 	if (!p_name || p_name[0] == 0)
 		return; //empty, ignore
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = StringNameTable::intern(String::hash(p_name), p_name, NULL);
 }
 
 StringName::StringName(const StaticCString &p_static_string) {
@@ -231,43 +655,7 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_static_string.ptr);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = StringNameTable::intern(String::hash(p_static_string.ptr), p_static_string.ptr, p_static_string.ptr);
 }
 
 StringName::StringName(const String &p_name) {
@@ -279,42 +667,7 @@ StringName::StringName(const String &p_name) {
 	if (p_name == String())
 		return;
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = StringNameTable::intern(p_name.hash(), p_name, NULL);
 }
 
 StringName StringName::search(const char *p_name) {
@@ -325,29 +678,12 @@ StringName StringName::search(const char *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+	_Data *_data = StringNameTable::search(String::hash(p_name), p_name);
 
+	if (_data) {
 		return StringName(_data);
 	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -359,56 +695,24 @@ StringName StringName::search(const CharType *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
+	_Data *_data = StringNameTable::search(String::hash(p_name), p_name);
 
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+	if (_data) {
 		return StringName(_data);
 	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 StringName StringName::search(const String &p_name) {
 
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
+	_Data *_data = StringNameTable::search(p_name.hash(), p_name);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name())
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+	if (_data) {
 		return StringName(_data);
 	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -43,12 +43,7 @@ struct StaticCString {
 
 class StringName {
 
-	enum {
-
-		STRING_TABLE_BITS = 12,
-		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
-	};
+	friend struct StringNameTable;
 
 	struct _Data {
 		SafeRefCount refcount;
@@ -56,20 +51,15 @@ class StringName {
 		String name;
 
 		String get_name() const { return cname ? String(cname) : name; }
-		int idx;
+		uint32_t idx;
 		uint32_t hash;
-		_Data *prev;
-		_Data *next;
 		_Data() {
 			cname = NULL;
-			next = prev = NULL;
 			idx = 0;
 			hash = 0;
 		}
 	};
 
-	static _Data *_table[STRING_TABLE_LEN];
-
 	_Data *_data;
 
 	union _HashUnion {
@@ -132,6 +122,12 @@ public:
 	static StringName search(const CharType *p_name);
 	static StringName search(const String &p_name);
 
+	static void reserve(uint32_t p_table_size);
+
+	static uint32_t get_interned_count();
+	static float get_average_probe_length();
+	static uint64_t get_lock_contention_count();
+
 	struct AlphCompare {
 
 		_FORCE_INLINE_ bool operator()(const StringName &l, const StringName &r) const {
@@ -1843,6 +1843,39 @@ inline DA _convert_array_from_variant(const Variant &p_variant) {
 	}
 }
 
+template <class T>
+inline std::vector<T> _convert_pool_vector_to_std_vector(const PoolVector<T> &p_from) {
+
+	// Lock once and copy the whole range, instead of going through
+	// PoolVector::operator[] (which takes a read lock per element).
+	int len = p_from.size();
+	if (len == 0)
+		return std::vector<T>();
+
+	typename PoolVector<T>::Read r = p_from.read();
+	return std::vector<T>(r.ptr(), r.ptr() + len);
+}
+
+template <class T, class S>
+inline PoolVector<T> _convert_std_vector_to_pool_vector(const std::vector<S> &p_from) {
+
+	// Same as above: a single write lock (and COW check) for the whole range,
+	// instead of PoolVector::set() per element.
+	PoolVector<T> to;
+	int len = p_from.size();
+	if (len == 0)
+		return to;
+
+	to.resize(len);
+	typename PoolVector<T>::Write w = to.write();
+	T *dst = w.ptr();
+	const S *src = p_from.data();
+	for (int i = 0; i < len; i++)
+		dst[i] = src[i];
+
+	return to;
+}
+
 Variant::operator Array() const {
 
 	if (type == ARRAY)
@@ -1917,18 +1950,7 @@ Variant::operator std::vector<RID>() const {
 
 Variant::operator std::vector<Vector2>() const {
 
-	PoolVector<Vector2> from = operator PoolVector<Vector2>();
-	std::vector<Vector2> to;
-	int len = from.size();
-	if (len == 0)
-		return std::vector<Vector2>();
-	to.resize(len);
-	PoolVector<Vector2>::Read r = from.read();
-	Vector2 *w = to.data();
-	for (int i = 0; i < len; i++) {
-		w[i] = r[i];
-	}
-	return to;
+	return _convert_pool_vector_to_std_vector<Vector2>(operator PoolVector<Vector2>());
 }
 
 Variant::operator PoolVector<Plane>() const {
@@ -1996,92 +2018,39 @@ Variant::operator std::vector<Variant>() const {
 
 Variant::operator std::vector<uint8_t>() const {
 
-	PoolVector<uint8_t> from = operator PoolVector<uint8_t>();
-	std::vector<uint8_t> to;
-	int len = from.size();
-	to.resize(len);
-	for (int i = 0; i < len; i++) {
-		to[i] = from[i];
-	}
-	return to;
+	return _convert_pool_vector_to_std_vector<uint8_t>(operator PoolVector<uint8_t>());
 }
 Variant::operator std::vector<int>() const {
 
-	PoolVector<int> from = operator PoolVector<int>();
-	std::vector<int> to;
-	int len = from.size();
-	to.resize(len);
-	for (int i = 0; i < len; i++) {
-		to[i] = from[i];
-	}
-	return to;
+	return _convert_pool_vector_to_std_vector<int>(operator PoolVector<int>());
 }
 Variant::operator std::vector<real_t>() const {
 
-	PoolVector<real_t> from = operator PoolVector<real_t>();
-	std::vector<real_t> to;
-	int len = from.size();
-	to.resize(len);
-	for (int i = 0; i < len; i++) {
-		to[i] = from[i];
-	}
-	return to;
+	return _convert_pool_vector_to_std_vector<real_t>(operator PoolVector<real_t>());
 }
 
 Variant::operator std::vector<String>() const {
 
-	PoolVector<String> from = operator PoolVector<String>();
-	std::vector<String> to;
-	int len = from.size();
-	to.resize(len);
-	for (int i = 0; i < len; i++) {
-		to[i] = from[i];
-	}
-	return to;
+	return _convert_pool_vector_to_std_vector<String>(operator PoolVector<String>());
 }
 Variant::operator std::vector<StringName>() const {
 
 	PoolVector<String> from = operator PoolVector<String>();
-	std::vector<StringName> to;
 	int len = from.size();
-	to.resize(len);
-	for (int i = 0; i < len; i++) {
-		to[i] = from[i];
-	}
-	return to;
+	if (len == 0)
+		return std::vector<StringName>();
+
+	PoolVector<String>::Read r = from.read();
+	return std::vector<StringName>(r.ptr(), r.ptr() + len);
 }
 
 Variant::operator std::vector<Vector3>() const {
 
-	PoolVector<Vector3> from = operator PoolVector<Vector3>();
-	std::vector<Vector3> to;
-	int len = from.size();
-	if (len == 0)
-		return std::vector<Vector3>();
-	to.resize(len);
-	PoolVector<Vector3>::Read r = from.read();
-	Vector3 *w = to.data();
-	for (int i = 0; i < len; i++) {
-
-		w[i] = r[i];
-	}
-	return to;
+	return _convert_pool_vector_to_std_vector<Vector3>(operator PoolVector<Vector3>());
 }
 Variant::operator std::vector<Color>() const {
 
-	PoolVector<Color> from = operator PoolVector<Color>();
-	std::vector<Color> to;
-	int len = from.size();
-	if (len == 0)
-		return std::vector<Color>();
-	to.resize(len);
-	PoolVector<Color>::Read r = from.read();
-	Color *w = to.data();
-	for (int i = 0; i < len; i++) {
-
-		w[i] = r[i];
-	}
-	return to;
+	return _convert_pool_vector_to_std_vector<Color>(operator PoolVector<Color>());
 }
 
 Variant::operator Margin() const {
@@ -2350,18 +2319,8 @@ Variant::Variant(const std::vector<RID> &p_array) {
 
 Variant::Variant(const std::vector<Vector2> &p_array) {
 
-	type = NIL;
-	PoolVector<Vector2> v;
-	auto len = p_array.size();
-	if (len > 0) {
-		v.resize(len);
-		PoolVector<Vector2>::Write w = v.write();
-		const Vector2 *r = p_array.data();
-
-		for (decltype(len) i = 0; i < len; ++i)
-			w[i] = r[i];
-	}
-	*this = v;
+	type = POOL_VECTOR2_ARRAY;
+	memnew_placement(_data._mem, PoolVector<Vector2>(_convert_std_vector_to_pool_vector<Vector2>(p_array)));
 }
 
 Variant::Variant(const PoolVector<uint8_t> &p_raw_array) {
@@ -2438,84 +2397,44 @@ Variant::Variant(const std::vector<Variant> &p_array) {
 
 Variant::Variant(const std::vector<uint8_t> &p_array) {
 
-	type = NIL;
-	PoolVector<uint8_t> v;
-	int len = p_array.size();
-	v.resize(len);
-	for (int i = 0; i < len; i++)
-		v.set(i, p_array[i]);
-	*this = v;
+	type = POOL_BYTE_ARRAY;
+	memnew_placement(_data._mem, PoolVector<uint8_t>(_convert_std_vector_to_pool_vector<uint8_t>(p_array)));
 }
 
 Variant::Variant(const std::vector<int> &p_array) {
 
-	type = NIL;
-	PoolVector<int> v;
-	int len = p_array.size();
-	v.resize(len);
-	for (int i = 0; i < len; i++)
-		v.set(i, p_array[i]);
-	*this = v;
+	type = POOL_INT_ARRAY;
+	memnew_placement(_data._mem, PoolVector<int>(_convert_std_vector_to_pool_vector<int>(p_array)));
 }
 
 Variant::Variant(const std::vector<real_t> &p_array) {
 
-	type = NIL;
-	PoolVector<real_t> v;
-	int len = p_array.size();
-	v.resize(len);
-	for (int i = 0; i < len; i++)
-		v.set(i, p_array[i]);
-	*this = v;
+	type = POOL_REAL_ARRAY;
+	memnew_placement(_data._mem, PoolVector<real_t>(_convert_std_vector_to_pool_vector<real_t>(p_array)));
 }
 
 Variant::Variant(const std::vector<String> &p_array) {
 
-	type = NIL;
-	PoolVector<String> v;
-	int len = p_array.size();
-	v.resize(len);
-	for (int i = 0; i < len; i++)
-		v.set(i, p_array[i]);
-	*this = v;
+	type = POOL_STRING_ARRAY;
+	memnew_placement(_data._mem, PoolVector<String>(_convert_std_vector_to_pool_vector<String>(p_array)));
 }
 
 Variant::Variant(const std::vector<StringName> &p_array) {
 
-	type = NIL;
-	PoolVector<String> v;
-	int len = p_array.size();
-	v.resize(len);
-	for (int i = 0; i < len; i++)
-		v.set(i, p_array[i]);
-	*this = v;
+	type = POOL_STRING_ARRAY;
+	memnew_placement(_data._mem, PoolVector<String>(_convert_std_vector_to_pool_vector<String>(p_array)));
 }
 
 Variant::Variant(const std::vector<Vector3> &p_array) {
 
-	type = NIL;
-	PoolVector<Vector3> v;
-	int len = p_array.size();
-	if (len > 0) {
-		v.resize(len);
-		PoolVector<Vector3>::Write w = v.write();
-		const Vector3 *r = p_array.data();
-
-		for (int i = 0; i < len; i++)
-			w[i] = r[i];
-	}
-	*this = v;
+	type = POOL_VECTOR3_ARRAY;
+	memnew_placement(_data._mem, PoolVector<Vector3>(_convert_std_vector_to_pool_vector<Vector3>(p_array)));
 }
 
 Variant::Variant(const std::vector<Color> &p_array) {
 
-	type = NIL;
-	PoolVector<Color> v;
-	int len = p_array.size();
-	v.resize(len);
-	for (int i = 0; i < len; i++)
-		v.set(i, p_array[i]);
-	*this = v;
+	type = POOL_COLOR_ARRAY;
+	memnew_placement(_data._mem, PoolVector<Color>(_convert_std_vector_to_pool_vector<Color>(p_array)));
 }
 
 void Variant::operator=(const Variant &p_variant) {
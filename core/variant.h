@@ -122,6 +122,7 @@ public:
 
 private:
 	friend struct _VariantCall;
+	friend class VariantInternal;
 	// Variant takes 20 bytes when real_t is float, and 36 if double
 	// it only allocates extra memory for aabb/matrix.
 
@@ -342,6 +343,21 @@ public:
 		return res;
 	}
 
+	// Same results as evaluate(), for operands of the types it was obtained for. r_ret may be one of them.
+	typedef void (*OperatorEvaluator)(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid);
+
+private:
+	friend void register_variant_operators();
+	static OperatorEvaluator operator_evaluators[OP_MAX][VARIANT_MAX][VARIANT_MAX];
+
+public:
+	// Callers knowing the operand types ahead (e.g. a script call site) can resolve the evaluator once and
+	// skip the dispatch in evaluate(). Unary operators ignore p_type_b. Common int, float, bool and vector
+	// operations get a dedicated function, the others go through evaluate().
+	static _FORCE_INLINE_ OperatorEvaluator get_operator_evaluator(Operator p_op, Type p_type_a, Type p_type_b) {
+		return operator_evaluators[p_op][p_type_a][p_type_b];
+	}
+
 	void zero();
 	Variant duplicate(bool deep = false) const;
 	static void blend(const Variant &a, const Variant &b, float c, Variant &r_dst);
@@ -365,6 +381,12 @@ public:
 	Variant call(const StringName &p_method, const Variant **p_args, int p_argcount, CallError &r_error);
 	Variant call(const StringName &p_method, const Variant &p_arg1 = Variant(), const Variant &p_arg2 = Variant(), const Variant &p_arg3 = Variant(), const Variant &p_arg4 = Variant(), const Variant &p_arg5 = Variant());
 
+	// Resolve a builtin method once (e.g. when compiling a call site) and call it by index afterwards.
+	// The index is only valid for the type it was resolved for, -1 means no such method.
+	static int get_method_index(Variant::Type p_type, const StringName &p_method);
+	static StringName get_method_name_by_index(Variant::Type p_type, int p_index);
+	void call_ptr_by_index(int p_method_index, const Variant **p_args, int p_argcount, Variant *r_ret, CallError &r_error);
+
 	static String get_call_error_text(Object *p_base, const StringName &p_method, const Variant **p_argptrs, int p_argcount, const Variant::CallError &ce);
 
 	static Variant construct(const Variant::Type, const Variant **p_args, int p_argcount, CallError &r_error, bool p_strict = true);
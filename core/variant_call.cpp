@@ -126,6 +126,72 @@ struct _VariantCall {
 	struct TypeFunc {
 
 		Map<StringName, FuncData> functions;
+
+		// Flat, open addressed (linear probing) table keyed by the StringName
+		// data pointer, built once all methods are registered. Lookups are a
+		// pointer hash and compare instead of a tree walk.
+		struct Slot {
+			const void *key;
+			int index;
+		};
+
+		std::vector<Slot> table;
+		uint32_t table_mask;
+		std::vector<FuncData *> methods; // by method index
+		std::vector<StringName> method_names;
+
+		TypeFunc() { table_mask = 0; }
+
+		_FORCE_INLINE_ static uint32_t hash_key(const void *p_key) {
+			uint64_t k = (uint64_t)(uintptr_t)p_key;
+			return uint32_t((k >> 4) * 0x9E3779B97F4A7C15ULL >> 32);
+		}
+
+		_FORCE_INLINE_ int find(const StringName &p_name) const {
+
+			const void *key = p_name.data_unique_pointer();
+			if (!key || table.empty())
+				return -1;
+
+			uint32_t pos = hash_key(key) & table_mask;
+			while (true) {
+				const Slot &slot = table[pos];
+				if (slot.key == key)
+					return slot.index;
+				if (!slot.key)
+					return -1;
+				pos = (pos + 1) & table_mask;
+			}
+		}
+
+		void build_table() {
+
+			methods.clear();
+			method_names.clear();
+			table.clear();
+
+			uint32_t size = 8;
+			while (size < uint32_t(functions.size()) * 2) // keep the load factor at or below 0.5
+				size <<= 1;
+
+			Slot empty;
+			empty.key = NULL;
+			empty.index = -1;
+			table.resize(size, empty);
+			table_mask = size - 1;
+
+			for (Map<StringName, FuncData>::Element *E = functions.front(); E; E = E->next()) {
+
+				uint32_t pos = hash_key(E->key().data_unique_pointer()) & table_mask;
+				while (table[pos].key)
+					pos = (pos + 1) & table_mask;
+
+				table[pos].key = E->key().data_unique_pointer();
+				table[pos].index = methods.size();
+				methods.push_back(&E->get());
+				method_names.push_back(E->key());
+			}
+		}
 	};
 
 	static TypeFunc *type_funcs;
@@ -1101,21 +1167,52 @@ void Variant::call_ptr(const StringName &p_method, const Variant **p_args, int p
 
 		r_error.error = Variant::CallError::CALL_OK;
 
-		Map<StringName, _VariantCall::FuncData>::Element *E = _VariantCall::type_funcs[type].functions.find(p_method);
-#ifdef DEBUG_ENABLED
-		if (!E) {
+		const _VariantCall::TypeFunc &tf = _VariantCall::type_funcs[type];
+		int index = tf.find(p_method);
+		if (index < 0) {
 			r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
 			return;
 		}
-#endif
-		_VariantCall::FuncData &funcdata = E->get();
-		funcdata.call(ret, *this, p_args, p_argcount, r_error);
+
+		tf.methods[index]->call(ret, *this, p_args, p_argcount, r_error);
 	}
 
 	if (r_error.error == Variant::CallError::CALL_OK && r_ret)
 		*r_ret = ret;
 }
 
+int Variant::get_method_index(Variant::Type p_type, const StringName &p_method) {
+
+	ERR_FAIL_INDEX_V(p_type, VARIANT_MAX, -1);
+	return _VariantCall::type_funcs[p_type].find(p_method);
+}
+
+StringName Variant::get_method_name_by_index(Variant::Type p_type, int p_index) {
+
+	ERR_FAIL_INDEX_V(p_type, VARIANT_MAX, StringName());
+	const _VariantCall::TypeFunc &tf = _VariantCall::type_funcs[p_type];
+	ERR_FAIL_INDEX_V(p_index, (int)tf.methods.size(), StringName());
+
+	return tf.method_names[p_index];
+}
+
+void Variant::call_ptr_by_index(int p_method_index, const Variant **p_args, int p_argcount, Variant *r_ret, CallError &r_error) {
+
+	const _VariantCall::TypeFunc &tf = _VariantCall::type_funcs[type];
+	if (unlikely(p_method_index < 0 || p_method_index >= (int)tf.methods.size())) {
+		r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
+		return;
+	}
+
+	r_error.error = Variant::CallError::CALL_OK;
+
+	Variant ret;
+	tf.methods[p_method_index]->call(ret, *this, p_args, p_argcount, r_error);
+
+	if (r_error.error == Variant::CallError::CALL_OK && r_ret)
+		*r_ret = ret;
+}
+
 #define VCALL(m_type, m_method) _VariantCall::_call_##m_type##_##m_method
 
 Variant Variant::construct(const Variant::Type p_type, const Variant **p_args, int p_argcount, CallError &r_error, bool p_strict) {
@@ -1275,7 +1372,7 @@ bool Variant::has_method(const StringName &p_method) const {
 	}
 
 	const _VariantCall::TypeFunc &tf = _VariantCall::type_funcs[type];
-	return tf.functions.has(p_method);
+	return tf.find(p_method) >= 0;
 }
 
 std::vector<Variant::Type> Variant::get_method_argument_types(Variant::Type p_type, const StringName &p_method) {
@@ -1926,6 +2023,10 @@ void register_variant_methods() {
 	ADDFUNC1R(TRANSFORM, NIL, Transform, xform, NIL, "v", varray());
 	ADDFUNC1R(TRANSFORM, NIL, Transform, xform_inv, NIL, "v", varray());
 
+	for (int i = 0; i < Variant::VARIANT_MAX; i++) {
+		_VariantCall::type_funcs[i].build_table();
+	}
+
 	/* REGISTER CONSTRUCTORS */
 
 	_VariantCall::add_constructor(_VariantCall::Vector2_init1, Variant::VECTOR2, "x", Variant::REAL, "y", Variant::REAL);
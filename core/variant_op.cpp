@@ -33,6 +33,7 @@
 #include "core/core_string_names.h"
 #include "core/object.h"
 #include "core/script_language.h"
+#include "core/variant_internal.h"
 
 #define CASE_TYPE_ALL(PREFIX, OP) \
 	CASE_TYPE(PREFIX, OP, INT)    \
@@ -1219,6 +1220,224 @@ void Variant::evaluate(const Operator &p_op, const Variant &p_a,
 	}
 }
 
+// Dedicated evaluators, see Variant::get_operator_evaluator(). Operands are read before the
+// result is written, as it may overwrite one of them.
+
+typedef VariantInternal VI;
+
+#define EVALUATOR_BINARY(m_name, m_get_a, m_get_b, m_op, m_ret_type, m_get_ret)                 \
+	static void m_name(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) { \
+		auto ret = *VI::m_get_a(&p_a) m_op *VI::m_get_b(&p_b);                                  \
+		VI::set_pod_type(&r_ret, Variant::m_ret_type);                                          \
+		*VI::m_get_ret(&r_ret) = ret;                                                           \
+		r_valid = true;                                                                         \
+	}
+
+// Operands swapped, for types only defining < and <=.
+#define EVALUATOR_BINARY_REV(m_name, m_get_a, m_get_b, m_op, m_ret_type, m_get_ret)             \
+	static void m_name(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) { \
+		auto ret = *VI::m_get_b(&p_b) m_op *VI::m_get_a(&p_a);                                  \
+		VI::set_pod_type(&r_ret, Variant::m_ret_type);                                          \
+		*VI::m_get_ret(&r_ret) = ret;                                                           \
+		r_valid = true;                                                                         \
+	}
+
+// Division by zero is left to evaluate(), which reports it.
+#define EVALUATOR_DIVISION(m_name, m_op_name, m_get_a, m_get_b, m_op, m_ret_type, m_get_ret)    \
+	static void m_name(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) { \
+		if (*VI::m_get_b(&p_b) == 0) {                                                          \
+			Variant::evaluate(Variant::m_op_name, p_a, p_b, r_ret, r_valid);                    \
+			return;                                                                             \
+		}                                                                                       \
+		auto ret = *VI::m_get_a(&p_a) m_op *VI::m_get_b(&p_b);                                  \
+		VI::set_pod_type(&r_ret, Variant::m_ret_type);                                          \
+		*VI::m_get_ret(&r_ret) = ret;                                                           \
+		r_valid = true;                                                                         \
+	}
+
+#define EVALUATOR_UNARY(m_name, m_get, m_op, m_ret_type, m_get_ret)                             \
+	static void m_name(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) { \
+		auto ret = m_op *VI::m_get(&p_a);                                                       \
+		VI::set_pod_type(&r_ret, Variant::m_ret_type);                                          \
+		*VI::m_get_ret(&r_ret) = ret;                                                           \
+		r_valid = true;                                                                         \
+	}
+
+// int and float arithmetic, mixed operands give a float.
+#define EVALUATOR_NUMBER_OPS(m_suffix, m_get_a, m_get_b, m_ret_type, m_get_ret)                   \
+	EVALUATOR_BINARY(_add_##m_suffix, m_get_a, m_get_b, +, m_ret_type, m_get_ret)                 \
+	EVALUATOR_BINARY(_subtract_##m_suffix, m_get_a, m_get_b, -, m_ret_type, m_get_ret)            \
+	EVALUATOR_BINARY(_multiply_##m_suffix, m_get_a, m_get_b, *, m_ret_type, m_get_ret)            \
+	EVALUATOR_DIVISION(_divide_##m_suffix, OP_DIVIDE, m_get_a, m_get_b, /, m_ret_type, m_get_ret) \
+	EVALUATOR_BINARY(_equal_##m_suffix, m_get_a, m_get_b, ==, BOOL, get_bool)                     \
+	EVALUATOR_BINARY(_not_equal_##m_suffix, m_get_a, m_get_b, !=, BOOL, get_bool)                 \
+	EVALUATOR_BINARY(_less_##m_suffix, m_get_a, m_get_b, <, BOOL, get_bool)                       \
+	EVALUATOR_BINARY(_less_equal_##m_suffix, m_get_a, m_get_b, <=, BOOL, get_bool)                \
+	EVALUATOR_BINARY(_greater_##m_suffix, m_get_a, m_get_b, >, BOOL, get_bool)                    \
+	EVALUATOR_BINARY(_greater_equal_##m_suffix, m_get_a, m_get_b, >=, BOOL, get_bool)
+
+EVALUATOR_NUMBER_OPS(int_int, get_int, get_int, INT, get_int)
+EVALUATOR_NUMBER_OPS(int_real, get_int, get_real, REAL, get_real)
+EVALUATOR_NUMBER_OPS(real_int, get_real, get_int, REAL, get_real)
+EVALUATOR_NUMBER_OPS(real_real, get_real, get_real, REAL, get_real)
+
+EVALUATOR_DIVISION(_module_int_int, OP_MODULE, get_int, get_int, %, INT, get_int)
+EVALUATOR_BINARY(_shift_left_int_int, get_int, get_int, <<, INT, get_int)
+EVALUATOR_BINARY(_shift_right_int_int, get_int, get_int, >>, INT, get_int)
+EVALUATOR_BINARY(_bit_and_int_int, get_int, get_int, &, INT, get_int)
+EVALUATOR_BINARY(_bit_or_int_int, get_int, get_int, |, INT, get_int)
+EVALUATOR_BINARY(_bit_xor_int_int, get_int, get_int, ^, INT, get_int)
+EVALUATOR_UNARY(_bit_negate_int, get_int, ~, INT, get_int)
+EVALUATOR_UNARY(_negate_int, get_int, -, INT, get_int)
+EVALUATOR_UNARY(_positive_int, get_int, , INT, get_int)
+EVALUATOR_UNARY(_negate_real, get_real, -, REAL, get_real)
+EVALUATOR_UNARY(_positive_real, get_real, , REAL, get_real)
+
+EVALUATOR_BINARY(_equal_bool_bool, get_bool, get_bool, ==, BOOL, get_bool)
+EVALUATOR_BINARY(_not_equal_bool_bool, get_bool, get_bool, !=, BOOL, get_bool)
+EVALUATOR_BINARY(_and_bool_bool, get_bool, get_bool, &&, BOOL, get_bool)
+EVALUATOR_BINARY(_or_bool_bool, get_bool, get_bool, ||, BOOL, get_bool)
+EVALUATOR_BINARY(_xor_bool_bool, get_bool, get_bool, !=, BOOL, get_bool)
+EVALUATOR_UNARY(_not_bool, get_bool, !, BOOL, get_bool)
+
+// Vector math, not checked for division by zero (same as evaluate()).
+#define EVALUATOR_VECTOR_OPS(m_suffix, m_type, m_get)                                 \
+	EVALUATOR_BINARY(_add_##m_suffix, m_get, m_get, +, m_type, m_get)                 \
+	EVALUATOR_BINARY(_subtract_##m_suffix, m_get, m_get, -, m_type, m_get)            \
+	EVALUATOR_BINARY(_multiply_##m_suffix, m_get, m_get, *, m_type, m_get)            \
+	EVALUATOR_BINARY(_divide_##m_suffix, m_get, m_get, /, m_type, m_get)              \
+	EVALUATOR_BINARY(_multiply_##m_suffix##_int, m_get, get_int, *, m_type, m_get)    \
+	EVALUATOR_BINARY(_multiply_##m_suffix##_real, m_get, get_real, *, m_type, m_get)  \
+	EVALUATOR_BINARY(_multiply_int_##m_suffix, get_int, m_get, *, m_type, m_get)      \
+	EVALUATOR_BINARY(_multiply_real_##m_suffix, get_real, m_get, *, m_type, m_get)    \
+	EVALUATOR_BINARY(_divide_##m_suffix##_int, m_get, get_int, /, m_type, m_get)      \
+	EVALUATOR_BINARY(_divide_##m_suffix##_real, m_get, get_real, /, m_type, m_get)    \
+	EVALUATOR_BINARY(_equal_##m_suffix, m_get, m_get, ==, BOOL, get_bool)             \
+	EVALUATOR_BINARY(_not_equal_##m_suffix, m_get, m_get, !=, BOOL, get_bool)         \
+	EVALUATOR_BINARY(_less_##m_suffix, m_get, m_get, <, BOOL, get_bool)               \
+	EVALUATOR_BINARY(_less_equal_##m_suffix, m_get, m_get, <=, BOOL, get_bool)        \
+	EVALUATOR_BINARY_REV(_greater_##m_suffix, m_get, m_get, <, BOOL, get_bool)        \
+	EVALUATOR_BINARY_REV(_greater_equal_##m_suffix, m_get, m_get, <=, BOOL, get_bool) \
+	EVALUATOR_UNARY(_negate_##m_suffix, m_get, -, m_type, m_get)                      \
+	EVALUATOR_UNARY(_positive_##m_suffix, m_get, , m_type, m_get)
+
+EVALUATOR_VECTOR_OPS(vector2, VECTOR2, get_vector2)
+EVALUATOR_VECTOR_OPS(vector3, VECTOR3, get_vector3)
+
+template <Variant::Operator op>
+static void _evaluate_generic(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) {
+
+	Variant::evaluate(op, p_a, p_b, r_ret, r_valid);
+}
+
+Variant::OperatorEvaluator Variant::operator_evaluators[Variant::OP_MAX][Variant::VARIANT_MAX][Variant::VARIANT_MAX];
+
+#define REGISTER_BINARY(m_op, m_type_a, m_type_b, m_func) \
+	Variant::operator_evaluators[Variant::m_op][Variant::m_type_a][Variant::m_type_b] = m_func;
+
+#define REGISTER_UNARY(m_op, m_type, m_func)                                      \
+	for (int i = 0; i < Variant::VARIANT_MAX; i++) {                              \
+		Variant::operator_evaluators[Variant::m_op][Variant::m_type][i] = m_func; \
+	}
+
+#define REGISTER_NUMBER_OPS(m_suffix, m_type_a, m_type_b)                      \
+	REGISTER_BINARY(OP_ADD, m_type_a, m_type_b, _add_##m_suffix)               \
+	REGISTER_BINARY(OP_SUBTRACT, m_type_a, m_type_b, _subtract_##m_suffix)     \
+	REGISTER_BINARY(OP_MULTIPLY, m_type_a, m_type_b, _multiply_##m_suffix)     \
+	REGISTER_BINARY(OP_DIVIDE, m_type_a, m_type_b, _divide_##m_suffix)         \
+	REGISTER_BINARY(OP_EQUAL, m_type_a, m_type_b, _equal_##m_suffix)           \
+	REGISTER_BINARY(OP_NOT_EQUAL, m_type_a, m_type_b, _not_equal_##m_suffix)   \
+	REGISTER_BINARY(OP_LESS, m_type_a, m_type_b, _less_##m_suffix)             \
+	REGISTER_BINARY(OP_LESS_EQUAL, m_type_a, m_type_b, _less_equal_##m_suffix) \
+	REGISTER_BINARY(OP_GREATER, m_type_a, m_type_b, _greater_##m_suffix)       \
+	REGISTER_BINARY(OP_GREATER_EQUAL, m_type_a, m_type_b, _greater_equal_##m_suffix)
+
+#define REGISTER_VECTOR_OPS(m_suffix, m_type)                                    \
+	REGISTER_BINARY(OP_ADD, m_type, m_type, _add_##m_suffix)                     \
+	REGISTER_BINARY(OP_SUBTRACT, m_type, m_type, _subtract_##m_suffix)           \
+	REGISTER_BINARY(OP_MULTIPLY, m_type, m_type, _multiply_##m_suffix)           \
+	REGISTER_BINARY(OP_DIVIDE, m_type, m_type, _divide_##m_suffix)               \
+	REGISTER_BINARY(OP_MULTIPLY, m_type, INT, _multiply_##m_suffix##_int)        \
+	REGISTER_BINARY(OP_MULTIPLY, m_type, REAL, _multiply_##m_suffix##_real)      \
+	REGISTER_BINARY(OP_MULTIPLY, INT, m_type, _multiply_int_##m_suffix)          \
+	REGISTER_BINARY(OP_MULTIPLY, REAL, m_type, _multiply_real_##m_suffix)        \
+	REGISTER_BINARY(OP_DIVIDE, m_type, INT, _divide_##m_suffix##_int)            \
+	REGISTER_BINARY(OP_DIVIDE, m_type, REAL, _divide_##m_suffix##_real)          \
+	REGISTER_BINARY(OP_EQUAL, m_type, m_type, _equal_##m_suffix)                 \
+	REGISTER_BINARY(OP_NOT_EQUAL, m_type, m_type, _not_equal_##m_suffix)         \
+	REGISTER_BINARY(OP_LESS, m_type, m_type, _less_##m_suffix)                   \
+	REGISTER_BINARY(OP_LESS_EQUAL, m_type, m_type, _less_equal_##m_suffix)       \
+	REGISTER_BINARY(OP_GREATER, m_type, m_type, _greater_##m_suffix)             \
+	REGISTER_BINARY(OP_GREATER_EQUAL, m_type, m_type, _greater_equal_##m_suffix) \
+	REGISTER_UNARY(OP_NEGATE, m_type, _negate_##m_suffix)                        \
+	REGISTER_UNARY(OP_POSITIVE, m_type, _positive_##m_suffix)
+
+void register_variant_operators() {
+
+	static const Variant::OperatorEvaluator generic_evaluators[Variant::OP_MAX] = {
+		_evaluate_generic<Variant::OP_EQUAL>,
+		_evaluate_generic<Variant::OP_NOT_EQUAL>,
+		_evaluate_generic<Variant::OP_LESS>,
+		_evaluate_generic<Variant::OP_LESS_EQUAL>,
+		_evaluate_generic<Variant::OP_GREATER>,
+		_evaluate_generic<Variant::OP_GREATER_EQUAL>,
+		_evaluate_generic<Variant::OP_ADD>,
+		_evaluate_generic<Variant::OP_SUBTRACT>,
+		_evaluate_generic<Variant::OP_MULTIPLY>,
+		_evaluate_generic<Variant::OP_DIVIDE>,
+		_evaluate_generic<Variant::OP_NEGATE>,
+		_evaluate_generic<Variant::OP_POSITIVE>,
+		_evaluate_generic<Variant::OP_MODULE>,
+		_evaluate_generic<Variant::OP_STRING_CONCAT>,
+		_evaluate_generic<Variant::OP_SHIFT_LEFT>,
+		_evaluate_generic<Variant::OP_SHIFT_RIGHT>,
+		_evaluate_generic<Variant::OP_BIT_AND>,
+		_evaluate_generic<Variant::OP_BIT_OR>,
+		_evaluate_generic<Variant::OP_BIT_XOR>,
+		_evaluate_generic<Variant::OP_BIT_NEGATE>,
+		_evaluate_generic<Variant::OP_AND>,
+		_evaluate_generic<Variant::OP_OR>,
+		_evaluate_generic<Variant::OP_XOR>,
+		_evaluate_generic<Variant::OP_NOT>,
+		_evaluate_generic<Variant::OP_IN>,
+	};
+
+	for (int i = 0; i < Variant::OP_MAX; i++) {
+		for (int j = 0; j < Variant::VARIANT_MAX; j++) {
+			for (int k = 0; k < Variant::VARIANT_MAX; k++) {
+				Variant::operator_evaluators[i][j][k] = generic_evaluators[i];
+			}
+		}
+	}
+
+	REGISTER_NUMBER_OPS(int_int, INT, INT);
+	REGISTER_NUMBER_OPS(int_real, INT, REAL);
+	REGISTER_NUMBER_OPS(real_int, REAL, INT);
+	REGISTER_NUMBER_OPS(real_real, REAL, REAL);
+
+	REGISTER_BINARY(OP_MODULE, INT, INT, _module_int_int);
+	REGISTER_BINARY(OP_SHIFT_LEFT, INT, INT, _shift_left_int_int);
+	REGISTER_BINARY(OP_SHIFT_RIGHT, INT, INT, _shift_right_int_int);
+	REGISTER_BINARY(OP_BIT_AND, INT, INT, _bit_and_int_int);
+	REGISTER_BINARY(OP_BIT_OR, INT, INT, _bit_or_int_int);
+	REGISTER_BINARY(OP_BIT_XOR, INT, INT, _bit_xor_int_int);
+	REGISTER_UNARY(OP_BIT_NEGATE, INT, _bit_negate_int);
+	REGISTER_UNARY(OP_NEGATE, INT, _negate_int);
+	REGISTER_UNARY(OP_POSITIVE, INT, _positive_int);
+	REGISTER_UNARY(OP_NEGATE, REAL, _negate_real);
+	REGISTER_UNARY(OP_POSITIVE, REAL, _positive_real);
+
+	REGISTER_BINARY(OP_EQUAL, BOOL, BOOL, _equal_bool_bool);
+	REGISTER_BINARY(OP_NOT_EQUAL, BOOL, BOOL, _not_equal_bool_bool);
+	REGISTER_BINARY(OP_AND, BOOL, BOOL, _and_bool_bool);
+	REGISTER_BINARY(OP_OR, BOOL, BOOL, _or_bool_bool);
+	REGISTER_BINARY(OP_XOR, BOOL, BOOL, _xor_bool_bool);
+	REGISTER_UNARY(OP_NOT, BOOL, _not_bool);
+
+	REGISTER_VECTOR_OPS(vector2, VECTOR2);
+	REGISTER_VECTOR_OPS(vector3, VECTOR3);
+}
+
 void Variant::set_named(const StringName &p_index, const Variant &p_value, bool *r_valid) {
 
 	bool valid = false;
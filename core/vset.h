@@ -82,11 +82,11 @@ class VSet {
 		if(_data.empty() )
 			return -1;
 
-		typename std::vector<T>::size_type low = 0;
+		int low = 0;
 
-		auto high = _data.size() - 1;
+		int high = _data.size() - 1;
 
-		typename std::vector<T>::size_type middle;
+		int middle;
 
 		const T *a = &_data[0];
 
@@ -122,13 +122,19 @@ public:
 		return _find_exact(p_val) != -1;
 	}
 
-	void erase(const T &p_val) {
+	bool erase(const T &p_val) {
 		int pos = _find_exact(p_val);
 
 		if (pos < 0)
-			return;
+			return false;
 
 		_data.erase( _data.begin()+pos );
+		return true;
+	}
+
+	void clear() {
+
+		_data.clear();
 	}
 
 	int find(const T &p_val) const {
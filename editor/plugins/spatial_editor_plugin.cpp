@@ -5149,8 +5149,8 @@ Set<T *> _get_child_nodes(Node *parent_node) {
 	return nodes;
 }
 
-Set<RID> _get_physics_bodies_rid(Node *node) {
-	Set<RID> rids = Set<RID>();
+VSet<RID> _get_physics_bodies_rid(Node *node) {
+	VSet<RID> rids;
 	PhysicsBody *pb = Node::cast_to<PhysicsBody>(node);
 	if (pb) {
 		rids.insert(pb->get_rid());
@@ -5230,7 +5230,7 @@ void SpatialEditor::snap_selected_nodes_to_floor() {
 			Dictionary d = snap_data[node];
 			Vector3 from = d["from"];
 			Vector3 to = from - Vector3(0.0, max_snap_height, 0.0);
-			Set<RID> excluded = _get_physics_bodies_rid(sp);
+			VSet<RID> excluded = _get_physics_bodies_rid(sp);
 
 			if (ss->intersect_ray(from, to, result, excluded)) {
 				snapped_to_floor = true;
@@ -5247,7 +5247,7 @@ void SpatialEditor::snap_selected_nodes_to_floor() {
 				Dictionary d = snap_data[node];
 				Vector3 from = d["from"];
 				Vector3 to = from - Vector3(0.0, max_snap_height, 0.0);
-				Set<RID> excluded = _get_physics_bodies_rid(sp);
+				VSet<RID> excluded = _get_physics_bodies_rid(sp);
 
 				if (ss->intersect_ray(from, to, result, excluded)) {
 					Vector3 position_offset = d["position_offset"];
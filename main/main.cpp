@@ -847,6 +847,8 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 
 	GLOBAL_DEF("memory/limits/multithreaded_server/rid_pool_prealloc", 60);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/multithreaded_server/rid_pool_prealloc", PropertyInfo(Variant::INT, "memory/limits/multithreaded_server/rid_pool_prealloc", PROPERTY_HINT_RANGE, "0,500,1")); // No negative and limit to 500 due to crashes
+	StringName::reserve(GLOBAL_DEF_RST("memory/limits/string_name/table_size", 65536));
+	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/string_name/table_size", PropertyInfo(Variant::INT, "memory/limits/string_name/table_size", PROPERTY_HINT_RANGE, "1024,1048576,1,or_greater"));
 	GLOBAL_DEF("network/limits/debugger_stdout/max_chars_per_second", 2048);
 	ProjectSettings::get_singleton()->set_custom_property_info("network/limits/debugger_stdout/max_chars_per_second", PropertyInfo(Variant::INT, "network/limits/debugger_stdout/max_chars_per_second", PROPERTY_HINT_RANGE, "0, 4096, 1, or_greater"));
 	GLOBAL_DEF("network/limits/debugger_stdout/max_messages_per_frame", 10);
@@ -1611,6 +1613,26 @@ bool Main::start() {
 					}
 				}
 
+				//let languages compile the scripts the autoloads and the main scene need, now that all globals exist
+				std::vector<String> startup_paths;
+				for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
+
+					String s = E->get().name;
+					if (!s.begins_with("autoload/"))
+						continue;
+					String path = ProjectSettings::get_singleton()->get(s);
+					if (path.begins_with("*")) {
+						path = path.substr(1, path.length() - 1);
+					}
+					startup_paths.push_back(path);
+				}
+				if (game_path.begins_with("res://")) {
+					startup_paths.push_back(game_path);
+				}
+				for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+					ScriptServer::get_language(i)->preload_scripts(startup_paths);
+				}
+
 				//second pass, load into global constants
 				List<Node *> to_add;
 				for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
@@ -1954,18 +1976,24 @@ bool Main::iteration() {
 		Physics2DServer::get_singleton()->sync();
 		Physics2DServer::get_singleton()->flush_queries();
 
+		Memory::set_thread_tag(Memory::TAG_SCENE);
 		if (OS::get_singleton()->get_main_loop()->iteration(frame_slice * time_scale)) {
+			Memory::set_thread_tag(Memory::TAG_GENERAL);
 			exit = true;
 			break;
 		}
 
 		message_queue->flush();
 
+		Memory::set_thread_tag(Memory::TAG_PHYSICS);
 		PhysicsServer::get_singleton()->step(frame_slice * time_scale);
 
+		Memory::set_thread_tag(Memory::TAG_PHYSICS_2D);
 		Physics2DServer::get_singleton()->end_sync();
 		Physics2DServer::get_singleton()->step(frame_slice * time_scale);
 
+		Memory::set_thread_tag(Memory::TAG_GENERAL);
+
 		message_queue->flush();
 
 		physics_process_ticks = MAX(physics_process_ticks, OS::get_singleton()->get_ticks_usec() - physics_begin); // keep the largest one for reference
@@ -1977,11 +2005,13 @@ bool Main::iteration() {
 
 	uint64_t idle_begin = OS::get_singleton()->get_ticks_usec();
 
+	Memory::set_thread_tag(Memory::TAG_SCENE);
 	if (OS::get_singleton()->get_main_loop()->idle(step * time_scale)) {
 		exit = true;
 	}
 	message_queue->flush();
 
+	Memory::set_thread_tag(Memory::TAG_RENDERING);
 	VisualServer::get_singleton()->sync(); //sync if still drawing from previous frames.
 
 	if (OS::get_singleton()->can_draw() && !disable_render_loop) {
@@ -1998,6 +2028,8 @@ bool Main::iteration() {
 		}
 	}
 
+	Memory::set_thread_tag(Memory::TAG_GENERAL);
+
 	idle_process_ticks = OS::get_singleton()->get_ticks_usec() - idle_begin;
 	idle_process_max = MAX(idle_process_ticks, idle_process_max);
 	uint64_t frame_time = OS::get_singleton()->get_ticks_usec() - ticks;
@@ -32,6 +32,7 @@
 
 #include "core/message_queue.h"
 #include "core/os/os.h"
+#include "core/os/thread_pool.h"
 #include "scene/main/node.h"
 #include "scene/main/scene_tree.h"
 #include "servers/audio_server.h"
@@ -44,6 +45,7 @@ Performance *Performance::singleton = NULL;
 void Performance::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_monitor", "monitor"), &Performance::get_monitor);
+	ClassDB::bind_method(D_METHOD("get_memory_usage_by_tag"), &Performance::get_memory_usage_by_tag);
 
 	BIND_ENUM_CONSTANT(TIME_FPS);
 	BIND_ENUM_CONSTANT(TIME_PROCESS);
@@ -74,6 +76,11 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(THREAD_POOL_QUEUE_DEPTH);
+	BIND_ENUM_CONSTANT(THREAD_POOL_UTILIZATION);
+	BIND_ENUM_CONSTANT(STRING_NAME_COUNT);
+	BIND_ENUM_CONSTANT(STRING_NAME_PROBE_LENGTH);
+	BIND_ENUM_CONSTANT(STRING_NAME_LOCK_CONTENTION);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -120,6 +127,11 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"thread_pool/queue_depth",
+		"thread_pool/utilization",
+		"string_name/count",
+		"string_name/probe_length",
+		"string_name/lock_contention",
 
 	};
 
@@ -158,6 +170,11 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY: return AudioServer::get_singleton()->get_output_latency();
+		case THREAD_POOL_QUEUE_DEPTH: return ThreadPool::get_singleton()->get_queue_depth();
+		case THREAD_POOL_UTILIZATION: return ThreadPool::get_singleton()->get_utilization();
+		case STRING_NAME_COUNT: return StringName::get_interned_count();
+		case STRING_NAME_PROBE_LENGTH: return StringName::get_average_probe_length();
+		case STRING_NAME_LOCK_CONTENTION: return StringName::get_lock_contention_count();
 
 		default: {
 		}
@@ -166,6 +183,16 @@ float Performance::get_monitor(Monitor p_monitor) const {
 	return 0;
 }
 
+Dictionary Performance::get_memory_usage_by_tag() const {
+
+	Dictionary usage;
+	for (int i = 0; i < Memory::TAG_MAX; i++) {
+		Memory::Tag tag = Memory::Tag(i);
+		usage[Memory::get_tag_name(tag)] = Memory::get_mem_usage_by_tag(tag);
+	}
+	return usage;
+}
+
 Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const {
 	ERR_FAIL_INDEX_V(p_monitor, MONITOR_MAX, MONITOR_TYPE_QUANTITY);
 	// ugly
@@ -200,6 +227,11 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
@@ -81,6 +81,11 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		THREAD_POOL_QUEUE_DEPTH,
+		THREAD_POOL_UTILIZATION,
+		STRING_NAME_COUNT,
+		STRING_NAME_PROBE_LENGTH,
+		STRING_NAME_LOCK_CONTENTION,
 		MONITOR_MAX
 	};
 
@@ -92,6 +97,7 @@ public:
 
 	float get_monitor(Monitor p_monitor) const;
 	String get_monitor_name(Monitor p_monitor) const;
+	Dictionary get_memory_usage_by_tag() const;
 
 	MonitorType get_monitor_type(Monitor p_monitor) const;
 
@@ -0,0 +1,190 @@
+/*************************************************************************/
+/*  test_command_queue.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_command_queue.h"
+
+#include "core/command_queue_mt.h"
+#include "core/math/transform.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+
+#include <vector>
+
+namespace TestCommandQueue {
+
+typedef bool (*TestFunc)(void);
+
+enum {
+	FRAMES = 20,
+};
+
+// Stands in for a server running on its own thread, like VisualServerWrapMT does.
+struct Receiver {
+
+	std::vector<Transform> transforms;
+	CommandQueueMT command_queue;
+	bool exit;
+
+	void set_transform(int p_index, const Transform &p_transform) {
+		transforms[p_index] = p_transform;
+	}
+
+	void sync() {
+	}
+
+	void quit() {
+		exit = true;
+	}
+
+	static void thread_func(void *p_userdata) {
+
+		Receiver *receiver = (Receiver *)p_userdata;
+		while (!receiver->exit) {
+			receiver->command_queue.wait_and_flush_one();
+		}
+	}
+
+	Receiver() :
+			command_queue(true) {
+		exit = false;
+	}
+};
+
+static Transform _make_transform(int p_frame, int p_index) {
+
+	return Transform(Basis(), Vector3(p_frame, p_index, 0));
+}
+
+static bool _check(const Receiver &p_receiver, int p_frame) {
+
+	for (int i = 0; i < (int)p_receiver.transforms.size(); i++) {
+		if (p_receiver.transforms[i].origin != _make_transform(p_frame, i).origin) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool test_1() {
+
+	OS::get_singleton()->print("\n\nTest 1: transform updates per second, direct vs threaded vs batched command queue\n");
+
+	bool ok = true;
+
+	for (int count = 1000; count <= 100000; count *= 10) {
+
+		Receiver receiver;
+		receiver.transforms.resize(count);
+
+		std::vector<int> indices(count);
+		std::vector<Transform> transforms(count);
+		for (int i = 0; i < count; i++) {
+			indices[i] = i;
+		}
+
+		Thread *thread = Thread::create(Receiver::thread_func, &receiver);
+
+		uint64_t direct_usec = 0;
+		uint64_t threaded_usec = 0;
+		uint64_t batched_usec = 0;
+
+		for (int frame = 0; frame < FRAMES; frame++) {
+
+			for (int i = 0; i < count; i++) {
+				transforms[i] = _make_transform(frame, i);
+			}
+
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			for (int i = 0; i < count; i++) {
+				receiver.set_transform(i, transforms[i]);
+			}
+			direct_usec += OS::get_singleton()->get_ticks_usec() - begin;
+
+			begin = OS::get_singleton()->get_ticks_usec();
+			for (int i = 0; i < count; i++) {
+				receiver.command_queue.push(&receiver, &Receiver::set_transform, i, transforms[i]);
+			}
+			receiver.command_queue.push_and_sync(&receiver, &Receiver::sync);
+			threaded_usec += OS::get_singleton()->get_ticks_usec() - begin;
+
+			ok = ok && _check(receiver, frame);
+
+			begin = OS::get_singleton()->get_ticks_usec();
+			receiver.command_queue.push_batch(&receiver, &Receiver::set_transform, count, indices.data(), transforms.data());
+			receiver.command_queue.push_and_sync(&receiver, &Receiver::sync);
+			batched_usec += OS::get_singleton()->get_ticks_usec() - begin;
+
+			ok = ok && _check(receiver, frame);
+		}
+
+		receiver.command_queue.push(&receiver, &Receiver::quit);
+		Thread::wait_to_finish(thread);
+		memdelete(thread);
+
+		double commands = double(count) * FRAMES;
+		OS::get_singleton()->print("\t%6d per frame: direct %8.2f Mcmd/s, threaded %8.2f Mcmd/s, batched %8.2f Mcmd/s\n", count, commands / MAX(direct_usec, 1), commands / MAX(threaded_usec, 1), commands / MAX(batched_usec, 1));
+	}
+
+	return ok;
+}
+
+TestFunc test_funcs[] = {
+
+	test_1,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestCommandQueue
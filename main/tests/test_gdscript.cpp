@@ -32,16 +32,21 @@
 
 #include <vector>
 
+#include "core/io/resource_loader.h"
+#include "core/os/dir_access.h"
 #include "core/os/file_access.h"
 #include "core/os/main_loop.h"
+#include "core/os/mutex.h"
 #include "core/os/os.h"
 
 #ifdef GDSCRIPT_ENABLED
 
 #include "modules/gdscript/gdscript.h"
+#include "modules/gdscript/gdscript_cache.h"
 #include "modules/gdscript/gdscript_compiler.h"
 #include "modules/gdscript/gdscript_parser.h"
 #include "modules/gdscript/gdscript_tokenizer.h"
+#include "modules/gdscript/gdscript_typed_ops.h"
 
 namespace TestGDScript {
 
@@ -616,6 +621,22 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const std::vector<S
 					txt += DADDR(3);
 					incr += 5;
 
+				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_TYPED: {
+
+					const GDScriptTypedOps::Operator &typed = GDScriptTypedOps::operators[code[ip + 1]];
+					txt += " op-typed ";
+
+					String opname = Variant::get_operator_name(typed.op);
+
+					txt += DADDR(4);
+					txt += " = ";
+					txt += DADDR(2);
+					txt += " " + opname + " ";
+					txt += DADDR(3);
+					txt += " (" + Variant::get_type_name(typed.type_a) + ", " + Variant::get_type_name(typed.type_b) + ")";
+					incr += 5;
+
 				} break;
 				case GDScriptFunction::OPCODE_SET: {
 
@@ -648,19 +669,44 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const std::vector<S
 					txt += func.get_global_name(code[ip + 2]);
 					txt += "\"]=";
 					txt += DADDR(3);
-					incr += 4;
+					incr += 5;
 
 				} break;
 				case GDScriptFunction::OPCODE_GET_NAMED: {
 
 					txt += " get_named ";
+					txt += DADDR(4);
+					txt += "=";
+					txt += DADDR(1);
+					txt += "[\"";
+					txt += func.get_global_name(code[ip + 2]);
+					txt += "\"]";
+					incr += 5;
+
+				} break;
+				case GDScriptFunction::OPCODE_SET_NAMED_TYPED: {
+
+					txt += " set_named-typed ";
+					txt += DADDR(1);
+					txt += "[\"";
+					txt += func.get_global_name(code[ip + 2]);
+					txt += "\"]=";
 					txt += DADDR(3);
+					txt += " (" + Variant::get_type_name(GDScriptTypedOps::members[code[ip + 4]].type) + ")";
+					incr += 5;
+
+				} break;
+				case GDScriptFunction::OPCODE_GET_NAMED_TYPED: {
+
+					txt += " get_named-typed ";
+					txt += DADDR(4);
 					txt += "=";
 					txt += DADDR(1);
 					txt += "[\"";
 					txt += func.get_global_name(code[ip + 2]);
 					txt += "\"]";
-					incr += 4;
+					txt += " (" + Variant::get_type_name(GDScriptTypedOps::members[code[ip + 3]].type) + ")";
+					incr += 5;
 
 				} break;
 				case GDScriptFunction::OPCODE_SET_MEMBER: {
@@ -792,7 +838,7 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const std::vector<S
 
 					int argc = code[ip + 1];
 					if (ret) {
-						txt += DADDR(4 + argc) + "=";
+						txt += DADDR(5 + argc) + "=";
 					}
 
 					txt += DADDR(2) + ".";
@@ -802,11 +848,33 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const std::vector<S
 					for (int i = 0; i < argc; i++) {
 						if (i > 0)
 							txt += ", ";
-						txt += DADDR(4 + i);
+						txt += DADDR(5 + i);
 					}
 					txt += ")";
 
-					incr = 5 + argc;
+					incr = 6 + argc;
+
+				} break;
+				case GDScriptFunction::OPCODE_CALL_TYPED: {
+
+					txt += " call-typed ";
+
+					int argc = code[ip + 1];
+					txt += DADDR(6 + argc) + "=";
+
+					txt += DADDR(2) + ".";
+					txt += String(func.get_global_name(code[ip + 3]));
+					txt += "(";
+
+					for (int i = 0; i < argc; i++) {
+						if (i > 0)
+							txt += ", ";
+						txt += DADDR(6 + i);
+					}
+					txt += ")";
+					txt += " (" + Variant::get_type_name(Variant::Type(code[ip + 4])) + " method " + itos(code[ip + 5]) + ")";
+
+					incr = 7 + argc;
 
 				} break;
 				case GDScriptFunction::OPCODE_CALL_BUILT_IN: {
@@ -955,8 +1023,544 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const std::vector<S
 	}
 }
 
+// Typical gameplay loops, typed so the compiler can use the typed instructions.
+static const char *_benchmark_code =
+		"extends Reference\n"
+		"\n"
+		"func counters(n: int) -> int:\n"
+		"\tvar total := 0\n"
+		"\tvar i := 0\n"
+		"\twhile i < n:\n"
+		"\t\ttotal += i * 3 - i % 7\n"
+		"\t\ti += 1\n"
+		"\treturn total\n"
+		"\n"
+		"func floats(n: int) -> float:\n"
+		"\tvar acc := 0.0\n"
+		"\tvar speed := 1.0001\n"
+		"\tvar i := 0\n"
+		"\twhile i < n:\n"
+		"\t\tacc += speed * 0.5 - acc * 0.001\n"
+		"\t\ti += 1\n"
+		"\treturn acc\n"
+		"\n"
+		"func movement_2d(n: int) -> Vector2:\n"
+		"\tvar pos := Vector2()\n"
+		"\tvar vel := Vector2(1.5, -0.5)\n"
+		"\tvar delta := 0.016\n"
+		"\tvar i := 0\n"
+		"\twhile i < n:\n"
+		"\t\tvel.y += 9.8 * delta\n"
+		"\t\tpos += vel * delta\n"
+		"\t\tif pos.y > 100.0:\n"
+		"\t\t\tpos.y = 0.0\n"
+		"\t\t\tvel.y = -vel.y * 0.5\n"
+		"\t\ti += 1\n"
+		"\treturn pos\n"
+		"\n"
+		"func movement_3d(n: int) -> float:\n"
+		"\tvar pos := Vector3(1, 2, 3)\n"
+		"\tvar dir := Vector3(0.1, 0.2, 0.3)\n"
+		"\tvar total := 0.0\n"
+		"\tvar i := 0\n"
+		"\twhile i < n:\n"
+		"\t\tpos += dir * 0.5\n"
+		"\t\ttotal += pos.length() + pos.dot(dir) - pos.z\n"
+		"\t\ti += 1\n"
+		"\treturn total\n";
+
+static const char *_benchmark_funcs[] = { "counters", "floats", "movement_2d", "movement_3d", NULL };
+
+static bool _benchmark_run(bool p_typed, int p_iterations, std::vector<Variant> &r_results, std::vector<uint64_t> &r_usecs) {
+
+	GDScriptLanguage::get_singleton()->set_typed_instructions_enabled(p_typed);
+
+	Ref<GDScript> script;
+	script.instance();
+	script->set_source_code(_benchmark_code);
+	Error err = script->reload();
+
+	GDScriptLanguage::get_singleton()->set_typed_instructions_enabled(true);
+	ERR_FAIL_COND_V_MSG(err != OK, false, "Benchmark script failed to compile.");
+
+	Ref<Reference> obj;
+	obj.instance();
+	obj->set_script(script.get_ref_ptr());
+
+	for (int i = 0; _benchmark_funcs[i]; i++) {
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		r_results.push_back(obj->call(_benchmark_funcs[i], p_iterations));
+		r_usecs.push_back(OS::get_singleton()->get_ticks_usec() - from);
+	}
+
+	return true;
+}
+
+static const char *_yield_benchmark_code =
+		"extends Reference\n"
+		"\n"
+		"var resumed = 0\n"
+		"\n"
+		"func wait(source, signal_name, frames):\n"
+		"\tfor i in range(frames):\n"
+		"\t\tyield(source, signal_name)\n"
+		"\t\tresumed += 1\n";
+
+// Yields per second of many functions waiting on the same signal every frame.
+static bool _benchmark_yields(const String &p_signal, int p_waiters, int p_frames) {
+
+	Ref<GDScript> script;
+	script.instance();
+	script->set_source_code(_yield_benchmark_code);
+	ERR_FAIL_COND_V_MSG(script->reload() != OK, false, "Yield benchmark script failed to compile.");
+
+	Ref<Reference> obj;
+	obj.instance();
+	obj->set_script(script.get_ref_ptr());
+
+	Object *source = memnew(Object);
+	source->add_user_signal(MethodInfo(p_signal));
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_waiters; i++) {
+		obj->call("wait", source, p_signal, p_frames);
+	}
+	for (int i = 0; i < p_frames; i++) {
+		source->emit_signal(p_signal);
+	}
+
+	uint64_t usecs = MAX(OS::get_singleton()->get_ticks_usec() - from, (uint64_t)1);
+	memdelete(source);
+
+	int yields = p_waiters * p_frames;
+	bool ok = int(obj->get("resumed")) == yields;
+	print_line("yield(obj, \"" + p_signal + "\"): " + itos(yields) + " yields in " + rtos(usecs / 1000.0) + " ms, " + itos(yields * 1000000.0 / usecs) + " yields/s" + (ok ? "" : " (RESUMED " + String(obj->get("resumed")) + ")"));
+	return ok;
+}
+
+static const char *_startup_benchmark_base =
+		"extends Reference\n"
+		"\n"
+		"const SCALE = 3\n"
+		"\n"
+		"func describe():\n"
+		"\treturn \"base\"\n";
+
+// Body of the generated scripts, %d is the script number.
+static const char *_startup_benchmark_code =
+		"extends \"base.gd\"\n"
+		"\n"
+		"const ID = %d\n"
+		"const NAMES = [\"a\", \"b\", \"c\"]\n"
+		"\n"
+		"signal changed(value)\n"
+		"\n"
+		"export var speed := 1.5\n"
+		"var items := {}\n"
+		"var position := Vector2()\n"
+		"\n"
+		"class Item:\n"
+		"\tvar weight := 0\n"
+		"\tfunc _init(w):\n"
+		"\t\tweight = w\n"
+		"\n"
+		"func _init():\n"
+		"\tfor i in range(3):\n"
+		"\t\titems[NAMES[i]] = Item.new(i * SCALE)\n"
+		"\n"
+		"func value():\n"
+		"\tvar total := 0\n"
+		"\tfor key in items:\n"
+		"\t\ttotal += items[key].weight\n"
+		"\treturn ID * 10 + total\n"
+		"\n"
+		"func move(delta : float):\n"
+		"\tposition += Vector2(speed, -speed) * delta\n"
+		"\temit_signal(\"changed\", position)\n"
+		"\treturn position\n";
+
+static int _load_startup_scripts(const String &p_dir, int p_scripts, std::vector<RES> &r_loaded) {
+
+	int sum = 0;
+	for (int i = 0; i < p_scripts; i++) {
+		Ref<GDScript> script = ResourceLoader::load(p_dir.plus_file("script_" + itos(i) + ".gd"));
+		ERR_FAIL_COND_V(script.is_null(), -1);
+		r_loaded.push_back(script);
+		sum += int(Variant(script).call("new").call("value"));
+	}
+	return sum;
+}
+
+// Time to load many scripts when they are compiled, when they come from GDScriptCache, and when
+// they are compiled in parallel by preload_scripts().
+static bool _benchmark_startup(int p_scripts) {
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+	bool cache_enabled = language->is_bytecode_cache_enabled();
+	String cache_path = language->get_bytecode_cache_path();
+
+	String dir = "user://gdscript_startup_benchmark";
+	language->set_bytecode_cache_path(dir.plus_file("cache"));
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_USERDATA);
+	da->make_dir_recursive(dir);
+	for (int i = 0; i < p_scripts; i++) {
+		// Left by a previous run.
+		String cache_file = GDScriptCache::get_cache_file(dir.plus_file("script_" + itos(i) + ".gd"));
+		if (da->file_exists(cache_file)) {
+			da->remove(cache_file);
+		}
+	}
+	memdelete(da);
+
+	FileAccess *f = FileAccess::open(dir.plus_file("base.gd"), FileAccess::WRITE);
+	ERR_FAIL_COND_V(!f, false);
+	f->store_string(_startup_benchmark_base);
+	memdelete(f);
+	for (int i = 0; i < p_scripts; i++) {
+		f = FileAccess::open(dir.plus_file("script_" + itos(i) + ".gd"), FileAccess::WRITE);
+		ERR_FAIL_COND_V(!f, false);
+		f->store_string(String(_startup_benchmark_code).replace("%d", itos(i)));
+		memdelete(f);
+	}
+
+	std::vector<String> paths;
+	for (int i = 0; i < p_scripts; i++) {
+		paths.push_back(dir.plus_file("script_" + itos(i) + ".gd"));
+	}
+
+	const char *passes[] = { "compiled", "compiled and cached", "from cache", "compiled in parallel" };
+	int sums[4];
+	for (int pass = 0; pass < 4; pass++) {
+
+		language->set_bytecode_cache_enabled(pass == 1 || pass == 2);
+
+		std::vector<RES> loaded;
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		if (pass == 3) {
+			language->preload_scripts(paths);
+		}
+		sums[pass] = _load_startup_scripts(dir, p_scripts, loaded);
+		uint64_t usecs = OS::get_singleton()->get_ticks_usec() - from;
+
+		print_line("startup, " + itos(p_scripts) + " scripts " + passes[pass] + ": " + rtos(usecs / 1000.0) + " ms");
+
+		// Releases what was preloaded.
+		language->frame();
+	}
+
+	language->set_bytecode_cache_enabled(cache_enabled);
+	language->set_bytecode_cache_path(cache_path);
+
+	bool ok = sums[0] >= 0 && sums[0] == sums[1] && sums[0] == sums[2] && sums[0] == sums[3];
+	if (!ok) {
+		print_line("startup: RESULTS DIFFER: " + itos(sums[0]) + " / " + itos(sums[1]) + " / " + itos(sums[2]) + " / " + itos(sums[3]));
+	}
+	return ok;
+}
+
+// Scripts with errors, and scripts depending on them, for _check_preload_errors().
+static const char *_preload_error_scripts[][2] = {
+	{ "base.gd", "extends Reference\n\nconst A = 1\n" },
+	{ "broken.gd", "extends \"base.gd\"\n\nfunc f(\n" },
+	{ "uses_broken.gd", "extends \"broken.gd\"\n" },
+	{ "undeclared.gd", "extends \"base.gd\"\n\nfunc f():\n\treturn missing\n" },
+	{ "ok.gd", "extends \"base.gd\"\n\nconst B = preload(\"uses_broken.gd\")\n" },
+	{ "main.gd", "extends Reference\n\nconst X = preload(\"ok.gd\")\nconst Y = preload(\"undeclared.gd\")\nconst Z = preload(\"base.gd\")\n" },
+	{ NULL, NULL }
+};
+
+struct _ErrorLog {
+	Mutex *mutex;
+	std::vector<String> messages;
+};
+
+static void _log_error(void *p_log, const char *p_function, const char *p_file, int p_line, const char *p_error, const char *p_message, ErrorHandlerType p_type) {
+
+	_ErrorLog *log = (_ErrorLog *)p_log;
+	log->mutex->lock();
+	log->messages.push_back(String(p_file) + ":" + itos(p_line) + ": " + p_error + " " + p_message);
+	log->mutex->unlock();
+}
+
+static void _load_preload_error_scripts(const String &p_dir, std::vector<String> &r_messages) {
+
+	_ErrorLog log;
+	log.mutex = Mutex::create();
+	ErrorHandlerList handler;
+	handler.errfunc = _log_error;
+	handler.userdata = &log;
+	add_error_handler(&handler);
+
+	std::vector<String> roots;
+	roots.push_back(p_dir.plus_file("main.gd"));
+	roots.push_back(p_dir.plus_file("uses_broken.gd"));
+
+	GDScriptLanguage::get_singleton()->preload_scripts(roots);
+
+	remove_error_handler(&handler);
+	memdelete(log.mutex);
+	r_messages = log.messages;
+
+	// Releases what was preloaded.
+	GDScriptLanguage::get_singleton()->frame();
+}
+
+// Errors of a parallel preload come once per script, dependencies first, in the same order on every
+// run. Note undeclared.gd isn't loaded serially: main.gd stops parsing at its first failed preload.
+static bool _check_preload_errors() {
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+	bool cache_enabled = language->is_bytecode_cache_enabled();
+	language->set_bytecode_cache_enabled(false);
+
+	String dir = "user://gdscript_preload_errors";
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_USERDATA);
+	da->make_dir_recursive(dir);
+	memdelete(da);
+
+	for (int i = 0; _preload_error_scripts[i][0]; i++) {
+		FileAccess *f = FileAccess::open(dir.plus_file(_preload_error_scripts[i][0]), FileAccess::WRITE);
+		ERR_FAIL_COND_V(!f, false);
+		f->store_string(_preload_error_scripts[i][1]);
+		memdelete(f);
+	}
+
+	const char *expected[] = { "broken.gd", "uses_broken.gd", "ok.gd", "undeclared.gd", "main.gd", NULL };
+
+	bool ok = true;
+	std::vector<String> first;
+	for (int run = 0; run < 5; run++) {
+
+		std::vector<String> messages;
+		_load_preload_error_scripts(dir, messages);
+
+		if (run == 0) {
+			first = messages;
+			int next = 0;
+			for (uint32_t i = 0; i < messages.size(); i++) {
+				if (messages[i].begins_with(dir)) {
+					ok = ok && expected[next] && messages[i].begins_with(dir.plus_file(expected[next]) + ":");
+					next += expected[next] ? 1 : 0;
+				}
+			}
+			ok = ok && !expected[next];
+		} else {
+			ok = ok && messages == first;
+		}
+	}
+
+	language->set_bytecode_cache_enabled(cache_enabled);
+
+	print_line("preload errors: " + itos(first.size()) + " messages" + (ok ? "" : " (UNEXPECTED ERRORS)"));
+	if (!ok) {
+		for (uint32_t i = 0; i < first.size(); i++) {
+			print_line("  " + first[i]);
+		}
+	}
+	return ok;
+}
+
+static const char *_inline_cache_caller_code =
+		"extends Reference\n"
+		"\n"
+		"func sum_values(receivers):\n"
+		"\tvar total = 0\n"
+		"\tfor r in receivers:\n"
+		"\t\ttotal += r.value()\n"
+		"\treturn total\n";
+
+// Receiver scripts, %d is the value they return.
+static const char *_inline_cache_receiver_code =
+		"extends Reference\n"
+		"\n"
+		"func value():\n"
+		"\treturn %d\n";
+
+// Cache hits and misses of the sum_values() call site so far, -1 if they aren't counted.
+static void _inline_cache_counts(int64_t &r_hits, int64_t &r_misses) {
+
+	r_hits = -1;
+	r_misses = -1;
+
+	std::vector<ScriptLanguage::ProfilingInfo> info(256);
+	int count;
+	while ((count = GDScriptLanguage::get_singleton()->profiling_get_accumulated_data(&info[0], info.size())) == (int)info.size()) {
+		info.resize(info.size() * 2);
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (String(info[i].signature).ends_with("::sum_values")) {
+			r_hits = info[i].cache_hits;
+			r_misses = info[i].cache_misses;
+		}
+	}
+}
+
+// A call site seeing up to four receiver scripts hits once each was seen, one seeing more still
+// returns the right results, and reloading a receiver script drops what was cached for it.
+static bool _check_inline_caches() {
+
+	Ref<GDScript> caller_script;
+	caller_script.instance();
+	caller_script->set_source_code(_inline_cache_caller_code);
+	ERR_FAIL_COND_V_MSG(caller_script->reload() != OK, false, "Inline cache test script failed to compile.");
+
+	Ref<Reference> caller;
+	caller.instance();
+	caller->set_script(caller_script.get_ref_ptr());
+
+	const int cache_size = 4; // GDScriptFunction::INLINE_CACHE_SIZE
+	const int receiver_count = cache_size + 2;
+	std::vector<Ref<GDScript> > scripts;
+	Array receivers, polymorphic;
+	for (int i = 0; i < receiver_count; i++) {
+		Ref<GDScript> script;
+		script.instance();
+		script->set_source_code(String(_inline_cache_receiver_code).replace("%d", itos(i + 1)));
+		ERR_FAIL_COND_V_MSG(script->reload() != OK, false, "Inline cache test script failed to compile.");
+		scripts.push_back(script);
+
+		Ref<Reference> receiver;
+		receiver.instance();
+		receiver->set_script(script.get_ref_ptr());
+		receivers.push_back(receiver);
+		if (i < cache_size) {
+			polymorphic.push_back(receiver);
+		}
+	}
+
+	const int calls = 100;
+	GDScriptLanguage::get_singleton()->profiling_start();
+
+	// Polymorphic: one miss per receiver, then only hits.
+	bool ok = true;
+	for (int i = 0; i < calls; i++) {
+		ok = ok && int(caller->call("sum_values", polymorphic)) == 10;
+	}
+
+	int64_t hits, misses;
+	_inline_cache_counts(hits, misses);
+	bool counted = hits >= 0;
+	if (counted) {
+		ok = ok && misses == cache_size && hits == (calls - 1) * cache_size;
+	}
+
+	// Reloaded in place: instances keep the script, its function is replaced.
+	scripts[0]->set_source_code(String(_inline_cache_receiver_code).replace("%d", "100"));
+	ok = ok && scripts[0]->reload(true) == OK;
+	ok = ok && int(caller->call("sum_values", polymorphic)) == 109;
+
+	int64_t reload_hits, reload_misses;
+	_inline_cache_counts(reload_hits, reload_misses);
+	if (counted) {
+		ok = ok && reload_misses == misses + cache_size && reload_hits == hits;
+	}
+
+	// Megamorphic: the cached receivers still hit, the others take the slow path every time.
+	for (int i = 0; i < calls; i++) {
+		ok = ok && int(caller->call("sum_values", receivers)) == 109 + 5 + 6;
+	}
+
+	int64_t megamorphic_hits, megamorphic_misses;
+	_inline_cache_counts(megamorphic_hits, megamorphic_misses);
+	if (counted) {
+		ok = ok && megamorphic_hits == reload_hits + calls * cache_size && megamorphic_misses == reload_misses + calls * (receiver_count - cache_size);
+	}
+
+	GDScriptLanguage::get_singleton()->profiling_stop();
+
+	print_line("inline caches: " + (counted ? itos(megamorphic_hits) + " hits, " + itos(megamorphic_misses) + " misses" : String("not counted in this build")) + (ok ? "" : " (UNEXPECTED RESULTS)"));
+	return ok;
+}
+
+// Only scripts are loaded by a parallel preload: resources may run script code when loaded, which
+// must happen after the autoloads are instanced, as without the preload.
+static bool _check_preload_skips_resources() {
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+	bool cache_enabled = language->is_bytecode_cache_enabled();
+	language->set_bytecode_cache_enabled(false);
+
+	String dir = "user://gdscript_preload_resources";
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_USERDATA);
+	da->make_dir_recursive(dir);
+	memdelete(da);
+
+	const char *files[][2] = {
+		{ "data.tres", "[gd_resource type=\"Resource\" format=2]\n\n[resource]\n" },
+		{ "uses_data.gd", "extends Reference\n\nconst DATA = preload(\"data.tres\")\n" },
+		{ "plain.gd", "extends Reference\n\nconst A = 1\n" },
+		{ NULL, NULL }
+	};
+	for (int i = 0; files[i][0]; i++) {
+		FileAccess *f = FileAccess::open(dir.plus_file(files[i][0]), FileAccess::WRITE);
+		ERR_FAIL_COND_V(!f, false);
+		f->store_string(files[i][1]);
+		memdelete(f);
+	}
+
+	std::vector<String> roots;
+	roots.push_back(dir.plus_file("uses_data.gd"));
+	roots.push_back(dir.plus_file("plain.gd"));
+	language->preload_scripts(roots);
+
+	bool ok = !ResourceCache::has(dir.plus_file("data.tres")) && !ResourceCache::has(dir.plus_file("uses_data.gd"));
+	if (language->is_parallel_preload_enabled() && !ScriptDebugger::get_singleton()) {
+		ok = ok && ResourceCache::has(dir.plus_file("plain.gd"));
+	}
+
+	// Releases what was preloaded.
+	language->frame();
+	language->set_bytecode_cache_enabled(cache_enabled);
+
+	print_line(String("preload resources: ") + (ok ? "left to their normal load" : "LOADED BY THE PRELOAD"));
+	return ok;
+}
+
+// Runs the same code compiled without and with the typed instructions, then measures yields
+// and script loading.
+static MainLoop *test_benchmark() {
+
+	const int iterations = 1000000;
+
+	std::vector<Variant> generic_results, typed_results;
+	std::vector<uint64_t> generic_usecs, typed_usecs;
+
+	if (!_benchmark_run(false, iterations, generic_results, generic_usecs) || !_benchmark_run(true, iterations, typed_results, typed_usecs)) {
+		return NULL;
+	}
+
+	bool ok = true;
+	for (int i = 0; _benchmark_funcs[i]; i++) {
+
+		bool same = generic_results[i] == typed_results[i];
+		ok = ok && same;
+		print_line(String(_benchmark_funcs[i]) + ": generic " + rtos(generic_usecs[i] / 1000.0) + " ms, typed " + rtos(typed_usecs[i] / 1000.0) + " ms, speedup " + rtos(generic_usecs[i] / (double)MAX(typed_usecs[i], (uint64_t)1)) + "x" + (same ? "" : " (RESULTS DIFFER: " + String(generic_results[i]) + " / " + String(typed_results[i]) + ")"));
+	}
+
+	// Frame signals queue their waiters, others connect each yielded state.
+	ok = _benchmark_yields("idle_frame", 500, 50) && ok;
+	ok = _benchmark_yields("tick", 500, 50) && ok;
+
+	ok = _check_inline_caches() && ok;
+
+	ok = _benchmark_startup(1000) && ok;
+	ok = _check_preload_errors() && ok;
+	ok = _check_preload_skips_resources() && ok;
+
+	print_line(ok ? "PASS" : "FAIL");
+	return NULL;
+}
+
 MainLoop *test(TestType p_type) {
 
+	if (p_type == TEST_BENCHMARK) {
+		return test_benchmark();
+	}
+
 	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
 
 	if (cmdlargs.empty()) {
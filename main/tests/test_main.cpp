@@ -34,16 +34,22 @@
 #ifdef DEBUG_ENABLED
 
 #include "test_astar.h"
+#include "test_command_queue.h"
 #include "test_gdscript.h"
 #include "test_gui.h"
 #include "test_math.h"
+#include "test_memory.h"
+#include "test_message_queue.h"
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
 #include "test_render.h"
+#include "test_scene_tree.h"
 #include "test_shader_lang.h"
+#include "test_signal.h"
 #include "test_string.h"
+#include "test_variant.h"
 
 const char **tests_get_names() {
 
@@ -51,7 +57,13 @@ const char **tests_get_names() {
 		"string",
 		"math",
 		"physics",
+		"physics_benchmark",
+		"physics_broad_phase_benchmark",
+		"physics_query_benchmark",
 		"physics_2d",
+		"physics_2d_benchmark",
+		"physics_2d_broad_phase_benchmark",
+		"physics_2d_query_benchmark",
 		"render",
 		"oa_hash_map",
 		"gui",
@@ -60,8 +72,15 @@ const char **tests_get_names() {
 		"gd_parser",
 		"gd_compiler",
 		"gd_bytecode",
+		"gd_benchmark",
 		"ordered_hash_map",
 		"astar",
+		"variant",
+		"memory",
+		"message_queue",
+		"command_queue",
+		"scene_tree",
+		"signal",
 		NULL
 	};
 
@@ -85,11 +104,41 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestPhysics::test();
 	}
 
+	if (p_test == "physics_benchmark") {
+
+		return TestPhysics::test_benchmark();
+	}
+
+	if (p_test == "physics_broad_phase_benchmark") {
+
+		return TestPhysics::test_broad_phase_benchmark();
+	}
+
+	if (p_test == "physics_query_benchmark") {
+
+		return TestPhysics::test_query_benchmark();
+	}
+
 	if (p_test == "physics_2d") {
 
 		return TestPhysics2D::test();
 	}
 
+	if (p_test == "physics_2d_benchmark") {
+
+		return TestPhysics2D::test_benchmark();
+	}
+
+	if (p_test == "physics_2d_broad_phase_benchmark") {
+
+		return TestPhysics2D::test_broad_phase_benchmark();
+	}
+
+	if (p_test == "physics_2d_query_benchmark") {
+
+		return TestPhysics2D::test_query_benchmark();
+	}
+
 	if (p_test == "render") {
 
 		return TestRender::test();
@@ -132,6 +181,11 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestGDScript::test(TestGDScript::TEST_BYTECODE);
 	}
 
+	if (p_test == "gd_benchmark") {
+
+		return TestGDScript::test(TestGDScript::TEST_BENCHMARK);
+	}
+
 	if (p_test == "ordered_hash_map") {
 
 		return TestOrderedHashMap::test();
@@ -142,6 +196,36 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestAStar::test();
 	}
 
+	if (p_test == "variant") {
+
+		return TestVariant::test();
+	}
+
+	if (p_test == "memory") {
+
+		return TestMemory::test();
+	}
+
+	if (p_test == "message_queue") {
+
+		return TestMessageQueue::test();
+	}
+
+	if (p_test == "command_queue") {
+
+		return TestCommandQueue::test();
+	}
+
+	if (p_test == "scene_tree") {
+
+		return TestSceneTree::test();
+	}
+
+	if (p_test == "signal") {
+
+		return TestSignal::test();
+	}
+
 	print_line("Unknown test: " + p_test);
 	return NULL;
 }
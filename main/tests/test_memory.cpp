@@ -0,0 +1,247 @@
+/*************************************************************************/
+/*  test_memory.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_memory.h"
+
+#include "core/os/os.h"
+#include "core/os/slab_allocator.h"
+#include "core/os/thread.h"
+
+#include <stdlib.h>
+
+namespace TestMemory {
+
+typedef bool (*TestFunc)(void);
+
+enum {
+	STRESS_ITERATIONS = 2000000,
+	STRESS_LIVE_SLOTS = 1024, // allocations kept alive per thread
+	PEAK_SPIKE_SIZE = 16 * 1024 * 1024,
+	PEAK_BLOCK_SIZE = 1024 * 1024,
+	PEAK_BLOCKS = 32,
+	PEAK_TOLERANCE = 2 * 1024 * 1024, // the peak is tracked in batches per thread
+};
+
+struct StressData {
+	bool slab;
+	uint32_t seed;
+	bool ok;
+};
+
+// Mix of sizes resembling engine objects: mostly list/map elements and variants, some strings and buffers.
+static size_t _stress_size(uint32_t &r_seed) {
+
+	r_seed = r_seed * 1103515245 + 12345;
+	uint32_t r = (r_seed >> 16) & 0x7FFF;
+	if (r < 24000)
+		return 16 + r % 112;
+	if (r < 31000)
+		return 128 + r % 896;
+	return 1024 + r % 8192;
+}
+
+static void _stress_thread(void *p_userdata) {
+
+	StressData *data = (StressData *)p_userdata;
+
+	void *ptrs[STRESS_LIVE_SLOTS] = {};
+	size_t sizes[STRESS_LIVE_SLOTS] = {};
+	uint32_t seed = data->seed;
+
+	for (int i = 0; i < STRESS_ITERATIONS; i++) {
+
+		int slot = i % STRESS_LIVE_SLOTS;
+		if (ptrs[slot]) {
+			if (*(uint8_t *)ptrs[slot] != uint8_t(slot)) {
+				data->ok = false;
+			}
+			if (data->slab)
+				SlabAllocator::free(ptrs[slot], sizes[slot]);
+			else
+				free(ptrs[slot]);
+		}
+
+		sizes[slot] = _stress_size(seed);
+		ptrs[slot] = data->slab ? SlabAllocator::alloc(sizes[slot]) : malloc(sizes[slot]);
+		*(uint8_t *)ptrs[slot] = uint8_t(slot);
+	}
+
+	for (int i = 0; i < STRESS_LIVE_SLOTS; i++) {
+		if (!ptrs[i])
+			continue;
+		if (data->slab)
+			SlabAllocator::free(ptrs[i], sizes[i]);
+		else
+			free(ptrs[i]);
+	}
+}
+
+static uint64_t _run_stress(int p_threads, bool p_slab, bool &r_ok) {
+
+	std::vector<StressData> data(p_threads);
+	std::vector<Thread *> threads(p_threads);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_threads; i++) {
+		data[i].slab = p_slab;
+		data[i].seed = 1234 + i;
+		data[i].ok = true;
+		threads[i] = Thread::create(_stress_thread, &data[i]);
+	}
+
+	for (int i = 0; i < p_threads; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+		r_ok = r_ok && data[i].ok;
+	}
+
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+#ifdef DEBUG_ENABLED
+static void _peak_alloc_thread(void *p_userdata) {
+
+	*(void **)p_userdata = memalloc(PEAK_BLOCK_SIZE);
+}
+
+static void _peak_free_thread(void *p_userdata) {
+
+	memfree(*(void **)p_userdata);
+}
+#endif
+
+bool test_1() {
+
+	OS::get_singleton()->print("\n\nTest 1: multi-threaded alloc/free throughput, slab allocator vs malloc\n");
+
+	bool ok = true;
+	int max_threads = MAX(OS::get_singleton()->get_processor_count(), 1);
+
+	for (int threads = 1; threads <= max_threads; threads *= 2) {
+
+		uint64_t malloc_usec = _run_stress(threads, false, ok);
+		uint64_t slab_usec = _run_stress(threads, true, ok);
+
+		double ops = double(STRESS_ITERATIONS) * threads;
+		OS::get_singleton()->print("\t%2d threads: malloc %8.2f Mops/s, slab %8.2f Mops/s\n", threads, ops / MAX(malloc_usec, 1), ops / MAX(slab_usec, 1));
+	}
+
+	OS::get_singleton()->print("\tsize class stats:\n");
+	for (int i = 0; i < SlabAllocator::get_size_class_count(); i++) {
+
+		SlabAllocator::SizeClassStats stats;
+		SlabAllocator::get_size_class_stats(i, &stats);
+		OS::get_singleton()->print("\t\t%4d bytes: %10d allocs, %10d frees, %4d spans, %6d blocks in depot\n", stats.block_size, (int)stats.allocs, (int)stats.frees, (int)stats.spans, (int)stats.depot_blocks);
+	}
+
+	return ok;
+}
+
+bool test_2() {
+
+	OS::get_singleton()->print("\n\nTest 2: peak memory usage between reads\n");
+
+#ifdef DEBUG_ENABLED
+	bool ok = true;
+
+	// A spike nothing reads the usage during must still raise the peak.
+	uint64_t usage = Memory::get_mem_usage();
+	uint64_t spike_size = Memory::get_mem_max_usage() - usage + PEAK_SPIKE_SIZE;
+	void *spike = memalloc(spike_size);
+	memfree(spike);
+
+	uint64_t peak = Memory::get_mem_max_usage();
+	OS::get_singleton()->print("\tusage %d KB, spike of %d KB, peak %d KB\n", int(usage / 1024), int(spike_size / 1024), int(peak / 1024));
+	if (peak + PEAK_TOLERANCE < usage + spike_size) {
+		OS::get_singleton()->print("\tspike missed\n");
+		ok = false;
+	}
+
+	// Blocks allocated by a thread and freed by another one must not add up.
+	for (int i = 0; i < PEAK_BLOCKS; i++) {
+
+		void *block = NULL;
+		Thread *thread = Thread::create(_peak_alloc_thread, &block);
+		Thread::wait_to_finish(thread);
+		memdelete(thread);
+		thread = Thread::create(_peak_free_thread, &block);
+		Thread::wait_to_finish(thread);
+		memdelete(thread);
+	}
+
+	uint64_t cross_thread_peak = Memory::get_mem_max_usage();
+	OS::get_singleton()->print("\tpeak after %d blocks freed by other threads %d KB\n", PEAK_BLOCKS, int(cross_thread_peak / 1024));
+	if (cross_thread_peak > peak + PEAK_TOLERANCE) {
+		OS::get_singleton()->print("\tpeak grew\n");
+		ok = false;
+	}
+
+	return ok;
+#else
+	OS::get_singleton()->print("\tusage is only tracked in debug builds, skipped\n");
+	return true;
+#endif
+}
+
+TestFunc test_funcs[] = {
+
+	test_1,
+	test_2,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestMemory
@@ -0,0 +1,271 @@
+/*************************************************************************/
+/*  test_message_queue.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_message_queue.h"
+
+#include "core/class_db.h"
+#include "core/message_queue.h"
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/project_settings.h"
+
+#include <atomic>
+#include <vector>
+
+namespace TestMessageQueue {
+
+typedef bool (*TestFunc)(void);
+
+enum {
+	SEGMENT_KB = 64, // Size of the segments the queue allocates.
+	THREAD_MESSAGES = 100,
+	MAIN_THREAD_MESSAGES = 4000, // Several segments worth.
+	MESSAGE_HEADER_MAX = 64, // A message is a header smaller than this and its arguments.
+};
+
+class MessageReceiver : public Object {
+
+	GDCLASS(MessageReceiver, Object);
+
+public:
+	std::vector<int> received;
+
+	void _receive(int p_sequence) {
+
+		received.push_back(p_sequence);
+	}
+
+protected:
+	static void _bind_methods() {
+
+		ClassDB::bind_method(D_METHOD("_receive", "sequence"), &MessageReceiver::_receive);
+	}
+};
+
+struct ProducerData {
+
+	ObjectID target;
+	Mutex *mutex;
+	int next_sequence;
+	std::atomic<int> finished;
+	int thread_count;
+	bool ok;
+};
+
+// Pushes under a lock, so the sequence numbers are the order the messages must be flushed in.
+static bool _push(ProducerData *p_data) {
+
+	p_data->mutex->lock();
+	int sequence = p_data->next_sequence;
+	Error err = MessageQueue::get_singleton()->push_call(p_data->target, "_receive", sequence);
+	if (err == OK) {
+		p_data->next_sequence++;
+	}
+	p_data->mutex->unlock();
+
+	return err == OK;
+}
+
+static void _producer_thread(void *p_userdata) {
+
+	ProducerData *data = (ProducerData *)p_userdata;
+
+	for (int i = 0; i < THREAD_MESSAGES; i++) {
+		if (!_push(data)) {
+			data->ok = false;
+		}
+	}
+
+	// Stay alive until every thread pushed, so no thread takes over the producer of another one.
+	data->finished++;
+	while (data->finished.load() < data->thread_count) {
+		OS::get_singleton()->delay_usec(100);
+	}
+}
+
+static bool _check_order(const MessageReceiver *p_receiver, int p_count) {
+
+	if ((int)p_receiver->received.size() != p_count) {
+		OS::get_singleton()->print("\treceived %d messages of %d\n", (int)p_receiver->received.size(), p_count);
+		return false;
+	}
+	for (int i = 0; i < p_count; i++) {
+		if (p_receiver->received[i] != i) {
+			OS::get_singleton()->print("\tmessage %d flushed in position %d\n", p_receiver->received[i], i);
+			return false;
+		}
+	}
+	return true;
+}
+
+static int _get_queue_size_kb() {
+
+	return GLOBAL_GET("memory/limits/message_queue/max_size_kb");
+}
+
+bool test_1() {
+
+	OS::get_singleton()->print("\n\nTest 1: more threads than the queue size holds segments for, then overflowing segments\n");
+
+	MessageQueue::get_singleton()->flush();
+
+	MessageReceiver *receiver = memnew(MessageReceiver);
+
+	ProducerData data;
+	data.target = receiver->get_instance_id();
+	data.mutex = Mutex::create();
+	data.next_sequence = 0;
+	data.finished = 0;
+	data.thread_count = _get_queue_size_kb() / SEGMENT_KB + 4;
+	data.ok = true;
+
+	std::vector<Thread *> threads(data.thread_count);
+	for (int i = 0; i < data.thread_count; i++) {
+		threads[i] = Thread::create(_producer_thread, &data);
+	}
+	for (int i = 0; i < data.thread_count; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	bool ok = data.ok;
+	if (!ok) {
+		OS::get_singleton()->print("\ta thread failed to push\n");
+	}
+
+	for (int i = 0; i < MAIN_THREAD_MESSAGES; i++) {
+		if (!_push(&data)) {
+			OS::get_singleton()->print("\tthe main thread failed to push message %d\n", i);
+			ok = false;
+			break;
+		}
+	}
+
+	OS::get_singleton()->print("\t%d threads, %d messages\n", data.thread_count, data.next_sequence);
+
+	MessageQueue::get_singleton()->flush();
+	ok = _check_order(receiver, data.next_sequence) && ok;
+
+	memdelete(data.mutex);
+	memdelete(receiver);
+
+	return ok;
+}
+
+bool test_2() {
+
+	OS::get_singleton()->print("\n\nTest 2: pushing until the queue is full\n");
+
+	MessageQueue::get_singleton()->flush();
+
+	MessageReceiver *receiver = memnew(MessageReceiver);
+
+	ProducerData data;
+	data.target = receiver->get_instance_id();
+	data.mutex = Mutex::create();
+	data.next_sequence = 0;
+
+	uint64_t queue_size = uint64_t(_get_queue_size_kb()) * 1024;
+	int max_messages = queue_size / sizeof(Variant) + 1;
+	bool full = false;
+	for (int i = 0; i < max_messages && !full; i++) {
+		full = !_push(&data);
+	}
+
+	// Messages may only be refused once the queue holds about as much as its size.
+	int expected = (queue_size - SEGMENT_KB * 1024) / (MESSAGE_HEADER_MAX + sizeof(Variant));
+	OS::get_singleton()->print("\t%d messages fit in %d KB, %d expected at least\n", data.next_sequence, int(queue_size / 1024), expected);
+
+	bool ok = true;
+	if (!full) {
+		OS::get_singleton()->print("\tthe queue never refused a message\n");
+		ok = false;
+	}
+	if (data.next_sequence < expected) {
+		ok = false;
+	}
+
+	MessageQueue::get_singleton()->flush();
+	ok = _check_order(receiver, data.next_sequence) && ok;
+
+	// Flushed segments must be reusable.
+	receiver->received.clear();
+	data.next_sequence = 0;
+	for (int i = 0; i < MAIN_THREAD_MESSAGES; i++) {
+		if (!_push(&data)) {
+			OS::get_singleton()->print("\tfailed to push after flushing a full queue\n");
+			ok = false;
+			break;
+		}
+	}
+	MessageQueue::get_singleton()->flush();
+	ok = _check_order(receiver, data.next_sequence) && ok;
+
+	memdelete(data.mutex);
+	memdelete(receiver);
+
+	return ok;
+}
+
+TestFunc test_funcs[] = {
+
+	test_1,
+	test_2,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestMessageQueue
@@ -35,9 +35,15 @@
 #include "core/map.h"
 #include "core/math/math_funcs.h"
 #include "core/math/quick_hull.h"
+#include "core/math/random_pcg.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/os/thread_pool.h"
 #include "core/print_string.h"
+#include "servers/physics/body_sw.h"
+#include "servers/physics/broad_phase_bvh.h"
+#include "servers/physics/broad_phase_octree.h"
 #include "servers/physics_server.h"
 #include "servers/visual_server.h"
 
@@ -431,10 +437,602 @@ public:
 	}
 };
 
+// Headless, steps the server directly: stacks of boxes on a plane shared by every island.
+class TestPhysicsBenchmarkMainLoop : public MainLoop {
+
+	GDCLASS(TestPhysicsBenchmarkMainLoop, MainLoop);
+
+	enum {
+		STACK_HEIGHT = 5,
+		FRAMES = 30,
+	};
+
+	RID space;
+	RID plane_shape;
+	RID box_shape;
+	RID plane;
+	std::vector<RID> boxes;
+
+	void _create_scene(int p_body_count) {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+
+		space = ps->space_create();
+		ps->space_set_active(space, true);
+
+		plane_shape = ps->shape_create(PhysicsServer::SHAPE_PLANE);
+		ps->shape_set_data(plane_shape, Plane(Vector3(0, 1, 0), 0));
+		plane = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+		ps->body_set_space(plane, space);
+		ps->body_add_shape(plane, plane_shape);
+
+		box_shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+		ps->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+
+		int stacks = p_body_count / STACK_HEIGHT;
+		int side = Math::ceil(Math::sqrt((double)stacks));
+
+		for (int i = 0; i < stacks; i++) {
+			for (int j = 0; j < STACK_HEIGHT; j++) {
+				RID box = ps->body_create(PhysicsServer::BODY_MODE_RIGID);
+				ps->body_set_space(box, space);
+				ps->body_add_shape(box, box_shape);
+				// Slightly apart and rotated, so the stacks settle during the run.
+				Transform t;
+				t.basis.rotate(Vector3(0, 1, 0), j * 0.1);
+				t.origin = Vector3((i % side) * 3.0, 0.55 + j * 1.05, (i / side) * 3.0);
+				ps->body_set_state(box, PhysicsServer::BODY_STATE_TRANSFORM, t);
+				boxes.push_back(box);
+			}
+		}
+	}
+
+	void _free_scene() {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+
+		for (size_t i = 0; i < boxes.size(); i++) {
+			ps->free(boxes[i]);
+		}
+		boxes.clear();
+		ps->free(plane);
+		ps->free(box_shape);
+		ps->free(plane_shape);
+		ps->free(space);
+	}
+
+	uint64_t _run(int p_body_count, std::vector<Transform> &r_transforms) {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+
+		_create_scene(p_body_count);
+
+		uint64_t usec = 0;
+		for (int i = 0; i < FRAMES; i++) {
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			ps->step(1.0 / 60.0);
+			usec += OS::get_singleton()->get_ticks_usec() - begin;
+			ps->sync();
+			ps->flush_queries();
+		}
+
+		r_transforms.resize(boxes.size());
+		for (size_t i = 0; i < boxes.size(); i++) {
+			r_transforms[i] = ps->body_get_state(boxes[i], PhysicsServer::BODY_STATE_TRANSFORM);
+		}
+
+		_free_scene();
+		return usec / FRAMES;
+	}
+
+public:
+	virtual void init() {
+
+		static const int body_counts[] = { 5000, 20000, 50000 };
+
+		if (!PhysicsServer::get_singleton()->is_class("PhysicsServerSW")) {
+			OS::get_singleton()->print("The benchmark needs GodotPhysics, set physics/3d/physics_engine in the project settings.\n");
+			return;
+		}
+
+		std::vector<int> thread_workers;
+		int max_workers = MAX(1, OS::get_singleton()->get_processor_count() - 1);
+		for (int workers = 0; workers < max_workers; workers = workers * 2 + 1) {
+			thread_workers.push_back(workers);
+		}
+		thread_workers.push_back(max_workers);
+
+		OS::get_singleton()->print("\n\nIsland solver scaling, stacks of %d boxes, %d frames\n", STACK_HEIGHT, FRAMES);
+
+		bool failed = false;
+
+		for (int i = 0; i < 3; i++) {
+
+			std::vector<Transform> serial_transforms;
+			uint64_t serial_usec = 0;
+
+			for (size_t j = 0; j < thread_workers.size(); j++) {
+
+				ThreadPool::get_singleton()->finish();
+				ThreadPool::get_singleton()->init(thread_workers[j]);
+
+				std::vector<Transform> transforms;
+				uint64_t usec = _run(body_counts[i], transforms);
+
+				if (thread_workers[j] == 0) {
+					serial_usec = usec;
+					serial_transforms = transforms;
+					OS::get_singleton()->print("\t%6d bodies, stepping thread only: %7d usec/frame\n", body_counts[i], (int)usec);
+					continue;
+				}
+
+				// Islands are independent, any schedule must give the same bits.
+				if (transforms != serial_transforms) {
+					OS::get_singleton()->print("\tthreaded results differ from the serial ones\n");
+					failed = true;
+				}
+				OS::get_singleton()->print("\t%6d bodies, %2d workers:           %7d usec/frame (%.2fx)\n", body_counts[i], thread_workers[j], (int)usec, usec ? (double)serial_usec / usec : 0.0);
+			}
+		}
+
+		ThreadPool::get_singleton()->finish();
+		ThreadPool::get_singleton()->init();
+
+		OS::get_singleton()->print("\t%s\n", failed ? "FAILED" : "PASS");
+	}
+
+	virtual bool iteration(float p_time) {
+		return true;
+	}
+
+	virtual bool idle(float p_time) {
+		return true;
+	}
+
+	virtual void finish() {
+	}
+};
+
+class TestPhysicsBroadPhaseMainLoop : public MainLoop {
+
+	GDCLASS(TestPhysicsBroadPhaseMainLoop, MainLoop);
+
+	enum {
+		FRAMES = 60,
+		QUERIES = 100,
+	};
+
+	struct Scene {
+		const char *name;
+		int static_count;
+		int dynamic_count;
+		real_t speed;
+	};
+
+	struct Result {
+		uint64_t create_usec;
+		uint64_t move_usec;
+		std::vector<int> pair_counts; // After every frame.
+		std::vector<int> query_counts;
+		int pairs_left; // After removing everything.
+	};
+
+	std::vector<BodySW *> owners;
+	std::vector<Vector3> positions;
+	std::vector<Vector3> velocities;
+	real_t extent;
+
+	static void *_pair(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_userdata) {
+
+		(*(int *)p_userdata)++;
+		return NULL;
+	}
+
+	static void _unpair(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_data, void *p_userdata) {
+
+		(*(int *)p_userdata)--;
+	}
+
+	void _create_scene(const Scene &p_scene) {
+
+		RandomPCG rng(12345);
+
+		int count = p_scene.static_count + p_scene.dynamic_count;
+		// About one unit box per 8 cubic units, so neighbours touch now and then.
+		extent = Math::pow(count * 8.0, 1.0 / 3.0);
+		int side = MAX(1, (int)Math::ceil(Math::pow((double)p_scene.static_count, 1.0 / 3.0)));
+		real_t spacing = extent / side;
+
+		for (int i = 0; i < count; i++) {
+
+			owners.push_back(memnew(BodySW));
+			if (i < p_scene.static_count) {
+				positions.push_back(Vector3(i % side, (i / side) % side, i / (side * side)) * spacing);
+				velocities.push_back(Vector3());
+			} else {
+				positions.push_back(Vector3(rng.randf(), rng.randf(), rng.randf()) * extent);
+				velocities.push_back(Vector3(rng.randf() - 0.5, rng.randf() - 0.5, rng.randf() - 0.5) * 2 * p_scene.speed);
+			}
+		}
+	}
+
+	void _free_scene() {
+
+		for (size_t i = 0; i < owners.size(); i++) {
+			memdelete(owners[i]);
+		}
+		owners.clear();
+		positions.clear();
+		velocities.clear();
+	}
+
+	void _run(BroadPhaseSW *p_broad_phase, const Scene &p_scene, Result &r_result) {
+
+		static const real_t delta = 1.0 / 60.0;
+		const Vector3 half_size(0.5, 0.5, 0.5);
+
+		int pair_count = 0;
+		p_broad_phase->set_pair_callback(_pair, &pair_count);
+		p_broad_phase->set_unpair_callback(_unpair, &pair_count);
+
+		std::vector<Vector3> current = positions;
+		std::vector<Vector3> velocity = velocities;
+		std::vector<BroadPhaseSW::ID> ids(owners.size());
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (size_t i = 0; i < owners.size(); i++) {
+			ids[i] = p_broad_phase->create(owners[i]);
+			p_broad_phase->set_static(ids[i], (int)i < p_scene.static_count);
+			p_broad_phase->move(ids[i], AABB(current[i] - half_size, half_size * 2));
+		}
+		r_result.create_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+		r_result.move_usec = 0;
+		for (int f = 0; f < FRAMES; f++) {
+
+			// Bounce around in the scene volume.
+			for (size_t i = p_scene.static_count; i < owners.size(); i++) {
+				current[i] += velocity[i] * delta;
+				for (int j = 0; j < 3; j++) {
+					if ((current[i][j] < 0 && velocity[i][j] < 0) || (current[i][j] > extent && velocity[i][j] > 0)) {
+						velocity[i][j] = -velocity[i][j];
+					}
+				}
+			}
+
+			begin = OS::get_singleton()->get_ticks_usec();
+			for (size_t i = p_scene.static_count; i < owners.size(); i++) {
+				p_broad_phase->move(ids[i], AABB(current[i] - half_size, half_size * 2));
+			}
+			r_result.move_usec += OS::get_singleton()->get_ticks_usec() - begin;
+			r_result.pair_counts.push_back(pair_count);
+		}
+		r_result.move_usec /= FRAMES;
+
+		CollisionObjectSW *results[1024];
+		for (int i = 0; i < QUERIES; i++) {
+			Vector3 point = current[(i * 7919) % current.size()];
+			r_result.query_counts.push_back(p_broad_phase->cull_aabb(AABB(point - Vector3(2, 2, 2), Vector3(4, 4, 4)), results, 1024));
+			r_result.query_counts.push_back(p_broad_phase->cull_point(point, results, 1024));
+			r_result.query_counts.push_back(p_broad_phase->cull_segment(point, point + Vector3(10, 5, 3), results, 1024));
+		}
+
+		for (size_t i = 0; i < owners.size(); i++) {
+			p_broad_phase->remove(ids[i]);
+		}
+		r_result.pairs_left = pair_count;
+	}
+
+public:
+	virtual void init() {
+
+		static const Scene scenes[] = {
+			{ "static-heavy", 20000, 1000, 5 },
+			{ "dynamic-heavy", 1000, 20000, 5 },
+			{ "fast dynamic", 0, 20000, 30 },
+		};
+
+		OS::get_singleton()->print("\n\nBroad phase pair updates, unit boxes, %d frames\n", FRAMES);
+
+		bool failed = false;
+
+		for (int i = 0; i < 3; i++) {
+
+			_create_scene(scenes[i]);
+
+			Result octree;
+			BroadPhaseSW *broad_phase = memnew(BroadPhaseOctree);
+			_run(broad_phase, scenes[i], octree);
+			memdelete(broad_phase);
+
+			Result bvh;
+			broad_phase = memnew(BroadPhaseBVH);
+			_run(broad_phase, scenes[i], bvh);
+			memdelete(broad_phase);
+
+			_free_scene();
+
+			// Both report every intersecting pair when it starts and stops intersecting.
+			if (bvh.pair_counts != octree.pair_counts || bvh.query_counts != octree.query_counts || bvh.pairs_left || octree.pairs_left) {
+				OS::get_singleton()->print("\tBVH results differ from the octree ones\n");
+				failed = true;
+			}
+
+			OS::get_singleton()->print("\t%s, %d static, %d moving, %d pairs:\n", scenes[i].name, scenes[i].static_count, scenes[i].dynamic_count, bvh.pair_counts.back());
+			OS::get_singleton()->print("\t\toctree: %7d usec to create, %7d usec/frame to move\n", (int)octree.create_usec, (int)octree.move_usec);
+			OS::get_singleton()->print("\t\tBVH:    %7d usec to create, %7d usec/frame to move (%.2fx)\n", (int)bvh.create_usec, (int)bvh.move_usec, bvh.move_usec ? (double)octree.move_usec / bvh.move_usec : 0.0);
+		}
+
+		OS::get_singleton()->print("\t%s\n", failed ? "FAILED" : "PASS");
+	}
+
+	virtual bool iteration(float p_time) {
+		return true;
+	}
+
+	virtual bool idle(float p_time) {
+		return true;
+	}
+
+	virtual void finish() {
+	}
+};
+
+class TestPhysicsQueryMainLoop : public MainLoop {
+
+	GDCLASS(TestPhysicsQueryMainLoop, MainLoop);
+
+	enum {
+		GRID_SIZE = 100,
+		CROWD_SIZE = 5000, // More than the 2048 results the spaces used to be limited to.
+		RAYS = 100000,
+		EXCLUDES = 16,
+		CROWD_QUERIES = 200,
+		QUERY_THREADS = 4,
+	};
+
+	RID space;
+	RID grid_shape;
+	RID crowd_shape;
+	RID sphere_shape;
+	std::vector<RID> grid;
+	std::vector<RID> crowd;
+
+	RID _create_box(RID p_shape, const Vector3 &p_origin) {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+
+		RID body = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, p_shape);
+		ps->body_set_state(body, PhysicsServer::BODY_STATE_TRANSFORM, Transform(Basis(), p_origin));
+		return body;
+	}
+
+	void _create_scene() {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+
+		space = ps->space_create();
+
+		grid_shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+		ps->shape_set_data(grid_shape, Vector3(0.5, 0.5, 0.5));
+		for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+			grid.push_back(_create_box(grid_shape, Vector3((i % GRID_SIZE) * 2.0, 0, (i / GRID_SIZE) * 2.0)));
+		}
+
+		// Tall boxes piled in one column, away from the grid. All of them contain its middle.
+		crowd_shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+		ps->shape_set_data(crowd_shape, Vector3(1, 30, 1));
+		for (int i = 0; i < CROWD_SIZE; i++) {
+			crowd.push_back(_create_box(crowd_shape, Vector3(-10, i * 0.01, -10)));
+		}
+
+		sphere_shape = ps->shape_create(PhysicsServer::SHAPE_SPHERE);
+		ps->shape_set_data(sphere_shape, 2.0);
+	}
+
+	void _free_scene() {
+
+		PhysicsServer *ps = PhysicsServer::get_singleton();
+
+		for (size_t i = 0; i < grid.size(); i++) {
+			ps->free(grid[i]);
+		}
+		grid.clear();
+		for (size_t i = 0; i < crowd.size(); i++) {
+			ps->free(crowd[i]);
+		}
+		crowd.clear();
+		ps->free(sphere_shape);
+		ps->free(crowd_shape);
+		ps->free(grid_shape);
+		ps->free(space);
+	}
+
+	// Casts rays straight down on the grid, returns rays per second.
+	double _cast_rays(PhysicsDirectSpaceState *p_state, const std::vector<RID> &p_exclude, bool p_rebuild_exclude, int &r_hits) {
+
+		RandomPCG rng(7);
+		PhysicsDirectSpaceState::RayResult result;
+		VSet<RID> exclude;
+		for (size_t i = 0; i < p_exclude.size(); i++) {
+			exclude.insert(p_exclude[i]);
+		}
+		r_hits = 0;
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < RAYS; i++) {
+			Vector3 from(rng.randf() * GRID_SIZE * 2.0, 10, rng.randf() * GRID_SIZE * 2.0);
+			bool hit;
+			if (p_rebuild_exclude) {
+				// Built for every ray, like when scripts pass an array of RIDs.
+				VSet<RID> rebuilt;
+				for (size_t j = 0; j < p_exclude.size(); j++) {
+					rebuilt.insert(p_exclude[j]);
+				}
+				hit = p_state->intersect_ray(from, from - Vector3(0, 20, 0), result, rebuilt);
+			} else {
+				hit = p_state->intersect_ray(from, from - Vector3(0, 20, 0), result, exclude);
+			}
+			if (hit) {
+				r_hits++;
+			}
+		}
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+		return usec ? RAYS * 1000000.0 / usec : 0.0;
+	}
+
+	struct QueryThreadData {
+		TestPhysicsQueryMainLoop *test;
+		PhysicsDirectSpaceState *state;
+		Transform middle;
+		int missed;
+	};
+
+	// Like scripts in process thread groups, queries the column from several threads at once.
+	static void _query_thread(void *p_userdata) {
+
+		QueryThreadData *data = (QueryThreadData *)p_userdata;
+		std::vector<PhysicsDirectSpaceState::ShapeResult> results;
+		for (int i = 0; i < CROWD_QUERIES; i++) {
+			if (data->state->intersect_shape_all(data->test->sphere_shape, data->middle, 0, results) != CROWD_SIZE) {
+				data->missed++;
+			}
+			if (data->state->intersect_point_all(data->middle.origin, results) != CROWD_SIZE) {
+				data->missed++;
+			}
+		}
+	}
+
+public:
+	virtual void init() {
+
+		if (!PhysicsServer::get_singleton()->is_class("PhysicsServerSW")) {
+			OS::get_singleton()->print("The benchmark needs GodotPhysics, set physics/3d/physics_engine in the project settings.\n");
+			return;
+		}
+
+		_create_scene();
+
+		PhysicsDirectSpaceState *state = PhysicsServer::get_singleton()->space_get_direct_state(space);
+		ERR_FAIL_COND(!state);
+
+		OS::get_singleton()->print("\n\nSpace queries, %d grid boxes, a column of %d overlapping boxes\n", GRID_SIZE * GRID_SIZE, CROWD_SIZE);
+
+		bool failed = false;
+
+		int hits;
+		double rays_per_sec = _cast_rays(state, std::vector<RID>(), false, hits);
+		OS::get_singleton()->print("\t%8d rays/sec, %d hits\n", (int)rays_per_sec, hits);
+
+		// Bodies the rays never reach, so the hits must not change.
+		std::vector<RID> out_of_reach;
+		for (int i = 0; i < EXCLUDES; i++) {
+			out_of_reach.push_back(crowd[i * 97]);
+		}
+		for (int i = 0; i < 2; i++) {
+			int exclude_hits;
+			rays_per_sec = _cast_rays(state, out_of_reach, i == 1, exclude_hits);
+			OS::get_singleton()->print("\t%8d rays/sec excluding %d bodies%s, %d hits\n", (int)rays_per_sec, EXCLUDES, i == 1 ? " rebuilt for every ray" : "", exclude_hits);
+			if (exclude_hits != hits) {
+				OS::get_singleton()->print("\texcluding bodies out of reach changed the hits\n");
+				failed = true;
+			}
+		}
+
+		// Every body of the column must be considered to find the closest hit.
+		PhysicsDirectSpaceState::RayResult result;
+		Vector3 top(-10, 100, -10);
+		if (!state->intersect_ray(top, top - Vector3(0, 200, 0), result) || result.rid != crowd.back()) {
+			OS::get_singleton()->print("\tthe ray missed the top of the column\n");
+			failed = true;
+		}
+		VSet<RID> exclude;
+		exclude.insert(crowd.back());
+		if (!state->intersect_ray(top, top - Vector3(0, 200, 0), result, exclude) || result.rid != crowd[CROWD_SIZE - 2]) {
+			OS::get_singleton()->print("\tthe ray didn't skip the excluded body\n");
+			failed = true;
+		}
+
+		std::vector<PhysicsDirectSpaceState::ShapeResult> results;
+		Transform middle(Basis(), Vector3(-10, 25, -10));
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		int shape_count = 0;
+		for (int i = 0; i < CROWD_QUERIES; i++) {
+			shape_count = state->intersect_shape_all(sphere_shape, middle, 0, results);
+		}
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+		OS::get_singleton()->print("\t%8d usec per shape query, %d results\n", (int)(usec / CROWD_QUERIES), shape_count);
+
+		begin = OS::get_singleton()->get_ticks_usec();
+		int point_count = 0;
+		for (int i = 0; i < CROWD_QUERIES; i++) {
+			point_count = state->intersect_point_all(middle.origin, results);
+		}
+		usec = OS::get_singleton()->get_ticks_usec() - begin;
+		OS::get_singleton()->print("\t%8d usec per point query, %d results\n", (int)(usec / CROWD_QUERIES), point_count);
+
+		if (shape_count != CROWD_SIZE || point_count != CROWD_SIZE) {
+			OS::get_singleton()->print("\tthe queries missed bodies of the column\n");
+			failed = true;
+		}
+
+		QueryThreadData data[QUERY_THREADS];
+		Thread *threads[QUERY_THREADS];
+		for (int i = 0; i < QUERY_THREADS; i++) {
+			data[i].test = this;
+			data[i].state = state;
+			data[i].middle = middle;
+			data[i].missed = 0;
+			threads[i] = Thread::create(_query_thread, &data[i]);
+		}
+		for (int i = 0; i < QUERY_THREADS; i++) {
+			Thread::wait_to_finish(threads[i]);
+			memdelete(threads[i]);
+			if (data[i].missed) {
+				OS::get_singleton()->print("\tconcurrent queries missed bodies of the column\n");
+				failed = true;
+			}
+		}
+
+		_free_scene();
+
+		OS::get_singleton()->print("\t%s\n", failed ? "FAILED" : "PASS");
+	}
+
+	virtual bool iteration(float p_time) {
+		return true;
+	}
+
+	virtual bool idle(float p_time) {
+		return true;
+	}
+
+	virtual void finish() {
+	}
+};
+
 namespace TestPhysics {
 
 MainLoop *test() {
 
 	return memnew(TestPhysicsMainLoop);
 }
+
+MainLoop *test_benchmark() {
+
+	return memnew(TestPhysicsBenchmarkMainLoop);
+}
+
+MainLoop *test_broad_phase_benchmark() {
+
+	return memnew(TestPhysicsBroadPhaseMainLoop);
+}
+
+MainLoop *test_query_benchmark() {
+
+	return memnew(TestPhysicsQueryMainLoop);
+}
 } // namespace TestPhysics
@@ -36,6 +36,9 @@
 namespace TestPhysics {
 
 MainLoop *test();
+MainLoop *test_benchmark();
+MainLoop *test_broad_phase_benchmark();
+MainLoop *test_query_benchmark();
 }
 
 #endif
@@ -33,10 +33,17 @@
 #include <vector>
 
 #include "core/map.h"
+#include "core/math/random_pcg.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/os/thread_pool.h"
 #include "core/print_string.h"
+#include "core/project_settings.h"
 #include "scene/resources/texture.h"
+#include "servers/physics_2d/body_2d_sw.h"
+#include "servers/physics_2d/broad_phase_2d_bvh.h"
+#include "servers/physics_2d/broad_phase_2d_hash_grid.h"
 #include "servers/physics_2d_server.h"
 #include "servers/visual_server.h"
 
@@ -429,10 +436,654 @@ public:
 	TestPhysics2DMainLoop() {}
 };
 
+// Headless, steps the server directly: debris piles in a row, on a ground line shared by every island.
+class TestPhysics2DBenchmarkMainLoop : public MainLoop {
+
+	GDCLASS(TestPhysics2DBenchmarkMainLoop, MainLoop);
+
+	enum {
+		PILE_HEIGHT = 5,
+		FRAMES = 30,
+	};
+
+	RID space;
+	RID line_shape;
+	RID box_shape;
+	RID ground;
+	std::vector<RID> boxes;
+
+	void _create_scene(int p_body_count) {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		space = ps->space_create();
+		ps->space_set_active(space, true);
+		ps->area_set_param(space, Physics2DServer::AREA_PARAM_GRAVITY, 98);
+		ps->area_set_param(space, Physics2DServer::AREA_PARAM_GRAVITY_VECTOR, Vector2(0, 1));
+
+		Array arr;
+		arr.push_back(Vector2(0, -1));
+		arr.push_back(0);
+		line_shape = ps->line_shape_create();
+		ps->shape_set_data(line_shape, arr);
+		ground = ps->body_create();
+		ps->body_set_mode(ground, Physics2DServer::BODY_MODE_STATIC);
+		ps->body_set_space(ground, space);
+		ps->body_add_shape(ground, line_shape);
+
+		box_shape = ps->rectangle_shape_create();
+		ps->shape_set_data(box_shape, Vector2(10, 10));
+
+		for (int i = 0; i < p_body_count / PILE_HEIGHT; i++) {
+			for (int j = 0; j < PILE_HEIGHT; j++) {
+				RID box = ps->body_create();
+				ps->body_set_space(box, space);
+				ps->body_add_shape(box, box_shape);
+				// Slightly apart and rotated, so the piles settle during the run.
+				ps->body_set_state(box, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(j * 0.1, Vector2(i * 60.0, -11.0 - j * 21.0)));
+				boxes.push_back(box);
+			}
+		}
+	}
+
+	void _free_scene() {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		for (size_t i = 0; i < boxes.size(); i++) {
+			ps->free(boxes[i]);
+		}
+		boxes.clear();
+		ps->free(ground);
+		ps->free(box_shape);
+		ps->free(line_shape);
+		ps->free(space);
+	}
+
+	uint64_t _run(int p_body_count, std::vector<Transform2D> &r_transforms) {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		_create_scene(p_body_count);
+
+		uint64_t usec = 0;
+		for (int i = 0; i < FRAMES; i++) {
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			ps->step(1.0 / 60.0);
+			usec += OS::get_singleton()->get_ticks_usec() - begin;
+			ps->sync();
+			ps->flush_queries();
+		}
+
+		r_transforms.resize(boxes.size());
+		for (size_t i = 0; i < boxes.size(); i++) {
+			r_transforms[i] = ps->body_get_state(boxes[i], Physics2DServer::BODY_STATE_TRANSFORM);
+		}
+
+		_free_scene();
+		return usec / FRAMES;
+	}
+
+public:
+	virtual void init() {
+
+		static const int body_counts[] = { 5000, 20000, 50000 };
+
+		std::vector<int> thread_workers;
+		int max_workers = MAX(1, OS::get_singleton()->get_processor_count() - 1);
+		for (int workers = 0; workers < max_workers; workers = workers * 2 + 1) {
+			thread_workers.push_back(workers);
+		}
+		thread_workers.push_back(max_workers);
+
+		OS::get_singleton()->print("\n\n2D step scaling, piles of %d boxes, %d frames\n", PILE_HEIGHT, FRAMES);
+		if (!GLOBAL_GET("physics/2d/parallel_step")) {
+			OS::get_singleton()->print("\tphysics/2d/parallel_step is disabled, every run is serial\n");
+		}
+
+		bool failed = false;
+
+		for (int i = 0; i < 3; i++) {
+
+			std::vector<Transform2D> serial_transforms;
+			uint64_t serial_usec = 0;
+
+			for (size_t j = 0; j < thread_workers.size(); j++) {
+
+				ThreadPool::get_singleton()->finish();
+				ThreadPool::get_singleton()->init(thread_workers[j]);
+
+				std::vector<Transform2D> transforms;
+				uint64_t usec = _run(body_counts[i], transforms);
+
+				if (thread_workers[j] == 0) {
+					serial_usec = usec;
+					serial_transforms = transforms;
+					OS::get_singleton()->print("\t%6d bodies, stepping thread only: %7d usec/frame\n", body_counts[i], (int)usec);
+					continue;
+				}
+
+				// Bodies and islands are independent, any schedule must give the same bits.
+				if (transforms != serial_transforms) {
+					OS::get_singleton()->print("\tthreaded results differ from the serial ones\n");
+					failed = true;
+				}
+				OS::get_singleton()->print("\t%6d bodies, %2d workers:           %7d usec/frame (%.2fx)\n", body_counts[i], thread_workers[j], (int)usec, usec ? (double)serial_usec / usec : 0.0);
+			}
+		}
+
+		ThreadPool::get_singleton()->finish();
+		ThreadPool::get_singleton()->init();
+
+		OS::get_singleton()->print("\t%s\n", failed ? "FAILED" : "PASS");
+	}
+
+	virtual bool iteration(float p_time) {
+		return true;
+	}
+
+	virtual bool idle(float p_time) {
+		return true;
+	}
+
+	virtual void finish() {
+	}
+};
+
+class TestPhysics2DBroadPhaseMainLoop : public MainLoop {
+
+	GDCLASS(TestPhysics2DBroadPhaseMainLoop, MainLoop);
+
+	enum {
+		FRAMES = 60,
+		RAYS = 1000, // Per frame.
+		WORLD_SIZE = 8192,
+	};
+
+	struct Group {
+		int count;
+		Size2 min_size;
+		Size2 max_size;
+		real_t speed; // 0 for static bodies.
+	};
+
+	struct Scene {
+		const char *name;
+		Group groups[4];
+	};
+
+	struct Result {
+		uint64_t create_usec;
+		uint64_t move_usec;
+		uint64_t ray_usec;
+		std::vector<int> pair_counts; // After every frame.
+		std::vector<int> query_counts;
+		int pairs_left; // After removing everything.
+	};
+
+	std::vector<Body2DSW *> owners;
+	std::vector<Rect2> rects;
+	std::vector<Vector2> velocities;
+	int static_count;
+
+	static void *_pair(CollisionObject2DSW *A, int p_subindex_A, CollisionObject2DSW *B, int p_subindex_B, void *p_userdata) {
+
+		(*(int *)p_userdata)++;
+		return NULL;
+	}
+
+	static void _unpair(CollisionObject2DSW *A, int p_subindex_A, CollisionObject2DSW *B, int p_subindex_B, void *p_data, void *p_userdata) {
+
+		(*(int *)p_userdata)--;
+	}
+
+	void _create_scene(const Scene &p_scene) {
+
+		RandomPCG rng(12345);
+
+		// Static groups come first, they never move.
+		static_count = 0;
+		for (int i = 0; i < 4; i++) {
+
+			const Group &group = p_scene.groups[i];
+			for (int j = 0; j < group.count; j++) {
+
+				Size2 size = group.min_size + (group.max_size - group.min_size) * rng.randf();
+				Vector2 position = Vector2(rng.randf(), rng.randf()) * (Size2(WORLD_SIZE, WORLD_SIZE) - size);
+				real_t angle = rng.randf() * Math_PI * 2;
+
+				owners.push_back(memnew(Body2DSW));
+				rects.push_back(Rect2(position, size));
+				velocities.push_back(Vector2(Math::cos(angle), Math::sin(angle)) * group.speed);
+				if (group.speed == 0) {
+					static_count++;
+				}
+			}
+		}
+	}
+
+	void _free_scene() {
+
+		for (size_t i = 0; i < owners.size(); i++) {
+			memdelete(owners[i]);
+		}
+		owners.clear();
+		rects.clear();
+		velocities.clear();
+	}
+
+	void _run(BroadPhase2DSW *p_broad_phase, Result &r_result) {
+
+		static const real_t delta = 1.0 / 60.0;
+
+		int pair_count = 0;
+		p_broad_phase->set_pair_callback(_pair, &pair_count);
+		p_broad_phase->set_unpair_callback(_unpair, &pair_count);
+
+		std::vector<Rect2> current = rects;
+		std::vector<Vector2> velocity = velocities;
+		std::vector<BroadPhase2DSW::ID> ids(owners.size());
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (size_t i = 0; i < owners.size(); i++) {
+			ids[i] = p_broad_phase->create(owners[i]);
+			p_broad_phase->set_static(ids[i], (int)i < static_count);
+			p_broad_phase->move(ids[i], current[i]);
+		}
+		r_result.create_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+		RandomPCG rng(54321);
+		CollisionObject2DSW *results[2048];
+		int result_indices[2048];
+
+		r_result.move_usec = 0;
+		r_result.ray_usec = 0;
+		for (int f = 0; f < FRAMES; f++) {
+
+			// Bounce around in the world.
+			for (size_t i = static_count; i < owners.size(); i++) {
+				Rect2 &rect = current[i];
+				rect.position += velocity[i] * delta;
+				for (int j = 0; j < 2; j++) {
+					if ((rect.position[j] < 0 && velocity[i][j] < 0) || (rect.position[j] + rect.size[j] > WORLD_SIZE && velocity[i][j] > 0)) {
+						velocity[i][j] = -velocity[i][j];
+					}
+				}
+			}
+
+			begin = OS::get_singleton()->get_ticks_usec();
+			for (size_t i = static_count; i < owners.size(); i++) {
+				p_broad_phase->move(ids[i], current[i]);
+			}
+			r_result.move_usec += OS::get_singleton()->get_ticks_usec() - begin;
+			r_result.pair_counts.push_back(pair_count);
+
+			// Rays of up to 512 pixels, like bullets and line of sight checks.
+			begin = OS::get_singleton()->get_ticks_usec();
+			int hits = 0;
+			for (int i = 0; i < RAYS; i++) {
+				Vector2 from = Vector2(rng.randf(), rng.randf()) * WORLD_SIZE;
+				Vector2 to = from + Vector2(rng.randf() - 0.5, rng.randf() - 0.5) * 1024;
+				hits += p_broad_phase->cull_segment(from, to, results, 2048, result_indices);
+			}
+			r_result.ray_usec += OS::get_singleton()->get_ticks_usec() - begin;
+			r_result.query_counts.push_back(hits);
+
+			Vector2 center = Vector2(rng.randf(), rng.randf()) * WORLD_SIZE;
+			r_result.query_counts.push_back(p_broad_phase->cull_aabb(Rect2(center, Size2(256, 256)), results, 2048, result_indices));
+		}
+		r_result.move_usec /= FRAMES;
+		r_result.ray_usec /= FRAMES;
+
+		for (size_t i = 0; i < owners.size(); i++) {
+			p_broad_phase->remove(ids[i]);
+		}
+		r_result.pairs_left = pair_count;
+	}
+
+	void _print(const char *p_name, const Result &p_result) {
+
+		OS::get_singleton()->print("\t\t%-15s %7d usec to create, %6d usec/frame to move, %6d usec/frame for %d rays\n", p_name, (int)p_result.create_usec, (int)p_result.move_usec, (int)p_result.ray_usec, (int)RAYS);
+	}
+
+public:
+	virtual void init() {
+
+		static const Scene scenes[] = {
+			{ "mixed sizes",
+					{
+							{ 16, Size2(2048, 64), Size2(8192, 512), 0 }, // Level geometry.
+							{ 4000, Size2(32, 32), Size2(32, 32), 0 }, // Tiles.
+							{ 500, Size2(48, 64), Size2(48, 64), 100 }, // Characters.
+							{ 5000, Size2(6, 6), Size2(6, 6), 800 }, // Bullets.
+					} },
+			{ "uniform sizes",
+					{
+							{ 0, Size2(), Size2(), 0 },
+							{ 4000, Size2(32, 32), Size2(32, 32), 0 },
+							{ 5000, Size2(24, 24), Size2(48, 48), 100 },
+							{ 0, Size2(), Size2(), 0 },
+					} },
+		};
+
+		static const int cell_sizes[] = { 32, 64, 128, 256, 512 };
+
+		OS::get_singleton()->print("\n\n2D broad phase tuning, %dx%d pixels, %d frames\n", (int)WORLD_SIZE, (int)WORLD_SIZE, (int)FRAMES);
+
+		// The hash grid reads its cell size from the project settings.
+		Variant previous_cell_size;
+		if (ProjectSettings::get_singleton()->has_setting("physics/2d/cell_size")) {
+			previous_cell_size = ProjectSettings::get_singleton()->get("physics/2d/cell_size");
+		}
+
+		bool failed = false;
+
+		for (int i = 0; i < 2; i++) {
+
+			_create_scene(scenes[i]);
+
+			OS::get_singleton()->print("\t%s, %d static, %d moving:\n", scenes[i].name, static_count, (int)owners.size() - static_count);
+
+			Result bvh;
+			BroadPhase2DSW *broad_phase = memnew(BroadPhase2DBVH);
+			_run(broad_phase, bvh);
+			memdelete(broad_phase);
+			_print("BVH", bvh);
+
+			for (int j = 0; j < 5; j++) {
+
+				ProjectSettings::get_singleton()->set("physics/2d/cell_size", cell_sizes[j]);
+
+				Result grid;
+				broad_phase = memnew(BroadPhase2DHashGrid);
+				_run(broad_phase, grid);
+				memdelete(broad_phase);
+
+				// Both report every intersecting pair when it starts and stops intersecting.
+				if (grid.pair_counts != bvh.pair_counts || grid.query_counts != bvh.query_counts || grid.pairs_left || bvh.pairs_left) {
+					OS::get_singleton()->print("\thash grid results differ from the BVH ones\n");
+					failed = true;
+				}
+
+				_print(vformat("grid, cell %d", cell_sizes[j]).utf8().get_data(), grid);
+			}
+
+			_free_scene();
+		}
+
+		ProjectSettings::get_singleton()->set("physics/2d/cell_size", previous_cell_size);
+
+		OS::get_singleton()->print("\t%s\n", failed ? "FAILED" : "PASS");
+	}
+
+	virtual bool iteration(float p_time) {
+		return true;
+	}
+
+	virtual bool idle(float p_time) {
+		return true;
+	}
+
+	virtual void finish() {
+	}
+};
+
+class TestPhysics2DQueryMainLoop : public MainLoop {
+
+	GDCLASS(TestPhysics2DQueryMainLoop, MainLoop);
+
+	enum {
+		GRID_SIZE = 100,
+		CROWD_SIZE = 5000, // More than the 2048 results the spaces used to be limited to.
+		RAYS = 100000,
+		EXCLUDES = 16,
+		CROWD_QUERIES = 200,
+		QUERY_THREADS = 4,
+	};
+
+	RID space;
+	RID grid_shape;
+	RID crowd_shape;
+	RID circle_shape;
+	std::vector<RID> grid;
+	std::vector<RID> crowd;
+
+	RID _create_body(RID p_shape, const Vector2 &p_origin) {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		RID body = ps->body_create();
+		ps->body_set_mode(body, Physics2DServer::BODY_MODE_STATIC);
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, p_shape);
+		ps->body_set_state(body, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, p_origin));
+		return body;
+	}
+
+	void _create_scene() {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		space = ps->space_create();
+
+		grid_shape = ps->rectangle_shape_create();
+		ps->shape_set_data(grid_shape, Vector2(16, 16));
+		for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+			grid.push_back(_create_body(grid_shape, Vector2((i % GRID_SIZE) * 64, (i / GRID_SIZE) * 64)));
+		}
+
+		// Tall rects piled in one column, away from the grid. All of them contain its middle.
+		crowd_shape = ps->rectangle_shape_create();
+		ps->shape_set_data(crowd_shape, Vector2(16, 1000));
+		for (int i = 0; i < CROWD_SIZE; i++) {
+			crowd.push_back(_create_body(crowd_shape, Vector2(-1000, i * 0.2)));
+		}
+
+		circle_shape = ps->circle_shape_create();
+		ps->shape_set_data(circle_shape, 20);
+	}
+
+	void _free_scene() {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		for (size_t i = 0; i < grid.size(); i++) {
+			ps->free(grid[i]);
+		}
+		grid.clear();
+		for (size_t i = 0; i < crowd.size(); i++) {
+			ps->free(crowd[i]);
+		}
+		crowd.clear();
+		ps->free(circle_shape);
+		ps->free(crowd_shape);
+		ps->free(grid_shape);
+		ps->free(space);
+	}
+
+	// Casts short rays over the grid, returns rays per second.
+	double _cast_rays(Physics2DDirectSpaceState *p_state, const std::vector<RID> &p_exclude, bool p_rebuild_exclude, int &r_hits) {
+
+		RandomPCG rng(7);
+		Physics2DDirectSpaceState::RayResult result;
+		VSet<RID> exclude;
+		for (size_t i = 0; i < p_exclude.size(); i++) {
+			exclude.insert(p_exclude[i]);
+		}
+		r_hits = 0;
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < RAYS; i++) {
+			Vector2 from(rng.randf() * GRID_SIZE * 64, rng.randf() * GRID_SIZE * 64);
+			bool hit;
+			if (p_rebuild_exclude) {
+				// Built for every ray, like when scripts pass an array of RIDs.
+				VSet<RID> rebuilt;
+				for (size_t j = 0; j < p_exclude.size(); j++) {
+					rebuilt.insert(p_exclude[j]);
+				}
+				hit = p_state->intersect_ray(from, from + Vector2(0, 100), result, rebuilt);
+			} else {
+				hit = p_state->intersect_ray(from, from + Vector2(0, 100), result, exclude);
+			}
+			if (hit) {
+				r_hits++;
+			}
+		}
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+		return usec ? RAYS * 1000000.0 / usec : 0.0;
+	}
+
+	struct QueryThreadData {
+		TestPhysics2DQueryMainLoop *test;
+		Physics2DDirectSpaceState *state;
+		Transform2D middle;
+		int missed;
+	};
+
+	// Like scripts in process thread groups, queries the column from several threads at once.
+	static void _query_thread(void *p_userdata) {
+
+		QueryThreadData *data = (QueryThreadData *)p_userdata;
+		std::vector<Physics2DDirectSpaceState::ShapeResult> results;
+		for (int i = 0; i < CROWD_QUERIES; i++) {
+			if (data->state->intersect_shape_all(data->test->circle_shape, data->middle, Vector2(), 0, results) != CROWD_SIZE) {
+				data->missed++;
+			}
+			if (data->state->intersect_point_all(data->middle.get_origin(), results) != CROWD_SIZE) {
+				data->missed++;
+			}
+		}
+	}
+
+public:
+	virtual void init() {
+
+		if (!Physics2DServer::get_singleton()->is_class("Physics2DServerSW")) {
+			OS::get_singleton()->print("The benchmark needs the default 2D physics server.\n");
+			return;
+		}
+
+		_create_scene();
+
+		Physics2DDirectSpaceState *state = Physics2DServer::get_singleton()->space_get_direct_state(space);
+		ERR_FAIL_COND(!state);
+
+		OS::get_singleton()->print("\n\nSpace queries, %d grid rects, a column of %d overlapping rects\n", GRID_SIZE * GRID_SIZE, CROWD_SIZE);
+
+		bool failed = false;
+
+		int hits;
+		double rays_per_sec = _cast_rays(state, std::vector<RID>(), false, hits);
+		OS::get_singleton()->print("\t%8d rays/sec, %d hits\n", (int)rays_per_sec, hits);
+
+		// Bodies the rays never reach, so the hits must not change.
+		std::vector<RID> out_of_reach;
+		for (int i = 0; i < EXCLUDES; i++) {
+			out_of_reach.push_back(crowd[i * 97]);
+		}
+		for (int i = 0; i < 2; i++) {
+			int exclude_hits;
+			rays_per_sec = _cast_rays(state, out_of_reach, i == 1, exclude_hits);
+			OS::get_singleton()->print("\t%8d rays/sec excluding %d bodies%s, %d hits\n", (int)rays_per_sec, EXCLUDES, i == 1 ? " rebuilt for every ray" : "", exclude_hits);
+			if (exclude_hits != hits) {
+				OS::get_singleton()->print("\texcluding bodies out of reach changed the hits\n");
+				failed = true;
+			}
+		}
+
+		// Every body of the column must be considered to find the closest hit.
+		Physics2DDirectSpaceState::RayResult result;
+		Vector2 top(-1000, -2000);
+		if (!state->intersect_ray(top, top + Vector2(0, 5000), result) || result.rid != crowd[0]) {
+			OS::get_singleton()->print("\tthe ray missed the top of the column\n");
+			failed = true;
+		}
+		VSet<RID> exclude;
+		exclude.insert(crowd[0]);
+		if (!state->intersect_ray(top, top + Vector2(0, 5000), result, exclude) || result.rid != crowd[1]) {
+			OS::get_singleton()->print("\tthe ray didn't skip the excluded body\n");
+			failed = true;
+		}
+
+		std::vector<Physics2DDirectSpaceState::ShapeResult> results;
+		Transform2D middle(0, Vector2(-1000, 500));
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		int shape_count = 0;
+		for (int i = 0; i < CROWD_QUERIES; i++) {
+			shape_count = state->intersect_shape_all(circle_shape, middle, Vector2(), 0, results);
+		}
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+		OS::get_singleton()->print("\t%8d usec per shape query, %d results\n", (int)(usec / CROWD_QUERIES), shape_count);
+
+		begin = OS::get_singleton()->get_ticks_usec();
+		int point_count = 0;
+		for (int i = 0; i < CROWD_QUERIES; i++) {
+			point_count = state->intersect_point_all(middle.get_origin(), results);
+		}
+		usec = OS::get_singleton()->get_ticks_usec() - begin;
+		OS::get_singleton()->print("\t%8d usec per point query, %d results\n", (int)(usec / CROWD_QUERIES), point_count);
+
+		if (shape_count != CROWD_SIZE || point_count != CROWD_SIZE) {
+			OS::get_singleton()->print("\tthe queries missed bodies of the column\n");
+			failed = true;
+		}
+
+		QueryThreadData data[QUERY_THREADS];
+		Thread *threads[QUERY_THREADS];
+		for (int i = 0; i < QUERY_THREADS; i++) {
+			data[i].test = this;
+			data[i].state = state;
+			data[i].middle = middle;
+			data[i].missed = 0;
+			threads[i] = Thread::create(_query_thread, &data[i]);
+		}
+		for (int i = 0; i < QUERY_THREADS; i++) {
+			Thread::wait_to_finish(threads[i]);
+			memdelete(threads[i]);
+			if (data[i].missed) {
+				OS::get_singleton()->print("\tconcurrent queries missed bodies of the column\n");
+				failed = true;
+			}
+		}
+
+		_free_scene();
+
+		OS::get_singleton()->print("\t%s\n", failed ? "FAILED" : "PASS");
+	}
+
+	virtual bool iteration(float p_time) {
+		return true;
+	}
+
+	virtual bool idle(float p_time) {
+		return true;
+	}
+
+	virtual void finish() {
+	}
+};
+
 namespace TestPhysics2D {
 
 MainLoop *test() {
 
 	return memnew(TestPhysics2DMainLoop);
 }
+
+MainLoop *test_benchmark() {
+
+	return memnew(TestPhysics2DBenchmarkMainLoop);
+}
+
+MainLoop *test_broad_phase_benchmark() {
+
+	return memnew(TestPhysics2DBroadPhaseMainLoop);
+}
+
+MainLoop *test_query_benchmark() {
+
+	return memnew(TestPhysics2DQueryMainLoop);
+}
 } // namespace TestPhysics2D
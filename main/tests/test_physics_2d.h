@@ -36,6 +36,9 @@
 namespace TestPhysics2D {
 
 MainLoop *test();
+MainLoop *test_benchmark();
+MainLoop *test_broad_phase_benchmark();
+MainLoop *test_query_benchmark();
 }
 
 #endif // TEST_PHYSICS_2D_H
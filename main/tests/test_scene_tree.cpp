@@ -0,0 +1,547 @@
+/*************************************************************************/
+/*  test_scene_tree.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_scene_tree.h"
+
+#include <vector>
+
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/os/thread_pool.h"
+#include "scene/2d/node_2d.h"
+#include "scene/3d/spatial.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+namespace TestSceneTree {
+
+class ProcessBenchNode : public Node {
+
+	GDCLASS(ProcessBenchNode, Node);
+
+public:
+	enum {
+		NOTIFICATION_BENCH_HIT = 9000,
+	};
+
+	static int processed;
+	static int hits;
+
+	// When set, flips the processing of this node every frame, so the group changes while it is iterated.
+	ProcessBenchNode *toggle;
+
+	ProcessBenchNode() {
+		toggle = NULL;
+	}
+
+protected:
+	void _notification(int p_what) {
+
+		if (p_what == NOTIFICATION_PROCESS) {
+			processed++;
+			if (toggle) {
+				toggle->set_process(!toggle->is_processing());
+			}
+		} else if (p_what == NOTIFICATION_BENCH_HIT) {
+			hits++;
+		}
+	}
+};
+
+int ProcessBenchNode::processed = 0;
+int ProcessBenchNode::hits = 0;
+
+// Only touches its own state when processed, so it can be put in a process thread group.
+class ThreadBenchNode : public Node {
+
+	GDCLASS(ThreadBenchNode, Node);
+
+public:
+	enum {
+		WORK = 256,
+		MUTATE_FRAME = 30,
+	};
+
+	double state;
+	int processed;
+	bool free_self;
+	Node *stop; // stopped with a deferred call, as other nodes can't be modified from a thread group
+
+	ThreadBenchNode() {
+		state = 0;
+		processed = 0;
+		free_self = false;
+		stop = NULL;
+	}
+
+protected:
+	void _notification(int p_what) {
+
+		if (p_what != NOTIFICATION_PROCESS)
+			return;
+
+		for (int i = 0; i < WORK; i++) {
+			state = state * 0.999 + Math::sin(state + i);
+		}
+		processed++;
+
+		if (processed == MUTATE_FRAME) {
+			if (stop) {
+				stop->call_deferred("set_process", false);
+			}
+			if (free_self) {
+				queue_delete();
+			}
+		}
+	}
+};
+
+struct MoveCounts {
+
+	int moved;
+	int changed;
+	int changed_off_main; // transform notifications received outside the main thread
+
+	MoveCounts() {
+		moved = 0;
+		changed = 0;
+		changed_off_main = 0;
+	}
+
+	void transform_changed() {
+		changed++;
+		if (Thread::get_caller_id() != Thread::get_main_id()) {
+			changed_off_main++;
+		}
+	}
+};
+
+// Move themselves when processed from a process thread group, and listen to their transform like visual nodes do.
+class ThreadMoveSpatial : public Spatial {
+
+	GDCLASS(ThreadMoveSpatial, Spatial);
+
+public:
+	MoveCounts counts;
+
+protected:
+	void _notification(int p_what) {
+
+		if (p_what == NOTIFICATION_PROCESS) {
+			translate(Vector3(1, 0, 0));
+			counts.moved++;
+		} else if (p_what == NOTIFICATION_TRANSFORM_CHANGED) {
+			get_global_transform();
+			counts.transform_changed();
+		}
+	}
+};
+
+class ThreadMoveNode2D : public Node2D {
+
+	GDCLASS(ThreadMoveNode2D, Node2D);
+
+public:
+	MoveCounts counts;
+
+protected:
+	void _notification(int p_what) {
+
+		if (p_what == NOTIFICATION_PROCESS) {
+			set_position(get_position() + Vector2(1, 0));
+			counts.moved++;
+		} else if (p_what == NOTIFICATION_TRANSFORM_CHANGED) {
+			get_global_transform();
+			counts.transform_changed();
+		}
+	}
+};
+
+class TestMainLoop : public SceneTree {
+
+	enum {
+		FRAMES = 60,
+		CHURN_INTERVAL = 100,
+		PROCESS_PASSES = 6,
+		SPAWN_PASSES = 3,
+		SPAWN_CONTAINER_SIZE = 100,
+		SPAWN_RATE = 100, // one in this many nodes is replaced every frame
+		THREAD_PASSES_BEGIN = PROCESS_PASSES + SPAWN_PASSES,
+		THREAD_NODES = 20000,
+		THREAD_MUTATE_INTERVAL = 50,
+		MOVE_NODES = 4000,
+		MOVE_THREAD_GROUPS = 4,
+	};
+
+	int pass;
+	int frame;
+	int expected;
+	uint64_t usec;
+	bool failed;
+	Node *holder;
+	std::vector<Node *> spawned;
+	std::vector<Node *> containers;
+	// Worker counts of the thread group passes, -1 is the serial reference pass.
+	std::vector<int> thread_workers;
+	uint64_t serial_usec;
+	double serial_checksum;
+	int serial_processed;
+
+	static int _get_node_count(int p_pass) {
+		static const int counts[3] = { 10000, 50000, 100000 };
+		return p_pass < PROCESS_PASSES ? counts[p_pass / 2] : counts[p_pass - PROCESS_PASSES];
+	}
+
+	void _spawn() {
+
+		Node *n = memnew(ProcessBenchNode);
+		containers[Math::rand() % containers.size()]->add_child(n);
+		n->add_to_group("bench_spawned");
+		spawned.push_back(n);
+	}
+
+	// Replaces random members of a group, like bullets or enemies being spawned and freed, then notifies the group in tree order.
+	void _spawn_frame() {
+
+		int count = spawned.size() / SPAWN_RATE;
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+		for (int i = 0; i < count; i++) {
+			int idx = Math::rand() % spawned.size();
+			memdelete(spawned[idx]);
+			spawned[idx] = spawned.back();
+			spawned.pop_back();
+		}
+		for (int i = 0; i < count; i++) {
+			_spawn();
+		}
+
+		ProcessBenchNode::hits = 0;
+		notify_group_flags(GROUP_CALL_REALTIME, "bench_spawned", ProcessBenchNode::NOTIFICATION_BENCH_HIT);
+
+		if (frame >= 0) {
+			usec += OS::get_singleton()->get_ticks_usec() - begin;
+		}
+
+		if (ProcessBenchNode::hits != (int)spawned.size()) {
+			OS::get_singleton()->print("\tframe %d notified %d nodes, expected %d\n", frame, ProcessBenchNode::hits, (int)spawned.size());
+			failed = true;
+		}
+
+		if (frame == FRAMES - 1) {
+			List<Node *> in_group;
+			get_nodes_in_group("bench_spawned", &in_group);
+			for (List<Node *>::Element *E = in_group.front(); E && E->next(); E = E->next()) {
+				if (E->get()->is_greater_than(E->next()->get())) {
+					OS::get_singleton()->print("\tgroup is not in tree order\n");
+					failed = true;
+					break;
+				}
+			}
+		}
+	}
+
+	// Runs after the thread group scaling passes, with the default worker count.
+	int _get_move_pass() const {
+		return THREAD_PASSES_BEGIN + thread_workers.size();
+	}
+
+	void _begin_move_pass() {
+
+		OS::get_singleton()->print("\n\nTest 4: nodes moving themselves from thread groups\n");
+
+		for (int i = 0; i < MOVE_NODES; i++) {
+			Node *n;
+			if (i & 1) {
+				n = memnew(ThreadMoveNode2D);
+			} else {
+				n = memnew(ThreadMoveSpatial);
+			}
+			n->set_process_thread_group(1 + i % MOVE_THREAD_GROUPS);
+			holder->add_child(n);
+			n->set_process(true);
+			if (i & 1) {
+				Object::cast_to<ThreadMoveNode2D>(n)->set_notify_transform(true);
+			} else {
+				Object::cast_to<ThreadMoveSpatial>(n)->set_notify_transform(true);
+			}
+		}
+	}
+
+	// Every move is notified once, on the main thread, whatever the groups did at the same time.
+	void _end_move_pass() {
+
+		int wrong = 0;
+		int off_main = 0;
+		for (int i = 0; i < holder->get_child_count(); i++) {
+			Node *n = holder->get_child(i);
+			const MoveCounts *counts;
+			real_t x;
+			if (Object::cast_to<ThreadMoveNode2D>(n)) {
+				counts = &Object::cast_to<ThreadMoveNode2D>(n)->counts;
+				x = Object::cast_to<ThreadMoveNode2D>(n)->get_position().x;
+			} else {
+				counts = &Object::cast_to<ThreadMoveSpatial>(n)->counts;
+				x = Object::cast_to<ThreadMoveSpatial>(n)->get_translation().x;
+			}
+			if (counts->moved != FRAMES + 1 || counts->changed != counts->moved || x != counts->moved) {
+				wrong++;
+			}
+			off_main += counts->changed_off_main;
+		}
+
+		if (wrong || off_main) {
+			OS::get_singleton()->print("\t%d nodes missed transform notifications, %d notifications off the main thread\n", wrong, off_main);
+			failed = true;
+		}
+		OS::get_singleton()->print("\t%6d nodes in %d thread groups, %2d workers: %6d usec/frame\n", MOVE_NODES, MOVE_THREAD_GROUPS, ThreadPool::get_singleton()->get_thread_count(), (int)(usec / FRAMES));
+	}
+
+	void _begin_pass() {
+
+		int count = _get_node_count(pass);
+
+		holder = memnew(Node);
+		get_root()->add_child(holder);
+		frame = -1; // the first frame sorts the group, don't time it
+		usec = 0;
+
+		if (pass == _get_move_pass()) {
+			_begin_move_pass();
+			return;
+		}
+
+		if (pass >= THREAD_PASSES_BEGIN) {
+
+			int workers = thread_workers[pass - THREAD_PASSES_BEGIN];
+			if (workers < 0) {
+				OS::get_singleton()->print("\n\nTest 3: process thread group scaling\n");
+			} else {
+				ThreadPool::get_singleton()->finish();
+				ThreadPool::get_singleton()->init(workers);
+			}
+
+			for (int i = 0; i < THREAD_NODES; i++) {
+				ThreadBenchNode *n = memnew(ThreadBenchNode);
+				n->state = i;
+				n->set_process_thread_group(workers < 0 ? 0 : 1);
+				holder->add_child(n);
+				n->set_process(true);
+				if (i % THREAD_MUTATE_INTERVAL == 0) {
+					n->free_self = true;
+				} else if (i % THREAD_MUTATE_INTERVAL == 2) {
+					n->stop = holder->get_child(i - 1);
+				}
+			}
+			return;
+		}
+
+		if (pass >= PROCESS_PASSES) {
+
+			if (pass == PROCESS_PASSES) {
+				OS::get_singleton()->print("\n\nTest 2: group spawn/despawn churn\n");
+			}
+
+			for (int i = 0; i < count / SPAWN_CONTAINER_SIZE; i++) {
+				containers.push_back(memnew(Node));
+				holder->add_child(containers[i]);
+			}
+			for (int i = 0; i < count; i++) {
+				_spawn();
+			}
+			return;
+		}
+
+		// Even passes only process, odd passes also add and remove nodes from the group mid-frame.
+		bool churn = pass & 1;
+
+		ProcessBenchNode *prev = NULL;
+		for (int i = 0; i < count; i++) {
+			ProcessBenchNode *n = memnew(ProcessBenchNode);
+			holder->add_child(n);
+			n->set_process(true);
+			if (churn && prev && (i - 1) % CHURN_INTERVAL == 0) {
+				prev->toggle = n;
+			}
+			prev = n;
+		}
+
+		// Toggled nodes are either removed before their turn or appended past the end of the frame's iteration.
+		expected = churn ? count - (count + CHURN_INTERVAL - 2) / CHURN_INTERVAL : count;
+	}
+
+	void _end_thread_pass() {
+
+		int workers = thread_workers[pass - THREAD_PASSES_BEGIN];
+
+		double checksum = 0;
+		int processed = 0;
+		for (int i = 0; i < holder->get_child_count(); i++) {
+			ThreadBenchNode *n = Object::cast_to<ThreadBenchNode>(holder->get_child(i));
+			checksum += n->state;
+			processed += n->processed;
+		}
+
+		if (workers < 0) {
+			// Freed nodes are gone, stopped ones were processed until the deferred call ran after the mutation frame.
+			int expected_processed = 0;
+			for (int i = 0; i < THREAD_NODES; i++) {
+				if (i % THREAD_MUTATE_INTERVAL == 1) {
+					expected_processed += ThreadBenchNode::MUTATE_FRAME;
+				} else if (i % THREAD_MUTATE_INTERVAL != 0) {
+					expected_processed += FRAMES + 1;
+				}
+			}
+			if (processed != expected_processed) {
+				OS::get_singleton()->print("\tprocessed %d times, expected %d\n", processed, expected_processed);
+				failed = true;
+			}
+
+			serial_usec = usec;
+			serial_checksum = checksum;
+			serial_processed = processed;
+			OS::get_singleton()->print("\t%6d nodes on the main thread:     %6d usec/frame\n", THREAD_NODES, (int)(usec / FRAMES));
+			return;
+		}
+
+		if (processed != serial_processed || checksum != serial_checksum) {
+			OS::get_singleton()->print("\tthreaded results differ from the main thread ones\n");
+			failed = true;
+		}
+		OS::get_singleton()->print("\t%6d nodes in a thread group, %2d workers: %6d usec/frame (%.2fx)\n", THREAD_NODES, workers, (int)(usec / FRAMES), usec ? (double)serial_usec / usec : 0.0);
+
+		if (pass - THREAD_PASSES_BEGIN == (int)thread_workers.size() - 1) {
+			ThreadPool::get_singleton()->finish();
+			ThreadPool::get_singleton()->init();
+		}
+	}
+
+	void _end_pass() {
+
+		if (pass == _get_move_pass()) {
+			_end_move_pass();
+		} else if (pass >= THREAD_PASSES_BEGIN) {
+			_end_thread_pass();
+		} else if (pass >= PROCESS_PASSES) {
+			OS::get_singleton()->print("\t%6d group members, %4d replaced per frame: %6d usec/frame\n", _get_node_count(pass), _get_node_count(pass) / SPAWN_RATE, (int)(usec / FRAMES));
+			spawned.clear();
+			containers.clear();
+		} else {
+			bool churn = pass & 1;
+			OS::get_singleton()->print("\t%6d processing nodes%s: %6d usec/frame\n", _get_node_count(pass), churn ? " with churn" : "           ", (int)(usec / FRAMES));
+		}
+		memdelete(holder);
+		holder = NULL;
+	}
+
+public:
+	virtual void init() {
+
+		SceneTree::init();
+
+		OS::get_singleton()->print("\n\nTest 1: idle processing\n");
+
+		// The thread waiting for the group helps as well, so 0 workers still runs it.
+		thread_workers.push_back(-1);
+		int max_workers = MAX(1, OS::get_singleton()->get_processor_count() - 1);
+		for (int workers = 0; workers < max_workers; workers = workers * 2 + 1) {
+			thread_workers.push_back(workers);
+		}
+		thread_workers.push_back(max_workers);
+
+		pass = 0;
+		failed = false;
+		_begin_pass();
+	}
+
+	virtual bool idle(float p_time) {
+
+		if (pass >= PROCESS_PASSES && pass < THREAD_PASSES_BEGIN) {
+			_spawn_frame();
+		}
+
+		ProcessBenchNode::processed = 0;
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		bool quit_requested = SceneTree::idle(p_time);
+		uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+
+		if (frame >= 0 && pass >= THREAD_PASSES_BEGIN) {
+			usec += elapsed;
+		} else if (frame >= 0 && pass < PROCESS_PASSES) {
+			usec += elapsed;
+			if (ProcessBenchNode::processed != expected) {
+				OS::get_singleton()->print("\tframe %d processed %d nodes, expected %d\n", frame, ProcessBenchNode::processed, expected);
+				failed = true;
+			}
+		}
+
+		frame++;
+		if (frame == FRAMES) {
+			_end_pass();
+			pass++;
+			int pass_count = _get_move_pass() + 1;
+			if (pass == PROCESS_PASSES || pass == THREAD_PASSES_BEGIN || pass == _get_move_pass() || pass == pass_count) {
+				OS::get_singleton()->print("\t%s\n", failed ? "FAILED" : "PASS");
+				failed = false;
+			}
+			if (pass == pass_count) {
+				return true;
+			}
+			_begin_pass();
+		}
+
+		return quit_requested;
+	}
+
+	virtual void finish() {
+
+		if (holder) {
+			memdelete(holder);
+			holder = NULL;
+		}
+		SceneTree::finish();
+	}
+
+	TestMainLoop() {
+		holder = NULL;
+		serial_usec = 0;
+		serial_checksum = 0;
+		serial_processed = 0;
+	}
+};
+
+MainLoop *test() {
+
+	return memnew(TestMainLoop);
+}
+} // namespace TestSceneTree
@@ -0,0 +1,275 @@
+/*************************************************************************/
+/*  test_signal.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_signal.h"
+
+#include "core/class_db.h"
+#include "core/os/memory.h"
+#include "core/os/os.h"
+
+namespace TestSignal {
+
+class SignalListener : public Object {
+
+	GDCLASS(SignalListener, Object);
+
+public:
+	static int calls;
+	static int64_t sum;
+	static uint64_t blocks_before; // heap blocks alive before the emission
+	static uint64_t blocks_held; // most heap blocks added by the emission while it calls its targets
+
+	// Mutated from inside the emission, which must not affect the targets it calls.
+	Object *emitter;
+	Object *disconnect_target;
+	Object *connect_target;
+
+	void _record_blocks() {
+		uint64_t blocks = Memory::get_alloc_count();
+		if (blocks > blocks_before && blocks - blocks_before > blocks_held) {
+			blocks_held = blocks - blocks_before;
+		}
+	}
+
+	void _on_signal(int p_value) {
+
+		calls++;
+		sum += p_value;
+		_record_blocks();
+
+		if (disconnect_target) {
+			emitter->disconnect("test_signal", disconnect_target, "_on_signal");
+			disconnect_target = NULL;
+		}
+		if (connect_target) {
+			emitter->connect("test_signal", connect_target, "_on_signal");
+			connect_target = NULL;
+		}
+	}
+
+	void _on_signal_bound(int p_value, int p_bound) {
+
+		calls++;
+		sum += p_value * p_bound;
+		_record_blocks();
+	}
+
+	Variant _on_signal_varargs(const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
+
+		r_error.error = Variant::CallError::CALL_OK;
+		calls++;
+		for (int i = 0; i < p_argcount; i++) {
+			sum += int(*p_args[i]);
+		}
+		return Variant();
+	}
+
+	SignalListener() {
+		emitter = NULL;
+		disconnect_target = NULL;
+		connect_target = NULL;
+	}
+
+protected:
+	static void _bind_methods() {
+
+		ClassDB::bind_method(D_METHOD("_on_signal", "value"), &SignalListener::_on_signal);
+		ClassDB::bind_method(D_METHOD("_on_signal_bound", "value", "bound"), &SignalListener::_on_signal_bound);
+		ClassDB::bind_vararg_method(METHOD_FLAGS_DEFAULT, "_on_signal_varargs", &SignalListener::_on_signal_varargs, MethodInfo("_on_signal_varargs"));
+	}
+};
+
+int SignalListener::calls = 0;
+int64_t SignalListener::sum = 0;
+uint64_t SignalListener::blocks_before = 0;
+uint64_t SignalListener::blocks_held = 0;
+
+static Object *_make_emitter() {
+
+	Object *emitter = memnew(Object);
+	emitter->add_user_signal(MethodInfo("test_signal", PropertyInfo(Variant::INT, "value")));
+	return emitter;
+}
+
+static void _emit(Object *p_emitter, int p_value) {
+
+	SignalListener::blocks_before = Memory::get_alloc_count();
+	p_emitter->emit_signal("test_signal", p_value);
+}
+
+typedef bool (*TestFunc)(void);
+
+bool test_1() {
+
+	OS::get_singleton()->print("\n\nTest 1: signal emission\n");
+
+	bool state = true;
+
+	Object *emitter = _make_emitter();
+	SignalListener *listeners[4];
+	for (int i = 0; i < 4; i++) {
+		listeners[i] = memnew(SignalListener);
+		listeners[i]->emitter = emitter;
+	}
+
+	// Arguments, binds, and more of them than fit on the stack.
+	emitter->connect("test_signal", listeners[0], "_on_signal");
+	emitter->connect("test_signal", listeners[1], "_on_signal_bound", varray(3));
+	std::vector<Variant> binds;
+	for (int i = 0; i < 20; i++) {
+		binds.push_back(1);
+	}
+	emitter->connect("test_signal", listeners[2], "_on_signal_varargs", binds);
+
+	SignalListener::calls = 0;
+	SignalListener::sum = 0;
+	_emit(emitter, 5);
+	state = state && SignalListener::calls == 3 && SignalListener::sum == 5 + 15 + 25;
+
+	// Oneshot connections are called once.
+	emitter->disconnect("test_signal", listeners[1], "_on_signal_bound");
+	emitter->disconnect("test_signal", listeners[2], "_on_signal_varargs");
+	emitter->connect("test_signal", listeners[3], "_on_signal", varray(), Object::CONNECT_ONESHOT);
+	SignalListener::calls = 0;
+	_emit(emitter, 1);
+	_emit(emitter, 1);
+	state = state && SignalListener::calls == 3 && !emitter->is_connected("test_signal", listeners[3], "_on_signal");
+
+	// Changes made while emitting apply to the next emission only.
+	emitter->connect("test_signal", listeners[1], "_on_signal");
+	SignalListener *first = listeners[0];
+	SignalListener *second = listeners[1];
+	if (first->get_instance_id() > second->get_instance_id()) {
+		SWAP(first, second); // slots are sorted by instance id
+	}
+	first->disconnect_target = second;
+	first->connect_target = listeners[2];
+	SignalListener::calls = 0;
+	_emit(emitter, 1);
+	state = state && SignalListener::calls == 2;
+	SignalListener::calls = 0;
+	_emit(emitter, 1);
+	state = state && SignalListener::calls == 2 && !emitter->is_connected("test_signal", second, "_on_signal");
+
+	memdelete(emitter);
+	for (int i = 0; i < 4; i++) {
+		memdelete(listeners[i]);
+	}
+
+	return state;
+}
+
+bool test_2() {
+
+	OS::get_singleton()->print("\n\nTest 2: signal emission speed\n");
+
+	bool state = true;
+
+	const int emissions = 100000;
+	const int listener_counts[3] = { 1, 10, 100 };
+
+	for (int bound = 0; bound < 2; bound++) {
+		for (int l = 0; l < 3; l++) {
+
+			int count = listener_counts[l];
+			Object *emitter = _make_emitter();
+			std::vector<SignalListener *> listeners;
+			for (int i = 0; i < count; i++) {
+				listeners.push_back(memnew(SignalListener));
+				if (bound) {
+					emitter->connect("test_signal", listeners[i], "_on_signal_bound", varray(2));
+				} else {
+					emitter->connect("test_signal", listeners[i], "_on_signal");
+				}
+			}
+
+			SignalListener::calls = 0;
+			SignalListener::sum = 0;
+			SignalListener::blocks_held = 0;
+
+			int iterations = emissions / count;
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			for (int i = 0; i < iterations; i++) {
+				_emit(emitter, 1);
+			}
+			uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+			state = state && SignalListener::calls == iterations * count && SignalListener::sum == int64_t(iterations) * count * (bound ? 2 : 1);
+			// Emitting must not allocate (only tracked in debug builds).
+			state = state && SignalListener::blocks_held == 0;
+
+			OS::get_singleton()->print("\t%3d listeners%s: %6.3f usec/emission, %5.1f nsec/call, %d heap blocks held\n", count, bound ? ", with binds" : "            ", (double)usec / iterations, usec * 1000.0 / (iterations * count), (int)SignalListener::blocks_held);
+
+			memdelete(emitter);
+			for (int i = 0; i < count; i++) {
+				memdelete(listeners[i]);
+			}
+		}
+	}
+
+	return state;
+}
+
+TestFunc test_funcs[] = {
+
+	test_1,
+	test_2,
+	0
+
+};
+
+MainLoop *test() {
+
+	ClassDB::register_class<SignalListener>();
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestSignal
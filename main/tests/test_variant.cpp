@@ -0,0 +1,519 @@
+/*************************************************************************/
+/*  test_variant.cpp                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_variant.h"
+
+#include "core/os/os.h"
+#include "core/variant.h"
+
+namespace TestVariant {
+
+typedef bool (*TestFunc)(void);
+
+// Old per-element bridging, kept here as a baseline for the benchmark.
+template <class T>
+static std::vector<T> _legacy_to_std_vector(const PoolVector<T> &p_from) {
+
+	std::vector<T> to;
+	int len = p_from.size();
+	to.resize(len);
+	for (int i = 0; i < len; i++) {
+		to[i] = p_from[i];
+	}
+	return to;
+}
+
+template <class T>
+static PoolVector<T> _legacy_to_pool_vector(const std::vector<T> &p_from) {
+
+	PoolVector<T> to;
+	int len = p_from.size();
+	to.resize(len);
+	for (int i = 0; i < len; i++)
+		to.set(i, p_from[i]);
+	return to;
+}
+
+template <class T>
+static bool _bench_pool_vector_bridge(const char *p_name, const T &p_fill) {
+
+	bool state = true;
+
+	for (int mb = 1; mb <= 64; mb *= 4) {
+
+		int count = (mb * 1024 * 1024) / sizeof(T);
+		std::vector<T> src(count, p_fill);
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		Variant v = src;
+		std::vector<T> dst = v;
+		uint64_t bridged = OS::get_singleton()->get_ticks_usec() - begin;
+
+		begin = OS::get_singleton()->get_ticks_usec();
+		PoolVector<T> legacy_pool = _legacy_to_pool_vector(src);
+		std::vector<T> legacy_dst = _legacy_to_std_vector(legacy_pool);
+		uint64_t legacy = OS::get_singleton()->get_ticks_usec() - begin;
+
+		OS::get_singleton()->print("\t%s %2d MB round-trip: %8d usec (per-element: %8d usec)\n", p_name, mb, (int)bridged, (int)legacy);
+
+		state = state && dst.size() == src.size() && legacy_dst.size() == src.size() && dst.back() == p_fill;
+	}
+
+	return state;
+}
+
+bool test_1() {
+
+	OS::get_singleton()->print("\n\nTest 1: std::vector <-> Variant pool array round-trip\n");
+
+	bool state = true;
+	state = _bench_pool_vector_bridge<uint8_t>("PoolByteArray   ", 0x5a) && state;
+	state = _bench_pool_vector_bridge<real_t>("PoolRealArray   ", 1.5) && state;
+	state = _bench_pool_vector_bridge<Vector3>("PoolVector3Array", Vector3(1, 2, 3)) && state;
+
+	return state;
+}
+
+bool test_2() {
+
+	OS::get_singleton()->print("\n\nTest 2: builtin method dispatch (Vector3)\n");
+
+	const int iterations = 1000000;
+
+	List<MethodInfo> methods;
+	Variant(Vector3()).get_method_list(&methods);
+
+	// Red-black tree keyed by StringName, like the dispatch used to be.
+	Map<StringName, int> tree;
+	std::vector<StringName> names;
+	for (List<MethodInfo>::Element *E = methods.front(); E; E = E->next()) {
+		tree[E->get().name] = names.size();
+		names.push_back(E->get().name);
+	}
+
+	bool state = true;
+	int found = 0;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		found += tree.find(names[i % names.size()]) ? 1 : 0;
+	}
+	uint64_t tree_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		found += Variant::get_method_index(Variant::VECTOR3, names[i % names.size()]) >= 0 ? 1 : 0;
+	}
+	uint64_t table_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+	OS::get_singleton()->print("\tlookup of %d methods x%d: Map %d usec, table %d usec\n", (int)names.size(), iterations, (int)tree_usec, (int)table_usec);
+	state = state && found == iterations * 2;
+
+	Variant v = Vector3(1, 2, 3);
+	Variant arg = Vector3(4, 5, 6);
+	const Variant *args[1] = { &arg };
+	StringName dot = "dot";
+	Variant ret;
+	Variant::CallError ce;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		v.call_ptr(dot, args, 1, &ret, ce);
+	}
+	uint64_t by_name_usec = OS::get_singleton()->get_ticks_usec() - begin;
+	state = state && ce.error == Variant::CallError::CALL_OK && real_t(ret) == 32;
+
+	int dot_index = Variant::get_method_index(Variant::VECTOR3, dot);
+	state = state && Variant::get_method_name_by_index(Variant::VECTOR3, dot_index) == dot;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		v.call_ptr_by_index(dot_index, args, 1, &ret, ce);
+	}
+	uint64_t by_index_usec = OS::get_singleton()->get_ticks_usec() - begin;
+	state = state && ce.error == Variant::CallError::CALL_OK && real_t(ret) == 32;
+
+	OS::get_singleton()->print("\tVector3.dot() x%d: by name %d usec, by index %d usec\n", iterations, (int)by_name_usec, (int)by_index_usec);
+
+	state = state && Variant::get_method_index(Variant::VECTOR3, "no_such_method") == -1;
+
+	return state;
+}
+
+// Creates, fills and walks many small arrays, the way GDScript builds signal arguments and JSON fragments.
+static uint64_t _bench_small_arrays(int p_size, int p_iterations, int64_t &r_sum) {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_iterations; i++) {
+		Array arr;
+		for (int j = 0; j < p_size; j++) {
+			arr.push_back(j);
+		}
+		Variant v = arr;
+		Array copy = v;
+		for (int j = 0; j < copy.size(); j++) {
+			r_sum += int(copy[j]);
+		}
+	}
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+static uint64_t _bench_small_dictionaries(int p_size, int p_iterations, const std::vector<Variant> &p_keys, int64_t &r_sum) {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_iterations; i++) {
+		Dictionary dict;
+		for (int j = 0; j < p_size; j++) {
+			dict[p_keys[j]] = j;
+		}
+		for (const Variant *key = dict.next(); key; key = dict.next(key)) {
+			r_sum += int(dict[*key]);
+		}
+		for (int j = 0; j < p_size; j++) {
+			r_sum += int(dict.get(p_keys[j], 0));
+		}
+	}
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+bool test_3() {
+
+	OS::get_singleton()->print("\n\nTest 3: small Array storage\n");
+
+	bool state = true;
+
+	// Grow past the inline capacity and back, checking contents and sharing on the way.
+	Array arr;
+	Array shared = arr;
+	for (int i = 0; i < 10; i++) {
+		arr.push_back(i);
+	}
+	state = state && shared.size() == 10 && int(shared[9]) == 9 && shared.id() == arr.id();
+
+	arr.insert(0, -1);
+	arr.push_front(arr[5]);
+	arr.remove(2);
+	arr.erase(9);
+	state = state && arr.size() == 10 && int(arr[0]) == 4 && int(arr[1]) == -1 && int(arr[2]) == 1 && int(arr.back()) == 8;
+	state = state && arr.find(4, 1) == 5 && arr.rfind(4) == 5 && arr.count(4) == 2;
+
+	arr.sort();
+	state = state && int(arr.front()) == -1 && arr.bsearch(5) == 6;
+	arr.invert();
+	state = state && int(arr[0]) == 8 && int(arr.pop_back()) == -1 && int(arr.pop_front()) == 8;
+
+	arr.clear();
+	arr.push_back(arr.size());
+	arr.push_back(arr[0]);
+	arr.resize(6);
+	state = state && arr.size() == 6 && int(arr[1]) == 0 && arr[5].get_type() == Variant::NIL;
+
+	// An array's own element must survive the reallocation triggered by appending it.
+	arr.resize(4);
+	arr[3] = "tail";
+	arr.push_back(arr[3]);
+	state = state && String(arr[4]) == "tail";
+
+	const int iterations = 200000;
+	const int kept = 1000;
+	int64_t sum = 0;
+	for (int size = 0; size <= 16; size = size ? size * 2 : 1) {
+
+		uint64_t usec = _bench_small_arrays(size, iterations, sum);
+
+		// Heap blocks held by each live array (only tracked in debug builds).
+		uint64_t blocks = Memory::get_alloc_count();
+		std::vector<Array> live(kept);
+		for (int i = 0; i < kept; i++) {
+			for (int j = 0; j < size; j++) {
+				live[i].push_back(j);
+			}
+		}
+		blocks = Memory::get_alloc_count() - blocks;
+
+		OS::get_singleton()->print("\t%2d elements x%d: %8d usec, %.2f heap blocks each\n", size, iterations, (int)usec, double(blocks) / kept);
+	}
+	state = state && sum > 0;
+
+	return state;
+}
+
+bool test_4() {
+
+	OS::get_singleton()->print("\n\nTest 4: small Dictionary storage\n");
+
+	bool state = true;
+
+	Dictionary dict;
+	Dictionary shared = dict;
+	dict["a"] = 1;
+	dict[2] = "b";
+	dict[Vector2(3, 3)] = 3;
+	state = state && shared.size() == 3 && int(shared["a"]) == 1 && shared.has(2) && !shared.has("b");
+
+	// Insertion order is kept while the pairs move to the hash map and after erasing.
+	for (int i = 0; i < 6; i++) {
+		dict[i * 10] = i;
+	}
+	state = state && dict.size() == 9 && dict.get_key_at_index(3) == Variant(0) && int(dict.get_value_at_index(8)) == 5;
+	state = state && dict.erase("a") && !dict.erase("a") && dict.get_key_at_index(0) == Variant(2);
+
+	Array keys = dict.keys();
+	int walked = 0;
+	for (const Variant *key = dict.next(); key; key = dict.next(key)) {
+		state = state && *key == keys[walked];
+		walked++;
+	}
+	state = state && walked == dict.size();
+
+	dict.clear();
+	state = state && dict.empty() && shared.empty() && dict.next() == NULL;
+
+	dict["x"] = 1;
+	dict["y"] = 2;
+	dict["z"] = 3;
+	state = state && dict.erase("x") && dict.get_key_at_index(0) == Variant("y") && int(dict.get_value_at_index(1)) == 3;
+	state = state && dict.get("missing", 7) == Variant(7) && dict.get_valid("missing").get_type() == Variant::NIL;
+
+	Dictionary copy = dict.duplicate();
+	state = state && copy.size() == 2 && copy.hash() == dict.hash() && copy.id() != dict.id();
+
+	// Pairs don't move: references stay valid while others are erased, or added past the inline ones.
+	Dictionary stable;
+	stable["a"] = 1;
+	stable["b"] = 2;
+	stable["c"] = 3;
+	Variant *b = stable.getptr("b");
+	Variant &c = stable["c"];
+	stable.erase("a");
+	for (int i = 0; i < 8; i++) {
+		stable[i] = i;
+	}
+	*b = 20;
+	c = 30;
+	state = state && stable.size() == 10 && stable.getptr("b") == b && int(stable["b"]) == 20 && int(stable["c"]) == 30;
+	state = state && stable.get_key_at_index(0) == Variant("b") && stable.get_key_at_index(2) == Variant(0) && stable.get_key_at_index(9) == Variant(7);
+
+	keys = stable.keys();
+	walked = 0;
+	for (const Variant *key = stable.next(); key; key = stable.next(key)) {
+		state = state && *key == keys[walked];
+		walked++;
+	}
+	state = state && walked == stable.size();
+
+	// A key taken from the dictionary itself must survive being inserted after the inline pairs.
+	Dictionary aliased;
+	for (int i = 0; i < 4; i++) {
+		aliased["key_" + itos(i)] = "value_" + itos(i);
+	}
+	aliased[aliased["key_3"]] = 4;
+	state = state && aliased.size() == 5 && int(aliased["value_3"]) == 4 && !aliased.has(Variant());
+
+	std::vector<Variant> bench_keys;
+	for (int i = 0; i < 16; i++) {
+		bench_keys.push_back("key_" + itos(i));
+	}
+
+	const int iterations = 200000;
+	const int kept = 1000;
+	int64_t sum = 0;
+	for (int size = 0; size <= 16; size = size ? size * 2 : 1) {
+
+		uint64_t usec = _bench_small_dictionaries(size, iterations, bench_keys, sum);
+
+		uint64_t blocks = Memory::get_alloc_count();
+		std::vector<Dictionary> live(kept);
+		for (int i = 0; i < kept; i++) {
+			for (int j = 0; j < size; j++) {
+				live[i][bench_keys[j]] = j;
+			}
+		}
+		blocks = Memory::get_alloc_count() - blocks;
+
+		OS::get_singleton()->print("\t%2d pairs x%d: %8d usec, %.2f heap blocks each\n", size, iterations, (int)usec, double(blocks) / kept);
+	}
+	state = state && sum > 0;
+
+	return state;
+}
+
+static bool _same_result(const Variant &p_a, const Variant &p_b) {
+
+	return p_a.get_type() == p_b.get_type() && p_a == p_b;
+}
+
+bool test_5() {
+
+	OS::get_singleton()->print("\n\nTest 5: operator evaluators\n");
+
+	bool state = true;
+
+	// Every operator on a few values of each common type (no zeros, divisions by zero are below),
+	// through the resolved evaluator and through evaluate().
+	std::vector<Variant> values;
+	values.push_back(Variant());
+	values.push_back(true);
+	values.push_back(false);
+	values.push_back(7);
+	values.push_back(3);
+	values.push_back(2.5);
+	values.push_back(-0.75);
+	values.push_back(Vector2(1, -2));
+	values.push_back(Vector2(3, 4));
+	values.push_back(Vector3(1, 2, -3));
+	values.push_back(Vector3(0.5, 4, 2));
+	values.push_back("text");
+	values.push_back(Color(1, 0.5, 0.25));
+
+	int mismatches = 0;
+	for (int op = 0; op < Variant::OP_MAX; op++) {
+		for (uint32_t i = 0; i < values.size(); i++) {
+			for (uint32_t j = 0; j < values.size(); j++) {
+
+				const Variant &a = values[i];
+				const Variant &b = values[j];
+				Variant::OperatorEvaluator evaluator = Variant::get_operator_evaluator(Variant::Operator(op), a.get_type(), b.get_type());
+
+				Variant expected;
+				bool expected_valid = true;
+				Variant::evaluate(Variant::Operator(op), a, b, expected, expected_valid);
+
+				// The result must replace whatever the destination held, even when it's an operand.
+				Variant ret = "previous";
+				bool valid = true;
+				evaluator(a, b, ret, valid);
+
+				Variant aliased = a;
+				bool aliased_valid = true;
+				evaluator(aliased, b, aliased, aliased_valid);
+
+				if (valid != expected_valid || aliased_valid != expected_valid || (valid && (!_same_result(ret, expected) || !_same_result(aliased, expected)))) {
+					OS::get_singleton()->print("\tmismatch: %s %s %s\n", Variant::get_type_name(a.get_type()).utf8().get_data(), Variant::get_operator_name(Variant::Operator(op)).utf8().get_data(), Variant::get_type_name(b.get_type()).utf8().get_data());
+					mismatches++;
+				}
+			}
+		}
+	}
+	state = state && mismatches == 0;
+
+#ifdef DEBUG_ENABLED
+	{
+		Variant ret;
+		bool valid = true;
+		Variant::get_operator_evaluator(Variant::OP_DIVIDE, Variant::INT, Variant::INT)(7, 0, ret, valid);
+		state = state && !valid && String(ret) == "Division By Zero";
+		valid = true;
+		Variant::get_operator_evaluator(Variant::OP_MODULE, Variant::INT, Variant::INT)(7, 0, ret, valid);
+		state = state && !valid && String(ret) == "Division By Zero";
+	}
+#endif
+
+	struct Bench {
+		const char *name;
+		Variant::Operator op;
+		Variant a;
+		Variant b;
+	};
+
+	const Bench benches[] = {
+		{ "int + int", Variant::OP_ADD, 7, 3 },
+		{ "int < int", Variant::OP_LESS, 7, 3 },
+		{ "float * float", Variant::OP_MULTIPLY, 2.5, -0.75 },
+		{ "float + int", Variant::OP_ADD, 2.5, 7 },
+		{ "Vector2 + Vector2", Variant::OP_ADD, Vector2(1, -2), Vector2(3, 4) },
+		{ "Vector3 * float", Variant::OP_MULTIPLY, Vector3(1, 2, -3), 2.5 },
+		{ "Vector3 == Vector3", Variant::OP_EQUAL, Vector3(1, 2, -3), Vector3(0.5, 4, 2) },
+	};
+
+	const int iterations = 1000000;
+	for (uint32_t i = 0; i < sizeof(benches) / sizeof(Bench); i++) {
+
+		const Bench &bench = benches[i];
+		Variant ret;
+		bool valid = true;
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int j = 0; j < iterations; j++) {
+			Variant::evaluate(bench.op, bench.a, bench.b, ret, valid);
+		}
+		uint64_t evaluate_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+		begin = OS::get_singleton()->get_ticks_usec();
+		Variant::OperatorEvaluator evaluator = Variant::get_operator_evaluator(bench.op, bench.a.get_type(), bench.b.get_type());
+		for (int j = 0; j < iterations; j++) {
+			evaluator(bench.a, bench.b, ret, valid);
+		}
+		uint64_t evaluator_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+		OS::get_singleton()->print("\t%-18s x%d: evaluate() %6d usec, evaluator %6d usec\n", bench.name, iterations, (int)evaluate_usec, (int)evaluator_usec);
+		state = state && valid;
+	}
+
+	return state;
+}
+
+TestFunc test_funcs[] = {
+
+	test_1,
+	test_2,
+	test_3,
+	test_4,
+	test_5,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestVariant
@@ -55,7 +55,7 @@ struct GodotFilterCallback : public btOverlapFilterCallback {
 
 /// It performs an additional check allow exclusions.
 struct GodotClosestRayResultCallback : public btCollisionWorld::ClosestRayResultCallback {
-	const Set<RID> *m_exclude;
+	const VSet<RID> *m_exclude;
 	bool m_pickRay;
 	int m_shapeId;
 
@@ -63,7 +63,7 @@ struct GodotClosestRayResultCallback : public btCollisionWorld::ClosestRayResult
 	bool collide_with_areas;
 
 public:
-	GodotClosestRayResultCallback(const btVector3 &rayFromWorld, const btVector3 &rayToWorld, const Set<RID> *p_exclude, bool p_collide_with_bodies, bool p_collide_with_areas) :
+	GodotClosestRayResultCallback(const btVector3 &rayFromWorld, const btVector3 &rayToWorld, const VSet<RID> *p_exclude, bool p_collide_with_bodies, bool p_collide_with_areas) :
 			btCollisionWorld::ClosestRayResultCallback(rayFromWorld, rayToWorld),
 			m_exclude(p_exclude),
 			m_pickRay(false),
@@ -87,10 +87,10 @@ struct GodotAllConvexResultCallback : public btCollisionWorld::ConvexResultCallb
 public:
 	PhysicsDirectSpaceState::ShapeResult *m_results;
 	int m_resultMax;
-	const Set<RID> *m_exclude;
+	const VSet<RID> *m_exclude;
 	int count;
 
-	GodotAllConvexResultCallback(PhysicsDirectSpaceState::ShapeResult *p_results, int p_resultMax, const Set<RID> *p_exclude) :
+	GodotAllConvexResultCallback(PhysicsDirectSpaceState::ShapeResult *p_results, int p_resultMax, const VSet<RID> *p_exclude) :
 			m_results(p_results),
 			m_resultMax(p_resultMax),
 			m_exclude(p_exclude),
@@ -116,13 +116,13 @@ public:
 
 struct GodotClosestConvexResultCallback : public btCollisionWorld::ClosestConvexResultCallback {
 public:
-	const Set<RID> *m_exclude;
+	const VSet<RID> *m_exclude;
 	int m_shapeId;
 
 	bool collide_with_bodies;
 	bool collide_with_areas;
 
-	GodotClosestConvexResultCallback(const btVector3 &convexFromWorld, const btVector3 &convexToWorld, const Set<RID> *p_exclude, bool p_collide_with_bodies, bool p_collide_with_areas) :
+	GodotClosestConvexResultCallback(const btVector3 &convexFromWorld, const btVector3 &convexToWorld, const VSet<RID> *p_exclude, bool p_collide_with_bodies, bool p_collide_with_areas) :
 			btCollisionWorld::ClosestConvexResultCallback(convexFromWorld, convexToWorld),
 			m_exclude(p_exclude),
 			m_shapeId(0),
@@ -139,13 +139,13 @@ public:
 	const btCollisionObject *m_self_object;
 	PhysicsDirectSpaceState::ShapeResult *m_results;
 	int m_resultMax;
-	const Set<RID> *m_exclude;
+	const VSet<RID> *m_exclude;
 	int m_count;
 
 	bool collide_with_bodies;
 	bool collide_with_areas;
 
-	GodotAllContactResultCallback(btCollisionObject *p_self_object, PhysicsDirectSpaceState::ShapeResult *p_results, int p_resultMax, const Set<RID> *p_exclude, bool p_collide_with_bodies, bool p_collide_with_areas) :
+	GodotAllContactResultCallback(btCollisionObject *p_self_object, PhysicsDirectSpaceState::ShapeResult *p_results, int p_resultMax, const VSet<RID> *p_exclude, bool p_collide_with_bodies, bool p_collide_with_areas) :
 			m_self_object(p_self_object),
 			m_results(p_results),
 			m_resultMax(p_resultMax),
@@ -165,13 +165,13 @@ public:
 	const btCollisionObject *m_self_object;
 	Vector3 *m_results;
 	int m_resultMax;
-	const Set<RID> *m_exclude;
+	const VSet<RID> *m_exclude;
 	int m_count;
 
 	bool collide_with_bodies;
 	bool collide_with_areas;
 
-	GodotContactPairContactResultCallback(btCollisionObject *p_self_object, Vector3 *p_results, int p_resultMax, const Set<RID> *p_exclude, bool p_collide_with_bodies, bool p_collide_with_areas) :
+	GodotContactPairContactResultCallback(btCollisionObject *p_self_object, Vector3 *p_results, int p_resultMax, const VSet<RID> *p_exclude, bool p_collide_with_bodies, bool p_collide_with_areas) :
 			m_self_object(p_self_object),
 			m_results(p_results),
 			m_resultMax(p_resultMax),
@@ -189,7 +189,7 @@ struct GodotRestInfoContactResultCallback : public btCollisionWorld::ContactResu
 public:
 	const btCollisionObject *m_self_object;
 	PhysicsDirectSpaceState::ShapeRestInfo *m_result;
-	const Set<RID> *m_exclude;
+	const VSet<RID> *m_exclude;
 	bool m_collided;
 	real_t m_min_distance;
 	const btCollisionObject *m_rest_info_collision_object;
@@ -197,7 +197,7 @@ public:
 	bool collide_with_bodies;
 	bool collide_with_areas;
 
-	GodotRestInfoContactResultCallback(btCollisionObject *p_self_object, PhysicsDirectSpaceState::ShapeRestInfo *p_result, const Set<RID> *p_exclude, bool p_collide_with_bodies, bool p_collide_with_areas) :
+	GodotRestInfoContactResultCallback(btCollisionObject *p_self_object, PhysicsDirectSpaceState::ShapeRestInfo *p_result, const VSet<RID> *p_exclude, bool p_collide_with_bodies, bool p_collide_with_areas) :
 			m_self_object(p_self_object),
 			m_result(p_result),
 			m_exclude(p_exclude),
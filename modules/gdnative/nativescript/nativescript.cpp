@@ -1215,6 +1215,8 @@ int NativeScriptLanguage::profiling_get_accumulated_data(ProfilingInfo *p_info_a
 		p_info_arr[current].call_count = d->get().call_count;
 		p_info_arr[current].self_time = d->get().self_time;
 		p_info_arr[current].total_time = d->get().total_time;
+		p_info_arr[current].cache_hits = 0;
+		p_info_arr[current].cache_misses = 0;
 		p_info_arr[current].signature = d->get().signature;
 		current++;
 	}
@@ -1240,6 +1242,8 @@ int NativeScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, in
 			p_info_arr[current].call_count = d->get().last_frame_call_count;
 			p_info_arr[current].self_time = d->get().last_frame_self_time;
 			p_info_arr[current].total_time = d->get().last_frame_total_time;
+			p_info_arr[current].cache_hits = 0;
+			p_info_arr[current].cache_misses = 0;
 			p_info_arr[current].signature = d->get().signature;
 			current++;
 		}
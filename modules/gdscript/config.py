@@ -10,6 +10,7 @@ def get_doc_classes():
         "GDScript",
         "GDScriptFunctionState",
         "GDScriptNativeClass",
+        "GDScriptSignalWaiters",
     ]
 
 def get_doc_path():
@@ -31,13 +31,17 @@
 #include "gdscript.h"
 
 #include "core/core_string_names.h"
+#include "core/crypto/crypto_core.h"
 #include "core/engine.h"
 #include "core/global_constants.h"
 #include "core/io/file_access_encrypted.h"
 #include "core/os/file_access.h"
 #include "core/os/os.h"
+#include "core/os/thread_pool.h"
 #include "core/project_settings.h"
+#include "gdscript_cache.h"
 #include "gdscript_compiler.h"
+#include "gdscript_preloader.h"
 
 ///////////////////////////
 
@@ -539,6 +543,13 @@ void GDScript::_set_subclass_path(Ref<GDScript> &p_sc, const String &p_path) {
 	}
 }
 
+bool GDScript::_can_use_bytecode_cache() const {
+
+	// Scripts run from the editor are compiled, so warnings reach the debugger.
+	return GDScriptLanguage::get_singleton()->is_bytecode_cache_enabled() && !ScriptDebugger::get_singleton() && !Engine::get_singleton()->is_editor_hint() &&
+		   !get_path().empty() && get_path().find("::") == -1;
+}
+
 Error GDScript::reload(bool p_keep_state) {
 
 #ifndef NO_THREADS
@@ -566,9 +577,27 @@ Error GDScript::reload(bool p_keep_state) {
 	}
 
 	valid = false;
+	compile_stamp = 0;
+
+	bool use_cache = !p_keep_state && _can_use_bytecode_cache();
+	std::vector<uint8_t> source_hash;
+	if (use_cache) {
+		source_hash = source.md5_buffer();
+		if (GDScriptCache::load(this, source_hash) == OK) {
+			valid = true;
+			for (Map<StringName, Ref<GDScript> >::Element *E = subclasses.front(); E; E = E->next()) {
+				_set_subclass_path(E->get(), path);
+			}
+			return OK;
+		}
+	}
+
 	GDScriptParser parser;
 	Error err = parser.parse(source, basedir, false, path);
 	if (err) {
+		if (GDScriptPreloader::is_worker_thread()) {
+			return ERR_PARSE_ERROR; // Reported when compiled again on the calling thread.
+		}
 		if (ScriptDebugger::get_singleton()) {
 			GDScriptLanguage::get_singleton()->debug_break_parse(get_path(), parser.get_error_line(), "Parser Error: " + parser.get_error());
 		}
@@ -580,8 +609,13 @@ Error GDScript::reload(bool p_keep_state) {
 
 	GDScriptCompiler compiler;
 	err = compiler.compile(&parser, this, p_keep_state);
+	// Functions and members were replaced.
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
 
 	if (err) {
+		if (GDScriptPreloader::is_worker_thread()) {
+			return ERR_COMPILATION_FAILED; // Reported when compiled again on the calling thread.
+		}
 
 		if (can_run) {
 			if (ScriptDebugger::get_singleton()) {
@@ -610,6 +644,10 @@ Error GDScript::reload(bool p_keep_state) {
 		_set_subclass_path(E->get(), path);
 	}
 
+	if (use_cache) {
+		GDScriptCache::save(this, source_hash, parser.get_loaded_dependencies());
+	}
+
 	return OK;
 }
 
@@ -771,17 +809,42 @@ Error GDScript::load_byte_code(const String &p_path) {
 		basedir = basedir.get_base_dir();
 
 	valid = false;
+	compile_stamp = 0;
+
+	// Encrypted scripts aren't cached, that would store them in the clear.
+	bool use_cache = !p_path.ends_with("gde") && _can_use_bytecode_cache();
+	std::vector<uint8_t> source_hash;
+	if (use_cache) {
+		source_hash.resize(16);
+		CryptoCore::md5(bytecode.data(), bytecode.size(), source_hash.data());
+		if (GDScriptCache::load(this, source_hash) == OK) {
+			valid = true;
+			for (Map<StringName, Ref<GDScript> >::Element *E = subclasses.front(); E; E = E->next()) {
+				_set_subclass_path(E->get(), path);
+			}
+			return OK;
+		}
+	}
+
 	GDScriptParser parser;
 	Error err = parser.parse_bytecode(bytecode, basedir, get_path());
 	if (err) {
+		if (GDScriptPreloader::is_worker_thread()) {
+			return ERR_PARSE_ERROR; // Reported when compiled again on the calling thread.
+		}
 		_err_print_error("GDScript::load_byte_code", path.empty() ? "built-in" : (const char *)path.utf8().get_data(), parser.get_error_line(), ("Parse Error: " + parser.get_error()).utf8().get_data(), ERR_HANDLER_SCRIPT);
 		ERR_FAIL_V(ERR_PARSE_ERROR);
 	}
 
 	GDScriptCompiler compiler;
 	err = compiler.compile(&parser, this);
+	// Functions and members were replaced.
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
 
 	if (err) {
+		if (GDScriptPreloader::is_worker_thread()) {
+			return ERR_COMPILATION_FAILED; // Reported when compiled again on the calling thread.
+		}
 		_err_print_error("GDScript::load_byte_code", path.empty() ? "built-in" : (const char *)path.utf8().get_data(), compiler.get_error_line(), ("Compile Error: " + compiler.get_error()).utf8().get_data(), ERR_HANDLER_SCRIPT);
 		ERR_FAIL_V(ERR_COMPILATION_FAILED);
 	}
@@ -793,6 +856,10 @@ Error GDScript::load_byte_code(const String &p_path) {
 		_set_subclass_path(E->get(), path);
 	}
 
+	if (use_cache) {
+		GDScriptCache::save(this, source_hash, parser.get_loaded_dependencies());
+	}
+
 	return OK;
 }
 
@@ -898,6 +965,7 @@ GDScript::GDScript() :
 	_base = NULL;
 	_owner = NULL;
 	tool = false;
+	compile_stamp = 0;
 #ifdef TOOLS_ENABLED
 	source_changed_cache = false;
 	placeholder_fallback_enabled = false;
@@ -916,6 +984,11 @@ GDScript::GDScript() :
 }
 
 GDScript::~GDScript() {
+
+	// Inline caches may point to the functions and members freed here, and another script may be
+	// allocated at the same address.
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
+
 	for (Map<StringName, GDScriptFunction *>::Element *E = member_functions.front(); E; E = E->next()) {
 		memdelete(E->get());
 	}
@@ -1357,6 +1430,7 @@ void GDScriptLanguage::_add_global(const StringName &p_name, const Variant &p_va
 	}
 	globals[p_name] = global_array.size();
 	global_array.push_back(p_value);
+	global_map_hash = hash_djb2_one_32(p_name.hash(), global_map_hash);
 	_global_array = global_array.data();
 }
 
@@ -1429,6 +1503,9 @@ Error GDScriptLanguage::execute_file(const String &p_path) {
 	return OK;
 }
 void GDScriptLanguage::finish() {
+
+	_clear_yield_waiters(true);
+	preloaded.clear();
 }
 
 void GDScriptLanguage::profiling_start() {
@@ -1449,6 +1526,12 @@ void GDScriptLanguage::profiling_start() {
 		elem->self()->profile.last_frame_call_count = 0;
 		elem->self()->profile.last_frame_self_time = 0;
 		elem->self()->profile.last_frame_total_time = 0;
+		elem->self()->profile.cache_hits = 0;
+		elem->self()->profile.cache_misses = 0;
+		elem->self()->profile.frame_cache_hits = 0;
+		elem->self()->profile.frame_cache_misses = 0;
+		elem->self()->profile.last_frame_cache_hits = 0;
+		elem->self()->profile.last_frame_cache_misses = 0;
 		elem = elem->next();
 	}
 
@@ -1491,6 +1574,8 @@ int GDScriptLanguage::profiling_get_accumulated_data(ProfilingInfo *p_info_arr,
 		p_info_arr[current].self_time = elem->self()->profile.self_time;
 		p_info_arr[current].total_time = elem->self()->profile.total_time;
 		p_info_arr[current].signature = elem->self()->profile.signature;
+		p_info_arr[current].cache_hits = elem->self()->profile.cache_hits;
+		p_info_arr[current].cache_misses = elem->self()->profile.cache_misses;
 		elem = elem->next();
 		current++;
 	}
@@ -1522,6 +1607,8 @@ int GDScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_
 			p_info_arr[current].self_time = elem->self()->profile.last_frame_self_time;
 			p_info_arr[current].total_time = elem->self()->profile.last_frame_total_time;
 			p_info_arr[current].signature = elem->self()->profile.signature;
+			p_info_arr[current].cache_hits = elem->self()->profile.last_frame_cache_hits;
+			p_info_arr[current].cache_misses = elem->self()->profile.last_frame_cache_misses;
 			current++;
 		}
 		elem = elem->next();
@@ -1745,6 +1832,10 @@ void GDScriptLanguage::frame() {
 			elem->self()->profile.frame_call_count = 0;
 			elem->self()->profile.frame_self_time = 0;
 			elem->self()->profile.frame_total_time = 0;
+			elem->self()->profile.last_frame_cache_hits = elem->self()->profile.frame_cache_hits;
+			elem->self()->profile.last_frame_cache_misses = elem->self()->profile.frame_cache_misses;
+			elem->self()->profile.frame_cache_hits = 0;
+			elem->self()->profile.frame_cache_misses = 0;
 			elem = elem->next();
 		}
 
@@ -1754,6 +1845,168 @@ void GDScriptLanguage::frame() {
 	}
 
 #endif
+
+	_clear_yield_waiters(false);
+
+	if (!preloaded.empty()) {
+		preloaded.clear();
+	}
+}
+
+void GDScriptLanguage::preload_scripts(const std::vector<String> &p_paths) {
+
+	// Compiling sends warnings to the debugger, which is not thread-safe.
+	if (!parallel_preload_enabled || !ThreadPool::get_singleton() || ScriptDebugger::get_singleton() || Engine::get_singleton()->is_editor_hint()) {
+		return;
+	}
+
+	GDScriptPreloader preloader;
+	preloader.preload(p_paths, preloaded);
+}
+
+bool GDScriptLanguage::queue_yield(Object *p_object, const String &p_signal, const Ref<GDScriptFunctionState> &p_state, Error &r_error) {
+
+	YieldSignal key;
+	if (p_signal == "idle_frame") {
+		key.signal = strings.idle_frame;
+	} else if (p_signal == "physics_frame") {
+		key.signal = strings.physics_frame;
+	} else {
+		return false;
+	}
+	key.object = p_object->get_instance_id();
+
+	r_error = OK;
+
+	if (lock) {
+		lock->lock();
+	}
+
+	Map<YieldSignal, GDScriptSignalWaiters *>::Element *E = yield_waiters.find(key);
+	if (!E) {
+		GDScriptSignalWaiters *waiters = memnew(GDScriptSignalWaiters);
+		r_error = p_object->connect(key.signal, waiters, "_signal_callback");
+		if (r_error == OK) {
+			E = yield_waiters.insert(key, waiters);
+		} else {
+			memdelete(waiters);
+		}
+	}
+
+	if (E) {
+		E->get()->states.push_back(p_state);
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	return true;
+}
+
+// Drops the waiters nobody yielded on since their signal was last emitted, or whose object
+// is gone, so connections don't outlive their use. All of them when p_all is set.
+void GDScriptLanguage::_clear_yield_waiters(bool p_all) {
+
+	if (yield_waiters.empty()) {
+		return;
+	}
+
+	std::vector<GDScriptSignalWaiters *> unused;
+
+	if (lock) {
+		lock->lock();
+	}
+
+	Map<YieldSignal, GDScriptSignalWaiters *>::Element *E = yield_waiters.front();
+	while (E) {
+		Map<YieldSignal, GDScriptSignalWaiters *>::Element *N = E->next();
+		if (p_all || E->get()->states.empty() || !ObjectDB::get_instance(E->key().object)) {
+			unused.push_back(E->get());
+			yield_waiters.erase(E);
+		}
+		E = N;
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	// Outside the lock, freeing the states they hold can run script code.
+	for (size_t i = 0; i < unused.size(); i++) {
+		memdelete(unused[i]);
+	}
+}
+
+uint8_t *GDScriptLanguage::alloc_yield_frame(uint32_t p_size, uint32_t &r_capacity) {
+
+	if (p_size == 0) {
+		r_capacity = 0;
+		return NULL;
+	}
+
+	int size_class = 0;
+	while ((1u << (size_class + YIELD_FRAME_MIN_SHIFT)) < p_size && size_class < YIELD_FRAME_CLASSES) {
+		size_class++;
+	}
+
+	if (size_class == YIELD_FRAME_CLASSES) {
+		r_capacity = p_size;
+		return (uint8_t *)memalloc(p_size);
+	}
+
+	r_capacity = 1u << (size_class + YIELD_FRAME_MIN_SHIFT);
+
+	uint8_t *frame = NULL;
+
+	if (lock) {
+		lock->lock();
+	}
+
+	if (!yield_frame_pool[size_class].empty()) {
+		frame = yield_frame_pool[size_class].back();
+		yield_frame_pool[size_class].pop_back();
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	return frame ? frame : (uint8_t *)memalloc(r_capacity);
+}
+
+void GDScriptLanguage::free_yield_frame(uint8_t *p_frame, uint32_t p_capacity) {
+
+	if (!p_frame) {
+		return;
+	}
+
+	int size_class = 0;
+	while ((1u << (size_class + YIELD_FRAME_MIN_SHIFT)) < p_capacity && size_class < YIELD_FRAME_CLASSES) {
+		size_class++;
+	}
+
+	if (size_class < YIELD_FRAME_CLASSES && p_capacity == 1u << (size_class + YIELD_FRAME_MIN_SHIFT)) {
+
+		if (lock) {
+			lock->lock();
+		}
+
+		bool pooled = yield_frame_pool[size_class].size() < YIELD_FRAME_POOL_MAX;
+		if (pooled) {
+			yield_frame_pool[size_class].push_back(p_frame);
+		}
+
+		if (lock) {
+			lock->unlock();
+		}
+
+		if (pooled) {
+			return;
+		}
+	}
+
+	memfree(p_frame);
 }
 
 /* EDITOR FUNCTIONS */
@@ -2112,6 +2365,8 @@ GDScriptLanguage::GDScriptLanguage() {
 	strings._get = StaticCString::create("_get");
 	strings._get_property_list = StaticCString::create("_get_property_list");
 	strings._script_source = StaticCString::create("script/source");
+	strings.idle_frame = StaticCString::create("idle_frame");
+	strings.physics_frame = StaticCString::create("physics_frame");
 	_debug_parse_err_line = -1;
 	_debug_parse_err_file = "";
 
@@ -2122,6 +2377,13 @@ GDScriptLanguage::GDScriptLanguage() {
 #endif
 	profiling = false;
 	script_frame_time = 0;
+	typed_instructions = true;
+	inline_cache_epoch.store(0);
+	global_map_hash = 5381;
+
+	bytecode_cache_enabled = GLOBAL_DEF("gdscript/bytecode_cache/enabled", true);
+	bytecode_cache_path = GLOBAL_DEF("gdscript/bytecode_cache/path", "user://gdscript_cache");
+	parallel_preload_enabled = GLOBAL_DEF("gdscript/parallel_preload/enabled", true);
 
 	_debug_call_stack_pos = 0;
 	int dmcs = GLOBAL_DEF("debug/settings/gdscript/max_call_stack", 1024);
@@ -2151,6 +2413,14 @@ GDScriptLanguage::GDScriptLanguage() {
 
 GDScriptLanguage::~GDScriptLanguage() {
 
+	_clear_yield_waiters(true);
+
+	for (int i = 0; i < YIELD_FRAME_CLASSES; i++) {
+		for (size_t j = 0; j < yield_frame_pool[i].size(); j++) {
+			memfree(yield_frame_pool[i][j]);
+		}
+	}
+
 	if (lock) {
 		memdelete(lock);
 		lock = NULL;
@@ -2177,7 +2447,9 @@ RES ResourceFormatLoaderGDScript::load(const String &p_path, const String &p_ori
 		script->set_script_path(p_original_path); // script needs this.
 		script->set_path(p_original_path);
 		Error err = script->load_byte_code(p_path);
-		ERR_FAIL_COND_V_MSG(err != OK, RES(), "Cannot load byte code from file '" + p_path + "'.");
+		// Preload workers get the invalid script, like for sources that don't compile. It's loaded
+		// again on the calling thread, which reports the error.
+		ERR_FAIL_COND_V_MSG(err != OK && !GDScriptPreloader::is_worker_thread(), RES(), "Cannot load byte code from file '" + p_path + "'.");
 
 	} else {
 		Error err = script->load_source_code(p_path);
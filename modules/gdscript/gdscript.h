@@ -75,6 +75,7 @@ class GDScript : public Script {
 	friend class GDScriptCompiler;
 	friend class GDScriptFunctions;
 	friend class GDScriptLanguage;
+	friend class GDScriptCache;
 
 	Variant _static_ref; //used for static call
 	Ref<GDScriptNativeClass> native;
@@ -116,9 +117,12 @@ class GDScript : public Script {
 	String name;
 	SelfList<GDScript> script_list;
 
+	uint64_t compile_stamp; // identifies the compiled code and what it was compiled against, 0 if unknown
+
 	GDScriptInstance *_create_instance(const Variant **p_args, int p_argcount, Object *p_owner, bool p_isref, Variant::CallError &r_error);
 
 	void _set_subclass_path(Ref<GDScript> &p_sc, const String &p_path);
+	bool _can_use_bytecode_cache() const;
 
 #ifdef TOOLS_ENABLED
 	Set<PlaceHolderScriptInstance *> placeholders;
@@ -351,10 +355,39 @@ class GDScriptLanguage : public ScriptLanguage {
 
 	SelfList<GDScript>::List script_list;
 	friend class GDScriptFunction;
+	friend class GDScriptSignalWaiters;
 
 	SelfList<GDScriptFunction>::List function_list;
+	uint32_t global_map_hash;
+	bool bytecode_cache_enabled;
+	String bytecode_cache_path;
+	bool parallel_preload_enabled;
+	std::vector<RES> preloaded; // Kept until the next frame.
 	bool profiling;
 	uint64_t script_frame_time;
+	bool typed_instructions;
+	std::atomic<uint32_t> inline_cache_epoch;
+
+	struct YieldSignal {
+		ObjectID object;
+		StringName signal;
+
+		bool operator<(const YieldSignal &p_other) const { return object == p_other.object ? signal < p_other.signal : object < p_other.object; }
+	};
+
+	// Functions yielding on the frame signals, which some scripts do every frame.
+	Map<YieldSignal, GDScriptSignalWaiters *> yield_waiters;
+
+	// Frames of yielded functions, recycled by power of two size classes.
+	enum {
+		YIELD_FRAME_MIN_SHIFT = 6,
+		YIELD_FRAME_CLASSES = 14,
+		YIELD_FRAME_POOL_MAX = 256, // per class
+	};
+
+	std::vector<uint8_t *> yield_frame_pool[YIELD_FRAME_CLASSES];
+
+	void _clear_yield_waiters(bool p_all);
 
 public:
 	int calls;
@@ -427,6 +460,8 @@ public:
 		StringName _get;
 		StringName _get_property_list;
 		StringName _script_source;
+		StringName idle_frame;
+		StringName physics_frame;
 
 	} strings;
 
@@ -437,6 +472,33 @@ public:
 
 	_FORCE_INLINE_ static GDScriptLanguage *get_singleton() { return singleton; }
 
+	// Changes when globals are added, as compiled code refers to them by index.
+	_FORCE_INLINE_ uint32_t get_global_map_hash() const { return global_map_hash; }
+
+	// Whether scripts loaded from files are compiled once and then loaded from GDScriptCache.
+	void set_bytecode_cache_enabled(bool p_enabled) { bytecode_cache_enabled = p_enabled; }
+	bool is_bytecode_cache_enabled() const { return bytecode_cache_enabled; }
+	void set_bytecode_cache_path(const String &p_path) { bytecode_cache_path = p_path; }
+	const String &get_bytecode_cache_path() const { return bytecode_cache_path; }
+
+	// Whether preload_scripts() compiles on the ThreadPool, otherwise scripts load when first used.
+	void set_parallel_preload_enabled(bool p_enabled) { parallel_preload_enabled = p_enabled; }
+	bool is_parallel_preload_enabled() const { return parallel_preload_enabled; }
+
+	// Whether the compiler emits the typed fast-path instructions when types are known.
+	void set_typed_instructions_enabled(bool p_enabled) { typed_instructions = p_enabled; }
+	bool is_typed_instructions_enabled() const { return typed_instructions; }
+
+	// Bumped when scripts are compiled, so function inline caches forget what they knew about scripts.
+	_FORCE_INLINE_ uint32_t get_inline_cache_epoch() const { return inline_cache_epoch.load(std::memory_order_acquire); }
+	void invalidate_inline_caches() { inline_cache_epoch.fetch_add(1, std::memory_order_acq_rel); }
+
+	// Queues p_state to be resumed by p_signal if it's one of the frame signals, returns false otherwise.
+	bool queue_yield(Object *p_object, const String &p_signal, const Ref<GDScriptFunctionState> &p_state, Error &r_error);
+
+	uint8_t *alloc_yield_frame(uint32_t p_size, uint32_t &r_capacity);
+	void free_yield_frame(uint8_t *p_frame, uint32_t p_capacity);
+
 	virtual String get_name() const;
 
 	/* LANGUAGE FUNCTIONS */
@@ -486,6 +548,7 @@ public:
 
 	virtual void reload_all_scripts();
 	virtual void reload_tool_script(const Ref<Script> &p_script, bool p_soft_reload);
+	virtual void preload_scripts(const std::vector<String> &p_paths);
 
 	virtual void frame();
 
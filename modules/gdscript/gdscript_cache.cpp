@@ -0,0 +1,1043 @@
+/*************************************************************************/
+/*  gdscript_cache.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_cache.h"
+
+#include "core/io/marshalls.h"
+#include "core/io/resource_loader.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/version.h"
+#include "core/version_hash.gen.h"
+#include "gdscript.h"
+#include "gdscript_preloader.h"
+#include "gdscript_typed_ops.h"
+
+enum {
+	CACHE_FLAG_DEBUG = 1,
+	CACHE_FLAG_TOOLS = 2,
+	CACHE_FLAG_TYPED_INSTRUCTIONS = 4,
+};
+
+enum CacheValueTag {
+	CACHE_VALUE_VARIANT, // anything encode_variant() can store by value
+	CACHE_VALUE_NULL_OBJECT,
+	CACHE_VALUE_NATIVE_CLASS, // global name
+	CACHE_VALUE_SCRIPT, // path of the root script (empty for the one being loaded), inner class names
+	CACHE_VALUE_RESOURCE, // path
+	CACHE_VALUE_ARRAY,
+	CACHE_VALUE_DICTIONARY,
+};
+
+static uint32_t _get_cache_flags() {
+
+	uint32_t flags = 0;
+#ifdef DEBUG_ENABLED
+	flags |= CACHE_FLAG_DEBUG;
+#endif
+#ifdef TOOLS_ENABLED
+	flags |= CACHE_FLAG_TOOLS;
+#endif
+	if (GDScriptLanguage::get_singleton()->is_typed_instructions_enabled()) {
+		flags |= CACHE_FLAG_TYPED_INSTRUCTIONS;
+	}
+	return flags;
+}
+
+static String _get_engine_build() {
+
+	// The typed instruction tables are compiled in, bytecode refers to them by index.
+	return String(VERSION_FULL_BUILD) + "." + VERSION_HASH + "." + itos(GDScriptTypedOps::operator_count) + "." + itos(GDScriptTypedOps::member_count);
+}
+
+/* WRITER */
+
+class GDScriptCache::Writer {
+public:
+	const GDScript *root;
+	std::vector<uint8_t> data;
+	Map<String, uint32_t> string_map;
+	std::vector<String> strings;
+	String error;
+
+	void put_32(uint32_t p_value) {
+		size_t pos = data.size();
+		data.resize(pos + 4);
+		encode_uint32(p_value, &data[pos]);
+	}
+
+	void put_64(uint64_t p_value) {
+		size_t pos = data.size();
+		data.resize(pos + 8);
+		encode_uint64(p_value, &data[pos]);
+	}
+
+	// Length and bytes padded to 4, for the few things written before the string table.
+	void put_buffer(const uint8_t *p_buffer, uint32_t p_len) {
+		put_32(p_len);
+		size_t pos = data.size();
+		data.resize(pos + ((p_len + 3) & ~3));
+		if (p_len) {
+			memcpy(&data[pos], p_buffer, p_len);
+		}
+	}
+
+	void put_raw_string(const String &p_string) {
+		CharString utf8 = p_string.utf8();
+		put_buffer((const uint8_t *)utf8.get_data(), utf8.length());
+	}
+
+	void put_string(const String &p_string) {
+		Map<String, uint32_t>::Element *E = string_map.find(p_string);
+		if (!E) {
+			E = string_map.insert(p_string, strings.size());
+			strings.push_back(p_string);
+		}
+		put_32(E->get());
+	}
+
+	void put_object(const Object *p_object);
+	void put_variant(const Variant &p_value);
+	void put_data_type(const GDScriptDataType &p_type);
+	void put_property(const PropertyInfo &p_property);
+	void put_class_tree(const GDScript *p_script);
+	void put_class(const GDScript *p_script);
+	void put_function(const GDScriptFunction *p_function);
+
+	Writer() :
+			root(NULL) {}
+};
+
+void GDScriptCache::Writer::put_object(const Object *p_object) {
+
+	if (!p_object) {
+		put_32(CACHE_VALUE_NULL_OBJECT);
+		return;
+	}
+
+	const GDScriptNativeClass *native = Object::cast_to<GDScriptNativeClass>(p_object);
+	if (native) {
+		// Registered without the underscore of the exposed singleton classes, see GDScriptLanguage::init().
+		String name = native->get_name();
+		if (name.begins_with("_")) {
+			name = name.substr(1, name.length());
+		}
+		put_32(CACHE_VALUE_NATIVE_CLASS);
+		put_string(name);
+		return;
+	}
+
+	const GDScript *script = Object::cast_to<GDScript>(p_object);
+	if (script) {
+		std::vector<StringName> names;
+		while (script->_owner) {
+			names.push_back(script->name);
+			script = script->_owner;
+		}
+
+		String path;
+		if (script != root) {
+			path = script->get_path();
+			if (path.empty() || path.find("::") != -1) {
+				error = "Script without a file";
+				return;
+			}
+		}
+
+		put_32(CACHE_VALUE_SCRIPT);
+		put_string(path);
+		put_32(names.size());
+		for (size_t i = names.size(); i > 0; i--) {
+			put_string(names[i - 1]);
+		}
+		return;
+	}
+
+	const Resource *resource = Object::cast_to<Resource>(p_object);
+	if (resource && !resource->get_path().empty() && resource->get_path().find("::") == -1) {
+		put_32(CACHE_VALUE_RESOURCE);
+		put_string(resource->get_path());
+		return;
+	}
+
+	error = "Constant object of type '" + p_object->get_class() + "' can't be stored";
+}
+
+void GDScriptCache::Writer::put_variant(const Variant &p_value) {
+
+	switch (p_value.get_type()) {
+		case Variant::OBJECT: {
+			put_object(p_value.operator Object *());
+		} break;
+		case Variant::ARRAY: {
+			Array array = p_value;
+			put_32(CACHE_VALUE_ARRAY);
+			put_32(array.size());
+			for (int i = 0; i < array.size(); i++) {
+				put_variant(array[i]);
+			}
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary dictionary = p_value;
+			List<Variant> keys;
+			dictionary.get_key_list(&keys);
+			put_32(CACHE_VALUE_DICTIONARY);
+			put_32(keys.size());
+			for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
+				put_variant(E->get());
+				put_variant(dictionary[E->get()]);
+			}
+		} break;
+		default: {
+			int len;
+			Error err = encode_variant(p_value, NULL, len);
+			if (err != OK) {
+				error = "Constant of type '" + Variant::get_type_name(p_value.get_type()) + "' can't be stored";
+				return;
+			}
+			put_32(CACHE_VALUE_VARIANT);
+			put_32(len);
+			size_t pos = data.size();
+			data.resize(pos + ((len + 3) & ~3));
+			encode_variant(p_value, &data[pos], len);
+		} break;
+	}
+}
+
+void GDScriptCache::Writer::put_data_type(const GDScriptDataType &p_type) {
+
+	put_32(p_type.has_type);
+	put_32(p_type.kind);
+	put_32(p_type.builtin_type);
+	put_string(p_type.native_type);
+	put_object(p_type.script_type.ptr());
+}
+
+void GDScriptCache::Writer::put_property(const PropertyInfo &p_property) {
+
+	put_32(p_property.type);
+	put_string(p_property.name);
+	put_string(p_property.class_name);
+	put_32(p_property.hint);
+	put_string(p_property.hint_string);
+	put_32(p_property.usage);
+}
+
+void GDScriptCache::Writer::put_class_tree(const GDScript *p_script) {
+
+	put_32(p_script->subclasses.size());
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		put_string(E->key());
+		put_class_tree(E->get().ptr());
+	}
+}
+
+void GDScriptCache::Writer::put_class(const GDScript *p_script) {
+
+	put_32(p_script->tool);
+	put_string(p_script->name);
+	put_object(p_script->native.ptr());
+	put_object(p_script->base.ptr());
+
+	put_32(p_script->members.size());
+	for (const Set<StringName>::Element *E = p_script->members.front(); E; E = E->next()) {
+		put_string(E->get());
+	}
+
+	put_32(p_script->member_indices.size());
+	for (const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.front(); E; E = E->next()) {
+		put_string(E->key());
+		put_32(E->get().index);
+		put_string(E->get().setter);
+		put_string(E->get().getter);
+		put_32(E->get().rpc_mode);
+		put_data_type(E->get().data_type);
+	}
+
+	put_32(p_script->member_info.size());
+	for (const Map<StringName, PropertyInfo>::Element *E = p_script->member_info.front(); E; E = E->next()) {
+		put_string(E->key());
+		put_property(E->get());
+	}
+
+	put_32(p_script->constants.size());
+	for (const Map<StringName, Variant>::Element *E = p_script->constants.front(); E; E = E->next()) {
+		put_string(E->key());
+		put_variant(E->get());
+	}
+
+	put_32(p_script->_signals.size());
+	for (const Map<StringName, std::vector<StringName> >::Element *E = p_script->_signals.front(); E; E = E->next()) {
+		put_string(E->key());
+		put_32(E->get().size());
+		for (size_t i = 0; i < E->get().size(); i++) {
+			put_string(E->get()[i]);
+		}
+	}
+
+#ifdef TOOLS_ENABLED
+	put_32(p_script->member_lines.size());
+	for (const Map<StringName, int>::Element *E = p_script->member_lines.front(); E; E = E->next()) {
+		put_string(E->key());
+		put_32(E->get());
+	}
+
+	put_32(p_script->member_default_values.size());
+	for (const Map<StringName, Variant>::Element *E = p_script->member_default_values.front(); E; E = E->next()) {
+		put_string(E->key());
+		put_variant(E->get());
+	}
+#endif
+
+	put_32(p_script->member_functions.size());
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+		put_string(E->key());
+		put_function(E->get());
+	}
+
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		put_class(E->get().ptr());
+	}
+}
+
+void GDScriptCache::Writer::put_function(const GDScriptFunction *p_function) {
+
+	put_string(p_function->name);
+	put_32(p_function->_static);
+	put_32(p_function->rpc_mode);
+
+	put_32(p_function->argument_types.size());
+	for (size_t i = 0; i < p_function->argument_types.size(); i++) {
+		put_data_type(p_function->argument_types[i]);
+	}
+	put_data_type(p_function->return_type);
+
+#ifdef TOOLS_ENABLED
+	put_32(p_function->arg_names.size());
+	for (size_t i = 0; i < p_function->arg_names.size(); i++) {
+		put_string(p_function->arg_names[i]);
+	}
+#endif
+
+	put_32(p_function->constants.size());
+	for (size_t i = 0; i < p_function->constants.size(); i++) {
+		put_variant(p_function->constants[i]);
+	}
+
+	put_32(p_function->global_names.size());
+	for (size_t i = 0; i < p_function->global_names.size(); i++) {
+		put_string(p_function->global_names[i]);
+	}
+
+#ifdef TOOLS_ENABLED
+	put_32(p_function->named_globals.size());
+	for (size_t i = 0; i < p_function->named_globals.size(); i++) {
+		put_string(p_function->named_globals[i]);
+	}
+#endif
+
+	put_32(p_function->default_arguments.size());
+	for (size_t i = 0; i < p_function->default_arguments.size(); i++) {
+		put_32(p_function->default_arguments[i]);
+	}
+
+	put_32(p_function->code.size());
+	for (size_t i = 0; i < p_function->code.size(); i++) {
+		put_32(p_function->code[i]);
+	}
+
+	put_32(p_function->_argument_count);
+	put_32(p_function->_stack_size);
+	put_32(p_function->_call_size);
+	put_32(p_function->_inline_cache_count);
+	put_32(p_function->_initial_line);
+
+	put_32(p_function->stack_debug.size());
+	for (const List<GDScriptFunction::StackDebug>::Element *E = p_function->stack_debug.front(); E; E = E->next()) {
+		put_32(E->get().line);
+		put_32(E->get().pos);
+		put_32(E->get().added);
+		put_string(E->get().identifier);
+	}
+}
+
+/* READER */
+
+class GDScriptCache::Reader {
+public:
+	GDScript *root;
+	const uint8_t *data;
+	uint32_t pos;
+	uint32_t end;
+	bool failed;
+	String error;
+	std::vector<String> strings;
+	std::vector<StringName> names; // made from strings when first needed
+	std::vector<bool> names_made;
+	std::vector<GDScript *> classes; // in the order of the file, StringName keys don't sort the same in every run
+
+	void fail(const String &p_error) {
+		if (!failed) {
+			failed = true;
+			error = p_error;
+		}
+	}
+
+	uint32_t get_32() {
+		if (pos + 4 > end) {
+			fail("Truncated file");
+			return 0;
+		}
+		uint32_t value = decode_uint32(data + pos);
+		pos += 4;
+		return value;
+	}
+
+	uint64_t get_64() {
+		if (pos + 8 > end) {
+			fail("Truncated file");
+			return 0;
+		}
+		uint64_t value = decode_uint64(data + pos);
+		pos += 8;
+		return value;
+	}
+
+	// Returns NULL if the buffer doesn't fit.
+	const uint8_t *get_buffer(uint32_t &r_len) {
+		r_len = get_32();
+		uint32_t padded = (r_len + 3) & ~3;
+		if (failed || padded < r_len || padded > end - pos) {
+			fail("Truncated file");
+			return NULL;
+		}
+		const uint8_t *buffer = data + pos;
+		pos += padded;
+		return buffer;
+	}
+
+	String get_raw_string() {
+		uint32_t len;
+		const uint8_t *buffer = get_buffer(len);
+		String string;
+		if (buffer) {
+			string.parse_utf8((const char *)buffer, len);
+		}
+		return string;
+	}
+
+	String get_string() {
+		uint32_t index = get_32();
+		if (index >= strings.size()) {
+			fail("Bad string index");
+			return String();
+		}
+		return strings[index];
+	}
+
+	StringName get_name() {
+		uint32_t index = get_32();
+		if (index >= strings.size()) {
+			fail("Bad string index");
+			return StringName();
+		}
+		if (!names_made[index]) {
+			names[index] = strings[index];
+			names_made[index] = true;
+		}
+		return names[index];
+	}
+
+	// Number of entries that follow, each at least p_min_size bytes.
+	uint32_t get_count(uint32_t p_min_size = 4) {
+		uint32_t count = get_32();
+		if (count > (end - pos) / p_min_size) {
+			fail("Bad count");
+			return 0;
+		}
+		return count;
+	}
+
+	Variant get_object(uint32_t p_tag);
+	Variant get_variant();
+	void get_data_type(GDScriptDataType &r_type);
+	void get_property(PropertyInfo &r_property);
+	void get_class_tree(GDScript *p_script);
+	void get_class(GDScript *p_script);
+	void get_function(GDScript *p_script, GDScriptFunction *p_function);
+
+	Reader() :
+			root(NULL),
+			data(NULL),
+			pos(0),
+			end(0),
+			failed(false) {}
+};
+
+Variant GDScriptCache::Reader::get_object(uint32_t p_tag) {
+
+	switch (p_tag) {
+		case CACHE_VALUE_NULL_OBJECT: {
+			return Variant((Object *)NULL);
+		} break;
+		case CACHE_VALUE_NATIVE_CLASS: {
+			StringName name = get_name();
+			GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+			const Map<StringName, int>::Element *E = language->get_global_map().find(name);
+			if (!E || !Object::cast_to<GDScriptNativeClass>(language->get_global_array()[E->get()].operator Object *())) {
+				fail("Unknown native class '" + String(name) + "'");
+				return Variant();
+			}
+			return language->get_global_array()[E->get()];
+		} break;
+		case CACHE_VALUE_SCRIPT: {
+			String path = get_string();
+			Ref<GDScript> script;
+			if (path.empty()) {
+				script = Ref<GDScript>(root);
+			} else if (!failed) {
+				if (GDScriptPreloader::can_load(path)) {
+					script = ResourceLoader::load(path);
+				}
+				if (script.is_null()) {
+					fail("Can't load script '" + path + "'");
+				}
+			}
+			uint32_t name_count = get_count();
+			for (uint32_t i = 0; i < name_count && !failed; i++) {
+				StringName name = get_name();
+				Map<StringName, Ref<GDScript> >::Element *E = script->subclasses.find(name);
+				if (!E) {
+					fail("Unknown class '" + String(name) + "' in '" + path + "'");
+					break;
+				}
+				script = E->get();
+			}
+			if (failed) {
+				return Variant();
+			}
+			return script;
+		} break;
+		case CACHE_VALUE_RESOURCE: {
+			String path = get_string();
+			if (failed) {
+				return Variant();
+			}
+			RES resource;
+			if (GDScriptPreloader::can_load(path)) {
+				resource = ResourceLoader::load(path);
+			}
+			if (resource.is_null()) {
+				fail("Can't load resource '" + path + "'");
+			}
+			return resource;
+		} break;
+	}
+
+	fail("Bad object");
+	return Variant();
+}
+
+Variant GDScriptCache::Reader::get_variant() {
+
+	uint32_t tag = get_32();
+	switch (tag) {
+		case CACHE_VALUE_VARIANT: {
+			uint32_t len;
+			const uint8_t *buffer = get_buffer(len);
+			Variant value;
+			if (buffer && decode_variant(value, buffer, len) != OK) {
+				fail("Bad variant");
+			}
+			return value;
+		} break;
+		case CACHE_VALUE_ARRAY: {
+			Array array;
+			array.resize(get_count());
+			for (int i = 0; i < array.size() && !failed; i++) {
+				array[i] = get_variant();
+			}
+			return array;
+		} break;
+		case CACHE_VALUE_DICTIONARY: {
+			Dictionary dictionary;
+			uint32_t count = get_count(8);
+			for (uint32_t i = 0; i < count && !failed; i++) {
+				Variant key = get_variant();
+				dictionary[key] = get_variant();
+			}
+			return dictionary;
+		} break;
+	}
+
+	return get_object(tag);
+}
+
+void GDScriptCache::Reader::get_data_type(GDScriptDataType &r_type) {
+
+	r_type.has_type = get_32();
+	uint32_t kind = get_32();
+	uint32_t builtin_type = get_32();
+	if (kind > GDScriptDataType::GDSCRIPT || builtin_type >= Variant::VARIANT_MAX) {
+		fail("Bad data type");
+		return;
+	}
+	r_type.kind = (decltype(r_type.kind))kind;
+	r_type.builtin_type = (Variant::Type)builtin_type;
+	r_type.native_type = get_name();
+	r_type.script_type = get_variant();
+}
+
+void GDScriptCache::Reader::get_property(PropertyInfo &r_property) {
+
+	r_property.type = (Variant::Type)get_32();
+	r_property.name = get_string();
+	r_property.class_name = get_name();
+	r_property.hint = (PropertyHint)get_32();
+	r_property.hint_string = get_string();
+	r_property.usage = get_32();
+}
+
+void GDScriptCache::Reader::get_class_tree(GDScript *p_script) {
+
+	// Same as GDScriptCompiler::_make_scripts(), so scripts can refer to their inner classes.
+	p_script->subclasses.clear();
+
+	uint32_t count = get_count();
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		StringName name = get_name();
+
+		Ref<GDScript> subclass;
+		subclass.instance();
+		subclass->_owner = p_script;
+		p_script->subclasses.insert(name, subclass);
+		classes.push_back(subclass.ptr());
+
+		get_class_tree(subclass.ptr());
+	}
+}
+
+void GDScriptCache::Reader::get_class(GDScript *p_script) {
+
+	// Same as GDScriptCompiler::_parse_class_level().
+	p_script->native = Ref<GDScriptNativeClass>();
+	p_script->base = Ref<GDScript>();
+	p_script->_base = NULL;
+	p_script->members.clear();
+	p_script->constants.clear();
+	for (Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+		memdelete(E->get());
+	}
+	p_script->member_functions.clear();
+	p_script->member_indices.clear();
+	p_script->member_info.clear();
+	p_script->_signals.clear();
+	p_script->initializer = NULL;
+#ifdef TOOLS_ENABLED
+	p_script->member_lines.clear();
+	p_script->member_default_values.clear();
+#endif
+
+	p_script->tool = get_32();
+	p_script->name = get_name();
+	p_script->native = get_variant();
+	p_script->base = get_variant();
+	p_script->_base = p_script->base.ptr();
+
+	uint32_t count = get_count();
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		p_script->members.insert(get_name());
+	}
+
+	count = get_count();
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		StringName name = get_name();
+		GDScript::MemberInfo minfo;
+		minfo.index = get_32();
+		minfo.setter = get_name();
+		minfo.getter = get_name();
+		minfo.rpc_mode = (MultiplayerAPI::RPCMode)get_32();
+		get_data_type(minfo.data_type);
+		p_script->member_indices[name] = minfo;
+	}
+
+	count = get_count();
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		StringName name = get_name();
+		get_property(p_script->member_info[name]);
+	}
+
+	count = get_count();
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		StringName name = get_name();
+		p_script->constants[name] = get_variant();
+	}
+
+	count = get_count();
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		std::vector<StringName> &arguments = p_script->_signals[get_name()];
+		arguments.resize(get_count());
+		for (size_t j = 0; j < arguments.size(); j++) {
+			arguments[j] = get_name();
+		}
+	}
+
+#ifdef TOOLS_ENABLED
+	count = get_count();
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		StringName name = get_name();
+		p_script->member_lines[name] = get_32();
+	}
+
+	count = get_count();
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		StringName name = get_name();
+		p_script->member_default_values[name] = get_variant();
+	}
+#endif
+
+	count = get_count();
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		StringName name = get_name();
+		GDScriptFunction *function = memnew(GDScriptFunction);
+		p_script->member_functions[name] = function;
+		get_function(p_script, function);
+	}
+
+	const Map<StringName, GDScriptFunction *>::Element *initializer = p_script->member_functions.find(GDScriptLanguage::get_singleton()->strings._init);
+	if (!initializer) {
+		fail("Missing initializer");
+		return;
+	}
+	p_script->initializer = initializer->get();
+
+	p_script->valid = !failed;
+}
+
+void GDScriptCache::Reader::get_function(GDScript *p_script, GDScriptFunction *p_function) {
+
+	// Same as GDScriptCompiler::_parse_function().
+	p_function->name = get_name();
+	p_function->_static = get_32();
+	p_function->rpc_mode = (MultiplayerAPI::RPCMode)get_32();
+
+	p_function->argument_types.resize(get_count());
+	for (size_t i = 0; i < p_function->argument_types.size(); i++) {
+		get_data_type(p_function->argument_types[i]);
+	}
+	get_data_type(p_function->return_type);
+
+#ifdef TOOLS_ENABLED
+	p_function->arg_names.resize(get_count());
+	for (size_t i = 0; i < p_function->arg_names.size(); i++) {
+		p_function->arg_names[i] = get_name();
+	}
+#endif
+
+	p_function->constants.resize(get_count());
+	for (size_t i = 0; i < p_function->constants.size() && !failed; i++) {
+		p_function->constants[i] = get_variant();
+	}
+	p_function->_constant_count = p_function->constants.size();
+	p_function->_constants_ptr = p_function->_constant_count ? p_function->constants.data() : NULL;
+
+	p_function->global_names.resize(get_count());
+	for (size_t i = 0; i < p_function->global_names.size(); i++) {
+		p_function->global_names[i] = get_name();
+	}
+	p_function->_global_names_count = p_function->global_names.size();
+	p_function->_global_names_ptr = p_function->_global_names_count ? p_function->global_names.data() : NULL;
+
+#ifdef TOOLS_ENABLED
+	p_function->named_globals.resize(get_count());
+	for (size_t i = 0; i < p_function->named_globals.size(); i++) {
+		p_function->named_globals[i] = get_name();
+	}
+	p_function->_named_globals_count = p_function->named_globals.size();
+	p_function->_named_globals_ptr = p_function->_named_globals_count ? p_function->named_globals.data() : NULL;
+#endif
+
+	p_function->default_arguments.resize(get_count());
+	for (size_t i = 0; i < p_function->default_arguments.size(); i++) {
+		p_function->default_arguments[i] = get_32();
+	}
+	p_function->_default_arg_count = p_function->default_arguments.size() ? p_function->default_arguments.size() - 1 : 0;
+	p_function->_default_arg_ptr = p_function->default_arguments.size() ? p_function->default_arguments.data() : NULL;
+
+	uint32_t code_size = get_count();
+	if (!failed) {
+		p_function->code.resize(code_size);
+		if (code_size) {
+			memcpy(p_function->code.data(), data + pos, code_size * 4);
+		}
+		pos += code_size * 4;
+	}
+#ifdef BIG_ENDIAN_ENABLED
+	for (size_t i = 0; i < p_function->code.size(); i++) {
+		p_function->code[i] = decode_uint32((const uint8_t *)&p_function->code[i]);
+	}
+#endif
+	p_function->_code_size = p_function->code.size();
+	p_function->_code_ptr = p_function->_code_size ? p_function->code.data() : NULL;
+
+	p_function->_argument_count = get_32();
+	p_function->_stack_size = get_32();
+	p_function->_call_size = get_32();
+	p_function->_inline_cache_count = get_32();
+	p_function->_initial_line = get_32();
+	if (failed) {
+		p_function->_inline_cache_count = 0;
+	} else if (p_function->_inline_cache_count) {
+		p_function->_inline_caches = memnew_arr(GDScriptFunction::InlineCache, p_function->_inline_cache_count);
+	}
+
+	uint32_t count = get_count(16);
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		GDScriptFunction::StackDebug sd;
+		sd.line = get_32();
+		sd.pos = get_32();
+		sd.added = get_32();
+		sd.identifier = get_name();
+		p_function->stack_debug.push_back(sd);
+	}
+
+	p_function->_script = p_script;
+	p_function->source = root->get_path();
+
+#ifdef DEBUG_ENABLED
+	p_function->func_cname = (String(p_function->source) + " - " + String(p_function->name)).utf8();
+	p_function->_func_cname = p_function->func_cname.get_data();
+#endif
+}
+
+/* CACHE */
+
+uint64_t GDScriptCache::_get_source_stamp(const std::vector<uint8_t> &p_source_hash) {
+
+	uint64_t stamp = 5381;
+	for (size_t i = 0; i < p_source_hash.size(); i++) {
+		stamp = hash_djb2_one_64(p_source_hash[i], stamp);
+	}
+	return stamp;
+}
+
+uint64_t GDScriptCache::_add_dependency_stamp(uint64_t p_stamp, const String &p_path, uint64_t p_dependency_stamp) {
+
+	uint64_t stamp = hash_djb2_one_64(p_dependency_stamp, hash_djb2_one_64(p_path.hash64(), p_stamp));
+	return stamp ? stamp : 1;
+}
+
+bool GDScriptCache::_get_dependency_stamp(const String &p_path, uint64_t &r_stamp) {
+
+	if (!GDScriptPreloader::can_load(p_path)) {
+		return false;
+	}
+
+	RES resource = ResourceLoader::load(p_path);
+	if (resource.is_null()) {
+		return false;
+	}
+
+	Ref<GDScript> script = resource;
+	if (script.is_valid()) {
+		r_stamp = script->compile_stamp;
+		return r_stamp != 0;
+	}
+
+	r_stamp = FileAccess::get_modified_time(p_path);
+	return true;
+}
+
+String GDScriptCache::get_cache_file(const String &p_script_path) {
+
+	return GDScriptLanguage::get_singleton()->get_bytecode_cache_path().plus_file(p_script_path.md5_text() + ".gdcc");
+}
+
+Error GDScriptCache::load(GDScript *p_script, const std::vector<uint8_t> &p_source_hash) {
+
+	String cache_file = get_cache_file(p_script->get_path());
+	if (!FileAccess::exists(cache_file)) {
+		return ERR_FILE_NOT_FOUND;
+	}
+
+	// Read in one go, then decoded in place.
+	std::vector<uint8_t> file = FileAccess::get_file_as_array(cache_file);
+
+	Reader reader;
+	reader.root = p_script;
+	reader.data = file.data();
+	reader.end = file.size();
+
+	if (reader.get_32() != 0x43434447 || reader.get_32() != FORMAT_VERSION || reader.get_32() != _get_cache_flags()) { // "GDCC"
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	uint32_t len;
+	const uint8_t *hash = reader.get_buffer(len);
+	if (reader.get_raw_string() != _get_engine_build() || !hash || len != p_source_hash.size() || memcmp(hash, p_source_hash.data(), len) != 0) {
+		return ERR_FILE_MISSING_DEPENDENCIES;
+	}
+	if (reader.get_32() != GDScriptLanguage::get_singleton()->get_global_map_hash()) {
+		return ERR_FILE_MISSING_DEPENDENCIES;
+	}
+
+	uint64_t compile_stamp = _get_source_stamp(p_source_hash);
+	uint32_t count = reader.get_count(12);
+	for (uint32_t i = 0; i < count && !reader.failed; i++) {
+		String path = reader.get_raw_string();
+		uint64_t stamp;
+		if (reader.failed || !_get_dependency_stamp(path, stamp) || reader.get_64() != stamp) {
+			return ERR_FILE_MISSING_DEPENDENCIES;
+		}
+		compile_stamp = _add_dependency_stamp(compile_stamp, path, stamp);
+	}
+
+	uint32_t strings_offset = reader.get_32();
+	uint32_t strings_size = reader.get_32();
+	uint32_t classes_offset = reader.get_32();
+	uint32_t classes_size = reader.get_32();
+	if (reader.failed || strings_offset > file.size() || strings_size > file.size() - strings_offset || classes_offset > file.size() || classes_size > file.size() - classes_offset) {
+		return ERR_FILE_CORRUPT;
+	}
+
+	reader.pos = strings_offset;
+	reader.end = strings_offset + strings_size;
+	reader.strings.resize(reader.get_count());
+	for (size_t i = 0; i < reader.strings.size(); i++) {
+		reader.strings[i] = reader.get_raw_string();
+	}
+	reader.names.resize(reader.strings.size());
+	reader.names_made.resize(reader.strings.size());
+
+	reader.pos = classes_offset;
+	reader.end = classes_offset + classes_size;
+	reader.classes.push_back(p_script);
+	reader.get_class_tree(p_script);
+	p_script->_owner = NULL;
+	for (size_t i = 0; i < reader.classes.size() && !reader.failed; i++) {
+		reader.get_class(reader.classes[i]);
+	}
+	// Functions and members were replaced, also when reading failed halfway. This covers
+	// both GDScript::reload() and GDScript::load_byte_code(), whatever they do next.
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
+
+	if (reader.failed) {
+		print_verbose("GDScript: Ignoring cached '" + p_script->get_path() + "': " + reader.error + ".");
+		return ERR_FILE_CORRUPT;
+	}
+
+	p_script->compile_stamp = compile_stamp;
+	return OK;
+}
+
+Error GDScriptCache::save(GDScript *p_script, const std::vector<uint8_t> &p_source_hash, const Set<String> &p_dependencies) {
+
+	uint64_t compile_stamp = _get_source_stamp(p_source_hash);
+	std::vector<uint64_t> stamps;
+	for (const Set<String>::Element *E = p_dependencies.front(); E; E = E->next()) {
+		uint64_t stamp;
+		if (!_get_dependency_stamp(E->get(), stamp)) {
+			// E.g. with cyclic references, where the dependency is still being compiled.
+			print_verbose("GDScript: Not caching '" + p_script->get_path() + "': Depends on '" + E->get() + "' which isn't cached.");
+			return ERR_UNAVAILABLE;
+		}
+		stamps.push_back(stamp);
+		compile_stamp = _add_dependency_stamp(compile_stamp, E->get(), stamp);
+	}
+	p_script->compile_stamp = compile_stamp;
+
+	Writer writer;
+	writer.root = p_script;
+	writer.put_class_tree(p_script);
+	writer.put_class(p_script);
+	if (!writer.error.empty()) {
+		print_verbose("GDScript: Not caching '" + p_script->get_path() + "': " + writer.error + ".");
+		return ERR_UNAVAILABLE;
+	}
+	std::vector<uint8_t> classes;
+	classes.swap(writer.data);
+
+	writer.put_32(writer.strings.size());
+	for (size_t i = 0; i < writer.strings.size(); i++) {
+		writer.put_raw_string(writer.strings[i]);
+	}
+	std::vector<uint8_t> strings;
+	strings.swap(writer.data);
+
+	writer.put_32(0x43434447); // "GDCC"
+	writer.put_32(FORMAT_VERSION);
+	writer.put_32(_get_cache_flags());
+	writer.put_buffer(p_source_hash.data(), p_source_hash.size());
+	writer.put_raw_string(_get_engine_build());
+	writer.put_32(GDScriptLanguage::get_singleton()->get_global_map_hash());
+
+	writer.put_32(p_dependencies.size());
+	int index = 0;
+	for (const Set<String>::Element *E = p_dependencies.front(); E; E = E->next()) {
+		writer.put_raw_string(E->get());
+		writer.put_64(stamps[index++]);
+	}
+
+	uint32_t strings_offset = writer.data.size() + 16;
+	writer.put_32(strings_offset);
+	writer.put_32(strings.size());
+	writer.put_32(strings_offset + strings.size());
+	writer.put_32(classes.size());
+
+	String cache_file = get_cache_file(p_script->get_path());
+	String cache_dir = cache_file.get_base_dir();
+
+	DirAccess *da = DirAccess::create_for_path(cache_dir);
+	ERR_FAIL_COND_V(!da, ERR_CANT_CREATE);
+	if (!da->dir_exists(cache_dir)) {
+		da->make_dir_recursive(cache_dir);
+	}
+
+	// Written aside and renamed, so another instance running the project never reads half a file.
+	String temp_file = cache_file + ".tmp";
+	Error err;
+	FileAccess *f = FileAccess::open(temp_file, FileAccess::WRITE, &err);
+	if (!f) {
+		memdelete(da);
+		ERR_FAIL_V_MSG(err, "Cannot write the compiled script cache file '" + temp_file + "'.");
+	}
+	f->store_buffer(writer.data.data(), writer.data.size());
+	f->store_buffer(strings.data(), strings.size());
+	f->store_buffer(classes.data(), classes.size());
+	f->close();
+	memdelete(f);
+
+	if (da->file_exists(cache_file)) {
+		da->remove(cache_file);
+	}
+	err = da->rename(temp_file, cache_file);
+	memdelete(da);
+	return err;
+}
@@ -0,0 +1,85 @@
+/*************************************************************************/
+/*  gdscript_cache.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_CACHE_H
+#define GDSCRIPT_CACHE_H
+
+#include "core/set.h"
+#include "core/ustring.h"
+
+#include <vector>
+
+class GDScript;
+
+// On-disk cache of compiled scripts: bytecode, constants and member layouts, so scripts whose
+// source didn't change can skip the parser and compiler on the next run.
+//
+// A cache file is only used when everything the bytecode depends on matches: the source hash,
+// the engine build and cache format, the GDScript global table (its indices are baked into the
+// bytecode), and every resource the script was compiled against. Scripts are compared by their
+// compile stamp, a hash of their source and of their own dependencies, as their constants may
+// have been folded into the code. Other resources are compared by modification time.
+//
+// Layout, all integers little endian and every section 4-byte aligned so code arrays could
+// be used in place once files are mapped instead of read:
+//
+//   header     magic, format version, build flags, source hash, engine build, globals hash
+//   depends    count, then (path, stamp) pairs
+//   sections   offsets and sizes of the string table and the class data, from the file start
+//   strings    count, then (length, utf-8 bytes) entries, referenced by index everywhere else
+//   classes    the class tree (names only), then each class in pre-order
+class GDScriptCache {
+	class Writer;
+	class Reader;
+
+	static uint64_t _get_source_stamp(const std::vector<uint8_t> &p_source_hash);
+	static uint64_t _add_dependency_stamp(uint64_t p_stamp, const String &p_path, uint64_t p_dependency_stamp);
+	static bool _get_dependency_stamp(const String &p_path, uint64_t &r_stamp);
+
+public:
+	enum {
+		FORMAT_VERSION = 1,
+	};
+
+	// Path of the cache file for the script at p_script_path.
+	static String get_cache_file(const String &p_script_path);
+
+	// Fill p_script (a root script that isn't compiled yet) from its cache file, if there's one
+	// matching p_source_hash. Anything else (no file, stale file, a dependency fails to load)
+	// returns an error and the script must be compiled as usual.
+	static Error load(GDScript *p_script, const std::vector<uint8_t> &p_source_hash);
+
+	// Stamp the freshly compiled p_script and write its cache file. p_dependencies are the paths
+	// the parser loaded. Scripts referencing objects that can't be found again on load (e.g.
+	// built-in resources) return ERR_UNAVAILABLE.
+	static Error save(GDScript *p_script, const std::vector<uint8_t> &p_source_hash, const Set<String> &p_dependencies);
+};
+
+#endif // GDSCRIPT_CACHE_H
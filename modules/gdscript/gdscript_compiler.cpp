@@ -31,6 +31,8 @@
 #include "gdscript_compiler.h"
 
 #include "gdscript.h"
+#include "gdscript_preloader.h"
+#include "gdscript_typed_ops.h"
 
 bool GDScriptCompiler::_is_class_member_property(CodeGen &codegen, const StringName &p_name) {
 
@@ -74,6 +76,38 @@ void GDScriptCompiler::_set_error(const String &p_error, const GDScriptParser::N
 	}
 }
 
+// The typed instructions are only emitted when the parser knows the builtin types involved.
+static bool _get_typed_builtin(const GDScriptParser::Node *p_node, Variant::Type &r_type) {
+
+	if (!GDScriptLanguage::get_singleton()->is_typed_instructions_enabled())
+		return false;
+
+	GDScriptParser::DataType datatype = p_node->get_datatype();
+	if (!datatype.has_type || datatype.is_meta_type || datatype.kind != GDScriptParser::DataType::BUILTIN)
+		return false;
+
+	r_type = datatype.builtin_type;
+	return true;
+}
+
+static int _get_typed_operator(Variant::Operator p_op, const GDScriptParser::Node *p_a, const GDScriptParser::Node *p_b) {
+
+	Variant::Type type_a, type_b;
+	if (!_get_typed_builtin(p_a, type_a) || !_get_typed_builtin(p_b, type_b))
+		return -1;
+
+	return GDScriptTypedOps::find_operator(p_op, type_a, type_b);
+}
+
+static int _get_typed_member(const GDScriptParser::Node *p_base, const StringName &p_name) {
+
+	Variant::Type type;
+	if (!_get_typed_builtin(p_base, type))
+		return -1;
+
+	return GDScriptTypedOps::find_member(type, p_name);
+}
+
 bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level) {
 
 	ERR_FAIL_COND_V(on->arguments.size() != 1, false);
@@ -82,8 +116,14 @@ bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptPa
 	if (src_address_a < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
-	codegen.opcodes.push_back(op); //which operator
+	int typed_op = _get_typed_operator(op, on->arguments[0], on->arguments[0]);
+	if (typed_op >= 0) {
+		codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR_TYPED); // perform operator
+		codegen.opcodes.push_back(typed_op); //which typed operator
+	} else {
+		codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+		codegen.opcodes.push_back(op); //which operator
+	}
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_a); // argument 2 (repeated)
 	//codegen.opcodes.push_back(GDScriptFunction::ADDR_TYPE_NIL); // argument 2 (unary only takes one parameter)
@@ -104,8 +144,14 @@ bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptP
 	if (src_address_b < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
-	codegen.opcodes.push_back(op); //which operator
+	int typed_op = _get_typed_operator(op, on->arguments[0], on->arguments[1]);
+	if (typed_op >= 0) {
+		codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR_TYPED); // perform operator
+		codegen.opcodes.push_back(typed_op); //which typed operator
+	} else {
+		codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+		codegen.opcodes.push_back(op); //which operator
+	}
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
 	return true;
@@ -325,7 +371,11 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 					return -1;
 				}
 
-				RES res = ResourceLoader::load(ScriptServer::get_global_class_path(identifier));
+				String path = ScriptServer::get_global_class_path(identifier);
+				RES res;
+				if (GDScriptPreloader::can_load(path)) {
+					res = ResourceLoader::load(path);
+				}
 				if (res.is_null()) {
 					_set_error("Can't load global class " + String(identifier) + ", cyclic reference?", p_expression);
 					return -1;
@@ -670,11 +720,33 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							arguments.push_back(ret);
 						}
 
-						codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL : GDScriptFunction::OPCODE_CALL_RETURN); // perform operator
-						codegen.opcodes.push_back(on->arguments.size() - 2);
-						codegen.alloc_call(on->arguments.size() - 2);
-						for (auto &&arg : arguments)
-							codegen.opcodes.push_back(arg);
+						Variant::Type base_type = Variant::NIL;
+						int method = -1;
+						if (instance->type != GDScriptParser::Node::TYPE_SELF && _get_typed_builtin(instance, base_type) && base_type != Variant::NIL && base_type != Variant::OBJECT) {
+							method = Variant::get_method_index(base_type, static_cast<const GDScriptParser::IdentifierNode *>(on->arguments[1])->name);
+						}
+
+						if (method >= 0) {
+							//method of a builtin type known at compile time, call it by index
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_CALL_TYPED);
+							codegen.opcodes.push_back(on->arguments.size() - 2);
+							codegen.alloc_call(on->arguments.size() - 2);
+							codegen.opcodes.push_back(arguments[0]); // base
+							codegen.opcodes.push_back(arguments[1]); // method name
+							codegen.opcodes.push_back(base_type);
+							codegen.opcodes.push_back(method);
+							for (decltype(len) i = 2; i < len; ++i)
+								codegen.opcodes.push_back(arguments[i]);
+						} else {
+							codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL : GDScriptFunction::OPCODE_CALL_RETURN); // perform operator
+							codegen.opcodes.push_back(on->arguments.size() - 2);
+							codegen.alloc_call(on->arguments.size() - 2);
+							codegen.opcodes.push_back(arguments[0]); // base
+							codegen.opcodes.push_back(arguments[1]); // method name
+							codegen.opcodes.push_back(codegen.alloc_inline_cache());
+							for (decltype(len) i = 2; i < len; ++i)
+								codegen.opcodes.push_back(arguments[i]);
+						}
 					}
 				} break;
 				case GDScriptParser::OperatorNode::OP_YIELD: {
@@ -720,6 +792,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						return from;
 
 					int index;
+					int member = -1;
 					if (named) {
 						if (on->arguments[0]->type == GDScriptParser::Node::TYPE_SELF && codegen.script && codegen.function_node && !codegen.function_node->_static) {
 
@@ -740,7 +813,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							}
 						}
 
-						index = codegen.get_name_map_pos(static_cast<GDScriptParser::IdentifierNode *>(on->arguments[1])->name);
+						StringName name = static_cast<GDScriptParser::IdentifierNode *>(on->arguments[1])->name;
+						index = codegen.get_name_map_pos(name);
+						member = _get_typed_member(on->arguments[0], name);
 
 					} else {
 
@@ -748,6 +823,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							//also, somehow, named (speed up anyway)
 							StringName name = static_cast<const GDScriptParser::ConstantNode *>(on->arguments[1])->value;
 							index = codegen.get_name_map_pos(name);
+							member = _get_typed_member(on->arguments[0], name);
 							named = true;
 
 						} else {
@@ -763,9 +839,18 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						}
 					}
 
-					codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
-					codegen.opcodes.push_back(from); // argument 1
-					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
+					if (member >= 0) {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_NAMED_TYPED); // perform operator
+						codegen.opcodes.push_back(from); // argument 1
+						codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
+						codegen.opcodes.push_back(member); // typed member
+					} else {
+						codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
+						codegen.opcodes.push_back(from); // argument 1
+						codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
+						if (named)
+							codegen.opcodes.push_back(codegen.alloc_inline_cache());
+					}
 
 				} break;
 				case GDScriptParser::OperatorNode::OP_AND: {
@@ -1042,10 +1127,13 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 
 							bool named = E->get()->op == GDScriptParser::OperatorNode::OP_INDEX_NAMED;
 							int key_idx;
+							int member = -1;
 
 							if (named) {
 
-								key_idx = codegen.get_name_map_pos(static_cast<const GDScriptParser::IdentifierNode *>(E->get()->arguments[1])->name);
+								StringName name = static_cast<const GDScriptParser::IdentifierNode *>(E->get()->arguments[1])->name;
+								key_idx = codegen.get_name_map_pos(name);
+								member = _get_typed_member(E->get()->arguments[0], name);
 								//printf("named key %x\n",key_idx);
 
 							} else {
@@ -1065,9 +1153,18 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							if (key_idx < 0) //error
 								return key_idx;
 
-							codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET);
-							codegen.opcodes.push_back(prev_pos);
-							codegen.opcodes.push_back(key_idx);
+							if (member >= 0) {
+								codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_NAMED_TYPED);
+								codegen.opcodes.push_back(prev_pos);
+								codegen.opcodes.push_back(key_idx);
+								codegen.opcodes.push_back(member);
+							} else {
+								codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET);
+								codegen.opcodes.push_back(prev_pos);
+								codegen.opcodes.push_back(key_idx);
+								if (named)
+									codegen.opcodes.push_back(codegen.alloc_inline_cache());
+							}
 							++slevel;
 							codegen.alloc_stack(slevel);
 							int dst_pos = (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS) | slevel;
@@ -1076,10 +1173,20 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 
 							//add in reverse order, since it will be reverted
 
-							setchain.push_back(dst_pos);
-							setchain.push_back(key_idx);
-							setchain.push_back(prev_pos);
-							setchain.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+							if (member >= 0) {
+								setchain.push_back(member);
+								setchain.push_back(dst_pos);
+								setchain.push_back(key_idx);
+								setchain.push_back(prev_pos);
+								setchain.push_back(GDScriptFunction::OPCODE_SET_NAMED_TYPED);
+							} else {
+								if (named)
+									setchain.push_back(codegen.alloc_inline_cache());
+								setchain.push_back(dst_pos);
+								setchain.push_back(key_idx);
+								setchain.push_back(prev_pos);
+								setchain.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+							}
 
 							prev_pos = dst_pos;
 						}
@@ -1088,10 +1195,13 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 
 						int set_index;
 						bool named = false;
+						int set_member = -1;
 
 						if (op->op == GDScriptParser::OperatorNode::OP_INDEX_NAMED) {
 
-							set_index = codegen.get_name_map_pos(static_cast<const GDScriptParser::IdentifierNode *>(op->arguments[1])->name);
+							StringName name = static_cast<const GDScriptParser::IdentifierNode *>(op->arguments[1])->name;
+							set_index = codegen.get_name_map_pos(name);
+							set_member = _get_typed_member(op->arguments[0], name);
 							named = true;
 						} else {
 
@@ -1111,10 +1221,20 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						if (set_value < 0) //error
 							return set_value;
 
-						codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
-						codegen.opcodes.push_back(prev_pos);
-						codegen.opcodes.push_back(set_index);
-						codegen.opcodes.push_back(set_value);
+						if (set_member >= 0) {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET_NAMED_TYPED);
+							codegen.opcodes.push_back(prev_pos);
+							codegen.opcodes.push_back(set_index);
+							codegen.opcodes.push_back(set_value);
+							codegen.opcodes.push_back(set_member);
+						} else {
+							codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+							codegen.opcodes.push_back(prev_pos);
+							codegen.opcodes.push_back(set_index);
+							codegen.opcodes.push_back(set_value);
+							if (named)
+								codegen.opcodes.push_back(codegen.alloc_inline_cache());
+						}
 
 						for (auto &&s : setchain) {
 
@@ -1592,6 +1712,7 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	codegen.stack_max = 0;
 	codegen.current_line = 0;
 	codegen.call_max = 0;
+	codegen.inline_cache_count = 0;
 	codegen.debug_stack = ScriptDebugger::get_singleton() != NULL;
 	std::vector<StringName> argnames;
 
@@ -1778,6 +1899,10 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	gdfunc->_argument_count = p_func ? p_func->arguments.size() : 0;
 	gdfunc->_stack_size = codegen.stack_max;
 	gdfunc->_call_size = codegen.call_max;
+	gdfunc->_inline_cache_count = codegen.inline_cache_count;
+	if (codegen.inline_cache_count) {
+		gdfunc->_inline_caches = memnew_arr(GDScriptFunction::InlineCache, codegen.inline_cache_count);
+	}
 	gdfunc->name = func_name;
 #ifdef DEBUG_ENABLED
 	if (ScriptDebugger::get_singleton()) {
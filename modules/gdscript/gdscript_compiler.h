@@ -130,10 +130,14 @@ class GDScriptCompiler {
 		void alloc_call(int p_params) {
 			if (p_params >= call_max) call_max = p_params;
 		}
+		int alloc_inline_cache() {
+			return inline_cache_count++;
+		}
 
 		int current_line;
 		int stack_max;
 		int call_max;
+		int inline_cache_count;
 	};
 
 	bool _is_class_member_property(CodeGen &codegen, const StringName &p_name);
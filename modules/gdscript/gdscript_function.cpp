@@ -30,9 +30,14 @@
 
 #include "gdscript_function.h"
 
+#include "core/class_db.h"
+#include "core/core_string_names.h"
+#include "core/engine.h"
 #include "core/os/os.h"
+#include "core/variant_internal.h"
 #include "gdscript.h"
 #include "gdscript_functions.h"
+#include "gdscript_typed_ops.h"
 
 Variant *GDScriptFunction::_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const {
 
@@ -159,6 +164,468 @@ static String _get_var_type(const Variant *p_var) {
 }
 #endif // DEBUG_ENABLED
 
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+
+// Types a Variant stores exactly the way ptrcall() passes them. Variant arguments
+// and returns (reported as NIL) are passed as the Variant itself.
+static _FORCE_INLINE_ bool _is_ptrcall_type(Variant::Type p_type) {
+
+	switch (p_type) {
+		case Variant::NIL:
+		case Variant::BOOL:
+		case Variant::INT:
+		case Variant::REAL:
+		case Variant::STRING:
+		case Variant::VECTOR2:
+		case Variant::RECT2:
+		case Variant::VECTOR3:
+		case Variant::COLOR:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool _is_ptrcall_compatible(const MethodBind *p_method) {
+
+	if (p_method->is_vararg())
+		return false;
+
+	for (int i = 0; i < p_method->get_argument_count(); i++) {
+		if (!_is_ptrcall_type(p_method->get_argument_type(i)))
+			return false;
+	}
+
+	if (p_method->has_return()) {
+		Variant::Type type = p_method->get_argument_type(-1);
+		if (!_is_ptrcall_type(type))
+			return false;
+		// Enums are returned as int, not int64_t, and carry no metadata to tell them apart.
+		if (type == Variant::INT && p_method->get_argument_meta(-1) == GodotTypeInfo::METADATA_NONE)
+			return false;
+	}
+
+	return true;
+}
+
+static _FORCE_INLINE_ const void *_get_ptrcall_argument(const Variant *p_arg) {
+
+	switch (p_arg->get_type()) {
+		case Variant::BOOL: return VariantInternal::get_bool(p_arg);
+		case Variant::INT: return VariantInternal::get_int(p_arg);
+		case Variant::REAL: return VariantInternal::get_real(p_arg);
+		case Variant::STRING: return VariantInternal::get_string(p_arg);
+		case Variant::VECTOR2: return VariantInternal::get_vector2(p_arg);
+		case Variant::RECT2: return VariantInternal::get_rect2(p_arg);
+		case Variant::VECTOR3: return VariantInternal::get_vector3(p_arg);
+		case Variant::COLOR: return VariantInternal::get_color(p_arg);
+		default: return p_arg;
+	}
+}
+
+// Calls a method accepted by _is_ptrcall_compatible() without converting the
+// arguments, returns false if they don't match its signature exactly.
+static bool _ptrcall(MethodBind *p_method, Object *p_object, const Variant **p_args, int p_argcount, Variant *r_ret) {
+
+	if (p_argcount != p_method->get_argument_count())
+		return false;
+
+	const void **args = (const void **)alloca(sizeof(void *) * (p_argcount + 1));
+	for (int i = 0; i < p_argcount; i++) {
+		Variant::Type type = p_method->get_argument_type(i);
+		if (type == Variant::NIL) {
+			args[i] = p_args[i];
+		} else if (p_args[i]->get_type() == type) {
+			args[i] = _get_ptrcall_argument(p_args[i]);
+		} else {
+			return false;
+		}
+	}
+
+	// Not written in place, r_ret may be one of the arguments.
+	Variant ret;
+	void *ret_ptr = NULL;
+	if (p_method->has_return()) {
+		Variant::Type type = p_method->get_argument_type(-1);
+		switch (type) {
+			case Variant::NIL: {
+				ret_ptr = &ret;
+			} break;
+			case Variant::STRING: {
+				ret = String();
+				ret_ptr = VariantInternal::get_string(&ret);
+			} break;
+			default: {
+				VariantInternal::set_pod_type(&ret, type);
+				ret_ptr = (void *)_get_ptrcall_argument(&ret);
+			}
+		}
+	}
+
+	p_method->ptrcall(p_object, args, ret_ptr);
+
+	if (r_ret)
+		*r_ret = ret;
+	return true;
+}
+
+#endif
+
+bool GDScriptFunction::_inline_cache_find(int p_cache, const void *p_native_class, const void *p_script, InlineCacheTarget &r_target) {
+
+	uint32_t epoch = GDScriptLanguage::get_singleton()->get_inline_cache_epoch();
+	InlineCacheEntry *entries = _inline_caches[p_cache].entries;
+
+	for (int i = 0; i < INLINE_CACHE_SIZE; i++) {
+
+		InlineCacheEntry &entry = entries[i];
+		uint32_t sequence = entry.sequence.load(std::memory_order_acquire);
+		if (sequence == 0)
+			break; // entries are filled in order
+		if (sequence & 1)
+			continue;
+
+		if (entry.native_class.load(std::memory_order_relaxed) != p_native_class || entry.script.load(std::memory_order_relaxed) != p_script)
+			continue;
+		if (p_script && entry.epoch.load(std::memory_order_relaxed) != epoch)
+			continue;
+
+		r_target.kind = entry.kind.load(std::memory_order_relaxed);
+		r_target.target = entry.target.load(std::memory_order_relaxed);
+		r_target.index = entry.index.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (entry.sequence.load(std::memory_order_relaxed) == sequence)
+			return true;
+	}
+
+	return false;
+}
+
+void GDScriptFunction::_inline_cache_store(int p_cache, const void *p_native_class, const void *p_script, const InlineCacheTarget &p_target) {
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+	InlineCache &cache = _inline_caches[p_cache];
+
+	// Polymorphic sites would otherwise take the lock on every miss only to find no room.
+	if (cache.megamorphic_epoch.load(std::memory_order_relaxed) == language->get_inline_cache_epoch() + 1)
+		return;
+
+	if (language->lock) {
+		language->lock->lock();
+	}
+
+	uint32_t epoch = language->get_inline_cache_epoch();
+	InlineCacheEntry *entries = cache.entries;
+	InlineCacheEntry *free_entry = NULL;
+	bool found = false;
+
+	for (int i = 0; i < INLINE_CACHE_SIZE; i++) {
+
+		InlineCacheEntry &entry = entries[i];
+		if (entry.sequence.load(std::memory_order_relaxed) == 0) {
+			if (!free_entry)
+				free_entry = &entry;
+			break;
+		}
+
+		const void *script = entry.script.load(std::memory_order_relaxed);
+		if (script && entry.epoch.load(std::memory_order_relaxed) != epoch) {
+			if (!free_entry)
+				free_entry = &entry;
+			continue;
+		}
+
+		if (entry.native_class.load(std::memory_order_relaxed) == p_native_class && script == p_script) {
+			free_entry = NULL; // another thread got here first
+			found = true;
+			break;
+		}
+	}
+
+	if (!free_entry && !found) {
+		cache.megamorphic_epoch.store(epoch + 1, std::memory_order_relaxed);
+	}
+
+	if (free_entry) {
+		uint32_t sequence = free_entry->sequence.load(std::memory_order_relaxed);
+		free_entry->sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		free_entry->epoch.store(epoch, std::memory_order_relaxed);
+		free_entry->native_class.store(p_native_class, std::memory_order_relaxed);
+		free_entry->script.store(p_script, std::memory_order_relaxed);
+		free_entry->kind.store(p_target.kind, std::memory_order_relaxed);
+		free_entry->target.store(p_target.target, std::memory_order_relaxed);
+		free_entry->index.store(p_target.index, std::memory_order_relaxed);
+
+		free_entry->sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	if (language->lock) {
+		language->lock->unlock();
+	}
+}
+
+bool GDScriptFunction::_inline_cache_receiver(const Variant *p_base, Object *&r_object, GDScriptInstance *&r_instance) const {
+
+	if (p_base->get_type() != Variant::OBJECT)
+		return false;
+
+	Object *obj = *p_base;
+	if (!obj)
+		return false;
+#ifdef DEBUG_ENABLED
+	if (ScriptDebugger::get_singleton() && !p_base->is_ref() && !ObjectDB::instance_validate(obj))
+		return false; // let the generic path report the freed instance
+#endif
+
+	// Other languages and placeholders resolve names their own way.
+	ScriptInstance *instance = obj->get_script_instance();
+	if (instance && (instance->is_placeholder() || instance->get_language() != GDScriptLanguage::get_singleton()))
+		return false;
+
+	r_object = obj;
+	r_instance = static_cast<GDScriptInstance *>(instance);
+	return true;
+}
+
+void GDScriptFunction::_inline_cache_count_lookup(bool p_hit) {
+
+#ifdef DEBUG_ENABLED
+	if (!GDScriptLanguage::get_singleton()->profiling)
+		return;
+
+	if (p_hit) {
+		profile.cache_hits++;
+		profile.frame_cache_hits++;
+	} else {
+		profile.cache_misses++;
+		profile.frame_cache_misses++;
+	}
+#endif
+}
+
+// Finds what Object::get()/set() would end up using for p_name, as long as it's a
+// plain script member or a native property reachable without going through the script.
+bool GDScriptFunction::_inline_cache_resolve_property(Object *p_object, const GDScript *p_script, const StringName &p_name, bool p_get, InlineCacheTarget &r_target) const {
+
+	if (p_script) {
+
+		const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.find(p_name);
+		if (E) {
+			if (p_get ? E->get().getter != StringName() : E->get().setter != StringName())
+				return false;
+
+			r_target.kind = INLINE_CACHE_SCRIPT_MEMBER;
+			r_target.target = const_cast<GDScript::MemberInfo *>(&E->get());
+			r_target.index = E->get().index;
+			return true;
+		}
+
+		const StringName &handler = p_get ? GDScriptLanguage::get_singleton()->strings._get : GDScriptLanguage::get_singleton()->strings._set;
+		for (const GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+			if (p_get && sptr->constants.has(p_name))
+				return false;
+			if (sptr->member_functions.has(handler))
+				return false;
+		}
+	}
+
+	const ClassDB::PropertySetGet *psg = ClassDB::get_property_setget(p_object->get_class_name(), p_name, p_get);
+	if (!psg)
+		return false;
+
+	MethodBind *method = p_get ? psg->_getptr : psg->_setptr;
+	if (p_get && psg->index >= 0) {
+		// Indexed getters go through Object::call(), which would try the script first.
+		method = p_script ? NULL : ClassDB::get_method(p_object->get_class_name(), psg->getter);
+	}
+	if (!method)
+		return false;
+
+	r_target.kind = INLINE_CACHE_NATIVE_PROPERTY;
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+	if (_is_ptrcall_compatible(method))
+		r_target.kind |= INLINE_CACHE_PTRCALL;
+#endif
+	r_target.target = method;
+	r_target.index = psg->index;
+	return true;
+}
+
+bool GDScriptFunction::_inline_cache_call(int p_cache, const Variant *p_base, const StringName &p_method, const Variant **p_args, int p_argcount, Variant *r_ret, Variant::CallError &r_error) {
+
+	Object *obj;
+	GDScriptInstance *instance;
+	if (!_inline_cache_receiver(p_base, obj, instance))
+		return false;
+
+	const void *native_class = obj->get_class_name().data_unique_pointer();
+	const GDScript *script = instance ? instance->script.ptr() : NULL;
+
+	InlineCacheTarget target;
+	bool hit = _inline_cache_find(p_cache, native_class, script, target);
+	_inline_cache_count_lookup(hit);
+
+	if (!hit) {
+
+		if (p_method == CoreStringNames::get_singleton()->_free)
+			return false;
+
+		target.target = NULL;
+		target.index = -1;
+
+		for (const GDScript *sptr = script; sptr; sptr = sptr->_base) {
+			const Map<StringName, GDScriptFunction *>::Element *E = sptr->member_functions.find(p_method);
+			if (E) {
+				target.kind = INLINE_CACHE_SCRIPT_FUNCTION;
+				target.target = E->get();
+				break;
+			}
+		}
+
+		if (!target.target) {
+			MethodBind *method = ClassDB::get_method(obj->get_class_name(), p_method);
+			if (!method)
+				return false;
+
+			target.kind = INLINE_CACHE_NATIVE_METHOD;
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+			if (_is_ptrcall_compatible(method))
+				target.kind |= INLINE_CACHE_PTRCALL;
+#endif
+			target.target = method;
+		}
+
+		_inline_cache_store(p_cache, native_class, script, target);
+	}
+
+	r_error.error = Variant::CallError::CALL_OK;
+
+#ifdef DEBUG_ENABLED
+	// Like Object::call(), so the receiver can't be freed while it runs, script functions included.
+	_ObjectDebugLock debug_lock(obj);
+#endif
+
+	if (target.kind == INLINE_CACHE_SCRIPT_FUNCTION) {
+		Variant ret = static_cast<GDScriptFunction *>(target.target)->call(instance, p_args, p_argcount, r_error);
+		if (r_ret && r_error.error == Variant::CallError::CALL_OK)
+			*r_ret = ret;
+		return true;
+	}
+
+	MethodBind *method = static_cast<MethodBind *>(target.target);
+
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+	if ((target.kind & INLINE_CACHE_PTRCALL) && _ptrcall(method, obj, p_args, p_argcount, r_ret))
+		return true;
+#endif
+
+	Variant ret = method->call(obj, p_args, p_argcount, r_error);
+	if (r_ret && r_error.error == Variant::CallError::CALL_OK)
+		*r_ret = ret;
+	return true;
+}
+
+bool GDScriptFunction::_inline_cache_get(int p_cache, const Variant *p_base, const StringName &p_name, Variant *r_ret) {
+
+	Object *obj;
+	GDScriptInstance *instance;
+	if (!_inline_cache_receiver(p_base, obj, instance))
+		return false;
+
+	const void *native_class = obj->get_class_name().data_unique_pointer();
+	const GDScript *script = instance ? instance->script.ptr() : NULL;
+
+	InlineCacheTarget target;
+	bool hit = _inline_cache_find(p_cache, native_class, script, target);
+	_inline_cache_count_lookup(hit);
+
+	if (!hit) {
+		if (!_inline_cache_resolve_property(obj, script, p_name, true, target))
+			return false;
+		_inline_cache_store(p_cache, native_class, script, target);
+	}
+
+	// Not written in place, r_ret may hold the last reference to the object.
+	Variant ret;
+
+	if (target.kind == INLINE_CACHE_SCRIPT_MEMBER) {
+		ret = instance->members[target.index];
+	} else {
+		MethodBind *getter = static_cast<MethodBind *>(target.target);
+		Variant index = target.index;
+		const Variant *arg = &index;
+		int argcount = target.index >= 0 ? 1 : 0;
+
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+		if (!((target.kind & INLINE_CACHE_PTRCALL) && _ptrcall(getter, obj, &arg, argcount, &ret)))
+#endif
+		{
+			Variant::CallError ce;
+			ret = getter->call(obj, &arg, argcount, ce);
+		}
+	}
+
+	*r_ret = ret;
+	return true;
+}
+
+bool GDScriptFunction::_inline_cache_set(int p_cache, const Variant *p_base, const StringName &p_name, const Variant &p_value, bool &r_valid) {
+
+#ifdef TOOLS_ENABLED
+	// Object::set() also marks the object as edited there.
+	if (Engine::get_singleton()->is_editor_hint())
+		return false;
+#endif
+
+	Object *obj;
+	GDScriptInstance *instance;
+	if (!_inline_cache_receiver(p_base, obj, instance))
+		return false;
+
+	const void *native_class = obj->get_class_name().data_unique_pointer();
+	const GDScript *script = instance ? instance->script.ptr() : NULL;
+
+	InlineCacheTarget target;
+	bool hit = _inline_cache_find(p_cache, native_class, script, target);
+	_inline_cache_count_lookup(hit);
+
+	if (!hit) {
+		if (!_inline_cache_resolve_property(obj, script, p_name, false, target))
+			return false;
+		_inline_cache_store(p_cache, native_class, script, target);
+	}
+
+	if (target.kind == INLINE_CACHE_SCRIPT_MEMBER) {
+		const GDScript::MemberInfo *member = static_cast<const GDScript::MemberInfo *>(target.target);
+		if (!member->data_type.is_type(p_value))
+			return false; // the generic path reports the type mismatch
+		instance->members[target.index] = p_value;
+		r_valid = true;
+		return true;
+	}
+
+	MethodBind *setter = static_cast<MethodBind *>(target.target);
+	Variant index = target.index;
+	const Variant *args[2] = { &index, &p_value };
+	const Variant **argptrs = target.index >= 0 ? args : args + 1;
+	int argcount = target.index >= 0 ? 2 : 1;
+
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+	if ((target.kind & INLINE_CACHE_PTRCALL) && _ptrcall(setter, obj, argptrs, argcount, NULL)) {
+		r_valid = true;
+		return true;
+	}
+#endif
+
+	Variant::CallError ce;
+	setter->call(obj, argptrs, argcount, ce);
+	r_valid = ce.error == Variant::CallError::CALL_OK;
+	return true;
+}
+
 String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const String &p_where, const Variant **argptrs) const {
 
 	String err_text;
@@ -193,12 +660,15 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 #define OPCODES_TABLE                         \
 	static const void *switch_table_ops[] = { \
 		&&OPCODE_OPERATOR,                    \
+		&&OPCODE_OPERATOR_TYPED,              \
 		&&OPCODE_EXTENDS_TEST,                \
 		&&OPCODE_IS_BUILTIN,                  \
 		&&OPCODE_SET,                         \
 		&&OPCODE_GET,                         \
 		&&OPCODE_SET_NAMED,                   \
 		&&OPCODE_GET_NAMED,                   \
+		&&OPCODE_SET_NAMED_TYPED,             \
+		&&OPCODE_GET_NAMED_TYPED,             \
 		&&OPCODE_SET_MEMBER,                  \
 		&&OPCODE_GET_MEMBER,                  \
 		&&OPCODE_ASSIGN,                      \
@@ -215,6 +685,7 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 		&&OPCODE_CONSTRUCT_DICTIONARY,        \
 		&&OPCODE_CALL,                        \
 		&&OPCODE_CALL_RETURN,                 \
+		&&OPCODE_CALL_TYPED,                  \
 		&&OPCODE_CALL_BUILT_IN,               \
 		&&OPCODE_CALL_SELF,                   \
 		&&OPCODE_CALL_SELF_BASE,              \
@@ -287,11 +758,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 	if (p_state) {
 		//use existing (supplied) state (yielded)
-		stack = (Variant *)p_state->stack.data();
-		call_args = (Variant **)&p_state->stack.data()[sizeof(Variant) * p_state->stack_size]; //ptr() to avoid bounds check
+		stack = (Variant *)p_state->stack;
+		call_args = (Variant **)&p_state->stack[sizeof(Variant) * p_state->stack_size];
 		line = p_state->line;
 		ip = p_state->ip;
-		alloca_size = p_state->stack.size();
+		alloca_size = p_state->alloca_size;
 		script = p_state->script.ptr();
 		p_instance = p_state->instance;
 		defarg = p_state->defarg;
@@ -455,12 +926,13 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GET_VARIANT_PTR(b, 3);
 				GET_VARIANT_PTR(dst, 4);
 
+				Variant::OperatorEvaluator evaluator = Variant::get_operator_evaluator(op, a->get_type(), b->get_type());
 #ifdef DEBUG_ENABLED
 
 				Variant ret;
-				Variant::evaluate(op, *a, *b, ret, valid);
+				evaluator(*a, *b, ret, valid);
 #else
-				Variant::evaluate(op, *a, *b, *dst, valid);
+				evaluator(*a, *b, *dst, valid);
 #endif
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -480,6 +952,58 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_OPERATOR_TYPED) {
+
+				CHECK_SPACE(5);
+
+				int typed_op = _code_ptr[ip + 1];
+				GD_ERR_BREAK(typed_op < 0 || typed_op >= GDScriptTypedOps::operator_count);
+				const GDScriptTypedOps::Operator &typed = GDScriptTypedOps::operators[typed_op];
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				bool valid;
+				if (likely(a->get_type() == typed.type_a && b->get_type() == typed.type_b)) {
+					Variant::get_operator_evaluator(typed.op, typed.type_a, typed.type_b)(*a, *b, *dst, valid);
+#ifdef DEBUG_ENABLED
+					if (!valid) {
+						//division by zero, the error is left in dst
+						err_text = *dst;
+						err_text += " in operator '" + Variant::get_operator_name(typed.op) + "'.";
+						OPCODE_BREAK;
+					}
+#endif
+				} else {
+					//types differ from what the parser expected, do it like OPCODE_OPERATOR
+					Variant::OperatorEvaluator evaluator = Variant::get_operator_evaluator(typed.op, a->get_type(), b->get_type());
+#ifdef DEBUG_ENABLED
+
+					Variant ret;
+					evaluator(*a, *b, ret, valid);
+#else
+					evaluator(*a, *b, *dst, valid);
+#endif
+#ifdef DEBUG_ENABLED
+					if (!valid) {
+
+						if (ret.get_type() == Variant::STRING) {
+							//return a string when invalid with the error
+							err_text = ret;
+							err_text += " in operator '" + Variant::get_operator_name(typed.op) + "'.";
+						} else {
+							err_text = "Invalid operands '" + Variant::get_type_name(a->get_type()) + "' and '" + Variant::get_type_name(b->get_type()) + "' in operator '" + Variant::get_operator_name(typed.op) + "'.";
+						}
+						OPCODE_BREAK;
+					}
+					*dst = ret;
+#endif
+				}
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_EXTENDS_TEST) {
 
 				CHECK_SPACE(4);
@@ -620,7 +1144,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 			OPCODE(OPCODE_SET_NAMED) {
 
-				CHECK_SPACE(3);
+				CHECK_SPACE(5);
 
 				GET_VARIANT_PTR(dst, 1);
 				GET_VARIANT_PTR(value, 3);
@@ -630,8 +1154,13 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache = _code_ptr[ip + 4];
+				GD_ERR_BREAK(cache < 0 || cache >= _inline_cache_count);
+
 				bool valid;
-				dst->set_named(*index, *value, &valid);
+				if (!_inline_cache_set(cache, dst, *index, *value, valid)) {
+					dst->set_named(*index, *value, &valid);
+				}
 
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -640,29 +1169,37 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_GET_NAMED) {
 
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 
 				GET_VARIANT_PTR(src, 1);
-				GET_VARIANT_PTR(dst, 3);
+				GET_VARIANT_PTR(dst, 4);
 
 				int indexname = _code_ptr[ip + 2];
 
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
-				bool valid;
+				int cache = _code_ptr[ip + 3];
+				GD_ERR_BREAK(cache < 0 || cache >= _inline_cache_count);
+
+				bool valid = true;
 #ifdef DEBUG_ENABLED
 				//allow better error message in cases where src and dst are the same stack position
-				Variant ret = src->get_named(*index, &valid);
+				Variant ret;
+				if (!_inline_cache_get(cache, src, *index, &ret)) {
+					ret = src->get_named(*index, &valid);
+				}
 
 #else
-				*dst = src->get_named(*index, &valid);
+				if (!_inline_cache_get(cache, src, *index, dst)) {
+					*dst = src->get_named(*index, &valid);
+				}
 #endif
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -675,7 +1212,78 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 				*dst = ret;
 #endif
-				ip += 4;
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_SET_NAMED_TYPED) {
+
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(dst, 1);
+				GET_VARIANT_PTR(value, 3);
+
+				int member = _code_ptr[ip + 4];
+				GD_ERR_BREAK(member < 0 || member >= GDScriptTypedOps::member_count);
+				const GDScriptTypedOps::Member &typed = GDScriptTypedOps::members[member];
+
+				if (unlikely(dst->get_type() != typed.type || !typed.set(dst, *value))) {
+
+					int indexname = _code_ptr[ip + 2];
+
+					GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+					const StringName *index = &_global_names_ptr[indexname];
+
+					bool valid;
+					dst->set_named(*index, *value, &valid);
+
+#ifdef DEBUG_ENABLED
+					if (!valid) {
+						err_text = "Invalid set index '" + String(*index) + "' (on base: '" + _get_var_type(dst) + "') with value of type '" + _get_var_type(value) + "'.";
+						OPCODE_BREAK;
+					}
+#endif
+				}
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_NAMED_TYPED) {
+
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(src, 1);
+				GET_VARIANT_PTR(dst, 4);
+
+				int member = _code_ptr[ip + 3];
+				GD_ERR_BREAK(member < 0 || member >= GDScriptTypedOps::member_count);
+				const GDScriptTypedOps::Member &typed = GDScriptTypedOps::members[member];
+
+				if (likely(src->get_type() == typed.type)) {
+
+					typed.get(*src, dst);
+				} else {
+
+					int indexname = _code_ptr[ip + 2];
+
+					GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+					const StringName *index = &_global_names_ptr[indexname];
+
+					bool valid;
+#ifdef DEBUG_ENABLED
+					Variant ret = src->get_named(*index, &valid);
+#else
+					*dst = src->get_named(*index, &valid);
+#endif
+#ifdef DEBUG_ENABLED
+					if (!valid) {
+						err_text = "Invalid get index '" + index->operator String() + "' (on base: '" + _get_var_type(src) + "').";
+						OPCODE_BREAK;
+					}
+					*dst = ret;
+#endif
+				}
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -1044,7 +1652,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_CALL_RETURN)
 			OPCODE(OPCODE_CALL) {
 
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 				bool call_ret = _code_ptr[ip] == OPCODE_CALL_RETURN;
 
 				int argc = _code_ptr[ip + 1];
@@ -1054,8 +1662,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
 				const StringName *methodname = &_global_names_ptr[nameg];
 
+				int cache = _code_ptr[ip + 4];
+				GD_ERR_BREAK(cache < 0 || cache >= _inline_cache_count);
+
 				GD_ERR_BREAK(argc < 0);
-				ip += 4;
+				ip += 5;
 				CHECK_SPACE(argc + 1);
 				Variant **argptrs = call_args;
 
@@ -1073,13 +1684,15 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 #endif
 				Variant::CallError err;
+				Variant *ret = NULL;
 				if (call_ret) {
 
-					GET_VARIANT_PTR(ret, argc);
-					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
-				} else {
+					GET_VARIANT_PTR(v, argc);
+					ret = v;
+				}
 
-					base->call_ptr(*methodname, (const Variant **)argptrs, argc, NULL, err);
+				if (!_inline_cache_call(cache, base, *methodname, (const Variant **)argptrs, argc, ret, err)) {
+					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
 				}
 #ifdef DEBUG_ENABLED
 				if (GDScriptLanguage::get_singleton()->profiling) {
@@ -1122,6 +1735,63 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_CALL_TYPED) {
+
+				CHECK_SPACE(6);
+
+				int argc = _code_ptr[ip + 1];
+				GET_VARIANT_PTR(base, 2);
+				int nameg = _code_ptr[ip + 3];
+				Variant::Type base_type = (Variant::Type)_code_ptr[ip + 4];
+				int method = _code_ptr[ip + 5];
+
+				GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
+				const StringName *methodname = &_global_names_ptr[nameg];
+
+				GD_ERR_BREAK(argc < 0);
+				ip += 6;
+				CHECK_SPACE(argc + 1);
+				Variant **argptrs = call_args;
+
+				for (int i = 0; i < argc; ++i) {
+					GET_VARIANT_PTR(v, i);
+					argptrs[i] = v;
+				}
+
+				GET_VARIANT_PTR(ret, argc);
+
+#ifdef DEBUG_ENABLED
+				uint64_t call_time = 0;
+
+				if (GDScriptLanguage::get_singleton()->profiling) {
+					call_time = OS::get_singleton()->get_ticks_usec();
+				}
+
+#endif
+				Variant::CallError err;
+				if (likely(base->get_type() == base_type)) {
+					//method index was resolved at compile time for this type
+					base->call_ptr_by_index(method, (const Variant **)argptrs, argc, ret, err);
+				} else {
+
+					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
+				}
+#ifdef DEBUG_ENABLED
+				if (GDScriptLanguage::get_singleton()->profiling) {
+					function_call_time += OS::get_singleton()->get_ticks_usec() - call_time;
+				}
+
+				if (err.error != Variant::CallError::CALL_OK) {
+
+					err_text = _get_call_error(err, "function '" + String(*methodname) + "' in base '" + _get_var_type(base) + "'", (const Variant **)argptrs);
+					OPCODE_BREAK;
+				}
+#endif
+
+				ip += argc + 1;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_CALL_BUILT_IN) {
 
 				CHECK_SPACE(4);
@@ -1247,37 +1917,13 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_YIELD_SIGNAL) {
 
 				int ipofs = 1;
+				Object *obj = NULL;
+				String signal;
+
 				if (_code_ptr[ip] == OPCODE_YIELD_SIGNAL) {
 					CHECK_SPACE(4);
 					ipofs += 2;
-				} else {
-					CHECK_SPACE(2);
-				}
-
-				Ref<GDScriptFunctionState> gdfs = memnew(GDScriptFunctionState);
-				gdfs->function = this;
 
-				gdfs->state.stack.resize(alloca_size);
-				//copy variant stack
-				for (int i = 0; i < _stack_size; ++i) {
-					memnew_placement(&gdfs->state.stack[sizeof(Variant) * i], Variant(stack[i]));
-				}
-				gdfs->state.stack_size = _stack_size;
-				gdfs->state.self = self;
-				gdfs->state.alloca_size = alloca_size;
-				gdfs->state.script = Ref<GDScript>(_script);
-				gdfs->state.ip = ip + ipofs;
-				gdfs->state.line = line;
-				gdfs->state.instance_id = (p_instance && p_instance->get_owner()) ? p_instance->get_owner()->get_instance_id() : 0;
-				//gdfs->state.result_pos=ip+ipofs-1;
-				gdfs->state.defarg = defarg;
-				gdfs->state.instance = p_instance;
-				gdfs->function = this;
-
-				retvalue = gdfs;
-
-				if (_code_ptr[ip] == OPCODE_YIELD_SIGNAL) {
-					//do the oneshot connect
 					GET_VARIANT_PTR(argobj, 1);
 					GET_VARIANT_PTR(argname, 2);
 
@@ -1292,8 +1938,8 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					}
 #endif
 
-					Object *obj = argobj->operator Object *();
-					String signal = argname->operator String();
+					obj = argobj->operator Object *();
+					signal = argname->operator String();
 
 #ifdef DEBUG_ENABLED
 					if (!obj) {
@@ -1311,14 +1957,46 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 						err_text = "Second argument of yield() is an empty string (for signal name).";
 						OPCODE_BREAK;
 					}
+#endif
+				} else {
+					CHECK_SPACE(2);
+				}
 
-					Error err = obj->connect(signal, gdfs.ptr(), "_signal_callback", varray(gdfs), Object::CONNECT_ONESHOT);
+				Ref<GDScriptFunctionState> gdfs = memnew(GDScriptFunctionState);
+				gdfs->function = this;
+
+				gdfs->state.stack = GDScriptLanguage::get_singleton()->alloc_yield_frame(alloca_size, gdfs->state.stack_capacity);
+				//move variant stack, leaving empty variants behind to be destroyed on exit
+				if (_stack_size) {
+					memcpy((void *)gdfs->state.stack, (const void *)stack, sizeof(Variant) * _stack_size);
+					for (int i = 0; i < _stack_size; ++i) {
+						memnew_placement(&stack[i], Variant);
+					}
+				}
+				gdfs->state.stack_size = _stack_size;
+				gdfs->state.self = self;
+				gdfs->state.alloca_size = alloca_size;
+				gdfs->state.script = Ref<GDScript>(_script);
+				gdfs->state.ip = ip + ipofs;
+				gdfs->state.line = line;
+				gdfs->state.instance_id = (p_instance && p_instance->get_owner()) ? p_instance->get_owner()->get_instance_id() : 0;
+				//gdfs->state.result_pos=ip+ipofs-1;
+				gdfs->state.defarg = defarg;
+				gdfs->state.instance = p_instance;
+
+				retvalue = gdfs;
+
+				if (obj) {
+					//frame signals resume all their waiters through one connection, others do a oneshot connect
+					Error err;
+					if (!GDScriptLanguage::get_singleton()->queue_yield(obj, signal, gdfs, err)) {
+						err = obj->connect(signal, gdfs.ptr(), "_signal_callback", varray(gdfs), Object::CONNECT_ONESHOT);
+					}
+#ifdef DEBUG_ENABLED
 					if (err != OK) {
 						err_text = "Error connecting to signal: " + signal + " during yield().";
 						OPCODE_BREAK;
 					}
-#else
-					obj->connect(signal, gdfs.ptr(), "_signal_callback", varray(gdfs), Object::CONNECT_ONESHOT);
 #endif
 				}
 
@@ -1744,6 +2422,8 @@ GDScriptFunction::GDScriptFunction() :
 
 	_stack_size = 0;
 	_call_size = 0;
+	_inline_caches = NULL;
+	_inline_cache_count = 0;
 	rpc_mode = MultiplayerAPI::RPC_MODE_DISABLED;
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
@@ -1767,11 +2447,22 @@ GDScriptFunction::GDScriptFunction() :
 	profile.last_frame_call_count = 0;
 	profile.last_frame_self_time = 0;
 	profile.last_frame_total_time = 0;
+	profile.cache_hits = 0;
+	profile.cache_misses = 0;
+	profile.frame_cache_hits = 0;
+	profile.frame_cache_misses = 0;
+	profile.last_frame_cache_hits = 0;
+	profile.last_frame_cache_misses = 0;
 
 #endif
 }
 
 GDScriptFunction::~GDScriptFunction() {
+
+	if (_inline_caches) {
+		memdelete_arr(_inline_caches);
+	}
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->lock) {
 		GDScriptLanguage::get_singleton()->lock->lock();
@@ -1875,16 +2566,34 @@ Variant GDScriptFunctionState::resume(const Variant &p_arg) {
 			GDScriptLanguage::get_singleton()->exit_function();
 		if (state.stack_size) {
 			//free stack
-			Variant *stack = (Variant *)state.stack.data();
+			Variant *stack = (Variant *)state.stack;
 			for (decltype(state.stack_size) i = 0; i < state.stack_size; ++i)
 				stack[i].~Variant();
 		}
 #endif
 	}
 
+	// The variants are destroyed by now, or were moved to the state of a new yield.
+	_free_stack();
+
 	return ret;
 }
 
+void GDScriptFunctionState::_free_stack() {
+
+	if (!state.stack)
+		return;
+
+	if (GDScriptLanguage::get_singleton()) {
+		GDScriptLanguage::get_singleton()->free_yield_frame(state.stack, state.stack_capacity);
+	} else {
+		memfree(state.stack);
+	}
+
+	state.stack = NULL;
+	state.stack_capacity = 0;
+}
+
 void GDScriptFunctionState::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("resume", "arg"), &GDScriptFunctionState::resume, DEFVAL(Variant()));
@@ -1897,6 +2606,9 @@ void GDScriptFunctionState::_bind_methods() {
 GDScriptFunctionState::GDScriptFunctionState() {
 
 	function = NULL;
+	state.stack = NULL;
+	state.stack_capacity = 0;
+	state.stack_size = 0;
 }
 
 GDScriptFunctionState::~GDScriptFunctionState() {
@@ -1908,4 +2620,52 @@ GDScriptFunctionState::~GDScriptFunctionState() {
 			v->~Variant();
 		}
 	}
+
+	_free_stack();
+}
+
+/////////////////////
+
+Variant GDScriptSignalWaiters::_signal_callback(const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
+
+	r_error.error = Variant::CallError::CALL_OK;
+
+	// What GDScriptFunctionState::_signal_callback() would resume with, without the bound state.
+	Variant arg;
+	if (p_argcount == 1) {
+		arg = *p_args[0];
+	} else if (p_argcount > 1) {
+		Array extra_args;
+		for (int i = 0; i < p_argcount; ++i) {
+			extra_args.push_back(*p_args[i]);
+		}
+		arg = extra_args;
+	}
+
+	// Functions yielding again while resumed wait for the next emission.
+	std::vector<Ref<GDScriptFunctionState> > nested;
+	std::vector<Ref<GDScriptFunctionState> > &list = resuming.empty() ? resuming : nested;
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+	if (language->lock) {
+		language->lock->lock();
+	}
+
+	list.swap(states);
+
+	if (language->lock) {
+		language->lock->unlock();
+	}
+
+	for (size_t i = 0; i < list.size(); i++) {
+		list[i]->resume(arg);
+	}
+	list.clear();
+
+	return Variant();
+}
+
+void GDScriptSignalWaiters::_bind_methods() {
+
+	ClassDB::bind_vararg_method(METHOD_FLAGS_DEFAULT, "_signal_callback", &GDScriptSignalWaiters::_signal_callback, MethodInfo("_signal_callback"));
 }
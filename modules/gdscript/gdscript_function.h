@@ -31,6 +31,7 @@
 #ifndef GDSCRIPT_FUNCTION_H
 #define GDSCRIPT_FUNCTION_H
 
+#include <atomic>
 #include <vector>
 
 #include "core/os/thread.h"
@@ -43,6 +44,7 @@
 
 class GDScriptInstance;
 class GDScript;
+class MethodBind;
 
 struct GDScriptDataType {
 	bool has_type;
@@ -150,12 +152,15 @@ class GDScriptFunction {
 public:
 	enum Opcode {
 		OPCODE_OPERATOR,
+		OPCODE_OPERATOR_TYPED,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_IS_BUILTIN,
 		OPCODE_SET,
 		OPCODE_GET,
 		OPCODE_SET_NAMED,
 		OPCODE_GET_NAMED,
+		OPCODE_SET_NAMED_TYPED,
+		OPCODE_GET_NAMED_TYPED,
 		OPCODE_SET_MEMBER,
 		OPCODE_GET_MEMBER,
 		OPCODE_ASSIGN,
@@ -172,6 +177,7 @@ public:
 		OPCODE_CONSTRUCT_DICTIONARY,
 		OPCODE_CALL,
 		OPCODE_CALL_RETURN,
+		OPCODE_CALL_TYPED,
 		OPCODE_CALL_BUILT_IN,
 		OPCODE_CALL_SELF,
 		OPCODE_CALL_SELF_BASE,
@@ -217,6 +223,7 @@ public:
 
 private:
 	friend class GDScriptCompiler;
+	friend class GDScriptCache;
 
 	StringName source;
 
@@ -259,6 +266,66 @@ private:
 
 	List<StackDebug> stack_debug;
 
+	// Inline caches of the OPCODE_CALL/OPCODE_CALL_RETURN, OPCODE_GET_NAMED and OPCODE_SET_NAMED
+	// sites: what the name resolved to for the last few receiver classes/scripts seen there.
+	// Threads running the same function share them, so entries are written under a sequence lock.
+	enum {
+		INLINE_CACHE_SIZE = 4, // receivers remembered per site, further receivers aren't cached
+		INLINE_CACHE_PTRCALL = 1 << 8, // flag on INLINE_CACHE_NATIVE_* kinds
+	};
+
+	enum InlineCacheKind {
+		INLINE_CACHE_SCRIPT_FUNCTION, // target is the GDScriptFunction
+		INLINE_CACHE_NATIVE_METHOD, // target is the MethodBind
+		INLINE_CACHE_SCRIPT_MEMBER, // target is the GDScript::MemberInfo
+		INLINE_CACHE_NATIVE_PROPERTY, // target is the getter or setter MethodBind, index the property index
+	};
+
+	struct InlineCacheTarget {
+		uint32_t kind;
+		void *target;
+		int index;
+	};
+
+	struct InlineCacheEntry {
+		std::atomic<uint32_t> sequence; // 0 while empty, odd while being written
+		std::atomic<uint32_t> epoch; // entries with a script are dropped when scripts are reloaded
+		std::atomic<const void *> native_class;
+		std::atomic<const void *> script;
+		std::atomic<uint32_t> kind;
+		std::atomic<void *> target;
+		std::atomic<int> index;
+
+		InlineCacheEntry() :
+				sequence(0),
+				epoch(0),
+				native_class(NULL),
+				script(NULL),
+				kind(0),
+				target(NULL),
+				index(-1) {}
+	};
+
+	struct InlineCache {
+		InlineCacheEntry entries[INLINE_CACHE_SIZE];
+		std::atomic<uint32_t> megamorphic_epoch; // epoch + 1 once all entries were taken in that epoch, misses then store nothing
+
+		InlineCache() :
+				megamorphic_epoch(0) {}
+	};
+
+	InlineCache *_inline_caches;
+	int _inline_cache_count;
+
+	bool _inline_cache_find(int p_cache, const void *p_native_class, const void *p_script, InlineCacheTarget &r_target);
+	void _inline_cache_store(int p_cache, const void *p_native_class, const void *p_script, const InlineCacheTarget &p_target);
+	_FORCE_INLINE_ bool _inline_cache_receiver(const Variant *p_base, Object *&r_object, GDScriptInstance *&r_instance) const;
+	void _inline_cache_count_lookup(bool p_hit);
+	bool _inline_cache_resolve_property(Object *p_object, const GDScript *p_script, const StringName &p_name, bool p_get, InlineCacheTarget &r_target) const;
+	bool _inline_cache_call(int p_cache, const Variant *p_base, const StringName &p_method, const Variant **p_args, int p_argcount, Variant *r_ret, Variant::CallError &r_error);
+	bool _inline_cache_get(int p_cache, const Variant *p_base, const StringName &p_name, Variant *r_ret);
+	bool _inline_cache_set(int p_cache, const Variant *p_base, const StringName &p_name, const Variant &p_value, bool &r_valid);
+
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Variant::CallError &p_err, const String &p_where, const Variant **argptrs) const;
 
@@ -280,6 +347,12 @@ private:
 		uint64_t last_frame_call_count;
 		uint64_t last_frame_self_time;
 		uint64_t last_frame_total_time;
+		uint64_t cache_hits;
+		uint64_t cache_misses;
+		uint64_t frame_cache_hits;
+		uint64_t frame_cache_misses;
+		uint64_t last_frame_cache_hits;
+		uint64_t last_frame_cache_misses;
 	} profile;
 
 #endif
@@ -289,7 +362,8 @@ public:
 
 		ObjectID instance_id;
 		GDScriptInstance *instance;
-		std::vector<uint8_t> stack;
+		uint8_t *stack; // from GDScriptLanguage::alloc_yield_frame()
+		uint32_t stack_capacity;
 		uint32_t stack_size;
 		Variant self;
 		uint32_t alloca_size;
@@ -349,6 +423,8 @@ class GDScriptFunctionState : public Reference {
 	Variant _signal_callback(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
 	Ref<GDScriptFunctionState> first_state;
 
+	void _free_stack();
+
 protected:
 	static void _bind_methods();
 
@@ -359,4 +435,19 @@ public:
 	~GDScriptFunctionState();
 };
 
+// Function states that yielded on the same signal of the same object, resumed
+// through one connection instead of each connecting and disconnecting itself.
+class GDScriptSignalWaiters : public Object {
+
+	GDCLASS(GDScriptSignalWaiters, Object);
+	friend class GDScriptLanguage;
+
+	std::vector<Ref<GDScriptFunctionState> > states;
+	std::vector<Ref<GDScriptFunctionState> > resuming;
+	Variant _signal_callback(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
+
+protected:
+	static void _bind_methods();
+};
+
 #endif // GDSCRIPT_FUNCTION_H
@@ -39,6 +39,7 @@
 #include "core/reference.h"
 #include "core/script_language.h"
 #include "gdscript.h"
+#include "gdscript_preloader.h"
 
 template <class T>
 T *GDScriptParser::alloc_node() {
@@ -490,7 +491,7 @@ GDScriptParser::Node *GDScriptParser::_parse_expression(Node *p_parent, bool p_s
 					if (for_completion && ScriptCodeCompletionCache::get_singleton() && FileAccess::exists(path)) {
 						res = ScriptCodeCompletionCache::get_singleton()->get_cached_resource(path);
 					} else if (!for_completion || FileAccess::exists(path)) {
-						res = ResourceLoader::load(path);
+						res = _load_dependency(path);
 					}
 				} else {
 
@@ -826,7 +827,7 @@ GDScriptParser::Node *GDScriptParser::_parse_expression(Node *p_parent, bool p_s
 
 				if (!dependencies_only) {
 					if (!bfn && ScriptServer::is_global_class(identifier)) {
-						Ref<Script> scr = ResourceLoader::load(ScriptServer::get_global_class_path(identifier));
+						Ref<Script> scr = _load_dependency(ScriptServer::get_global_class_path(identifier));
 						if (scr.is_valid() && scr->is_valid()) {
 							ConstantNode *constant = alloc_node<ConstantNode>();
 							constant->value = scr;
@@ -5228,7 +5229,7 @@ void GDScriptParser::_determine_inheritance(ClassNode *p_class, bool p_recursive
 				}
 				path = base.plus_file(path).simplify_path();
 			}
-			script = ResourceLoader::load(path);
+			script = _load_dependency(path);
 			if (script.is_null()) {
 				_set_error("Couldn't load the base class: " + path, p_class->line);
 				return;
@@ -5270,7 +5271,7 @@ void GDScriptParser::_determine_inheritance(ClassNode *p_class, bool p_recursive
 			Ref<GDScript> base_script;
 
 			if (ScriptServer::is_global_class(base)) {
-				base_script = ResourceLoader::load(ScriptServer::get_global_class_path(base));
+				base_script = _load_dependency(ScriptServer::get_global_class_path(base));
 				if (!base_script.is_valid()) {
 					_set_error("The class \"" + base + "\" couldn't be fully loaded (script error or cyclic dependency).", p_class->line);
 					return;
@@ -5293,7 +5294,7 @@ void GDScriptParser::_determine_inheritance(ClassNode *p_class, bool p_recursive
 						if (!singleton_path.begins_with("res://")) {
 							singleton_path = "res://" + singleton_path;
 						}
-						base_script = ResourceLoader::load(singleton_path);
+						base_script = _load_dependency(singleton_path);
 						if (!base_script.is_valid()) {
 							_set_error("Class '" + base + "' could not be fully loaded (script error or cyclic inheritance).", p_class->line);
 							return;
@@ -5626,7 +5627,7 @@ GDScriptParser::DataType GDScriptParser::_resolve_type(const DataType &p_source,
 					result.kind = DataType::CLASS;
 					result.class_type = static_cast<ClassNode *>(head);
 				} else {
-					Ref<Script> script = ResourceLoader::load(script_path);
+					Ref<Script> script = _load_dependency(script_path);
 					Ref<GDScript> gds = script;
 					if (gds.is_valid()) {
 						if (!gds->is_valid()) {
@@ -5667,7 +5668,7 @@ GDScriptParser::DataType GDScriptParser::_resolve_type(const DataType &p_source,
 				}
 			}
 			if (!singleton_path.empty()) {
-				Ref<Script> script = ResourceLoader::load(singleton_path);
+				Ref<Script> script = _load_dependency(singleton_path);
 				Ref<GDScript> gds = script;
 				if (gds.is_valid()) {
 					if (!gds->is_valid()) {
@@ -7508,7 +7509,7 @@ GDScriptParser::DataType GDScriptParser::_reduce_identifier_type(const DataType
 		}
 
 		if (ScriptServer::is_global_class(p_identifier)) {
-			Ref<Script> scr = ResourceLoader::load(ScriptServer::get_global_class_path(p_identifier));
+			Ref<Script> scr = _load_dependency(ScriptServer::get_global_class_path(p_identifier));
 			if (scr.is_valid()) {
 				DataType result;
 				result.has_type = true;
@@ -7560,7 +7561,7 @@ GDScriptParser::DataType GDScriptParser::_reduce_identifier_type(const DataType
 				if (!script.begins_with("res://")) {
 					script = "res://" + script;
 				}
-				Ref<Script> singleton = ResourceLoader::load(script);
+				Ref<Script> singleton = _load_dependency(script);
 				if (singleton.is_valid()) {
 					DataType result;
 					result.has_type = true;
@@ -8336,6 +8337,18 @@ void GDScriptParser::_set_error(const String &p_error, int p_line, int p_column)
 	error_set = true;
 }
 
+RES GDScriptParser::_load_dependency(const String &p_path) {
+
+	// Constants of loaded scripts may be folded into the code, see GDScriptCache.
+	loaded_dependencies.insert(p_path);
+	if (!GDScriptPreloader::can_load(p_path)) {
+		// Compiling on a preload worker, the script will be compiled again on the calling thread.
+		_set_error("Dependency \"" + p_path + "\" isn't loaded yet.");
+		return RES();
+	}
+	return ResourceLoader::load(p_path);
+}
+
 #ifdef DEBUG_ENABLED
 void GDScriptParser::_add_warning(int p_code, int p_line, const String &p_symbol1, const String &p_symbol2, const String &p_symbol3, const String &p_symbol4) {
 	std::vector<String> symbols;
@@ -8581,6 +8594,7 @@ void GDScriptParser::clear() {
 	check_types = true;
 	dependencies_only = false;
 	dependencies.clear();
+	loaded_dependencies.clear();
 	error = "";
 #ifdef DEBUG_ENABLED
 	safe_lines = NULL;
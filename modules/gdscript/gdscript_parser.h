@@ -544,6 +544,7 @@ private:
 	bool check_types;
 	bool dependencies_only;
 	List<String> dependencies;
+	Set<String> loaded_dependencies;
 #ifdef DEBUG_ENABLED
 	Set<int> *safe_lines;
 #endif // DEBUG_ENABLED
@@ -583,6 +584,7 @@ private:
 	MultiplayerAPI::RPCMode rpc_mode;
 
 	void _set_error(const String &p_error, int p_line = -1, int p_column = -1);
+	RES _load_dependency(const String &p_path);
 #ifdef DEBUG_ENABLED
 	void _add_warning(int p_code, int p_line = -1, const String &p_symbol1 = String(), const String &p_symbol2 = String(), const String &p_symbol3 = String(), const String &p_symbol4 = String());
 	void _add_warning(int p_code, int p_line, const std::vector<String> &p_symbols);
@@ -667,6 +669,8 @@ public:
 	int get_completion_identifier_is_function();
 
 	const List<String> &get_dependencies() const { return dependencies; }
+	// Paths of everything loaded while parsing, which the compiled code may depend on.
+	const Set<String> &get_loaded_dependencies() const { return loaded_dependencies; }
 
 	void clear();
 	GDScriptParser();
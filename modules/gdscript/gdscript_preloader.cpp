@@ -0,0 +1,519 @@
+/*************************************************************************/
+/*  gdscript_preloader.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_preloader.h"
+
+#include "core/io/resource_loader.h"
+#include "core/os/file_access.h"
+#include "core/os/thread_pool.h"
+#include "core/pair.h"
+#include "core/project_settings.h"
+#include "core/script_language.h"
+#include "gdscript.h"
+#include "gdscript_tokenizer.h"
+
+#include <algorithm>
+
+static thread_local const GDScriptPreloader *worker_preloader = NULL;
+
+bool GDScriptPreloader::is_worker_thread() {
+
+	return worker_preloader != NULL;
+}
+
+bool GDScriptPreloader::can_load(const String &p_path) {
+
+	return !worker_preloader || worker_preloader->_is_loaded(p_path);
+}
+
+bool GDScriptPreloader::_is_loaded(const String &p_path) const {
+
+	// Items only change state between waves, on the calling thread. Those of the current wave are
+	// still pending, they may be in the ResourceCache already but aren't compiled yet.
+	const int *index = indices.getptr(p_path);
+	if (index) {
+		return items[*index].state == STATE_LOADED;
+	}
+	return ResourceCache::has(p_path);
+}
+
+int GDScriptPreloader::_add_item(const String &p_path) {
+
+	String path = p_path.is_rel_path() ? "res://" + p_path : ProjectSettings::get_singleton()->localize_path(p_path);
+
+	const int *index = indices.getptr(path);
+	if (index) {
+		return *index;
+	}
+
+	Item item;
+	item.path = path;
+	item.remapped_path = ResourceLoader::path_remap(path);
+	String extension = item.remapped_path.get_extension().to_lower();
+	item.script = extension == "gd" || extension == "gdc";
+	item.scanned = false;
+	item.state = STATE_PENDING;
+
+	if (ResourceCache::has(path)) {
+		item.resource = ResourceLoader::load(path);
+		if (item.resource.is_valid()) {
+			item.state = STATE_LOADED;
+		}
+	}
+
+	int new_index = items.size();
+	items.push_back(item);
+	indices[path] = new_index;
+	return new_index;
+}
+
+void GDScriptPreloader::_add_name(const String &p_name, const String &p_path) {
+
+	uint32_t hash = String::hash(p_name.c_str(), p_name.length());
+	if (_find_name(p_name.c_str(), p_name.length())) {
+		return; // Global classes come first, like in GDScriptParser.
+	}
+
+	Name name;
+	name.name = p_name;
+	name.path = p_path;
+	name_hashes[hash].push_back(names.size());
+	names.push_back(name);
+}
+
+const String *GDScriptPreloader::_find_name(const CharType *p_chars, int p_length) const {
+
+	const std::vector<int> *candidates = name_hashes.getptr(String::hash(p_chars, p_length));
+	if (!candidates) {
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < candidates->size(); i++) {
+		const Name &name = names[(*candidates)[i]];
+		if (name.name.length() == p_length && memcmp(name.name.c_str(), p_chars, p_length * sizeof(CharType)) == 0) {
+			return &name.path;
+		}
+	}
+	return NULL;
+}
+
+// Same path resolution as GDScriptParser.
+
+static String _preload_path(const String &p_base_dir, String p_path) {
+
+	if (!p_path.is_abs_path()) {
+		p_path = p_base_dir.plus_file(p_path);
+	}
+	return p_path.replace("///", "//").simplify_path();
+}
+
+static String _extends_path(const String &p_base_dir, const String &p_path) {
+
+	return p_path.is_rel_path() ? p_base_dir.plus_file(p_path).simplify_path() : p_path;
+}
+
+static _FORCE_INLINE_ bool _is_identifier_char(CharType c) {
+
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static int _skip_spaces(const CharType *p_chars, int p_length, int p_pos) {
+
+	while (p_pos < p_length && (p_chars[p_pos] == ' ' || p_chars[p_pos] == '\t' || p_chars[p_pos] == '\n' || p_chars[p_pos] == '\r')) {
+		p_pos++;
+	}
+	return p_pos;
+}
+
+// Position after the string literal at p_pos, its contents in r_string when it has no escapes.
+static int _skip_string(const CharType *p_chars, int p_length, int p_pos, String *r_string) {
+
+	CharType quote = p_chars[p_pos];
+	bool multiline = p_pos + 2 < p_length && p_chars[p_pos + 1] == quote && p_chars[p_pos + 2] == quote;
+	int from = p_pos + (multiline ? 3 : 1);
+	bool escapes = false;
+
+	for (int i = from; i < p_length; i++) {
+		if (p_chars[i] == '\\') {
+			escapes = true;
+			i++;
+		} else if (p_chars[i] == quote && (!multiline || (i + 2 < p_length && p_chars[i + 1] == quote && p_chars[i + 2] == quote))) {
+			if (r_string && !escapes) {
+				*r_string = String(&p_chars[from], i - from);
+			}
+			return i + (multiline ? 3 : 1);
+		} else if (p_chars[i] == '\n' && !multiline) {
+			break;
+		}
+	}
+	return p_length;
+}
+
+void GDScriptPreloader::_scan_source(const String &p_source, Item &r_item) const {
+
+	// Not a tokenizer, that would take about as long as parsing. Only words outside of comments and
+	// strings matter.
+	const CharType *chars = p_source.c_str();
+	int length = p_source.length();
+	String base_dir = r_item.path.get_base_dir();
+
+	int pos = 0;
+	while (pos < length) {
+
+		CharType c = chars[pos];
+		if (c == '#') {
+			while (pos < length && chars[pos] != '\n') {
+				pos++;
+			}
+			continue;
+		}
+		if (c == '"' || c == '\'') {
+			pos = _skip_string(chars, length, pos, NULL);
+			continue;
+		}
+		if (c >= '0' && c <= '9') {
+			// Numbers whole, so 0x1F or 1e5 aren't taken for words.
+			while (pos < length && _is_identifier_char(chars[pos])) {
+				pos++;
+			}
+			continue;
+		}
+		if (!_is_identifier_char(c)) {
+			pos++;
+			continue;
+		}
+
+		int from = pos;
+		while (pos < length && _is_identifier_char(chars[pos])) {
+			pos++;
+		}
+		int word_length = pos - from;
+
+		String path;
+		if (word_length == 7 && memcmp(&chars[from], L"preload", 7 * sizeof(CharType)) == 0) {
+			int next = _skip_spaces(chars, length, pos);
+			if (next < length && chars[next] == '(') {
+				next = _skip_spaces(chars, length, next + 1);
+				if (next < length && (chars[next] == '"' || chars[next] == '\'')) {
+					pos = _skip_string(chars, length, next, &path);
+					if (!path.empty()) {
+						path = _preload_path(base_dir, path);
+					}
+				}
+			}
+		} else if (word_length == 7 && memcmp(&chars[from], L"extends", 7 * sizeof(CharType)) == 0) {
+			int next = _skip_spaces(chars, length, pos);
+			if (next < length && (chars[next] == '"' || chars[next] == '\'')) {
+				pos = _skip_string(chars, length, next, &path);
+				if (!path.empty()) {
+					path = _extends_path(base_dir, path);
+				}
+			}
+		} else {
+			const String *name_path = _find_name(&chars[from], word_length);
+			if (name_path) {
+				path = *name_path;
+			}
+		}
+
+		if (!path.empty() && path != r_item.path) {
+			r_item.found.push_back(path);
+		}
+	}
+}
+
+void GDScriptPreloader::_scan_tokens(GDScriptTokenizer *p_tokenizer, Item &r_item) const {
+
+	String base_dir = r_item.path.get_base_dir();
+
+	while (true) {
+
+		GDScriptTokenizer::Token token = p_tokenizer->get_token();
+		if (token == GDScriptTokenizer::TK_EOF || token == GDScriptTokenizer::TK_ERROR) {
+			break;
+		}
+
+		String path;
+		switch (token) {
+			case GDScriptTokenizer::TK_PR_PRELOAD: {
+				if (p_tokenizer->get_token(1) == GDScriptTokenizer::TK_PARENTHESIS_OPEN && p_tokenizer->get_token(2) == GDScriptTokenizer::TK_CONSTANT && p_tokenizer->get_token_constant(2).get_type() == Variant::STRING) {
+					path = _preload_path(base_dir, p_tokenizer->get_token_constant(2));
+				}
+			} break;
+			case GDScriptTokenizer::TK_PR_EXTENDS: {
+				if (p_tokenizer->get_token(1) == GDScriptTokenizer::TK_CONSTANT && p_tokenizer->get_token_constant(1).get_type() == Variant::STRING) {
+					path = _extends_path(base_dir, p_tokenizer->get_token_constant(1));
+				}
+			} break;
+			case GDScriptTokenizer::TK_IDENTIFIER: {
+				String identifier = p_tokenizer->get_token_identifier();
+				const String *name_path = _find_name(identifier.c_str(), identifier.length());
+				if (name_path) {
+					path = *name_path;
+				}
+			} break;
+			default: {
+			}
+		}
+
+		if (!path.empty() && path != r_item.path) {
+			r_item.found.push_back(path);
+		}
+
+		p_tokenizer->advance();
+	}
+}
+
+void GDScriptPreloader::_scan_script(Item &r_item) const {
+
+	// Anything unreadable is left to the serial pass, which reports why.
+	if (r_item.remapped_path.get_extension().to_lower() == "gdc") {
+		std::vector<uint8_t> buffer = FileAccess::get_file_as_array(r_item.remapped_path);
+		GDScriptTokenizerBuffer tokenizer;
+		if (buffer.empty() || tokenizer.set_code_buffer(buffer) != OK) {
+			return;
+		}
+		_scan_tokens(&tokenizer, r_item);
+	} else {
+		Error err;
+		String source = FileAccess::get_file_as_string(r_item.remapped_path, &err);
+		if (err != OK) {
+			return;
+		}
+		_scan_source(source, r_item);
+	}
+
+	r_item.scanned = true;
+}
+
+void GDScriptPreloader::_scan(uint32_t p_index, const int *p_items) {
+
+	Item &item = items[p_items[p_index]];
+
+	if (item.script) {
+		_scan_script(item);
+		return;
+	}
+
+	List<String> dependencies;
+	ResourceLoader::get_dependencies(item.path, &dependencies);
+	for (List<String>::Element *E = dependencies.front(); E; E = E->next()) {
+		String path = E->get();
+		int type_pos = path.find("::");
+		if (type_pos != -1) {
+			path = path.left(type_pos);
+		}
+		item.found.push_back(path);
+	}
+	item.scanned = true;
+}
+
+void GDScriptPreloader::_compile(uint32_t p_index, const int *p_items) {
+
+	Item &item = items[p_items[p_index]];
+
+	worker_preloader = this;
+	item.resource = ResourceLoader::load(item.path);
+	worker_preloader = NULL;
+}
+
+void GDScriptPreloader::_sort_dependencies(std::vector<int> &r_order) const {
+
+	// Depth first, dependencies before the items using them. Items are in discovery order, so
+	// the order only depends on the preloaded paths and the files.
+	std::vector<bool> visited(items.size(), false);
+	std::vector<Pair<int, int> > stack;
+
+	for (int i = 0; i < (int)items.size(); i++) {
+
+		if (visited[i]) {
+			continue;
+		}
+		visited[i] = true;
+		stack.push_back(Pair<int, int>(i, 0));
+
+		while (!stack.empty()) {
+			Pair<int, int> &top = stack.back();
+			const std::vector<int> &dependencies = items[top.first].dependencies;
+			if (top.second < (int)dependencies.size()) {
+				int dependency = dependencies[top.second++];
+				if (!visited[dependency]) {
+					visited[dependency] = true;
+					stack.push_back(Pair<int, int>(dependency, 0));
+				}
+			} else {
+				r_order.push_back(top.first);
+				stack.pop_back();
+			}
+		}
+	}
+}
+
+void GDScriptPreloader::preload(const std::vector<String> &p_paths, std::vector<RES> &r_loaded) {
+
+	List<StringName> global_classes;
+	ScriptServer::get_global_class_list(&global_classes);
+	for (List<StringName>::Element *E = global_classes.front(); E; E = E->next()) {
+		_add_name(E->get(), ScriptServer::get_global_class_path(E->get()));
+	}
+
+	List<PropertyInfo> properties;
+	ProjectSettings::get_singleton()->get_property_list(&properties);
+	for (List<PropertyInfo>::Element *E = properties.front(); E; E = E->next()) {
+		const String &name = E->get().name;
+		if (!name.begins_with("autoload/")) {
+			continue;
+		}
+		String path = ProjectSettings::get_singleton()->get(name);
+		if (path.begins_with("*")) {
+			path = path.right(1);
+		}
+		if (!path.begins_with("res://")) {
+			path = "res://" + path;
+		}
+		_add_name(name.get_slicec('/', 1), path);
+	}
+
+	for (uint32_t i = 0; i < p_paths.size(); i++) {
+		_add_item(p_paths[i]);
+	}
+
+	// Scan breadth first, the items found at each level in parallel.
+	ThreadPool *pool = ThreadPool::get_singleton();
+	std::vector<int> batch;
+	uint32_t scanned_to = 0;
+
+	while (scanned_to < items.size()) {
+
+		batch.clear();
+		for (uint32_t i = scanned_to; i < items.size(); i++) {
+			if (items[i].state == STATE_PENDING) {
+				batch.push_back(i);
+			}
+		}
+		scanned_to = items.size();
+		pool->parallel_for(batch.size(), this, &GDScriptPreloader::_scan, (const int *)batch.data());
+
+		for (uint32_t i = 0; i < batch.size(); i++) {
+			std::vector<String> found;
+			found.swap(items[batch[i]].found);
+			for (uint32_t j = 0; j < found.size(); j++) {
+				int dependency = _add_item(found[j]);
+				std::vector<int> &dependencies = items[batch[i]].dependencies;
+				if (dependency != batch[i] && std::find(dependencies.begin(), dependencies.end(), dependency) == dependencies.end()) {
+					dependencies.push_back(dependency);
+				}
+			}
+		}
+	}
+
+	// Compile in waves, each wave has the scripts whose dependencies are loaded.
+	while (true) {
+
+		batch.clear();
+		bool cached = false;
+		for (uint32_t i = 0; i < items.size(); i++) {
+			Item &item = items[i];
+			if (item.state != STATE_PENDING || !item.scanned) {
+				continue;
+			}
+
+			bool ready = true;
+			for (uint32_t j = 0; j < item.dependencies.size() && ready; j++) {
+				ready = items[item.dependencies[j]].state == STATE_LOADED;
+			}
+			if (!ready) {
+				continue;
+			}
+
+			if (ResourceCache::has(item.path)) {
+				// Loaded along with another resource of a previous wave.
+				item.resource = ResourceLoader::load(item.path);
+				item.state = item.resource.is_valid() ? STATE_LOADED : STATE_FAILED;
+				cached = true;
+				continue;
+			}
+
+			if (item.script) {
+				batch.push_back(i);
+			}
+		}
+
+		if (batch.empty()) {
+			if (cached) {
+				continue; // may have made other scripts ready
+			}
+			break;
+		}
+
+		pool->parallel_for(batch.size(), this, &GDScriptPreloader::_compile, (const int *)batch.data());
+
+		for (uint32_t i = 0; i < batch.size(); i++) {
+			Item &item = items[batch[i]];
+			Ref<GDScript> script = item.resource;
+			item.state = script.is_valid() && script->is_valid() ? STATE_LOADED : STATE_FAILED;
+		}
+	}
+
+	// Serial pass for the other scripts, in dependency order.
+	std::vector<int> order;
+	_sort_dependencies(order);
+
+	for (uint32_t i = 0; i < order.size(); i++) {
+		Item &item = items[order[i]];
+		if (!item.script || item.state == STATE_LOADED) {
+			continue;
+		}
+
+		// Compiling it would load other resources, leave it to its normal load.
+		bool skip = false;
+		for (uint32_t j = 0; j < item.dependencies.size() && !skip; j++) {
+			const Item &dependency = items[item.dependencies[j]];
+			skip = dependency.state == STATE_SKIPPED || (!dependency.script && dependency.state != STATE_LOADED);
+		}
+		if (skip) {
+			item.resource = RES();
+			item.state = STATE_SKIPPED;
+			continue;
+		}
+
+		// Scripts that failed on a worker didn't report anything, release them so they're loaded
+		// (and fail) again the usual way.
+		item.resource = RES();
+		item.resource = ResourceLoader::load(item.path);
+		item.state = item.resource.is_valid() ? STATE_LOADED : STATE_FAILED;
+	}
+
+	for (uint32_t i = 0; i < items.size(); i++) {
+		if (items[i].resource.is_valid()) {
+			r_loaded.push_back(items[i].resource);
+		}
+	}
+}
@@ -0,0 +1,109 @@
+/*************************************************************************/
+/*  gdscript_preloader.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_PRELOADER_H
+#define GDSCRIPT_PRELOADER_H
+
+#include "core/hash_map.h"
+#include "core/resource.h"
+
+#include <vector>
+
+class GDScriptTokenizer;
+
+// Compiles the GDScripts a set of resources depends on, on the ThreadPool.
+//
+// Dependencies are found by a quick scan of the source (of the tokens for compiled scripts):
+// preload and extends paths, and names of global classes and autoloads, which the parser may load
+// to resolve types. Other resources are only scanned, with ResourceLoader::get_dependencies(). The
+// scan doesn't need to be exact, see below. Then scripts are compiled in waves: those whose
+// dependencies are all loaded compile in parallel. No two threads ever load the same resource.
+//
+// Only scripts are loaded. Loading other resources may run script code (a resource's _init()),
+// which must see the same state as when they're loaded the usual way, e.g. autoloads instanced.
+// Scripts depending on such a resource are left to their normal load as well.
+//
+// On a worker, GDScriptParser and GDScriptCache may only use resources loaded before the wave. A
+// script needing anything else (a dependency the scan missed) fails without reporting errors, like
+// any script that fails there. Those, their dependents and scripts in dependency cycles are loaded
+// last on the calling thread in dependency order, so errors are reported as usual and in the same
+// order on every run.
+class GDScriptPreloader {
+
+	enum State {
+		STATE_PENDING,
+		STATE_LOADED,
+		STATE_FAILED,
+		STATE_SKIPPED, // Left to its normal load.
+	};
+
+	struct Item {
+		String path;
+		String remapped_path;
+		bool script; // Compiled on a worker.
+		bool scanned; // Dependencies are known, otherwise it's only loaded in the serial pass.
+		State state;
+		std::vector<String> found; // Dependency paths, filled by the scan.
+		std::vector<int> dependencies;
+		RES resource;
+	};
+
+	struct Name {
+		String name;
+		String path;
+	};
+
+	std::vector<Item> items;
+	HashMap<String, int> indices;
+	std::vector<Name> names; // Global classes and autoloads.
+	HashMap<uint32_t, std::vector<int> > name_hashes;
+
+	int _add_item(const String &p_path);
+	void _add_name(const String &p_name, const String &p_path);
+	const String *_find_name(const CharType *p_chars, int p_length) const;
+	void _scan_source(const String &p_source, Item &r_item) const;
+	void _scan_tokens(GDScriptTokenizer *p_tokenizer, Item &r_item) const;
+	void _scan_script(Item &r_item) const;
+	void _scan(uint32_t p_index, const int *p_items);
+	void _compile(uint32_t p_index, const int *p_items);
+	bool _is_loaded(const String &p_path) const;
+	void _sort_dependencies(std::vector<int> &r_order) const;
+
+public:
+	// True while the calling thread compiles a script for a preload.
+	static bool is_worker_thread();
+	// Whether the parser or GDScriptCache may load p_path, always true outside of preload workers.
+	static bool can_load(const String &p_path);
+
+	// Loads p_paths and their dependencies, appending everything that was loaded to r_loaded.
+	void preload(const std::vector<String> &p_paths, std::vector<RES> &r_loaded);
+};
+
+#endif // GDSCRIPT_PRELOADER_H
@@ -0,0 +1,166 @@
+/*************************************************************************/
+/*  gdscript_typed_ops.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_typed_ops.h"
+
+#include "core/variant_internal.h"
+
+typedef VariantInternal VI;
+
+// Kept in this order, compiled code (and the bytecode cache) refers to operators by index.
+#define NUMBER_OPERATORS(m_type_a, m_type_b)                                  \
+	{ Variant::OP_ADD, Variant::m_type_a, Variant::m_type_b },                \
+			{ Variant::OP_SUBTRACT, Variant::m_type_a, Variant::m_type_b },   \
+			{ Variant::OP_MULTIPLY, Variant::m_type_a, Variant::m_type_b },   \
+			{ Variant::OP_DIVIDE, Variant::m_type_a, Variant::m_type_b },     \
+			{ Variant::OP_EQUAL, Variant::m_type_a, Variant::m_type_b },      \
+			{ Variant::OP_NOT_EQUAL, Variant::m_type_a, Variant::m_type_b },  \
+			{ Variant::OP_LESS, Variant::m_type_a, Variant::m_type_b },       \
+			{ Variant::OP_LESS_EQUAL, Variant::m_type_a, Variant::m_type_b }, \
+			{ Variant::OP_GREATER, Variant::m_type_a, Variant::m_type_b },    \
+			{ Variant::OP_GREATER_EQUAL, Variant::m_type_a, Variant::m_type_b }
+
+#define VECTOR_OPERATORS(m_type)                                         \
+	{ Variant::OP_ADD, Variant::m_type, Variant::m_type },               \
+			{ Variant::OP_SUBTRACT, Variant::m_type, Variant::m_type },  \
+			{ Variant::OP_MULTIPLY, Variant::m_type, Variant::m_type },  \
+			{ Variant::OP_DIVIDE, Variant::m_type, Variant::m_type },    \
+			{ Variant::OP_MULTIPLY, Variant::m_type, Variant::INT },     \
+			{ Variant::OP_MULTIPLY, Variant::m_type, Variant::REAL },    \
+			{ Variant::OP_MULTIPLY, Variant::INT, Variant::m_type },     \
+			{ Variant::OP_MULTIPLY, Variant::REAL, Variant::m_type },    \
+			{ Variant::OP_DIVIDE, Variant::m_type, Variant::INT },       \
+			{ Variant::OP_DIVIDE, Variant::m_type, Variant::REAL },      \
+			{ Variant::OP_EQUAL, Variant::m_type, Variant::m_type },     \
+			{ Variant::OP_NOT_EQUAL, Variant::m_type, Variant::m_type }, \
+			{ Variant::OP_NEGATE, Variant::m_type, Variant::m_type }
+
+const GDScriptTypedOps::Operator GDScriptTypedOps::operators[] = {
+	NUMBER_OPERATORS(INT, INT),
+	NUMBER_OPERATORS(INT, REAL),
+	NUMBER_OPERATORS(REAL, INT),
+	NUMBER_OPERATORS(REAL, REAL),
+	{ Variant::OP_MODULE, Variant::INT, Variant::INT },
+	{ Variant::OP_BIT_AND, Variant::INT, Variant::INT },
+	{ Variant::OP_BIT_OR, Variant::INT, Variant::INT },
+	{ Variant::OP_BIT_XOR, Variant::INT, Variant::INT },
+	{ Variant::OP_NEGATE, Variant::INT, Variant::INT },
+	{ Variant::OP_NEGATE, Variant::REAL, Variant::REAL },
+	VECTOR_OPERATORS(VECTOR2),
+	VECTOR_OPERATORS(VECTOR3),
+};
+
+const int GDScriptTypedOps::operator_count = sizeof(GDScriptTypedOps::operators) / sizeof(GDScriptTypedOps::Operator);
+
+// Members of builtin types, only accepting the value types Variant::set_named() accepts for them.
+
+#define TYPED_REAL_MEMBER(m_name, m_get, m_member)                            \
+	static void _get_##m_name(const Variant &p_base, Variant *r_ret) {        \
+		double value = VI::m_get(&p_base)->m_member;                          \
+		VI::set_pod_type(r_ret, Variant::REAL);                               \
+		*VI::get_real(r_ret) = value;                                         \
+	}                                                                         \
+	static bool _set_##m_name(Variant *p_base, const Variant &p_value) {      \
+		if (p_value.get_type() == Variant::REAL) {                            \
+			VI::m_get(p_base)->m_member = *VI::get_real(&p_value);            \
+		} else if (p_value.get_type() == Variant::INT) {                      \
+			VI::m_get(p_base)->m_member = *VI::get_int(&p_value);             \
+		} else {                                                              \
+			return false;                                                     \
+		}                                                                     \
+		return true;                                                          \
+	}
+
+#define TYPED_VALUE_MEMBER(m_name, m_get, m_member, m_value_type, m_value_class) \
+	static void _get_##m_name(const Variant &p_base, Variant *r_ret) {           \
+		m_value_class value = VI::m_get(&p_base)->m_member;                      \
+		*r_ret = value;                                                          \
+	}                                                                            \
+	static bool _set_##m_name(Variant *p_base, const Variant &p_value) {         \
+		if (p_value.get_type() != Variant::m_value_type)                         \
+			return false;                                                        \
+		VI::m_get(p_base)->m_member = p_value;                                   \
+		return true;                                                             \
+	}
+
+TYPED_REAL_MEMBER(vector2_x, get_vector2, x)
+TYPED_REAL_MEMBER(vector2_y, get_vector2, y)
+TYPED_VALUE_MEMBER(rect2_position, get_rect2, position, VECTOR2, Vector2)
+TYPED_VALUE_MEMBER(rect2_size, get_rect2, size, VECTOR2, Vector2)
+TYPED_REAL_MEMBER(vector3_x, get_vector3, x)
+TYPED_REAL_MEMBER(vector3_y, get_vector3, y)
+TYPED_REAL_MEMBER(vector3_z, get_vector3, z)
+TYPED_REAL_MEMBER(color_r, get_color, r)
+TYPED_REAL_MEMBER(color_g, get_color, g)
+TYPED_REAL_MEMBER(color_b, get_color, b)
+TYPED_REAL_MEMBER(color_a, get_color, a)
+TYPED_VALUE_MEMBER(transform2d_origin, get_transform2d, elements[2], VECTOR2, Vector2)
+TYPED_VALUE_MEMBER(transform_origin, get_transform, origin, VECTOR3, Vector3)
+TYPED_VALUE_MEMBER(transform_basis, get_transform, basis, BASIS, Basis)
+
+#define MEMBER(m_type, m_name, m_func) \
+	{ Variant::m_type, m_name, _get_##m_func, _set_##m_func }
+
+const GDScriptTypedOps::Member GDScriptTypedOps::members[] = {
+	MEMBER(VECTOR2, "x", vector2_x),
+	MEMBER(VECTOR2, "y", vector2_y),
+	MEMBER(RECT2, "position", rect2_position),
+	MEMBER(RECT2, "size", rect2_size),
+	MEMBER(VECTOR3, "x", vector3_x),
+	MEMBER(VECTOR3, "y", vector3_y),
+	MEMBER(VECTOR3, "z", vector3_z),
+	MEMBER(COLOR, "r", color_r),
+	MEMBER(COLOR, "g", color_g),
+	MEMBER(COLOR, "b", color_b),
+	MEMBER(COLOR, "a", color_a),
+	MEMBER(TRANSFORM2D, "origin", transform2d_origin),
+	MEMBER(TRANSFORM, "origin", transform_origin),
+	MEMBER(TRANSFORM, "basis", transform_basis),
+};
+
+const int GDScriptTypedOps::member_count = sizeof(GDScriptTypedOps::members) / sizeof(GDScriptTypedOps::Member);
+
+int GDScriptTypedOps::find_operator(Variant::Operator p_op, Variant::Type p_a, Variant::Type p_b) {
+
+	for (int i = 0; i < operator_count; i++) {
+		if (operators[i].op == p_op && operators[i].type_a == p_a && operators[i].type_b == p_b)
+			return i;
+	}
+	return -1;
+}
+
+int GDScriptTypedOps::find_member(Variant::Type p_type, const StringName &p_name) {
+
+	for (int i = 0; i < member_count; i++) {
+		if (members[i].type == p_type && p_name == members[i].name)
+			return i;
+	}
+	return -1;
+}
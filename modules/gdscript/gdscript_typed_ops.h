@@ -0,0 +1,69 @@
+/*************************************************************************/
+/*  gdscript_typed_ops.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_TYPED_OPS_H
+#define GDSCRIPT_TYPED_OPS_H
+
+#include "core/variant.h"
+
+// Operations the compiler can bind ahead of time when the parser knows the types involved.
+// The VM still checks the types before using them (static types aren't guaranteed at runtime,
+// e.g. an int may be stored in a float variable) and falls back to the generic path otherwise.
+class GDScriptTypedOps {
+public:
+	typedef void (*MemberGetFunc)(const Variant &p_base, Variant *r_ret);
+	typedef bool (*MemberSetFunc)(Variant *p_base, const Variant &p_value);
+
+	// Evaluated by Variant::get_operator_evaluator(), these types have a dedicated evaluator which
+	// only fails on division by zero.
+	struct Operator {
+		Variant::Operator op;
+		Variant::Type type_a;
+		Variant::Type type_b; // same as type_a for unary operators
+	};
+
+	struct Member {
+		Variant::Type type;
+		const char *name;
+		MemberGetFunc get;
+		MemberSetFunc set;
+	};
+
+	static const Operator operators[];
+	static const int operator_count;
+	static const Member members[];
+	static const int member_count;
+
+	// Return the index in the tables above, or -1 if there is no fast path.
+	static int find_operator(Variant::Operator p_op, Variant::Type p_a, Variant::Type p_b);
+	static int find_member(Variant::Type p_type, const StringName &p_name);
+};
+
+#endif // GDSCRIPT_TYPED_OPS_H
@@ -154,6 +154,7 @@ void register_gdscript_types() {
 
 	ClassDB::register_class<GDScript>();
 	ClassDB::register_virtual_class<GDScriptFunctionState>();
+	ClassDB::register_virtual_class<GDScriptSignalWaiters>();
 
 	script_language_gd = memnew(GDScriptLanguage);
 	ScriptServer::register_language(script_language_gd);
@@ -1272,7 +1272,7 @@ public:
 				}
 
 				bool valid = true;
-				Variant::evaluate(op->op, a, b, r_ret, valid);
+				Variant::get_operator_evaluator(op->op, a.get_type(), b.get_type())(a, b, r_ret, valid);
 				if (!valid) {
 					r_error_str = "Invalid operands to operator " + Variant::get_operator_name(op->op) + ": " + Variant::get_type_name(a.get_type()) + " and " + Variant::get_type_name(b.get_type()) + ".";
 					return true;
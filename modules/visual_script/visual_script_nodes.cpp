@@ -1036,9 +1036,9 @@ public:
 		bool valid;
 		if (unary) {
 
-			Variant::evaluate(op, *p_inputs[0], Variant(), *p_outputs[0], valid);
+			Variant::get_operator_evaluator(op, p_inputs[0]->get_type(), Variant::NIL)(*p_inputs[0], Variant(), *p_outputs[0], valid);
 		} else {
-			Variant::evaluate(op, *p_inputs[0], *p_inputs[1], *p_outputs[0], valid);
+			Variant::get_operator_evaluator(op, p_inputs[0]->get_type(), p_inputs[1]->get_type())(*p_inputs[0], *p_inputs[1], *p_outputs[0], valid);
 		}
 
 		if (!valid) {
@@ -575,7 +575,7 @@ void CanvasItem::_notification(int p_what) {
 			}
 			_enter_canvas();
 			if (!block_transform_notify && !xform_change.in_list()) {
-				get_tree()->xform_change_list.add(&xform_change);
+				get_tree()->_add_xform_change(&xform_change);
 			}
 		} break;
 		case NOTIFICATION_MOVED_IN_PARENT: {
@@ -944,7 +944,7 @@ void CanvasItem::_notify_transform(CanvasItem *p_node) {
 	if (p_node->notify_transform && !p_node->xform_change.in_list()) {
 		if (!p_node->block_transform_notify) {
 			if (p_node->is_inside_tree())
-				get_tree()->xform_change_list.add(&p_node->xform_change);
+				get_tree()->_add_xform_change(&p_node->xform_change);
 		}
 	}
 
@@ -1089,11 +1089,21 @@ Vector2 CanvasItem::get_local_mouse_position() const {
 	return get_global_transform().affine_inverse().xform(get_global_mouse_position());
 }
 
+void CanvasItem::_set_canvas_item_transform(const Transform2D &p_transform) {
+
+	if (is_inside_tree()) {
+		get_tree()->_set_canvas_item_transform(canvas_item, p_transform);
+	} else {
+		VisualServer::get_singleton()->canvas_item_set_transform(canvas_item, p_transform);
+	}
+}
+
 void CanvasItem::force_update_transform() {
 	ERR_FAIL_COND(!is_inside_tree());
 	if (!xform_change.in_list()) {
 		return;
 	}
+	ERR_FAIL_COND_MSG(get_tree()->is_processing_threaded(), "Transform notifications are sent after the process thread group, force_update_transform() failed. Consider using call_deferred(\"force_update_transform\") instead.");
 
 	get_tree()->xform_change_list.remove(&xform_change);
 
@@ -234,6 +234,8 @@ protected:
 	}
 
 	void item_rect_changed(bool p_size_changed = true);
+	// Queued until the batch ends when called from a process thread group.
+	void _set_canvas_item_transform(const Transform2D &p_transform);
 
 	void _notification(int p_what);
 	static void _bind_methods();
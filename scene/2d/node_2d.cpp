@@ -133,7 +133,7 @@ void Node2D::_update_transform() {
 	_mat.set_rotation_and_scale(angle, _scale);
 	_mat.elements[2] = pos;
 
-	VisualServer::get_singleton()->canvas_item_set_transform(get_canvas_item(), _mat);
+	_set_canvas_item_transform(_mat);
 
 	if (!is_inside_tree())
 		return;
@@ -311,7 +311,7 @@ void Node2D::set_transform(const Transform2D &p_transform) {
 	_mat = p_transform;
 	_xform_dirty = true;
 
-	VisualServer::get_singleton()->canvas_item_set_transform(get_canvas_item(), _mat);
+	_set_canvas_item_transform(_mat);
 
 	if (!is_inside_tree())
 		return;
@@ -31,6 +31,7 @@
 #ifndef RAY_CAST_2D_H
 #define RAY_CAST_2D_H
 
+#include "core/vset.h"
 #include "scene/2d/node_2d.h"
 
 class RayCast2D : public Node2D {
@@ -43,7 +44,7 @@ class RayCast2D : public Node2D {
 	int against_shape;
 	Vector2 collision_point;
 	Vector2 collision_normal;
-	Set<RID> exclude;
+	VSet<RID> exclude;
 	uint32_t collision_mask;
 	bool exclude_parent_body;
 
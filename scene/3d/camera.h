@@ -33,6 +33,7 @@
 
 #include <vector>
 
+#include "core/vset.h"
 #include "scene/3d/spatial.h"
 #include "scene/3d/spatial_velocity_tracker.h"
 #include "scene/main/viewport.h"
@@ -200,7 +201,7 @@ private:
 	bool clip_to_areas;
 	bool clip_to_bodies;
 
-	Set<RID> exclude;
+	VSet<RID> exclude;
 
 	std::vector<Vector3> points;
 
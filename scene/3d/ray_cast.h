@@ -31,6 +31,7 @@
 #ifndef RAY_CAST_H
 #define RAY_CAST_H
 
+#include "core/vset.h"
 #include "scene/3d/spatial.h"
 
 class RayCast : public Spatial {
@@ -45,7 +46,7 @@ class RayCast : public Spatial {
 	Vector3 collision_normal;
 
 	Vector3 cast_to;
-	Set<RID> exclude;
+	VSet<RID> exclude;
 
 	uint32_t collision_mask;
 	bool exclude_parent_body;
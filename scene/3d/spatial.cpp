@@ -81,7 +81,7 @@ void Spatial::_notify_dirty() {
 	if (data.notify_transform && !data.ignore_notification && !xform_change.in_list()) {
 
 #endif
-		get_tree()->xform_change_list.add(&xform_change);
+		get_tree()->_add_xform_change(&xform_change);
 	}
 }
 
@@ -114,7 +114,7 @@ void Spatial::_propagate_transform_changed(Spatial *p_origin) {
 #else
 	if (data.notify_transform && !data.ignore_notification && !xform_change.in_list()) {
 #endif
-		get_tree()->xform_change_list.add(&xform_change);
+		get_tree()->_add_xform_change(&xform_change);
 	}
 	data.dirty |= DIRTY_GLOBAL;
 
@@ -728,6 +728,7 @@ void Spatial::force_update_transform() {
 	if (!xform_change.in_list()) {
 		return; //nothing to update
 	}
+	ERR_FAIL_COND_MSG(get_tree()->is_processing_threaded(), "Transform notifications are sent after the process thread group, force_update_transform() failed. Consider using call_deferred(\"force_update_transform\") instead.");
 	get_tree()->xform_change_list.remove(&xform_change);
 
 	notification(NOTIFICATION_TRANSFORM_CHANGED);
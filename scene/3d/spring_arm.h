@@ -31,13 +31,14 @@
 #ifndef SPRING_ARM_H
 #define SPRING_ARM_H
 
+#include "core/vset.h"
 #include "scene/3d/spatial.h"
 
 class SpringArm : public Spatial {
 	GDCLASS(SpringArm, Spatial);
 
 	Ref<Shape> shape;
-	Set<RID> excluded_objects;
+	VSet<RID> excluded_objects;
 	float spring_length;
 	float current_spring_length;
 	bool keep_child_basis;
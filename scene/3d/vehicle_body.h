@@ -164,7 +164,7 @@ class VehicleBody : public RigidBody {
 	real_t m_steeringValue;
 	real_t m_currentVehicleSpeedKmHour;
 
-	Set<RID> exclude;
+	VSet<RID> exclude;
 
 	std::vector<Vector3> m_forwardWS;
 	std::vector<Vector3> m_axle;
@@ -68,10 +68,19 @@ void VisualInstance::_notification(int p_what) {
 		case NOTIFICATION_TRANSFORM_CHANGED: {
 
 			Transform gt = get_global_transform();
-			VisualServer::get_singleton()->instance_set_transform(instance, gt);
+			SceneTree *tree = is_inside_tree() ? get_tree() : NULL;
+			if (tree && tree->xform_batching) {
+				tree->xform_batch_instances.push_back(instance);
+				tree->xform_batch_transforms.push_back(gt);
+			} else {
+				VisualServer::get_singleton()->instance_set_transform(instance, gt);
+			}
 		} break;
 		case NOTIFICATION_EXIT_WORLD: {
 
+			// The instance may be freed next, send any transform still queued for it first.
+			get_tree()->_flush_transform_batch();
+
 			VisualServer::get_singleton()->instance_set_scenario(instance, RID());
 			VisualServer::get_singleton()->instance_attach_skeleton(instance, RID());
 			//VS::get_singleton()->instance_geometry_set_baked_light_sampler(instance, RID() );
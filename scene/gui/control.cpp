@@ -466,7 +466,7 @@ void Control::_update_canvas_item_transform() {
 		xform[2] = xform[2].round();
 	}
 
-	VisualServer::get_singleton()->canvas_item_set_transform(get_canvas_item(), xform);
+	_set_canvas_item_transform(xform);
 }
 
 void Control::_notification(int p_notification) {
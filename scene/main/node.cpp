@@ -216,8 +216,10 @@ void Node::_propagate_enter_tree() {
 	data.inside_tree = true;
 
 	for (Map<StringName, GroupData>::Element *E = data.grouped.front(); E; E = E->next()) {
-		E->get().group = data.tree->add_to_group(E->key(), this);
+		E->get().group = data.tree->add_to_group(E->key(), this, &E->get().index);
 	}
+	if (data.process_thread_group)
+		data.tree->process_thread_group_nodes++;
 
 	notification(NOTIFICATION_ENTER_TREE);
 
@@ -309,9 +311,11 @@ void Node::_propagate_exit_tree() {
 	// exit groups
 
 	for (Map<StringName, GroupData>::Element *E = data.grouped.front(); E; E = E->next()) {
-		data.tree->remove_from_group(E->key(), this);
+		data.tree->remove_from_group(E->key(), this, E->get().index);
 		E->get().group = NULL;
 	}
+	if (data.process_thread_group)
+		data.tree->process_thread_group_nodes--;
 
 	data.viewport = NULL;
 
@@ -330,6 +334,7 @@ void Node::move_child(Node *p_child, int p_pos) {
 	ERR_FAIL_INDEX_MSG(p_pos, data.children.size() + 1, "Invalid new child position: " + itos(p_pos) + ".");
 	ERR_FAIL_COND_MSG(p_child->data.parent != this, "Child is not a child of this node.");
 	ERR_FAIL_COND_MSG(data.blocked > 0, "Parent node is busy setting up children, move_child() failed. Consider using call_deferred(\"move_child\") instead (or \"popup\" if this is from a popup).");
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, move_child() failed. Consider using call_deferred(\"move_child\", child, position) instead.");
 
 	// Specifying one place beyond the end
 	// means the same as moving to the last position
@@ -395,6 +400,7 @@ void Node::set_physics_process(bool p_process) {
 
 	if (data.physics_process == p_process)
 		return;
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, set_physics_process() failed. Consider using call_deferred(\"set_physics_process\", process) instead.");
 
 	data.physics_process = p_process;
 
@@ -415,6 +421,7 @@ void Node::set_physics_process_internal(bool p_process_internal) {
 
 	if (data.physics_process_internal == p_process_internal)
 		return;
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, set_physics_process_internal() failed. Consider using call_deferred(\"set_physics_process_internal\", process_internal) instead.");
 
 	data.physics_process_internal = p_process_internal;
 
@@ -794,6 +801,7 @@ void Node::set_process(bool p_idle_process) {
 
 	if (data.idle_process == p_idle_process)
 		return;
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, set_process() failed. Consider using call_deferred(\"set_process\", process) instead.");
 
 	data.idle_process = p_idle_process;
 
@@ -814,6 +822,7 @@ void Node::set_process_internal(bool p_idle_process_internal) {
 
 	if (data.idle_process_internal == p_idle_process_internal)
 		return;
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, set_process_internal() failed. Consider using call_deferred(\"set_process_internal\", process_internal) instead.");
 
 	data.idle_process_internal = p_idle_process_internal;
 
@@ -848,10 +857,30 @@ void Node::set_process_priority(int p_priority) {
 		data.tree->make_group_changed("physics_process_internal");
 }
 
+void Node::set_process_thread_group(int p_thread_group) {
+
+	ERR_FAIL_COND(p_thread_group < 0);
+	if (data.process_thread_group == p_thread_group)
+		return;
+
+	if (data.tree) {
+		ERR_FAIL_COND_MSG(data.tree->is_processing_threaded(), "Node is being processed in a process thread group, set_process_thread_group() failed. Consider using call_deferred(\"set_process_thread_group\", thread_group) instead.");
+		data.tree->process_thread_group_nodes += (p_thread_group != 0) - (data.process_thread_group != 0);
+	}
+
+	data.process_thread_group = p_thread_group;
+}
+
+int Node::get_process_thread_group() const {
+
+	return data.process_thread_group;
+}
+
 void Node::set_process_input(bool p_enable) {
 
 	if (p_enable == data.input)
 		return;
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, set_process_input() failed. Consider using call_deferred(\"set_process_input\", enable) instead.");
 
 	data.input = p_enable;
 	if (!is_inside_tree())
@@ -871,6 +900,7 @@ void Node::set_process_unhandled_input(bool p_enable) {
 
 	if (p_enable == data.unhandled_input)
 		return;
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, set_process_unhandled_input() failed. Consider using call_deferred(\"set_process_unhandled_input\", enable) instead.");
 	data.unhandled_input = p_enable;
 	if (!is_inside_tree())
 		return;
@@ -889,6 +919,7 @@ void Node::set_process_unhandled_key_input(bool p_enable) {
 
 	if (p_enable == data.unhandled_key_input)
 		return;
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, set_process_unhandled_key_input() failed. Consider using call_deferred(\"set_process_unhandled_key_input\", enable) instead.");
 	data.unhandled_key_input = p_enable;
 	if (!is_inside_tree())
 		return;
@@ -1161,6 +1192,7 @@ void Node::add_child(Node *p_child, bool p_legible_unique_name) {
 	ERR_FAIL_COND_MSG(p_child == this, "Can't add child '" + p_child->get_name() + "' to itself."); // adding to itself!
 	ERR_FAIL_COND_MSG(p_child->data.parent, "Can't add child '" + p_child->get_name() + "' to '" + get_name() + "', already has a parent '" + p_child->data.parent->get_name() + "'."); //Fail if node has a parent
 	ERR_FAIL_COND_MSG(data.blocked > 0, "Parent node is busy setting up children, add_node() failed. Consider using call_deferred(\"add_child\", child) instead.");
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, add_child() failed. Consider using call_deferred(\"add_child\", child) instead.");
 
 	/* Validate name */
 	_validate_child_name(p_child, p_legible_unique_name);
@@ -1216,6 +1248,7 @@ void Node::remove_child(Node *p_child) {
 
 	ERR_FAIL_NULL(p_child);
 	ERR_FAIL_COND_MSG(data.blocked > 0, "Parent node is busy setting up children, remove_node() failed. Consider using call_deferred(\"remove_child\", child) instead.");
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, remove_child() failed. Consider using call_deferred(\"remove_child\", child) instead.");
 
 	auto child_count = data.children.size();
 	Node **children = data.children.data();
@@ -1661,20 +1694,19 @@ void Node::add_to_group(const StringName &p_identifier, bool p_persistent) {
 
 	ERR_FAIL_COND(!p_identifier.operator String().length());
 
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, add_to_group() failed. Consider using call_deferred(\"add_to_group\", group) instead.");
+
 	if (data.grouped.has(p_identifier))
 		return;
 
-	GroupData gd;
+	// Inserted first, the tree keeps a pointer to its index.
+	GroupData &gd = data.grouped[p_identifier];
 
 	if (data.tree) {
-		gd.group = data.tree->add_to_group(p_identifier, this);
-	} else {
-		gd.group = NULL;
+		gd.group = data.tree->add_to_group(p_identifier, this, &gd.index);
 	}
 
 	gd.persistent = p_persistent;
-
-	data.grouped[p_identifier] = gd;
 }
 
 void Node::remove_from_group(const StringName &p_identifier) {
@@ -1684,9 +1716,10 @@ void Node::remove_from_group(const StringName &p_identifier) {
 	Map<StringName, GroupData>::Element *E = data.grouped.find(p_identifier);
 
 	ERR_FAIL_COND(!E);
+	ERR_FAIL_COND_MSG(data.tree && data.tree->is_processing_threaded(), "Node is being processed in a process thread group, remove_from_group() failed. Consider using call_deferred(\"remove_from_group\", group) instead.");
 
 	if (data.tree)
-		data.tree->remove_from_group(E->key(), this);
+		data.tree->remove_from_group(E->key(), this, E->get().index);
 
 	data.grouped.erase(E);
 }
@@ -2749,6 +2782,8 @@ void Node::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_process_delta_time"), &Node::get_process_delta_time);
 	ClassDB::bind_method(D_METHOD("set_process", "enable"), &Node::set_process);
 	ClassDB::bind_method(D_METHOD("set_process_priority", "priority"), &Node::set_process_priority);
+	ClassDB::bind_method(D_METHOD("set_process_thread_group", "thread_group"), &Node::set_process_thread_group);
+	ClassDB::bind_method(D_METHOD("get_process_thread_group"), &Node::get_process_thread_group);
 	ClassDB::bind_method(D_METHOD("is_processing"), &Node::is_processing);
 	ClassDB::bind_method(D_METHOD("set_process_input", "enable"), &Node::set_process_input);
 	ClassDB::bind_method(D_METHOD("is_processing_input"), &Node::is_processing_input);
@@ -2876,6 +2911,7 @@ void Node::_bind_methods() {
 
 	ADD_GROUP("Pause", "pause_");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "pause_mode", PROPERTY_HINT_ENUM, "Inherit,Stop,Process"), "set_pause_mode", "get_pause_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "process_thread_group", PROPERTY_HINT_RANGE, "0,64,1,or_greater"), "set_process_thread_group", "get_process_thread_group");
 
 #ifdef ENABLE_DEPRECATED
 	//no longer exists, but remains for compatibility (keep previous scenes folded
@@ -2919,6 +2955,7 @@ Node::Node() {
 	data.physics_process = false;
 	data.idle_process = false;
 	data.process_priority = 0;
+	data.process_thread_group = 0;
 	data.physics_process_internal = false;
 	data.idle_process_internal = false;
 	data.inside_tree = false;
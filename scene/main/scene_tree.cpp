@@ -36,6 +36,7 @@
 #include "core/os/dir_access.h"
 #include "core/os/keyboard.h"
 #include "core/os/os.h"
+#include "core/os/thread_pool.h"
 #include "core/print_string.h"
 #include "core/project_settings.h"
 #include "main/input_default.h"
@@ -47,6 +48,7 @@
 #include "scene/scene_string_names.h"
 #include "servers/physics_2d_server.h"
 #include "servers/physics_server.h"
+#include "servers/visual_server.h"
 #include "viewport.h"
 
 #include <stdio.h>
@@ -109,45 +111,82 @@ void SceneTree::node_renamed(Node *p_node) {
 	emit_signal(node_renamed_name, p_node);
 }
 
-SceneTree::Group *SceneTree::add_to_group(const StringName &p_group, Node *p_node) {
+SceneTree::Group *SceneTree::add_to_group(const StringName &p_group, Node *p_node, int *r_index) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
-		E = group_map.insert(p_group, Group());
-	}
+	Group &g = group_map[p_group];
+
+	ERR_FAIL_COND_V_MSG(*r_index >= 0 && *r_index < (int)g.nodes.size() && g.nodes[*r_index].node == p_node, &g, "Already in group: " + p_group + ".");
 
-	auto &nodes = E->get().nodes;
-	ERR_FAIL_COND_V_MSG(std::find(nodes.begin(), nodes.end(), p_node) != nodes.end(), &E->get(), "Already in group: " + p_group + ".");
-	nodes.push_back(p_node);
-	//E->get().last_tree_version=0;
-	E->get().changed = true;
-	return &E->get();
+	GroupMember member;
+	member.node = p_node;
+	member.index = r_index;
+	*r_index = g.nodes.size();
+	g.nodes.push_back(member);
+	//g.last_tree_version=0;
+	return &g;
 }
 
-void SceneTree::remove_from_group(const StringName &p_group, Node *p_node) {
+void SceneTree::remove_from_group(const StringName &p_group, Node *p_node, int p_index) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	ERR_FAIL_COND(!E);
+	Group *g = group_map.getptr(p_group);
+	ERR_FAIL_COND(!g);
+	ERR_FAIL_INDEX(p_index, (int)g->nodes.size());
+	ERR_FAIL_COND(g->nodes[p_index].node != p_node);
 
-	auto &nodes = E->get().nodes;
+	*g->nodes[p_index].index = -1;
 
-	auto it_node = std::find(nodes.begin(), nodes.end(), p_node);
-	if (it_node != nodes.end()) {
-		nodes.erase(it_node);
+	if (p_index == (int)g->nodes.size() - 1 && !g->iterating) {
+		g->nodes.pop_back();
+		g->sorted = MIN(g->sorted, p_index);
+	} else {
+		g->nodes[p_index].node = NULL;
+		g->holes++;
 	}
 
-	if (nodes.empty())
-		group_map.erase(E);
+	if (g->iterating)
+		return;
+
+	if (g->holes == (int)g->nodes.size()) {
+		group_map.erase(p_group);
+	} else if (g->holes > (int)g->nodes.size() / 2) {
+		// Keep groups nobody walks (and so never get compacted) from growing forever.
+		_compact_group(*g);
+	}
 }
 
 void SceneTree::make_group_changed(const StringName &p_group) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (E)
-		E->get().changed = true;
+	Group *g = group_map.getptr(p_group);
+	if (g)
+		g->changed = true;
+}
+
+void SceneTree::_add_xform_change(SelfList<Node> *p_change) {
+
+	if (threaded_process) {
+		_get_threaded_transform_changes()->xform_change_list.add(p_change);
+		return;
+	}
+
+	xform_change_list.add(p_change);
+}
+
+void SceneTree::_set_canvas_item_transform(RID p_canvas_item, const Transform2D &p_transform) {
+
+	if (threaded_process) {
+		ThreadedTransformChanges *changes = _get_threaded_transform_changes();
+		changes->canvas_items.push_back(p_canvas_item);
+		changes->canvas_item_transforms.push_back(p_transform);
+		return;
+	}
+
+	VisualServer::get_singleton()->canvas_item_set_transform(p_canvas_item, p_transform);
 }
 
 void SceneTree::flush_transform_notifications() {
 
+	bool was_batching = xform_batching;
+	xform_batching = true;
+
 	SelfList<Node> *n = xform_change_list.first();
 	while (n) {
 
@@ -157,6 +196,22 @@ void SceneTree::flush_transform_notifications() {
 		n = nx;
 		node->notification(NOTIFICATION_TRANSFORM_CHANGED);
 	}
+
+	xform_batching = was_batching;
+	if (!xform_batching) {
+		_flush_transform_batch();
+	}
+}
+
+void SceneTree::_flush_transform_batch() {
+
+	if (xform_batch_instances.empty()) {
+		return;
+	}
+
+	VisualServer::get_singleton()->instance_set_transforms(xform_batch_instances.data(), xform_batch_transforms.data(), xform_batch_instances.size());
+	xform_batch_instances.clear();
+	xform_batch_transforms.clear();
 }
 
 void SceneTree::_flush_ugc() {
@@ -179,32 +234,102 @@ void SceneTree::_flush_ugc() {
 	ugc_locked = false;
 }
 
+template <class C>
+struct _GroupMemberComparator {
+
+	C compare;
+
+	template <class T>
+	_FORCE_INLINE_ bool operator()(const T &p_a, const T &p_b) const { return compare(p_a.node, p_b.node); }
+};
+
+// Sorts the members appended after p_sorted and merges them into the already sorted ones.
+template <class C, class T>
+static void _sort_group_members(T *p_members, int p_sorted, int p_count) {
+
+	SortArray<T, _GroupMemberComparator<C> > member_sort;
+	member_sort.sort(p_members + p_sorted, p_count - p_sorted);
+	if (p_sorted > 0) {
+		std::inplace_merge(p_members, p_members + p_sorted, p_members + p_count, member_sort.compare);
+	}
+}
+
 void SceneTree::_update_group_order(Group &g, bool p_use_priority) {
 
-	if (!g.changed)
-		return;
-	if (g.nodes.empty())
-		return;
+	if (g.iterating)
+		return; // reordered once the iteration is over
+
+	if (g.holes)
+		_compact_group(g);
 
-	Node **nodes = g.nodes.data();
 	int node_count = g.nodes.size();
+	if (g.changed) {
+		g.sorted = 0;
+		g.changed = false;
+	}
+	if (g.sorted == node_count)
+		return;
+
+	GroupMember *nodes = g.nodes.data();
 
 	if (p_use_priority) {
-		SortArray<Node *, Node::ComparatorWithPriority> node_sort;
-		node_sort.sort(nodes, node_count);
+		_sort_group_members<Node::ComparatorWithPriority>(nodes, g.sorted, node_count);
 	} else {
-		SortArray<Node *, Node::Comparator> node_sort;
-		node_sort.sort(nodes, node_count);
+		_sort_group_members<Node::Comparator>(nodes, g.sorted, node_count);
+	}
+
+	for (int i = 0; i < node_count; i++) {
+		*nodes[i].index = i;
+	}
+	g.sorted = node_count;
+}
+
+void SceneTree::_compact_group(Group &g) {
+
+	int node_count = g.nodes.size();
+	int to = 0;
+	int sorted = 0;
+
+	for (int from = 0; from < node_count; from++) {
+
+		if (!g.nodes[from].node)
+			continue;
+
+		if (from < g.sorted)
+			sorted++;
+		if (to != from) {
+			g.nodes[to] = g.nodes[from];
+			*g.nodes[to].index = to;
+		}
+		to++;
+	}
+
+	g.nodes.resize(to);
+	g.sorted = sorted;
+	g.holes = 0;
+}
+
+void SceneTree::_end_group_iteration(const StringName &p_group, Group &g) {
+
+	g.iterating--;
+	if (g.iterating)
+		return;
+
+	if (g.holes == (int)g.nodes.size()) {
+		group_map.erase(p_group);
+	} else if (g.holes) {
+		_compact_group(g);
 	}
-	g.changed = false;
 }
 
 void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_group, const StringName &p_function, VARIANT_ARG_DECLARE) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	ERR_FAIL_COND_MSG(threaded_process, "Groups can't be walked from a process thread group, call_group() failed. Consider using call_deferred(\"call_group\", ...) instead.");
+
+	Group *gp = group_map.getptr(p_group);
+	if (!gp)
 		return;
-	Group &g = E->get();
+	Group &g = *gp;
 	if (g.nodes.empty())
 		return;
 
@@ -234,33 +359,35 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 
 	_update_group_order(g);
 
-	std::vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = nodes_copy.data();
-	auto node_count = nodes_copy.size();
+	// Nodes added during the calls are appended past node_count and not called.
+	int node_count = g.nodes.size();
 
+	g.iterating++;
 	call_lock++;
 
 	if (p_call_flags & GROUP_CALL_REVERSE) {
 
 		for (int i = node_count - 1; i >= 0; i--) {
 
-			if (call_lock && call_skip.has(nodes[i]))
+			Node *node = g.nodes[i].node;
+			if (!node || (call_lock && call_skip.has(node)))
 				continue;
 
 			if (p_call_flags & GROUP_CALL_REALTIME) {
 				if (p_call_flags & GROUP_CALL_MULTILEVEL)
-					nodes[i]->call_multilevel(p_function, VARIANT_ARG_PASS);
+					node->call_multilevel(p_function, VARIANT_ARG_PASS);
 				else
-					nodes[i]->call(p_function, VARIANT_ARG_PASS);
+					node->call(p_function, VARIANT_ARG_PASS);
 			} else
-				MessageQueue::get_singleton()->push_call(nodes[i], p_function, VARIANT_ARG_PASS);
+				MessageQueue::get_singleton()->push_call(node, p_function, VARIANT_ARG_PASS);
 		}
 
 	} else {
 
-		for (auto &&node : nodes_copy) {
+		for (int i = 0; i < node_count; i++) {
 
-			if (call_lock && call_skip.has(node))
+			Node *node = g.nodes[i].node;
+			if (!node || (call_lock && call_skip.has(node)))
 				continue;
 
 			if (p_call_flags & GROUP_CALL_REALTIME) {
@@ -276,40 +403,48 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 	call_lock--;
 	if (call_lock == 0)
 		call_skip.clear();
+
+	_end_group_iteration(p_group, g);
 }
 
 void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_group, int p_notification) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	ERR_FAIL_COND_MSG(threaded_process, "Groups can't be walked from a process thread group, notify_group() failed. Consider using call_deferred(\"notify_group\", ...) instead.");
+
+	Group *gp = group_map.getptr(p_group);
+	if (!gp)
 		return;
-	Group &g = E->get();
+	Group &g = *gp;
 	if (g.nodes.empty())
 		return;
 
 	_update_group_order(g);
 
-	std::vector<Node *> nodes_copy = g.nodes;
+	int node_count = g.nodes.size();
 
+	g.iterating++;
 	call_lock++;
 
 	if (p_call_flags & GROUP_CALL_REVERSE) {
 
-		std::for_each(nodes_copy.rbegin(), nodes_copy.rend(), [&](Node *node) {
-			if (call_lock && call_skip.has(node))
-				return;
+		for (int i = node_count - 1; i >= 0; i--) {
+
+			Node *node = g.nodes[i].node;
+			if (!node || (call_lock && call_skip.has(node)))
+				continue;
 
 			if (p_call_flags & GROUP_CALL_REALTIME)
 				node->notification(p_notification);
 			else
 				MessageQueue::get_singleton()->push_notification(node, p_notification);
-		});
+		}
 
 	} else {
 
-		for (auto &&node : nodes_copy) {
+		for (int i = 0; i < node_count; i++) {
 
-			if (call_lock && call_skip.has(node))
+			Node *node = g.nodes[i].node;
+			if (!node || (call_lock && call_skip.has(node)))
 				continue;
 
 			if (p_call_flags & GROUP_CALL_REALTIME)
@@ -322,40 +457,48 @@ void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_gr
 	call_lock--;
 	if (call_lock == 0)
 		call_skip.clear();
+
+	_end_group_iteration(p_group, g);
 }
 
 void SceneTree::set_group_flags(uint32_t p_call_flags, const StringName &p_group, const String &p_name, const Variant &p_value) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	ERR_FAIL_COND_MSG(threaded_process, "Groups can't be walked from a process thread group, set_group() failed. Consider using call_deferred(\"set_group\", ...) instead.");
+
+	Group *gp = group_map.getptr(p_group);
+	if (!gp)
 		return;
-	Group &g = E->get();
+	Group &g = *gp;
 	if (g.nodes.empty())
 		return;
 
 	_update_group_order(g);
 
-	std::vector<Node *> nodes_copy = g.nodes;
+	int node_count = g.nodes.size();
 
+	g.iterating++;
 	call_lock++;
 
 	if (p_call_flags & GROUP_CALL_REVERSE) {
 
-		std::for_each(nodes_copy.rbegin(), nodes_copy.rend(), [&](Node *node) {
-			if (call_lock && call_skip.has(node))
-				return;
+		for (int i = node_count - 1; i >= 0; i--) {
+
+			Node *node = g.nodes[i].node;
+			if (!node || (call_lock && call_skip.has(node)))
+				continue;
 
 			if (p_call_flags & GROUP_CALL_REALTIME)
 				node->set(p_name, p_value);
 			else
 				MessageQueue::get_singleton()->push_set(node, p_name, p_value);
-		});
+		}
 
 	} else {
 
-		for (auto &&node : nodes_copy) {
+		for (int i = 0; i < node_count; i++) {
 
-			if (call_lock && call_skip.has(node))
+			Node *node = g.nodes[i].node;
+			if (!node || (call_lock && call_skip.has(node)))
 				continue;
 
 			if (p_call_flags & GROUP_CALL_REALTIME)
@@ -368,6 +511,8 @@ void SceneTree::set_group_flags(uint32_t p_call_flags, const StringName &p_group
 	call_lock--;
 	if (call_lock == 0)
 		call_skip.clear();
+
+	_end_group_iteration(p_group, g);
 }
 
 void SceneTree::call_group(const StringName &p_group, const StringName &p_function, VARIANT_ARG_DECLARE) {
@@ -888,76 +1033,204 @@ bool SceneTree::is_paused() const {
 
 void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p_method, const Ref<InputEvent> &p_input) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *gp = group_map.getptr(p_group);
+	if (!gp)
 		return;
-	Group &g = E->get();
+	Group &g = *gp;
 	if (g.nodes.empty())
 		return;
 
 	_update_group_order(g);
 
-	//copy, so copy on write happens in case something is removed from process while being called
-	//performance is not lost because only if something is added/removed the vector is copied.
-
 	Variant arg = p_input;
 	const Variant *v[1] = { &arg };
 
+	// No copy: nodes removed while handling the event are left as NULL, added ones are appended past node_count.
+	int node_count = g.nodes.size();
+
+	g.iterating++;
 	call_lock++;
 
-	for (auto it_nodes = g.nodes.rbegin(); it_nodes != g.nodes.rend(); ++it_nodes) {
+	for (int i = node_count - 1; i >= 0; i--) {
 		if (input_handled)
 			break;
 
-		if (call_lock && call_skip.has(*it_nodes))
+		Node *n = g.nodes[i].node;
+		if (!n || (call_lock && call_skip.has(n)))
 			continue;
 
-		if (!(*it_nodes)->can_process())
+		if (!n->can_process())
 			continue;
 
-		(*it_nodes)->call_multilevel(p_method, (const Variant **)v, 1);
-		//ERR_FAIL_COND(node_count != g.nodes.size());
+		n->call_multilevel(p_method, (const Variant **)v, 1);
 	}
 
 	call_lock--;
 
 	if (call_lock == 0)
 		call_skip.clear();
+
+	_end_group_iteration(p_group, g);
 }
 
 void SceneTree::_notify_group_pause(const StringName &p_group, int p_notification) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *gp = group_map.getptr(p_group);
+	if (!gp)
 		return;
-	Group &g = E->get();
+	Group &g = *gp;
 	if (g.nodes.empty())
 		return;
 
 	_update_group_order(g, p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PROCESS || p_notification == Node::NOTIFICATION_PHYSICS_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
 
-	//copy, so copy on write happens in case something is removed from process while being called
-	//performance is not lost because only if something is added/removed the vector is copied.
-	std::vector<Node *> nodes_copy = g.nodes;
+	// No copy: nodes removed while processing are left as NULL, added ones are appended past node_count.
+	int node_count = g.nodes.size();
+
+	// Only the script facing callbacks can be threaded, internal processing of built-in nodes isn't thread-safe.
+	bool threaded = process_thread_group_nodes > 0 && (p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_PHYSICS_PROCESS);
 
+	g.iterating++;
 	call_lock++;
 
-	for (auto &&n : nodes_copy) {
-		if (call_lock && call_skip.has(n))
+	if (threaded)
+		_collect_process_thread_batches(g, node_count);
+
+	for (int i = 0; i < node_count; i++) {
+		Node *n = g.nodes[i].node;
+		if (!n || (call_lock && call_skip.has(n)))
 			continue;
 
+		if (threaded && n->data.process_thread_group) {
+			// A thread group runs where its first member is met in process order.
+			ProcessThreadBatch *batch = _find_process_thread_batch(n->data.process_thread_group);
+			if (batch) {
+				if (!batch->done)
+					_run_process_thread_batch(g, *batch, p_notification);
+				continue;
+			}
+		}
+
 		if (!n->can_process())
 			continue;
 		if (!n->can_process_notification(p_notification))
 			continue;
 
 		n->notification(p_notification);
-		//ERR_FAIL_COND(node_count != g.nodes.size());
 	}
 
 	call_lock--;
 	if (call_lock == 0)
 		call_skip.clear();
+
+	_end_group_iteration(p_group, g);
+}
+
+void SceneTree::_collect_process_thread_batches(const Group &g, int p_node_count) {
+
+	process_thread_batch_count = 0;
+
+	for (int i = 0; i < p_node_count; i++) {
+		Node *n = g.nodes[i].node;
+		if (!n || !n->data.process_thread_group || (call_lock && call_skip.has(n)))
+			continue;
+
+		ProcessThreadBatch *batch = _find_process_thread_batch(n->data.process_thread_group);
+		if (!batch) {
+			// Batches are reused between frames to keep the member lists allocated.
+			if (process_thread_batch_count == (int)process_thread_batches.size())
+				process_thread_batches.push_back(ProcessThreadBatch());
+			batch = &process_thread_batches[process_thread_batch_count++];
+			batch->thread_group = n->data.process_thread_group;
+			batch->done = false;
+			batch->members.clear();
+		}
+		batch->members.push_back(i);
+	}
+}
+
+SceneTree::ProcessThreadBatch *SceneTree::_find_process_thread_batch(int p_thread_group) {
+
+	// There are only a handful of thread groups, a linear search is enough.
+	for (int i = 0; i < process_thread_batch_count; i++) {
+		if (process_thread_batches[i].thread_group == p_thread_group)
+			return &process_thread_batches[i];
+	}
+	return NULL;
+}
+
+void SceneTree::_run_process_thread_batch(Group &g, ProcessThreadBatch &p_batch, int p_notification) {
+
+	p_batch.done = true;
+
+	threaded_group = &g;
+	threaded_notification = p_notification;
+	threaded_process = true;
+
+	last_process_thread_batch++;
+	threaded_transform_changes_count = 0;
+
+	// The calling thread helps, so this also works without worker threads.
+	ThreadPool::get_singleton()->parallel_for(p_batch.members.size(), this, &SceneTree::_process_thread_batch_node, &p_batch);
+
+	threaded_process = false;
+	threaded_group = NULL;
+
+	_flush_threaded_transform_changes();
+}
+
+void SceneTree::_process_thread_batch_node(uint32_t p_index, ProcessThreadBatch *p_batch) {
+
+	Node *n = threaded_group->nodes[p_batch->members[p_index]].node;
+	if (!n)
+		return; // left before its batch ran
+
+	if (!n->can_process())
+		return;
+	if (!n->can_process_notification(threaded_notification))
+		return;
+
+	n->notification(threaded_notification);
+}
+
+SceneTree::ThreadedTransformChanges *SceneTree::_get_threaded_transform_changes() {
+
+	if (thread_transform_changes_batch != last_process_thread_batch) {
+		// First change this thread makes in the batch.
+		threaded_transform_changes_mutex->lock();
+		if (threaded_transform_changes_count == (int)threaded_transform_changes.size())
+			threaded_transform_changes.push_back(memnew(ThreadedTransformChanges));
+		thread_transform_changes = threaded_transform_changes[threaded_transform_changes_count++];
+		threaded_transform_changes_mutex->unlock();
+
+		thread_transform_changes_batch = last_process_thread_batch;
+	}
+
+	return thread_transform_changes;
+}
+
+void SceneTree::_flush_threaded_transform_changes() {
+
+	for (int i = 0; i < threaded_transform_changes_count; i++) {
+
+		ThreadedTransformChanges *changes = threaded_transform_changes[i];
+
+		SelfList<Node> *n = changes->xform_change_list.first();
+		while (n) {
+			SelfList<Node> *nx = n->next();
+			changes->xform_change_list.remove(n);
+			xform_change_list.add(n);
+			n = nx;
+		}
+
+		for (uint32_t j = 0; j < changes->canvas_items.size(); j++) {
+			VisualServer::get_singleton()->canvas_item_set_transform(changes->canvas_items[j], changes->canvas_item_transforms[j]);
+		}
+		changes->canvas_items.clear();
+		changes->canvas_item_transforms.clear();
+	}
+
+	threaded_transform_changes_count = 0;
 }
 
 /*
@@ -1027,20 +1300,19 @@ int64_t SceneTree::get_event_count() const {
 Array SceneTree::_get_nodes_in_group(const StringName &p_group) {
 
 	Array ret;
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *g = group_map.getptr(p_group);
+	if (!g)
 		return ret;
 
-	_update_group_order(E->get()); //update order just in case
-	auto nc = E->get().nodes.size();
+	_update_group_order(*g); //update order just in case
+	auto nc = g->nodes.size();
 	if (nc == 0)
 		return ret;
 
-	ret.resize(nc);
-
-	Node **ptr = E->get().nodes.data();
+	GroupMember *ptr = g->nodes.data();
 	for (decltype(nc) i = 0; i < nc; ++i) {
-		ret[i] = ptr[i];
+		if (ptr[i].node) // removed while the group is being iterated
+			ret.push_back(ptr[i].node);
 	}
 
 	return ret;
@@ -1052,17 +1324,18 @@ bool SceneTree::has_group(const StringName &p_identifier) const {
 }
 void SceneTree::get_nodes_in_group(const StringName &p_group, List<Node *> *p_list) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *g = group_map.getptr(p_group);
+	if (!g)
 		return;
 
-	_update_group_order(E->get()); //update order just in case
+	_update_group_order(*g); //update order just in case
 
-	if (E->get().nodes.empty())
+	if (g->nodes.empty())
 		return;
 
-	for (auto &&node : E->get().nodes) {
-		p_list->push_back(node);
+	for (auto &&member : g->nodes) {
+		if (member.node)
+			p_list->push_back(member.node);
 	}
 }
 
@@ -1919,6 +2192,9 @@ void SceneTree::_bind_methods() {
 }
 
 SceneTree *SceneTree::singleton = NULL;
+thread_local SceneTree::ThreadedTransformChanges *SceneTree::thread_transform_changes = NULL;
+thread_local uint64_t SceneTree::thread_transform_changes_batch = 0;
+uint64_t SceneTree::last_process_thread_batch = 0;
 
 SceneTree::IdleCallback SceneTree::idle_callbacks[SceneTree::MAX_IDLE_CALLBACKS];
 int SceneTree::idle_callback_count = 0;
@@ -1988,6 +2264,7 @@ SceneTree::SceneTree() {
 	quit_on_go_back = true;
 	initialized = false;
 	use_font_oversampling = false;
+	xform_batching = false;
 #ifdef DEBUG_ENABLED
 	debug_collisions_hint = false;
 	debug_navigation_hint = false;
@@ -2016,6 +2293,13 @@ SceneTree::SceneTree() {
 	call_lock = 0;
 	root_lock = 0;
 	node_count = 0;
+	process_thread_group_nodes = 0;
+	threaded_process = false;
+	process_thread_batch_count = 0;
+	threaded_group = NULL;
+	threaded_notification = 0;
+	threaded_transform_changes_mutex = Mutex::create();
+	threaded_transform_changes_count = 0;
 
 	//create with mainloop
 
@@ -2136,5 +2420,10 @@ SceneTree::~SceneTree() {
 		memdelete(root);
 	}
 
+	for (uint32_t i = 0; i < threaded_transform_changes.size(); i++) {
+		memdelete(threaded_transform_changes[i]);
+	}
+	memdelete(threaded_transform_changes_mutex);
+
 	if (singleton == this) singleton = NULL;
 }
@@ -33,8 +33,10 @@
 
 #include <vector>
 
+#include "core/hash_map.h"
 #include "core/io/multiplayer_api.h"
 #include "core/os/main_loop.h"
+#include "core/os/mutex.h"
 #include "core/os/thread_safe.h"
 #include "core/self_list.h"
 #include "scene/resources/mesh.h"
@@ -92,12 +94,29 @@ public:
 	};
 
 private:
+	struct GroupMember {
+
+		Node *node;
+		int *index; // the node's Node::GroupData::index, kept equal to its position in Group::nodes
+	};
+
 	struct Group {
 
-		std::vector<Node *> nodes;
+		std::vector<GroupMember> nodes;
 		//uint64_t last_tree_version;
 		bool changed;
-		Group() { changed = false; };
+		// nodes[0, sorted) is in tree order, nodes added later are merged in on the next ordered walk.
+		int sorted;
+		// Leaving a group leaves a NULL hole, so it is O(1) and keeps the order. Holes are compacted lazily.
+		int holes;
+		// Reordering, compacting and erasing the group wait until no walk over it is in progress.
+		int iterating;
+		Group() {
+			changed = false;
+			sorted = 0;
+			holes = 0;
+			iterating = 0;
+		};
 	};
 
 	Viewport *root;
@@ -115,7 +134,7 @@ private:
 	bool pause;
 	int root_lock;
 
-	Map<StringName, Group> group_map;
+	HashMap<StringName, Group> group_map;
 	bool _quit;
 	bool initialized;
 	bool input_handled;
@@ -146,6 +165,38 @@ private:
 	int call_lock;
 	Set<Node *> call_skip; //skip erased nodes
 
+	// Nodes sharing a Node::process_thread_group, processed in parallel on the ThreadPool.
+	struct ProcessThreadBatch {
+
+		int thread_group;
+		bool done;
+		std::vector<int> members; // positions in Group::nodes, holes are checked when processing
+	};
+
+	int process_thread_group_nodes; // nodes inside the tree with a thread group set
+	bool threaded_process; // a batch is running, the tree can't be modified until it ends
+	std::vector<ProcessThreadBatch> process_thread_batches;
+	int process_thread_batch_count;
+	Group *threaded_group;
+	int threaded_notification;
+
+	// Transform changes of nodes moved from a process thread group. Each thread queues its own and
+	// the main thread sends them on when the batch ends.
+	struct ThreadedTransformChanges {
+
+		SelfList<Node>::List xform_change_list;
+		std::vector<RID> canvas_items;
+		std::vector<Transform2D> canvas_item_transforms;
+	};
+
+	static thread_local ThreadedTransformChanges *thread_transform_changes;
+	static thread_local uint64_t thread_transform_changes_batch; // batch the changes above were taken for
+	static uint64_t last_process_thread_batch;
+
+	Mutex *threaded_transform_changes_mutex;
+	std::vector<ThreadedTransformChanges *> threaded_transform_changes; // reused between batches
+	int threaded_transform_changes_count; // taken by the running batch
+
 	StretchMode stretch_mode;
 	StretchAspect stretch_aspect;
 	Size2i stretch_min;
@@ -161,6 +212,8 @@ private:
 	void _flush_ugc();
 
 	_FORCE_INLINE_ void _update_group_order(Group &g, bool p_use_priority = false);
+	void _compact_group(Group &g);
+	void _end_group_iteration(const StringName &p_group, Group &g);
 	void _update_listener();
 
 	Array _get_nodes_in_group(const StringName &p_group);
@@ -202,11 +255,17 @@ private:
 	void node_removed(Node *p_node);
 	void node_renamed(Node *p_node);
 
-	Group *add_to_group(const StringName &p_group, Node *p_node);
-	void remove_from_group(const StringName &p_group, Node *p_node);
+	Group *add_to_group(const StringName &p_group, Node *p_node, int *r_index);
+	void remove_from_group(const StringName &p_group, Node *p_node, int p_index);
 	void make_group_changed(const StringName &p_group);
 
 	void _notify_group_pause(const StringName &p_group, int p_notification);
+	void _collect_process_thread_batches(const Group &g, int p_node_count);
+	ProcessThreadBatch *_find_process_thread_batch(int p_thread_group);
+	void _run_process_thread_batch(Group &g, ProcessThreadBatch &p_batch, int p_notification);
+	void _process_thread_batch_node(uint32_t p_index, ProcessThreadBatch *p_batch);
+	ThreadedTransformChanges *_get_threaded_transform_changes();
+	void _flush_threaded_transform_changes();
 	void _call_input_pause(const StringName &p_group, const StringName &p_method, const Ref<InputEvent> &p_input);
 	Variant _call_group_flags(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
 	Variant _call_group(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
@@ -217,9 +276,22 @@ private:
 	friend class CanvasItem;
 	friend class Spatial;
 	friend class Viewport;
+	friend class VisualInstance;
 
 	SelfList<Node>::List xform_change_list;
 
+	// Nodes processed in a thread group queue their changes per thread, so additions go through these.
+	void _add_xform_change(SelfList<Node> *p_change);
+	void _set_canvas_item_transform(RID p_canvas_item, const Transform2D &p_transform);
+
+	// While flushing transform notifications, visual instances queue their transforms here and they
+	// go to the VisualServer in one batch.
+	bool xform_batching;
+	std::vector<RID> xform_batch_instances;
+	std::vector<Transform> xform_batch_transforms;
+
+	void _flush_transform_batch();
+
 #ifdef DEBUG_ENABLED
 
 	Map<int, NodePath> live_edit_node_path_cache;
@@ -378,6 +450,7 @@ public:
 	int64_t get_event_count() const;
 
 	int get_node_count() const;
+	_FORCE_INLINE_ bool is_processing_threaded() const { return threaded_process; }
 
 	void queue_delete(Object *p_object);
 
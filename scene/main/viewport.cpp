@@ -519,7 +519,7 @@ void Viewport::_notification(int p_what) {
 
 							Vector2 point = canvas_transform.affine_inverse().xform(pos);
 
-							int rc = ss2d->intersect_point_on_canvas(point, canvas_layer_id, res, 64, Set<RID>(), 0xFFFFFFFF, true, true, true);
+							int rc = ss2d->intersect_point_on_canvas(point, canvas_layer_id, res, 64, VSet<RID>(), 0xFFFFFFFF, true, true, true);
 							for (int i = 0; i < rc; i++) {
 
 								if (res[i].collider_id && res[i].collider) {
@@ -614,7 +614,7 @@ void Viewport::_notification(int p_what) {
 							PhysicsDirectSpaceState *space = PhysicsServer::get_singleton()->space_get_direct_state(find_world()->get_space());
 							if (space) {
 
-								bool col = space->intersect_ray(from, from + dir * 10000, result, Set<RID>(), 0xFFFFFFFF, true, true, true);
+								bool col = space->intersect_ray(from, from + dir * 10000, result, VSet<RID>(), 0xFFFFFFFF, true, true, true);
 								ObjectID new_collider = 0;
 								if (col) {
 
@@ -44,6 +44,8 @@ class AreaPairSW : public ConstraintSW {
 	bool colliding;
 
 public:
+	virtual bool is_island_local() const { return false; } // Updates the area queries.
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -60,6 +62,8 @@ class Area2PairSW : public ConstraintSW {
 	bool colliding;
 
 public:
+	virtual bool is_island_local() const { return false; }
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
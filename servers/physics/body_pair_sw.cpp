@@ -219,6 +219,16 @@ real_t combine_friction(BodySW *A, BodySW *B) {
 	return ABS(MIN(A->get_friction(), B->get_friction()));
 }
 
+bool BodyPairSW::is_island_local() const {
+
+	// Static and kinematic bodies are shared between islands, reporting their contacts writes to them.
+	if (A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && A->can_report_contacts())
+		return false;
+	if (B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && B->can_report_contacts())
+		return false;
+	return true;
+}
+
 bool BodyPairSW::setup(real_t p_step) {
 
 	//cannot collide
@@ -87,6 +87,8 @@ class BodyPairSW : public ConstraintSW {
 	SpaceSW *space;
 
 public:
+	virtual bool is_island_local() const;
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -0,0 +1,656 @@
+/*************************************************************************/
+/*  broad_phase_bvh.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "broad_phase_bvh.h"
+#include "collision_object_sw.h"
+
+// Grown around every leaf, larger than what most bodies move in a step.
+static const real_t fat_margin = 0.1;
+// Leaves are also stretched by this many times their last displacement, ahead of the motion.
+static const real_t displacement_multiplier = 2.0;
+
+static _FORCE_INLINE_ real_t _surface(const AABB &p_aabb) {
+
+	const Vector3 &s = p_aabb.size;
+	return s.x * s.y + s.y * s.z + s.z * s.x;
+}
+
+// Traversal stack, on the C stack unless the tree is unusually deep.
+struct _BVHStack {
+
+	enum {
+		LOCAL_SIZE = 128,
+	};
+
+	int local[LOCAL_SIZE];
+	std::vector<int> heap;
+	int *data;
+	uint32_t size;
+	uint32_t capacity;
+
+	_FORCE_INLINE_ void push(int p_node) {
+
+		if (unlikely(size == capacity)) {
+			heap.resize(capacity * 2);
+			if (data == local) {
+				memcpy(heap.data(), local, sizeof(local));
+			}
+			data = heap.data();
+			capacity *= 2;
+		}
+		data[size++] = p_node;
+	}
+
+	_FORCE_INLINE_ int pop() { return data[--size]; }
+
+	_BVHStack() {
+		data = local;
+		size = 0;
+		capacity = LOCAL_SIZE;
+	}
+};
+
+int BroadPhaseBVH::_alloc_node() {
+
+	int node;
+	if (free_nodes.size()) {
+		node = free_nodes.back();
+		free_nodes.pop_back();
+	} else {
+		node = nodes.size();
+		nodes.push_back(Node());
+	}
+
+	Node &n = nodes[node];
+	n.parent = -1;
+	n.children[0] = -1;
+	n.children[1] = -1;
+	n.element = 0;
+	return node;
+}
+
+void BroadPhaseBVH::_free_node(int p_node) {
+
+	free_nodes.push_back(p_node);
+}
+
+void BroadPhaseBVH::_rotate(int p_node) {
+
+	// Swap a child with a grandchild on the other side, when that shrinks the other side the most.
+	// Unlike height balancing, this never pushes a huge leaf down among small ones.
+	Node &a = nodes[p_node];
+	real_t best_gain = 0;
+	int best_child = -1;
+	int best_grandchild = -1;
+
+	for (int i = 0; i < 2; i++) {
+
+		const Node &child = nodes[a.children[i]];
+		const Node &other = nodes[a.children[1 - i]];
+		if (other.is_leaf()) {
+			continue;
+		}
+
+		real_t surface = _surface(other.aabb);
+		for (int j = 0; j < 2; j++) {
+			// The child replaces grandchild j, which moves up.
+			real_t gain = surface - _surface(child.aabb.merge(nodes[other.children[1 - j]].aabb));
+			if (gain > best_gain) {
+				best_gain = gain;
+				best_child = i;
+				best_grandchild = j;
+			}
+		}
+	}
+
+	if (best_child == -1) {
+		return;
+	}
+
+	int child = a.children[best_child];
+	int other_index = a.children[1 - best_child];
+	Node &other = nodes[other_index];
+	int grandchild = other.children[best_grandchild];
+
+	a.children[best_child] = grandchild;
+	nodes[grandchild].parent = p_node;
+	other.children[best_grandchild] = child;
+	nodes[child].parent = other_index;
+	other.aabb = nodes[other.children[0]].aabb.merge(nodes[other.children[1]].aabb);
+}
+
+void BroadPhaseBVH::_refit_upwards(int p_node) {
+
+	while (p_node != -1) {
+
+		Node &n = nodes[p_node];
+		AABB aabb = nodes[n.children[0]].aabb.merge(nodes[n.children[1]].aabb);
+		bool changed = aabb != n.aabb;
+		n.aabb = aabb;
+		_rotate(p_node);
+
+		if (!changed) {
+			break; // The ancestors are still up to date.
+		}
+		p_node = n.parent;
+	}
+}
+
+void BroadPhaseBVH::_insert_leaf(int p_tree, int p_leaf) {
+
+	if (roots[p_tree] == -1) {
+		roots[p_tree] = p_leaf;
+		nodes[p_leaf].parent = -1;
+		return;
+	}
+
+	// Descend to the sibling with the lowest surface area cost.
+	const AABB leaf_aabb = nodes[p_leaf].aabb;
+	int index = roots[p_tree];
+	while (!nodes[index].is_leaf()) {
+
+		const Node &n = nodes[index];
+		real_t area = _surface(n.aabb);
+		real_t combined_area = _surface(n.aabb.merge(leaf_aabb));
+
+		// Cost of pairing the leaf with this node, and the minimum added cost of pushing it further down.
+		real_t cost = 2 * combined_area;
+		real_t inheritance_cost = 2 * (combined_area - area);
+
+		real_t child_cost[2];
+		for (int i = 0; i < 2; i++) {
+			const Node &child = nodes[n.children[i]];
+			child_cost[i] = _surface(child.aabb.merge(leaf_aabb)) + inheritance_cost;
+			if (!child.is_leaf()) {
+				child_cost[i] -= _surface(child.aabb);
+			}
+		}
+
+		if (cost < child_cost[0] && cost < child_cost[1]) {
+			break;
+		}
+		index = child_cost[0] < child_cost[1] ? n.children[0] : n.children[1];
+	}
+
+	int sibling = index;
+	int old_parent = nodes[sibling].parent;
+	int new_parent = _alloc_node();
+
+	Node &np = nodes[new_parent];
+	np.parent = old_parent;
+	np.children[0] = sibling;
+	np.children[1] = p_leaf;
+	np.aabb = AABB(); // Fitted by _refit_upwards().
+	nodes[sibling].parent = new_parent;
+	nodes[p_leaf].parent = new_parent;
+
+	if (old_parent != -1) {
+		Node &op = nodes[old_parent];
+		op.children[op.children[0] == sibling ? 0 : 1] = new_parent;
+	} else {
+		roots[p_tree] = new_parent;
+	}
+
+	_refit_upwards(new_parent);
+}
+
+void BroadPhaseBVH::_remove_leaf(int p_tree, int p_leaf) {
+
+	if (roots[p_tree] == p_leaf) {
+		roots[p_tree] = -1;
+		return;
+	}
+
+	int parent = nodes[p_leaf].parent;
+	const Node &p = nodes[parent];
+	int grandparent = p.parent;
+	int sibling = p.children[p.children[0] == p_leaf ? 1 : 0];
+
+	_free_node(parent);
+	nodes[p_leaf].parent = -1;
+	nodes[sibling].parent = grandparent;
+
+	if (grandparent != -1) {
+		Node &g = nodes[grandparent];
+		g.children[g.children[0] == parent ? 0 : 1] = sibling;
+		_refit_upwards(grandparent);
+	} else {
+		roots[p_tree] = sibling;
+	}
+}
+
+bool BroadPhaseBVH::_can_pair(const Element &p_a, const Element &p_b) const {
+
+	return (!p_a._static || !p_b._static) && p_a.owner != p_b.owner;
+}
+
+bool BroadPhaseBVH::_has_pair(ID p_a, ID p_b) const {
+
+	const Element &a = elements[p_a - 1];
+	const Element &b = elements[p_b - 1];
+	const std::vector<uint32_t> &list = a.pairs.size() <= b.pairs.size() ? a.pairs : b.pairs;
+
+	for (uint32_t i = 0; i < list.size(); i++) {
+		const Pair &pair = pairs[list[i]];
+		if ((pair.a == p_a && pair.b == p_b) || (pair.a == p_b && pair.b == p_a)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void BroadPhaseBVH::_add_pair(ID p_a, ID p_b) {
+
+	uint32_t index;
+	if (free_pairs.size()) {
+		index = free_pairs.back();
+		free_pairs.pop_back();
+	} else {
+		index = pairs.size();
+		pairs.push_back(Pair());
+	}
+
+	Element &a = elements[p_a - 1];
+	Element &b = elements[p_b - 1];
+
+	Pair &pair = pairs[index];
+	pair.a = p_a;
+	pair.b = p_b;
+	pair.index_a = a.pairs.size();
+	pair.index_b = b.pairs.size();
+	pair.intersect = false;
+	pair.ud = NULL;
+
+	a.pairs.push_back(index);
+	b.pairs.push_back(index);
+}
+
+void BroadPhaseBVH::_unlink_pair(ID p_id, uint32_t p_index) {
+
+	std::vector<uint32_t> &list = elements[p_id - 1].pairs;
+	uint32_t moved = list.back();
+	list[p_index] = moved;
+	list.pop_back();
+
+	if (p_index < list.size()) {
+		Pair &pair = pairs[moved];
+		if (pair.a == p_id) {
+			pair.index_a = p_index;
+		} else {
+			pair.index_b = p_index;
+		}
+	}
+}
+
+void BroadPhaseBVH::_remove_pair(uint32_t p_pair) {
+
+	Pair &pair = pairs[p_pair];
+	if (pair.intersect && unpair_callback) {
+		const Element &a = elements[pair.a - 1];
+		const Element &b = elements[pair.b - 1];
+		unpair_callback(a.owner, a.subindex, b.owner, b.subindex, pair.ud, unpair_userdata);
+	}
+
+	_unlink_pair(pair.a, pair.index_a);
+	_unlink_pair(pair.b, pair.index_b);
+	free_pairs.push_back(p_pair);
+}
+
+void BroadPhaseBVH::_check_pair(Pair &p_pair) {
+
+	const Element &a = elements[p_pair.a - 1];
+	const Element &b = elements[p_pair.b - 1];
+
+	bool intersect = a.aabb.intersects_inclusive(b.aabb);
+	if (intersect == p_pair.intersect) {
+		return;
+	}
+
+	if (intersect) {
+		if (pair_callback) {
+			p_pair.ud = pair_callback(a.owner, a.subindex, b.owner, b.subindex, pair_userdata);
+		}
+	} else {
+		if (unpair_callback) {
+			unpair_callback(a.owner, a.subindex, b.owner, b.subindex, p_pair.ud, unpair_userdata);
+		}
+	}
+	p_pair.intersect = intersect;
+}
+
+void BroadPhaseBVH::_check_pairs(ID p_id) {
+
+	const std::vector<uint32_t> &list = elements[p_id - 1].pairs;
+	for (uint32_t i = 0; i < list.size(); i++) {
+		_check_pair(pairs[list[i]]);
+	}
+}
+
+void BroadPhaseBVH::_update_pairs(ID p_id) {
+
+	Element &e = elements[p_id - 1];
+	const AABB fat = nodes[e.leaf].aabb;
+
+	// Drop the pairs that were left behind, or that can't pair anymore.
+	for (uint32_t i = 0; i < e.pairs.size();) {
+		const Pair &pair = pairs[e.pairs[i]];
+		const Element &other = elements[(pair.a == p_id ? pair.b : pair.a) - 1];
+		if (_can_pair(e, other) && fat.intersects_inclusive(nodes[other.leaf].aabb)) {
+			i++;
+		} else {
+			_remove_pair(e.pairs[i]); // Moves the last pair here.
+		}
+	}
+
+	// Static elements only pair with dynamic ones.
+	query_results.clear();
+	_BVHStack stack;
+	for (int t = e._static ? TREE_DYNAMIC : TREE_STATIC; t < TREE_MAX; t++) {
+
+		if (roots[t] == -1) {
+			continue;
+		}
+
+		stack.push(roots[t]);
+		while (stack.size) {
+
+			const Node &n = nodes[stack.pop()];
+			if (!n.aabb.intersects_inclusive(fat)) {
+				continue;
+			}
+			if (n.is_leaf()) {
+				if (n.element != p_id) {
+					query_results.push_back(n.element);
+				}
+				continue;
+			}
+			stack.push(n.children[0]);
+			stack.push(n.children[1]);
+		}
+	}
+
+	for (uint32_t i = 0; i < query_results.size(); i++) {
+		ID other = query_results[i];
+		if (_can_pair(e, elements[other - 1]) && !_has_pair(p_id, other)) {
+			_add_pair(p_id, other);
+		}
+	}
+
+	_check_pairs(p_id);
+}
+
+void BroadPhaseBVH::_clear_pairs(ID p_id) {
+
+	std::vector<uint32_t> &list = elements[p_id - 1].pairs;
+	while (list.size()) {
+		_remove_pair(list.back());
+	}
+}
+
+BroadPhaseSW::ID BroadPhaseBVH::create(CollisionObjectSW *p_object, int p_subindex) {
+
+	ERR_FAIL_COND_V(!p_object, 0);
+
+	ID id;
+	if (free_elements.size()) {
+		id = free_elements.back();
+		free_elements.pop_back();
+	} else {
+		elements.push_back(Element());
+		id = elements.size();
+	}
+
+	// Like in the octree, new elements are static until told otherwise.
+	Element &e = elements[id - 1];
+	e.owner = p_object;
+	e.subindex = p_subindex;
+	e._static = true;
+	e.used = true;
+	e.aabb = AABB();
+	e.leaf = -1;
+	return id;
+}
+
+void BroadPhaseBVH::move(ID p_id, const AABB &p_aabb) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].used);
+	Element &e = elements[p_id - 1];
+	int tree = _tree_of(e);
+
+	if (p_aabb.has_no_surface()) {
+		// Leave the tree, the octree doesn't pair these either.
+		if (e.leaf != -1) {
+			_clear_pairs(p_id);
+			_remove_leaf(tree, e.leaf);
+			_free_node(e.leaf);
+			e.leaf = -1;
+		}
+		e.aabb = p_aabb;
+		return;
+	}
+
+	AABB previous = e.aabb;
+	e.aabb = p_aabb;
+
+	if (e.leaf != -1 && nodes[e.leaf].aabb.encloses(p_aabb)) {
+		_check_pairs(p_id);
+		return;
+	}
+
+	AABB fat = p_aabb.grow(fat_margin);
+	if (e.leaf != -1) {
+		Vector3 displacement = (p_aabb.position - previous.position) * displacement_multiplier;
+		for (int i = 0; i < 3; i++) {
+			if (displacement[i] < 0) {
+				fat.position[i] += displacement[i];
+				fat.size[i] -= displacement[i];
+			} else {
+				fat.size[i] += displacement[i];
+			}
+		}
+		_remove_leaf(tree, e.leaf);
+	} else {
+		e.leaf = _alloc_node();
+		nodes[e.leaf].element = p_id;
+	}
+
+	nodes[e.leaf].aabb = fat;
+	_insert_leaf(tree, e.leaf);
+	_update_pairs(p_id);
+}
+
+void BroadPhaseBVH::set_static(ID p_id, bool p_static) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].used);
+	Element &e = elements[p_id - 1];
+	if (e._static == p_static) {
+		return;
+	}
+
+	if (e.leaf == -1) {
+		e._static = p_static;
+		return;
+	}
+
+	_remove_leaf(_tree_of(e), e.leaf);
+	e._static = p_static;
+	_insert_leaf(_tree_of(e), e.leaf);
+	_update_pairs(p_id);
+}
+
+void BroadPhaseBVH::remove(ID p_id) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].used);
+	Element &e = elements[p_id - 1];
+
+	//unpair must be done immediately on removal to avoid potential invalid pointers
+	if (e.leaf != -1) {
+		_clear_pairs(p_id);
+		_remove_leaf(_tree_of(e), e.leaf);
+		_free_node(e.leaf);
+		e.leaf = -1;
+	}
+
+	e.owner = NULL;
+	e.used = false;
+	free_elements.push_back(p_id);
+}
+
+CollisionObjectSW *BroadPhaseBVH::get_object(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].used, NULL);
+	return elements[p_id - 1].owner;
+}
+bool BroadPhaseBVH::is_static(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].used, false);
+	return elements[p_id - 1]._static;
+}
+int BroadPhaseBVH::get_subindex(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].used, -1);
+	return elements[p_id - 1].subindex;
+}
+
+template <class QueryTest>
+int BroadPhaseBVH::_cull(const QueryTest &p_test, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) const {
+
+	int results = 0;
+	_BVHStack stack;
+
+	for (int t = 0; t < TREE_MAX; t++) {
+
+		if (roots[t] == -1) {
+			continue;
+		}
+
+		stack.push(roots[t]);
+		while (stack.size) {
+
+			const Node &n = nodes[stack.pop()];
+			if (!p_test(n.aabb)) {
+				continue;
+			}
+
+			if (n.is_leaf()) {
+				const Element &e = elements[n.element - 1];
+				if (!p_test(e.aabb)) {
+					continue;
+				}
+				if (results >= p_max_results) {
+					return results;
+				}
+				p_results[results] = e.owner;
+				if (p_result_indices) {
+					p_result_indices[results] = e.subindex;
+				}
+				results++;
+				continue;
+			}
+
+			stack.push(n.children[0]);
+			stack.push(n.children[1]);
+		}
+	}
+
+	return results;
+}
+
+struct _BVHCullPoint {
+
+	Vector3 point;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.has_point(point); }
+};
+
+struct _BVHCullSegment {
+
+	Vector3 from;
+	Vector3 to;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects_segment(from, to); }
+};
+
+struct _BVHCullAABB {
+
+	AABB aabb;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects_inclusive(aabb); }
+};
+
+int BroadPhaseBVH::cull_point(const Vector3 &p_point, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_BVHCullPoint test;
+	test.point = p_point;
+	return _cull(test, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhaseBVH::cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_BVHCullSegment test;
+	test.from = p_from;
+	test.to = p_to;
+	return _cull(test, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhaseBVH::cull_aabb(const AABB &p_aabb, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_BVHCullAABB test;
+	test.aabb = p_aabb;
+	return _cull(test, p_results, p_max_results, p_result_indices);
+}
+
+void BroadPhaseBVH::set_pair_callback(PairCallback p_pair_callback, void *p_userdata) {
+
+	pair_callback = p_pair_callback;
+	pair_userdata = p_userdata;
+}
+void BroadPhaseBVH::set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) {
+
+	unpair_callback = p_unpair_callback;
+	unpair_userdata = p_userdata;
+}
+
+void BroadPhaseBVH::update() {
+	// Pairs are kept up to date by move().
+}
+
+BroadPhaseSW *BroadPhaseBVH::_create() {
+
+	return memnew(BroadPhaseBVH);
+}
+
+BroadPhaseBVH::BroadPhaseBVH() {
+
+	for (int i = 0; i < TREE_MAX; i++) {
+		roots[i] = -1;
+	}
+	pair_callback = NULL;
+	pair_userdata = NULL;
+	unpair_callback = NULL;
+	unpair_userdata = NULL;
+}
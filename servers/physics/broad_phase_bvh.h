@@ -0,0 +1,148 @@
+/*************************************************************************/
+/*  broad_phase_bvh.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BROAD_PHASE_BVH_H
+#define BROAD_PHASE_BVH_H
+
+#include "broad_phase_sw.h"
+
+#include <vector>
+
+// Dynamic AABB tree broadphase.
+//
+// Every element with a surface is a leaf holding a fattened copy of its AABB: the real AABB grown
+// by a margin and stretched along the last displacement. Moving inside the fat AABB costs only a
+// check of the element's pairs; leaving it reinserts the leaf, refitting ancestors until they
+// stop changing and rotating nodes on the way up when that reduces their surface. Static elements
+// live in a separate tree, so moving bodies don't cost anything to the static world and static
+// elements never test each other.
+//
+// A pair exists while the fat AABBs of two elements that can pair overlap. The pair callback is
+// called when their real AABBs start intersecting, like BroadPhaseOctree does.
+class BroadPhaseBVH : public BroadPhaseSW {
+
+	enum {
+		TREE_STATIC,
+		TREE_DYNAMIC,
+		TREE_MAX,
+	};
+
+	struct Node {
+		AABB aabb;
+		int parent;
+		int children[2]; // -1 for leaves.
+		ID element; // Leaves only.
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == -1; }
+	};
+
+	struct Element {
+		CollisionObjectSW *owner;
+		int subindex;
+		bool _static;
+		bool used;
+		AABB aabb;
+		int leaf; // -1 while not in a tree.
+		std::vector<uint32_t> pairs;
+	};
+
+	struct Pair {
+		ID a;
+		ID b;
+		uint32_t index_a; // Index in the pairs of a.
+		uint32_t index_b;
+		bool intersect;
+		void *ud;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<int> free_nodes;
+	int roots[TREE_MAX];
+
+	std::vector<Element> elements; // At ID - 1.
+	std::vector<ID> free_elements;
+
+	std::vector<Pair> pairs;
+	std::vector<uint32_t> free_pairs;
+
+	std::vector<ID> query_results; // Candidates found when reinserting a leaf.
+
+	PairCallback pair_callback;
+	void *pair_userdata;
+	UnpairCallback unpair_callback;
+	void *unpair_userdata;
+
+	int _alloc_node();
+	void _free_node(int p_node);
+	void _rotate(int p_node);
+	void _refit_upwards(int p_node);
+	void _insert_leaf(int p_tree, int p_leaf);
+	void _remove_leaf(int p_tree, int p_leaf);
+
+	_FORCE_INLINE_ int _tree_of(const Element &p_element) const { return p_element._static ? TREE_STATIC : TREE_DYNAMIC; }
+	_FORCE_INLINE_ bool _can_pair(const Element &p_a, const Element &p_b) const;
+
+	bool _has_pair(ID p_a, ID p_b) const;
+	void _add_pair(ID p_a, ID p_b);
+	void _unlink_pair(ID p_id, uint32_t p_index);
+	void _remove_pair(uint32_t p_pair);
+	void _check_pair(Pair &p_pair);
+	void _check_pairs(ID p_id);
+	void _update_pairs(ID p_id);
+	void _clear_pairs(ID p_id);
+
+	template <class QueryTest>
+	int _cull(const QueryTest &p_test, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) const;
+
+public:
+	// 0 is an invalid ID
+	virtual ID create(CollisionObjectSW *p_object, int p_subindex = 0);
+	virtual void move(ID p_id, const AABB &p_aabb);
+	virtual void set_static(ID p_id, bool p_static);
+	virtual void remove(ID p_id);
+
+	virtual CollisionObjectSW *get_object(ID p_id) const;
+	virtual bool is_static(ID p_id) const;
+	virtual int get_subindex(ID p_id) const;
+
+	virtual int cull_point(const Vector3 &p_point, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_aabb(const AABB &p_aabb, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+
+	virtual void set_pair_callback(PairCallback p_pair_callback, void *p_userdata);
+	virtual void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata);
+
+	virtual void update();
+
+	static BroadPhaseSW *_create();
+	BroadPhaseBVH();
+};
+
+#endif // BROAD_PHASE_BVH_H
@@ -76,6 +76,10 @@ public:
 	_FORCE_INLINE_ void disable_collisions_between_bodies(const bool p_disabled) { disabled_collisions_between_bodies = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled_collisions_between_bodies() const { return disabled_collisions_between_bodies; }
 
+	// Whether setup() and solve() only write to this constraint and its rigid or character bodies.
+	// Islands with other constraints can't be processed in parallel with the rest.
+	virtual bool is_island_local() const { return true; }
+
 	virtual bool setup(real_t p_step) = 0;
 	virtual void solve(real_t p_step) = 0;
 
@@ -32,8 +32,9 @@
 #include "joints_sw.h"
 
 #include "core/os/os.h"
+#include "core/os/thread_pool.h"
 
-void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island) {
+void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island, bool &r_island_local) {
 
 	p_body->set_island_step(_step);
 	p_body->set_island_next(*p_island);
@@ -48,13 +49,16 @@ void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **
 		c->set_island_next(*p_constraint_island);
 		*p_constraint_island = c;
 
+		if (!c->is_island_local())
+			r_island_local = false;
+
 		for (int i = 0; i < c->get_body_count(); i++) {
 			if (i == E->get())
 				continue;
 			BodySW *b = c->get_body_ptr()[i];
 			if (b->get_island_step() == _step || b->get_mode() == PhysicsServer::BODY_MODE_STATIC || b->get_mode() == PhysicsServer::BODY_MODE_KINEMATIC)
 				continue; //no go
-			_populate_island(c->get_body_ptr()[i], p_island, p_constraint_island);
+			_populate_island(c->get_body_ptr()[i], p_island, p_constraint_island, r_island_local);
 		}
 	}
 }
@@ -107,7 +111,7 @@ void StepSW::_solve_island(ConstraintSW *p_island, int p_iterations, real_t p_de
 	}
 }
 
-void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
+bool StepSW::_sleep_test_island(BodySW *p_island, real_t p_delta) {
 
 	bool can_sleep = true;
 
@@ -125,9 +129,14 @@ void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
 		b = b->get_island_next();
 	}
 
+	return can_sleep;
+}
+
+void StepSW::_check_suspend(BodySW *p_island, bool p_can_sleep) {
+
 	//put all to sleep or wake up everyoen
 
-	b = p_island;
+	BodySW *b = p_island;
 	while (b) {
 
 		if (b->get_mode() == PhysicsServer::BODY_MODE_STATIC || b->get_mode() == PhysicsServer::BODY_MODE_KINEMATIC) {
@@ -137,19 +146,37 @@ void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
 
 		bool active = b->is_active();
 
-		if (active == can_sleep)
-			b->set_active(!can_sleep);
+		if (active == p_can_sleep)
+			b->set_active(!p_can_sleep);
 
 		b = b->get_island_next();
 	}
 }
 
+void StepSW::_setup_island_thread(uint32_t p_index, ConstraintSW **p_islands) {
+
+	_setup_island(p_islands[p_index], delta);
+}
+
+void StepSW::_solve_island_thread(uint32_t p_index, ConstraintSW **p_islands) {
+
+	_solve_island(p_islands[p_index], iterations, delta);
+}
+
+void StepSW::_sleep_test_island_thread(uint32_t p_index, BodySW **p_islands) {
+
+	body_islands_can_sleep[p_index] = _sleep_test_island(p_islands[p_index], delta);
+}
+
 void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	p_space->lock(); // can't access space during this
 
 	p_space->setup(); //update inertias, etc
 
+	iterations = p_iterations;
+	delta = p_delta;
+
 	const SelfList<BodySW>::List *body_list = &p_space->get_active_body_list();
 
 	/* INTEGRATE FORCES */
@@ -177,12 +204,11 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* GENERATE CONSTRAINT ISLANDS */
 
-	BodySW *island_list = NULL;
-	ConstraintSW *constraint_island_list = NULL;
-	b = body_list->first();
-
-	int island_count = 0;
+	body_islands.clear();
+	constraint_islands.clear();
+	serial_constraint_islands.clear();
 
+	b = body_list->first();
 	while (b) {
 		BodySW *body = b->self();
 
@@ -190,21 +216,22 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 			BodySW *island = NULL;
 			ConstraintSW *constraint_island = NULL;
-			_populate_island(body, &island, &constraint_island);
+			bool island_local = true;
+			_populate_island(body, &island, &constraint_island, island_local);
 
-			island->set_island_list_next(island_list);
-			island_list = island;
+			body_islands.push_back(island);
 
 			if (constraint_island) {
-				constraint_island->set_island_list_next(constraint_island_list);
-				constraint_island_list = constraint_island;
-				island_count++;
+				if (island_local)
+					constraint_islands.push_back(constraint_island);
+				else
+					serial_constraint_islands.push_back(constraint_island);
 			}
 		}
 		b = b->next();
 	}
 
-	p_space->set_island_count(island_count);
+	p_space->set_island_count(constraint_islands.size() + serial_constraint_islands.size());
 
 	const SelfList<AreaSW>::List &aml = p_space->get_moved_area_list();
 
@@ -216,8 +243,7 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 				continue;
 			c->set_island_step(_step);
 			c->set_island_next(NULL);
-			c->set_island_list_next(constraint_island_list);
-			constraint_island_list = c;
+			serial_constraint_islands.push_back(c);
 		}
 		p_space->area_remove_from_moved_list((SelfList<AreaSW> *)aml.first()); //faster to remove here
 	}
@@ -228,17 +254,25 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 		profile_begtime = profile_endtime;
 	}
 
-	/* SETUP CONSTRAINT ISLANDS */
+	// Islands share nothing they write to, so the results are the same on any number of threads.
+	// Debug contacts are appended to the space, which only the stepping thread may do.
+	ThreadPool *thread_pool = ThreadPool::get_singleton();
+	bool parallel = thread_pool && thread_pool->get_thread_count() > 0 && !p_space->is_debugging_contacts();
 
-	{
-		ConstraintSW *ci = constraint_island_list;
-		while (ci) {
+	/* SETUP CONSTRAINT ISLANDS */
 
-			_setup_island(ci, p_delta);
-			ci = ci->get_island_list_next();
+	if (parallel) {
+		thread_pool->parallel_for(constraint_islands.size(), this, &StepSW::_setup_island_thread, constraint_islands.data());
+	} else {
+		for (uint32_t i = 0; i < constraint_islands.size(); i++) {
+			_setup_island(constraint_islands[i], p_delta);
 		}
 	}
 
+	for (uint32_t i = 0; i < serial_constraint_islands.size(); i++) {
+		_setup_island(serial_constraint_islands[i], p_delta);
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_SETUP_CONSTRAINTS, profile_endtime - profile_begtime);
@@ -247,15 +281,19 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
-	{
-		ConstraintSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
+	//iterating each island separatedly improves cache efficiency
+	if (parallel) {
+		thread_pool->parallel_for(constraint_islands.size(), this, &StepSW::_solve_island_thread, constraint_islands.data());
+	} else {
+		for (uint32_t i = 0; i < constraint_islands.size(); i++) {
+			_solve_island(constraint_islands[i], p_iterations, p_delta);
 		}
 	}
 
+	for (uint32_t i = 0; i < serial_constraint_islands.size(); i++) {
+		_solve_island(serial_constraint_islands[i], p_iterations, p_delta);
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_SOLVE_CONSTRAINTS, profile_endtime - profile_begtime);
@@ -273,15 +311,21 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SLEEP / WAKE UP ISLANDS */
 
-	{
-		BodySW *bi = island_list;
-		while (bi) {
+	body_islands_can_sleep.resize(body_islands.size());
 
-			_check_suspend(bi, p_delta);
-			bi = bi->get_island_list_next();
+	if (parallel) {
+		thread_pool->parallel_for(body_islands.size(), this, &StepSW::_sleep_test_island_thread, body_islands.data());
+	} else {
+		for (uint32_t i = 0; i < body_islands.size(); i++) {
+			body_islands_can_sleep[i] = _sleep_test_island(body_islands[i], p_delta);
 		}
 	}
 
+	// Activation changes the active body list, which orders the next step.
+	for (uint32_t i = 0; i < body_islands.size(); i++) {
+		_check_suspend(body_islands[i], body_islands_can_sleep[i]);
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_INTEGRATE_VELOCITIES, profile_endtime - profile_begtime);
@@ -296,4 +340,6 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 StepSW::StepSW() {
 
 	_step = 1;
+	iterations = 0;
+	delta = 0;
 }
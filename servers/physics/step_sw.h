@@ -33,14 +33,31 @@
 
 #include "space_sw.h"
 
+#include <vector>
+
 class StepSW {
 
 	uint64_t _step;
 
-	void _populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island);
+	int iterations;
+	real_t delta;
+
+	// Islands in the order they were generated, so stepping doesn't depend on how they are scheduled.
+	// Constraint islands that write to shared objects are processed on the stepping thread.
+	std::vector<BodySW *> body_islands;
+	std::vector<uint8_t> body_islands_can_sleep;
+	std::vector<ConstraintSW *> constraint_islands;
+	std::vector<ConstraintSW *> serial_constraint_islands;
+
+	void _populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island, bool &r_island_local);
 	void _setup_island(ConstraintSW *p_island, real_t p_delta);
 	void _solve_island(ConstraintSW *p_island, int p_iterations, real_t p_delta);
-	void _check_suspend(BodySW *p_island, real_t p_delta);
+	bool _sleep_test_island(BodySW *p_island, real_t p_delta);
+	void _check_suspend(BodySW *p_island, bool p_can_sleep);
+
+	void _setup_island_thread(uint32_t p_index, ConstraintSW **p_islands);
+	void _solve_island_thread(uint32_t p_index, ConstraintSW **p_islands);
+	void _sleep_test_island_thread(uint32_t p_index, BodySW **p_islands);
 
 public:
 	void step(SpaceSW *p_space, real_t p_delta, int p_iterations);
@@ -44,6 +44,8 @@ class AreaPair2DSW : public Constraint2DSW {
 	bool colliding;
 
 public:
+	virtual bool is_island_local() const { return false; } // Updates the area queries.
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -60,6 +62,8 @@ class Area2Pair2DSW : public Constraint2DSW {
 	bool colliding;
 
 public:
+	virtual bool is_island_local() const { return false; }
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
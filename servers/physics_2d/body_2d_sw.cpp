@@ -530,29 +530,32 @@ void Body2DSW::integrate_forces(real_t p_step) {
 	biased_angular_velocity = 0;
 	biased_linear_velocity = Vector2();
 
-	if (do_motion) { //shapes temporarily extend for raycast
-		_update_shapes_with_motion(motion);
-	}
+	//shapes temporarily extend for raycast
+	shapes_motion_pending = do_motion;
+	shapes_motion = motion;
 
 	// damp_area=NULL; // clear the area, so it is set in the next frame
 	def_area = NULL; // clear the area, so it is set in the next frame
 	contact_count = 0;
 }
 
+void Body2DSW::update_shapes_after_forces() {
+
+	if (shapes_motion_pending) {
+		_update_shapes_with_motion(shapes_motion);
+		shapes_motion_pending = false;
+	}
+}
+
 void Body2DSW::integrate_velocities(real_t p_step) {
 
 	if (mode == Physics2DServer::BODY_MODE_STATIC)
 		return;
 
-	if (fi_callback)
-		get_space()->body_add_to_state_query_list(&direct_state_query_list);
-
 	if (mode == Physics2DServer::BODY_MODE_KINEMATIC) {
 
 		_set_transform(new_transform, false);
 		_set_inv_transform(new_transform.affine_inverse());
-		if (contacts.size() == 0 && linear_velocity == Vector2() && angular_velocity == 0)
-			set_active(false); //stopped moving, deactivate
 		return;
 	}
 
@@ -562,7 +565,7 @@ void Body2DSW::integrate_velocities(real_t p_step) {
 	real_t angle = get_transform().get_rotation() + total_angular_velocity * p_step;
 	Vector2 pos = get_transform().get_origin() + total_linear_velocity * p_step;
 
-	_set_transform(Transform2D(angle, pos), continuous_cd_mode == Physics2DServer::CCD_MODE_DISABLED);
+	_set_transform(Transform2D(angle, pos), false);
 	_set_inv_transform(get_transform().inverse());
 
 	if (continuous_cd_mode != Physics2DServer::CCD_MODE_DISABLED)
@@ -571,6 +574,25 @@ void Body2DSW::integrate_velocities(real_t p_step) {
 	//_update_inertia_tensor();
 }
 
+void Body2DSW::update_after_velocities() {
+
+	if (mode == Physics2DServer::BODY_MODE_STATIC)
+		return;
+
+	if (fi_callback)
+		get_space()->body_add_to_state_query_list(&direct_state_query_list);
+
+	if (mode == Physics2DServer::BODY_MODE_KINEMATIC) {
+
+		if (contacts.size() == 0 && linear_velocity == Vector2() && angular_velocity == 0)
+			set_active(false); //stopped moving, deactivate
+		return;
+	}
+
+	if (continuous_cd_mode == Physics2DServer::CCD_MODE_DISABLED)
+		_update_shapes();
+}
+
 void Body2DSW::wakeup_neighbours() {
 
 	for (Map<Constraint2DSW *, int>::Element *E = constraint_map.front(); E; E = E->next()) {
@@ -689,6 +711,7 @@ Body2DSW::Body2DSW() :
 	contact_count = 0;
 	gravity_scale = 1.0;
 	first_integration = false;
+	shapes_motion_pending = false;
 
 	still_time = 0;
 	continuous_cd_mode = Physics2DServer::CCD_MODE_DISABLED;
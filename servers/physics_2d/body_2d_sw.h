@@ -87,6 +87,9 @@ class Body2DSW : public CollisionObject2DSW {
 	virtual void _shapes_changed();
 	Transform2D new_transform;
 
+	bool shapes_motion_pending;
+	Vector2 shapes_motion; // Swept by the shapes in update_shapes_after_forces().
+
 	Map<Constraint2DSW *, int> constraint_map;
 
 	struct AreaCMP {
@@ -204,22 +207,32 @@ public:
 	_FORCE_INLINE_ void set_biased_angular_velocity(real_t p_velocity) { biased_angular_velocity = p_velocity; }
 	_FORCE_INLINE_ real_t get_biased_angular_velocity() const { return biased_angular_velocity; }
 
+	// Impulses don't move static and kinematic bodies, skip them so islands solved in parallel never write
+	// to the bodies they share.
 	_FORCE_INLINE_ void apply_central_impulse(const Vector2 &p_impulse) {
+		if (mode <= Physics2DServer::BODY_MODE_KINEMATIC)
+			return;
 		linear_velocity += p_impulse * _inv_mass;
 	}
 
 	_FORCE_INLINE_ void apply_impulse(const Vector2 &p_offset, const Vector2 &p_impulse) {
 
+		if (mode <= Physics2DServer::BODY_MODE_KINEMATIC)
+			return;
 		linear_velocity += p_impulse * _inv_mass;
 		angular_velocity += _inv_inertia * p_offset.cross(p_impulse);
 	}
 
 	_FORCE_INLINE_ void apply_torque_impulse(real_t p_torque) {
+		if (mode <= Physics2DServer::BODY_MODE_KINEMATIC)
+			return;
 		angular_velocity += _inv_inertia * p_torque;
 	}
 
 	_FORCE_INLINE_ void apply_bias_impulse(const Vector2 &p_pos, const Vector2 &p_j) {
 
+		if (mode <= Physics2DServer::BODY_MODE_KINEMATIC)
+			return;
 		biased_linear_velocity += p_j * _inv_mass;
 		biased_angular_velocity += _inv_inertia * p_pos.cross(p_j);
 	}
@@ -277,8 +290,12 @@ public:
 	_FORCE_INLINE_ real_t get_linear_damp() const { return linear_damp; }
 	_FORCE_INLINE_ real_t get_angular_damp() const { return angular_damp; }
 
+	// The integrations only write to the body, so bodies can be integrated in parallel. The updates that
+	// follow each of them change the broadphase and the space lists, they run serially in active list order.
 	void integrate_forces(real_t p_step);
+	void update_shapes_after_forces();
 	void integrate_velocities(real_t p_step);
+	void update_after_velocities();
 
 	_FORCE_INLINE_ Vector2 get_motion() const {
 
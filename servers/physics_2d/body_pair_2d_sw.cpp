@@ -227,6 +227,16 @@ real_t combine_friction(Body2DSW *A, Body2DSW *B) {
 	return ABS(MIN(A->get_friction(), B->get_friction()));
 }
 
+bool BodyPair2DSW::is_island_local() const {
+
+	// Static and kinematic bodies are shared between islands, reporting their contacts writes to them.
+	if (A->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && A->can_report_contacts())
+		return false;
+	if (B->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && B->can_report_contacts())
+		return false;
+	return true;
+}
+
 bool BodyPair2DSW::setup(real_t p_step) {
 
 	//cannot collide
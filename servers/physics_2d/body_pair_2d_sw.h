@@ -86,6 +86,8 @@ class BodyPair2DSW : public Constraint2DSW {
 	_FORCE_INLINE_ void _contact_added_callback(const Vector2 &p_point_A, const Vector2 &p_point_B);
 
 public:
+	virtual bool is_island_local() const;
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
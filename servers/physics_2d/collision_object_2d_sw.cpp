@@ -207,7 +207,7 @@ void CollisionObject2DSW::_update_shapes_with_motion(const Vector2 &p_motion) {
 	if (!space)
 		return;
 
-	for (decltype(shapes.size()) i; i < shapes.size(); ++i) {
+	for (decltype(shapes.size()) i = 0; i < shapes.size(); ++i) {
 		Shape &s = shapes[i];
 
 		if (s.disabled)
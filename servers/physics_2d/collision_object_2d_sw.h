@@ -80,9 +80,8 @@ private:
 
 	SelfList<CollisionObject2DSW> pending_shape_update_list;
 
-	void _update_shapes();
-
 protected:
+	void _update_shapes();
 	void _update_shapes_with_motion(const Vector2 &p_motion);
 	void _unregister_shapes();
 
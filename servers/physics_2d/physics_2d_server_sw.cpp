@@ -30,6 +30,7 @@
 
 #include "physics_2d_server_sw.h"
 #include "broad_phase_2d_basic.h"
+#include "broad_phase_2d_bvh.h"
 #include "broad_phase_2d_hash_grid.h"
 #include "collision_solver_2d_sw.h"
 #include "core/os/os.h"
@@ -1447,7 +1448,14 @@ Physics2DServerSW *Physics2DServerSW::singletonsw = NULL;
 Physics2DServerSW::Physics2DServerSW() {
 
 	singletonsw = this;
-	BroadPhase2DSW::create_func = BroadPhase2DHashGrid::_create;
+
+	String broad_phase = GLOBAL_DEF("physics/2d/broad_phase", "HashGrid");
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/2d/broad_phase", PropertyInfo(Variant::STRING, "physics/2d/broad_phase", PROPERTY_HINT_ENUM, "HashGrid,BVH"));
+	if (broad_phase == "BVH") {
+		BroadPhase2DSW::create_func = BroadPhase2DBVH::_create;
+	} else {
+		BroadPhase2DSW::create_func = BroadPhase2DHashGrid::_create;
+	}
 	//BroadPhase2DSW::create_func=BroadPhase2DBasic::_create;
 
 	active = true;
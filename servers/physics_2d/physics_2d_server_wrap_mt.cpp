@@ -53,6 +53,7 @@ void Physics2DServerWrapMT::_thread_callback(void *_instance) {
 void Physics2DServerWrapMT::thread_loop() {
 
 	server_thread = Thread::get_caller_id();
+	Memory::set_thread_tag(Memory::TAG_PHYSICS_2D);
 
 	physics_2d_server->init();
 
@@ -30,8 +30,10 @@
 
 #include "step_2d_sw.h"
 #include "core/os/os.h"
+#include "core/os/thread_pool.h"
+#include "core/project_settings.h"
 
-void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
+void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island, bool &r_island_local) {
 
 	p_body->set_island_step(_step);
 	p_body->set_island_next(*p_island);
@@ -46,40 +48,46 @@ void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constrain
 		c->set_island_next(*p_constraint_island);
 		*p_constraint_island = c;
 
+		if (!c->is_island_local())
+			r_island_local = false;
+
 		for (int i = 0; i < c->get_body_count(); i++) {
 			if (i == E->get())
 				continue;
 			Body2DSW *b = c->get_body_ptr()[i];
 			if (b->get_island_step() == _step || b->get_mode() == Physics2DServer::BODY_MODE_STATIC || b->get_mode() == Physics2DServer::BODY_MODE_KINEMATIC)
 				continue; //no go
-			_populate_island(c->get_body_ptr()[i], p_island, p_constraint_island);
+			_populate_island(c->get_body_ptr()[i], p_island, p_constraint_island, r_island_local);
 		}
 	}
 }
 
-bool Step2DSW::_setup_island(Constraint2DSW *p_island, real_t p_delta) {
+Constraint2DSW *Step2DSW::_setup_island(Constraint2DSW *p_island, real_t p_delta) {
 
-	Constraint2DSW *ci = p_island;
+	//remove from island if process fails, returns the new root
+	Constraint2DSW *root = NULL;
 	Constraint2DSW *prev_ci = NULL;
-	bool removed_root = false;
+
+	Constraint2DSW *ci = p_island;
 	while (ci) {
-		bool process = ci->setup(p_delta);
+		Constraint2DSW *next = ci->get_island_next();
 
-		if (!process) {
-			//remove from island if process fails
+		if (ci->setup(p_delta)) {
 			if (prev_ci) {
-				prev_ci->set_island_next(ci->get_island_next());
+				prev_ci->set_island_next(ci);
 			} else {
-				removed_root = true;
-				prev_ci = ci;
+				root = ci;
 			}
-		} else {
 			prev_ci = ci;
 		}
-		ci = ci->get_island_next();
+		ci = next;
 	}
 
-	return removed_root;
+	if (prev_ci) {
+		prev_ci->set_island_next(NULL);
+	}
+
+	return root;
 }
 
 void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta) {
@@ -94,7 +102,7 @@ void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t
 	}
 }
 
-void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
+bool Step2DSW::_sleep_test_island(Body2DSW *p_island, real_t p_delta) {
 
 	bool can_sleep = true;
 
@@ -112,9 +120,14 @@ void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 		b = b->get_island_next();
 	}
 
+	return can_sleep;
+}
+
+void Step2DSW::_check_suspend(Body2DSW *p_island, bool p_can_sleep) {
+
 	//put all to sleep or wake up everyoen
 
-	b = p_island;
+	Body2DSW *b = p_island;
 	while (b) {
 
 		if (b->get_mode() == Physics2DServer::BODY_MODE_STATIC || b->get_mode() == Physics2DServer::BODY_MODE_KINEMATIC) {
@@ -124,19 +137,64 @@ void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 
 		bool active = b->is_active();
 
-		if (active == can_sleep)
-			b->set_active(!can_sleep);
+		if (active == p_can_sleep)
+			b->set_active(!p_can_sleep);
 
 		b = b->get_island_next();
 	}
 }
 
+void Step2DSW::_collect_active_bodies(const SelfList<Body2DSW>::List *p_body_list) {
+
+	active_bodies.clear();
+
+	const SelfList<Body2DSW> *b = p_body_list->first();
+	while (b) {
+		active_bodies.push_back(b->self());
+		b = b->next();
+	}
+}
+
+void Step2DSW::_integrate_forces_thread(uint32_t p_index, Body2DSW **p_bodies) {
+
+	p_bodies[p_index]->integrate_forces(delta);
+}
+
+void Step2DSW::_integrate_velocities_thread(uint32_t p_index, Body2DSW **p_bodies) {
+
+	p_bodies[p_index]->integrate_velocities(delta);
+}
+
+void Step2DSW::_setup_island_thread(uint32_t p_index, Constraint2DSW **p_islands) {
+
+	p_islands[p_index] = _setup_island(p_islands[p_index], delta);
+}
+
+void Step2DSW::_solve_island_thread(uint32_t p_index, Constraint2DSW **p_islands) {
+
+	if (p_islands[p_index])
+		_solve_island(p_islands[p_index], iterations, delta);
+}
+
+void Step2DSW::_sleep_test_island_thread(uint32_t p_index, Body2DSW **p_islands) {
+
+	body_islands_can_sleep[p_index] = _sleep_test_island(p_islands[p_index], delta);
+}
+
 void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	p_space->lock(); // can't access space during this
 
 	p_space->setup(); //update inertias, etc
 
+	iterations = p_iterations;
+	delta = p_delta;
+
+	// Bodies and islands share nothing they write to, so the results are the same on any number of threads.
+	// Debug contacts are appended to the space, which only the stepping thread may do.
+	ThreadPool *thread_pool = ThreadPool::get_singleton();
+	bool use_threads = parallel && thread_pool && thread_pool->get_thread_count() > 0 && !p_space->is_debugging_contacts();
+
 	const SelfList<Body2DSW>::List *body_list = &p_space->get_active_body_list();
 
 	/* INTEGRATE FORCES */
@@ -144,17 +202,21 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	uint64_t profile_begtime = OS::get_singleton()->get_ticks_usec();
 	uint64_t profile_endtime = 0;
 
-	int active_count = 0;
+	_collect_active_bodies(body_list);
 
-	const SelfList<Body2DSW> *b = body_list->first();
-	while (b) {
+	if (use_threads) {
+		thread_pool->parallel_for(active_bodies.size(), this, &Step2DSW::_integrate_forces_thread, active_bodies.data());
+	} else {
+		for (uint32_t i = 0; i < active_bodies.size(); i++) {
+			active_bodies[i]->integrate_forces(p_delta);
+		}
+	}
 
-		b->self()->integrate_forces(p_delta);
-		b = b->next();
-		active_count++;
+	for (uint32_t i = 0; i < active_bodies.size(); i++) {
+		active_bodies[i]->update_shapes_after_forces();
 	}
 
-	p_space->set_active_objects(active_count);
+	p_space->set_active_objects(active_bodies.size());
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -164,12 +226,11 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* GENERATE CONSTRAINT ISLANDS */
 
-	Body2DSW *island_list = NULL;
-	Constraint2DSW *constraint_island_list = NULL;
-	b = body_list->first();
-
-	int island_count = 0;
+	body_islands.clear();
+	constraint_islands.clear();
+	serial_constraint_islands.clear();
 
+	const SelfList<Body2DSW> *b = body_list->first();
 	while (b) {
 		Body2DSW *body = b->self();
 
@@ -177,21 +238,22 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 			Body2DSW *island = NULL;
 			Constraint2DSW *constraint_island = NULL;
-			_populate_island(body, &island, &constraint_island);
+			bool island_local = true;
+			_populate_island(body, &island, &constraint_island, island_local);
 
-			island->set_island_list_next(island_list);
-			island_list = island;
+			body_islands.push_back(island);
 
 			if (constraint_island) {
-				constraint_island->set_island_list_next(constraint_island_list);
-				constraint_island_list = constraint_island;
-				island_count++;
+				if (island_local)
+					constraint_islands.push_back(constraint_island);
+				else
+					serial_constraint_islands.push_back(constraint_island);
 			}
 		}
 		b = b->next();
 	}
 
-	p_space->set_island_count(island_count);
+	p_space->set_island_count(constraint_islands.size() + serial_constraint_islands.size());
 
 	const SelfList<Area2DSW>::List &aml = p_space->get_moved_area_list();
 
@@ -203,8 +265,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 				continue;
 			c->set_island_step(_step);
 			c->set_island_next(NULL);
-			c->set_island_list_next(constraint_island_list);
-			constraint_island_list = c;
+			serial_constraint_islands.push_back(c);
 		}
 		p_space->area_remove_from_moved_list((SelfList<Area2DSW> *)aml.first()); //faster to remove here
 	}
@@ -217,44 +278,19 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		Constraint2DSW *prev_ci = NULL;
-		while (ci) {
-
-			if (_setup_island(ci, p_delta)) {
-
-				//removed the root from the island graph because it is not to be processed
-
-				Constraint2DSW *next = ci->get_island_next();
-
-				if (next) {
-					//root from list being deleted no longer exists, replace by next
-					next->set_island_list_next(ci->get_island_list_next());
-					if (prev_ci) {
-						prev_ci->set_island_list_next(next);
-					} else {
-						constraint_island_list = next;
-					}
-					prev_ci = next;
-				} else {
-
-					//list is empty, just skip
-					if (prev_ci) {
-						prev_ci->set_island_list_next(ci->get_island_list_next());
-
-					} else {
-						constraint_island_list = ci->get_island_list_next();
-					}
-				}
-			} else {
-				prev_ci = ci;
-			}
-
-			ci = ci->get_island_list_next();
+	// Constraints that don't need processing are removed, islands left empty become NULL.
+	if (use_threads) {
+		thread_pool->parallel_for(constraint_islands.size(), this, &Step2DSW::_setup_island_thread, constraint_islands.data());
+	} else {
+		for (uint32_t i = 0; i < constraint_islands.size(); i++) {
+			constraint_islands[i] = _setup_island(constraint_islands[i], p_delta);
 		}
 	}
 
+	for (uint32_t i = 0; i < serial_constraint_islands.size(); i++) {
+		serial_constraint_islands[i] = _setup_island(serial_constraint_islands[i], p_delta);
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_SETUP_CONSTRAINTS, profile_endtime - profile_begtime);
@@ -263,15 +299,21 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
+	//iterating each island separatedly improves cache efficiency
+	if (use_threads) {
+		thread_pool->parallel_for(constraint_islands.size(), this, &Step2DSW::_solve_island_thread, constraint_islands.data());
+	} else {
+		for (uint32_t i = 0; i < constraint_islands.size(); i++) {
+			if (constraint_islands[i])
+				_solve_island(constraint_islands[i], p_iterations, p_delta);
 		}
 	}
 
+	for (uint32_t i = 0; i < serial_constraint_islands.size(); i++) {
+		if (serial_constraint_islands[i])
+			_solve_island(serial_constraint_islands[i], p_iterations, p_delta);
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_SOLVE_CONSTRAINTS, profile_endtime - profile_begtime);
@@ -280,25 +322,38 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* INTEGRATE VELOCITIES */
 
-	b = body_list->first();
-	while (b) {
+	// Pairs created while moving the shapes may have activated kinematic bodies.
+	_collect_active_bodies(body_list);
+
+	if (use_threads) {
+		thread_pool->parallel_for(active_bodies.size(), this, &Step2DSW::_integrate_velocities_thread, active_bodies.data());
+	} else {
+		for (uint32_t i = 0; i < active_bodies.size(); i++) {
+			active_bodies[i]->integrate_velocities(p_delta);
+		}
+	}
 
-		const SelfList<Body2DSW> *n = b->next();
-		b->self()->integrate_velocities(p_delta);
-		b = n; // in case it shuts itself down
+	for (uint32_t i = 0; i < active_bodies.size(); i++) {
+		active_bodies[i]->update_after_velocities(); // may deactivate the body
 	}
 
 	/* SLEEP / WAKE UP ISLANDS */
 
-	{
-		Body2DSW *bi = island_list;
-		while (bi) {
+	body_islands_can_sleep.resize(body_islands.size());
 
-			_check_suspend(bi, p_delta);
-			bi = bi->get_island_list_next();
+	if (use_threads) {
+		thread_pool->parallel_for(body_islands.size(), this, &Step2DSW::_sleep_test_island_thread, body_islands.data());
+	} else {
+		for (uint32_t i = 0; i < body_islands.size(); i++) {
+			body_islands_can_sleep[i] = _sleep_test_island(body_islands[i], p_delta);
 		}
 	}
 
+	// Activation changes the active body list, which orders the next step.
+	for (uint32_t i = 0; i < body_islands.size(); i++) {
+		_check_suspend(body_islands[i], body_islands_can_sleep[i]);
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_INTEGRATE_VELOCITIES, profile_endtime - profile_begtime);
@@ -313,4 +368,9 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 Step2DSW::Step2DSW() {
 
 	_step = 1;
+	iterations = 0;
+	delta = 0;
+
+	// Same results either way, off keeps the whole step on the physics thread.
+	parallel = GLOBAL_DEF("physics/2d/parallel_step", true);
 }
@@ -33,14 +33,36 @@
 
 #include "space_2d_sw.h"
 
+#include <vector>
+
 class Step2DSW {
 
 	uint64_t _step;
 
-	void _populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island);
-	bool _setup_island(Constraint2DSW *p_island, real_t p_delta);
+	bool parallel;
+	int iterations;
+	real_t delta;
+
+	// Bodies and islands in list and generation order, so stepping doesn't depend on how they are scheduled.
+	// Constraint islands that write to shared objects are processed on the stepping thread.
+	std::vector<Body2DSW *> active_bodies;
+	std::vector<Body2DSW *> body_islands;
+	std::vector<uint8_t> body_islands_can_sleep;
+	std::vector<Constraint2DSW *> constraint_islands;
+	std::vector<Constraint2DSW *> serial_constraint_islands;
+
+	void _populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island, bool &r_island_local);
+	Constraint2DSW *_setup_island(Constraint2DSW *p_island, real_t p_delta);
 	void _solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta);
-	void _check_suspend(Body2DSW *p_island, real_t p_delta);
+	bool _sleep_test_island(Body2DSW *p_island, real_t p_delta);
+	void _check_suspend(Body2DSW *p_island, bool p_can_sleep);
+	void _collect_active_bodies(const SelfList<Body2DSW>::List *p_body_list);
+
+	void _integrate_forces_thread(uint32_t p_index, Body2DSW **p_bodies);
+	void _integrate_velocities_thread(uint32_t p_index, Body2DSW **p_bodies);
+	void _setup_island_thread(uint32_t p_index, Constraint2DSW **p_islands);
+	void _solve_island_thread(uint32_t p_index, Constraint2DSW **p_islands);
+	void _sleep_test_island_thread(uint32_t p_index, Body2DSW **p_islands);
 
 public:
 	void step(Space2DSW *p_space, real_t p_delta, int p_iterations);
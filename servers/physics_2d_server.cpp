@@ -198,9 +198,8 @@ void Physics2DShapeQueryParameters::set_exclude(const std::vector<RID> &p_exclud
 std::vector<RID> Physics2DShapeQueryParameters::get_exclude() const {
 
 	std::vector<RID> ret(exclude.size());
-	int idx = 0;
-	for (Set<RID>::Element *E = exclude.front(); E; E = E->next()) {
-		ret[idx] = E->get();
+	for (int i = 0; i < exclude.size(); i++) {
+		ret[i] = exclude[i];
 	}
 	return ret;
 }
@@ -270,7 +269,7 @@ Physics2DShapeQueryParameters::Physics2DShapeQueryParameters() {
 Dictionary Physics2DDirectSpaceState::_intersect_ray(const Vector2 &p_from, const Vector2 &p_to, const std::vector<RID> &p_exclude, uint32_t p_layers, bool p_collide_with_bodies, bool p_collide_with_areas) {
 
 	RayResult inters;
-	Set<RID> exclude;
+	VSet<RID> exclude;
 	for (auto &&ex : p_exclude)
 		exclude.insert(ex);
 
@@ -331,7 +330,7 @@ Array Physics2DDirectSpaceState::_cast_motion(const Ref<Physics2DShapeQueryParam
 
 Array Physics2DDirectSpaceState::_intersect_point_impl(const Vector2 &p_point, int p_max_results, const std::vector<RID> &p_exclude, uint32_t p_layers, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_filter_by_canvas, ObjectID p_canvas_instance_id) {
 
-	Set<RID> exclude;
+	VSet<RID> exclude;
 	for (auto &&ex : p_exclude)
 		exclude.insert(ex);
 
@@ -410,6 +409,28 @@ Dictionary Physics2DDirectSpaceState::_get_rest_info(const Ref<Physics2DShapeQue
 	return r;
 }
 
+int Physics2DDirectSpaceState::intersect_point_all(const Vector2 &p_point, std::vector<ShapeResult> &r_results, const VSet<RID> &p_exclude, uint32_t p_collision_layer, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_point) {
+
+	r_results.resize(MAX(r_results.capacity(), (size_t)32));
+	int rc;
+	while ((rc = intersect_point(p_point, r_results.data(), r_results.size(), p_exclude, p_collision_layer, p_collide_with_bodies, p_collide_with_areas, p_pick_point)) == (int)r_results.size()) {
+		r_results.resize(r_results.size() * 2); // Results may have been dropped, query again.
+	}
+	r_results.resize(rc);
+	return rc;
+}
+
+int Physics2DDirectSpaceState::intersect_shape_all(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, float p_margin, std::vector<ShapeResult> &r_results, const VSet<RID> &p_exclude, uint32_t p_collision_layer, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	r_results.resize(MAX(r_results.capacity(), (size_t)32));
+	int rc;
+	while ((rc = intersect_shape(p_shape, p_xform, p_motion, p_margin, r_results.data(), r_results.size(), p_exclude, p_collision_layer, p_collide_with_bodies, p_collide_with_areas)) == (int)r_results.size()) {
+		r_results.resize(r_results.size() * 2); // Results may have been dropped, query again.
+	}
+	r_results.resize(rc);
+	return rc;
+}
+
 Physics2DDirectSpaceState::Physics2DDirectSpaceState() {
 }
 
@@ -193,11 +193,9 @@ void PhysicsShapeQueryParameters::set_exclude(const std::vector<RID> &p_exclude)
 
 std::vector<RID> PhysicsShapeQueryParameters::get_exclude() const {
 
-	std::vector<RID> ret;
-	ret.resize(exclude.size());
-	int idx = 0;
-	for (Set<RID>::Element *E = exclude.front(); E; E = E->next()) {
-		ret[idx] = E->get();
+	std::vector<RID> ret(exclude.size());
+	for (int i = 0; i < exclude.size(); i++) {
+		ret[i] = exclude[i];
 	}
 	return ret;
 }
@@ -265,7 +263,7 @@ PhysicsShapeQueryParameters::PhysicsShapeQueryParameters() {
 Dictionary PhysicsDirectSpaceState::_intersect_ray(const Vector3 &p_from, const Vector3 &p_to, const std::vector<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 
 	RayResult inters;
-	Set<RID> exclude;
+	VSet<RID> exclude;
 	for (auto &&ex : p_exclude)
 		exclude.insert(ex);
 
@@ -358,6 +356,28 @@ Dictionary PhysicsDirectSpaceState::_get_rest_info(const Ref<PhysicsShapeQueryPa
 	return r;
 }
 
+int PhysicsDirectSpaceState::intersect_point_all(const Vector3 &p_point, std::vector<ShapeResult> &r_results, const VSet<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	r_results.resize(MAX(r_results.capacity(), (size_t)32));
+	int rc;
+	while ((rc = intersect_point(p_point, r_results.data(), r_results.size(), p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) == (int)r_results.size()) {
+		r_results.resize(r_results.size() * 2); // Results may have been dropped, query again.
+	}
+	r_results.resize(rc);
+	return rc;
+}
+
+int PhysicsDirectSpaceState::intersect_shape_all(const RID &p_shape, const Transform &p_xform, float p_margin, std::vector<ShapeResult> &r_results, const VSet<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	r_results.resize(MAX(r_results.capacity(), (size_t)32));
+	int rc;
+	while ((rc = intersect_shape(p_shape, p_xform, p_margin, r_results.data(), r_results.size(), p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) == (int)r_results.size()) {
+		r_results.resize(r_results.size() * 2); // Results may have been dropped, query again.
+	}
+	r_results.resize(rc);
+	return rc;
+}
+
 PhysicsDirectSpaceState::PhysicsDirectSpaceState() {
 }
 
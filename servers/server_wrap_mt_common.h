@@ -395,6 +395,16 @@
 		}                                                                 \
 	}
 
+// Batched variant of a FUNC2 method, the whole array goes through the command queue in as few commands as possible.
+#define FUNC2BATCH(m_batch_type, m_type, m_arg1, m_arg2)                                 \
+	virtual void m_batch_type(const m_arg1 *p1, const m_arg2 *p2, int p_count) {         \
+		if (Thread::get_caller_id() != server_thread) {                                  \
+			command_queue.push_batch(server_name, &ServerName::m_type, p_count, p1, p2); \
+		} else {                                                                         \
+			server_name->m_batch_type(p1, p2, p_count);                                  \
+		}                                                                                \
+	}
+
 #define FUNC2C(m_type, m_arg1, m_arg2)                                    \
 	virtual void m_type(m_arg1 p1, m_arg2 p2) const {                     \
 		if (Thread::get_caller_id() != server_thread) {                   \
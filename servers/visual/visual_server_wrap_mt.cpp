@@ -60,6 +60,7 @@ void VisualServerWrapMT::_thread_callback(void *_instance) {
 void VisualServerWrapMT::thread_loop() {
 
 	server_thread = Thread::get_caller_id();
+	Memory::set_thread_tag(Memory::TAG_RENDERING);
 
 	OS::get_singleton()->make_rendering_thread();
 
@@ -2313,6 +2313,13 @@ void VisualServer::_camera_set_orthogonal(RID p_camera, float p_size, float p_z_
 	camera_set_orthogonal(p_camera, p_size, p_z_near, p_z_far);
 }
 
+void VisualServer::instance_set_transforms(const RID *p_instances, const Transform *p_transforms, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		instance_set_transform(p_instances[i], p_transforms[i]);
+	}
+}
+
 void VisualServer::mesh_add_surface_from_mesh_data(RID p_mesh, const Geometry::MeshData &p_mesh_data) {
 
 	PoolVector<Vector3> vertices;